@@ -37,6 +37,20 @@ limitations under the License.
 namespace tensorflow {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
+constexpr size_t BFCAllocator::kMaxThreadCachedChunkSize;
+
+namespace {
+
+// Threads are assigned to thread caches round-robin, so that each of the
+// first BFCAllocator::kNumThreadCaches threads has a cache of its own.
+int CurrentThreadCacheIndex(int num_caches) {
+  static std::atomic<int> next_index{0};
+  thread_local const int index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+  return index % num_caches;
+}
+
+}  // namespace
 
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name,
@@ -399,6 +413,17 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
+  if (freed_before == 0) {
+    const int cache_index = ThreadCacheIndexFor(rounded_bytes);
+    if (cache_index >= 0) {
+      void* ptr = AllocateFromThreadCache(&thread_caches_[cache_index],
+                                          rounded_bytes, num_bytes);
+      if (ptr != nullptr) {
+        return ptr;
+      }
+    }
+  }
+
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
@@ -413,6 +438,15 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     return ptr;
   }
 
+  // Chunks held by thread caches are reused before the allocator grows.
+  if (thread_caches_ != nullptr && FlushThreadCaches()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Try to extend
   if (Extend(unused_alignment, rounded_bytes)) {
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
@@ -497,8 +531,9 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
   tensorflow::profiler::TraceMe::InstantActivity(
       [this, traceme_name, chunk_ptr, req_bytes, alloc_bytes]()
           TF_NO_THREAD_SAFETY_ANALYSIS {
+            const AllocatorStats stats = CurrentStats();
             int64 bytes_available =
-                memory_limit_ - stats_.bytes_reserved - stats_.bytes_in_use;
+                memory_limit_ - stats.bytes_reserved - stats.bytes_in_use;
             const auto& annotation =
                 ScopedMemoryDebugAnnotation::CurrentAnnotation();
             std::string tensor_shape;
@@ -507,11 +542,11 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
             }
             return tensorflow::profiler::TraceMeEncode(
                 traceme_name, {{"allocator_name", name_},
-                               {"bytes_reserved", stats_.bytes_reserved},
-                               {"bytes_allocated", stats_.bytes_in_use},
+                               {"bytes_reserved", stats.bytes_reserved},
+                               {"bytes_allocated", stats.bytes_in_use},
                                {"bytes_available", bytes_available},
                                {"fragmentation", GetFragmentation()},
-                               {"peak_bytes_in_use", stats_.peak_bytes_in_use},
+                               {"peak_bytes_in_use", stats.peak_bytes_in_use},
                                {"requested_bytes", req_bytes},
                                {"allocation_bytes", alloc_bytes},
                                {"addr", reinterpret_cast<uint64>(chunk_ptr)},
@@ -574,6 +609,9 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
+        if (thread_caches_ != nullptr) {
+          AddClientBytesInUse(chunk->size);
+        }
 
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
@@ -658,6 +696,9 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     VLOG(2) << "tried to deallocate nullptr";
     return;
   }
+  if (thread_caches_ != nullptr && DeallocateToThreadCache(ptr)) {
+    return;
+  }
   mutex_lock l(lock_);
 
   // Find the chunk from the ptr.
@@ -665,19 +706,21 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   CHECK(h != kInvalidChunkHandle);
   // Record chunk information before it's freed.
   Chunk* chunk = ChunkFromHandle(h);
+  if (chunk->cache_index >= 0) {
+    // Served by a thread cache that cannot take the chunk back.
+    TakeFromThreadCache(h);
+  }
   void* chunk_ptr = chunk->ptr;
   int64 req_bytes = chunk->requested_size;
   int64 alloc_bytes = chunk->size;
 
-  MarkFree(h);
-
-  // Consider coalescing it.
-  if (timing_counter_) {
-    InsertFreeChunkIntoBin(h);
-    timestamped_chunks_.push_back(h);
-  } else {
-    InsertFreeChunkIntoBin(TryToCoalesce(h, false));
+  if (thread_caches_ != nullptr) {
+    client_bytes_in_use_.fetch_sub(alloc_bytes, std::memory_order_relaxed);
+    if (CacheChunk(h)) {
+      return;
+    }
   }
+  FreeChunk(h);
 
   // TraceMe needs to be added after MarkFree and InsertFreeChunkIntoBin for
   // correct aggregation stats (bytes_in_use, fragmentation).
@@ -781,6 +824,18 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
 #endif
 }
 
+void BFCAllocator::FreeChunk(BFCAllocator::ChunkHandle h) {
+  MarkFree(h);
+
+  // Consider coalescing it.
+  if (timing_counter_) {
+    InsertFreeChunkIntoBin(h);
+    timestamped_chunks_.push_back(h);
+  } else {
+    InsertFreeChunkIntoBin(TryToCoalesce(h, false));
+  }
+}
+
 BFCAllocator::ChunkHandle BFCAllocator::TryToCoalesce(ChunkHandle h,
                                                       bool ignore_freed_at) {
   Chunk* c = ChunkFromHandle(h);
@@ -907,6 +962,9 @@ size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(h != kInvalidChunkHandle)
       << "Asked for requested size of pointer we never allocated: " << ptr;
   const BFCAllocator::Chunk* c = ChunkFromHandle(h);
+  if (c->cache_index >= 0) {
+    return GetCachedAllocation(c).requested_size;
+  }
   return c->requested_size;
 }
 
@@ -925,6 +983,9 @@ int64 BFCAllocator::AllocationId(const void* ptr) const {
   CHECK(h != kInvalidChunkHandle)
       << "Asked for allocation id of pointer we never allocated: " << ptr;
   const BFCAllocator::Chunk* c = ChunkFromHandle(h);
+  if (c->cache_index >= 0) {
+    return GetCachedAllocation(c).allocation_id;
+  }
   return c->allocation_id;
 }
 
@@ -1077,7 +1138,7 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
             << (memory_limit_ - total_region_allocated_bytes_)
             << " curr_region_allocation_bytes_: "
             << curr_region_allocation_bytes_;
-  LOG(INFO) << "Stats: \n" << stats_.DebugString();
+  LOG(INFO) << "Stats: \n" << CurrentStats().DebugString();
 }
 
 void BFCAllocator::MaybeWriteMemoryMap() {
@@ -1102,6 +1163,9 @@ void BFCAllocator::MaybeWriteMemoryMap() {
 
 MemoryDump BFCAllocator::RecordMemoryMap() {
   mutex_lock l(lock_);
+  if (thread_caches_ != nullptr) {
+    FlushThreadCaches();
+  }
   return RecordMemoryMapInternal();
 }
 
@@ -1111,10 +1175,11 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
   // Record the general stats
   MemAllocatorStats* mas = md.mutable_stats();
-  mas->set_num_allocs(stats_.num_allocs);
-  mas->set_bytes_in_use(stats_.bytes_in_use);
-  mas->set_peak_bytes_in_use(stats_.peak_bytes_in_use);
-  mas->set_largest_alloc_size(stats_.largest_alloc_size);
+  const AllocatorStats stats = CurrentStats();
+  mas->set_num_allocs(stats.num_allocs);
+  mas->set_bytes_in_use(stats.bytes_in_use);
+  mas->set_peak_bytes_in_use(stats.peak_bytes_in_use);
+  mas->set_largest_alloc_size(stats.largest_alloc_size);
 
   // Record summary data for every bin.
   const std::array<BinDebugInfo, kNumBins> bin_infos = get_bin_debug_info();
@@ -1173,7 +1238,7 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  return CurrentStats();
 }
 
 bool BFCAllocator::ClearStats() {
@@ -1181,9 +1246,246 @@ bool BFCAllocator::ClearStats() {
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
+  if (thread_caches_ != nullptr) {
+    client_peak_bytes_in_use_.store(
+        client_bytes_in_use_.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    for (int i = 0; i < kNumThreadCaches; ++i) {
+      ThreadCache* cache = &thread_caches_[i];
+      mutex_lock cache_lock(cache->mu);
+      cache->num_allocs = 0;
+      cache->largest_alloc_size = 0;
+    }
+  }
+  return true;
+}
+
+AllocatorStats BFCAllocator::CurrentStats() {
+  AllocatorStats stats = stats_;
+  if (thread_caches_ != nullptr) {
+    stats.bytes_in_use = client_bytes_in_use_.load(std::memory_order_relaxed);
+    stats.peak_bytes_in_use =
+        client_peak_bytes_in_use_.load(std::memory_order_relaxed);
+    for (int i = 0; i < kNumThreadCaches; ++i) {
+      ThreadCache* cache = &thread_caches_[i];
+      mutex_lock cache_lock(cache->mu);
+      stats.num_allocs += cache->num_allocs;
+      stats.largest_alloc_size =
+          std::max(stats.largest_alloc_size, cache->largest_alloc_size);
+    }
+  }
+  return stats;
+}
+
+void BFCAllocator::AddClientBytesInUse(int64 bytes) {
+  const int64 bytes_in_use =
+      client_bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  int64 peak = client_peak_bytes_in_use_.load(std::memory_order_relaxed);
+  while (bytes_in_use > peak &&
+         !client_peak_bytes_in_use_.compare_exchange_weak(
+             peak, bytes_in_use, std::memory_order_relaxed)) {
+  }
+}
+
+void BFCAllocator::EnableThreadCaches() {
+  mutex_lock l(lock_);
+  DCHECK(thread_caches_ == nullptr);
+  thread_caches_.reset(new ThreadCache[kNumThreadCaches]);
+  client_bytes_in_use_.store(stats_.bytes_in_use, std::memory_order_relaxed);
+  client_peak_bytes_in_use_.store(stats_.peak_bytes_in_use,
+                                  std::memory_order_relaxed);
+}
+
+int BFCAllocator::ThreadCacheIndexFor(size_t rounded_bytes) const {
+#ifdef TENSORFLOW_MEM_DEBUG
+  // Chunks record the op and step that allocated them.
+  return -1;
+#else
+  // Timestamped chunks must go through the bins, and the profiler expects
+  // an event for every allocation.
+  if (thread_caches_ == nullptr || rounded_bytes > kMaxThreadCachedChunkSize ||
+      timing_counter_ != nullptr ||
+      profiler::TraceMe::Active(profiler::TraceMeLevel::kInfo)) {
+    return -1;
+  }
+  return CurrentThreadCacheIndex(kNumThreadCaches);
+#endif
+}
+
+void* BFCAllocator::AllocateFromThreadCache(ThreadCache* cache,
+                                            size_t rounded_bytes,
+                                            size_t num_bytes) {
+  // Like FindChunkPtr, only use chunks that are too small to be split.
+  const size_t max_size =
+      std::min(2 * rounded_bytes - kMinAllocationSize,
+               kMaxThreadCachedChunkSize);
+  void* ptr = nullptr;
+  size_t size = rounded_bytes;
+  bool flush;
+  {
+    mutex_lock l(cache->mu);
+    for (; size <= max_size; size += kMinAllocationSize) {
+      const int size_class = ThreadCacheClass(size);
+      std::vector<void*>& free_chunks = cache->free_chunks[size_class];
+      if (!free_chunks.empty()) {
+        ptr = free_chunks.back();
+        free_chunks.pop_back();
+        cache->low_water[size_class] =
+            std::min(cache->low_water[size_class], free_chunks.size());
+        break;
+      }
+    }
+    if (ptr == nullptr) {
+      return nullptr;
+    }
+    cache->free_bytes -= size;
+    cache->allocations[ptr] = {size, num_bytes, next_allocation_id_++};
+    ++cache->num_allocs;
+    cache->largest_alloc_size =
+        std::max<int64>(cache->largest_alloc_size, size);
+    flush = ++cache->num_ops >= kThreadCacheFlushInterval;
+  }
+  AddClientBytesInUse(size);
+  if (flush) {
+    ReleaseIdleChunks(cache);
+  }
+  VLOG(4) << "Returning from thread cache: " << ptr;
+  return ptr;
+}
+
+bool BFCAllocator::DeallocateToThreadCache(void* ptr) {
+  if (timing_counter_ != nullptr ||
+      profiler::TraceMe::Active(profiler::TraceMeLevel::kInfo)) {
+    return false;
+  }
+  ThreadCache* cache =
+      &thread_caches_[CurrentThreadCacheIndex(kNumThreadCaches)];
+  size_t size;
+  bool flush;
+  {
+    mutex_lock l(cache->mu);
+    auto it = cache->allocations.find(ptr);
+    if (it == cache->allocations.end()) {
+      return false;
+    }
+    size = it->second.size;
+    if (cache->free_bytes + size > kMaxThreadCacheBytes) {
+      return false;
+    }
+    cache->allocations.erase(it);
+    cache->free_chunks[ThreadCacheClass(size)].push_back(ptr);
+    cache->free_bytes += size;
+    flush = ++cache->num_ops >= kThreadCacheFlushInterval;
+  }
+  client_bytes_in_use_.fetch_sub(size, std::memory_order_relaxed);
+  if (flush) {
+    ReleaseIdleChunks(cache);
+  }
+  return true;
+}
+
+bool BFCAllocator::CacheChunk(ChunkHandle h) {
+  Chunk* c = ChunkFromHandle(h);
+  const int cache_index = ThreadCacheIndexFor(c->size);
+  if (cache_index < 0) {
+    return false;
+  }
+  ThreadCache* cache = &thread_caches_[cache_index];
+  mutex_lock l(cache->mu);
+  if (cache->free_bytes + c->size > kMaxThreadCacheBytes) {
+    return false;
+  }
+  c->cache_index = cache_index;
+  cache->free_chunks[ThreadCacheClass(c->size)].push_back(c->ptr);
+  cache->free_bytes += c->size;
+  if (++cache->num_ops >= kThreadCacheFlushInterval) {
+    ReleaseIdleChunksLocked(cache);
+  }
   return true;
 }
 
+void BFCAllocator::TakeFromThreadCache(ChunkHandle h) {
+  Chunk* c = ChunkFromHandle(h);
+  ThreadCache* cache = &thread_caches_[c->cache_index];
+  mutex_lock l(cache->mu);
+  auto it = cache->allocations.find(c->ptr);
+  CHECK(it != cache->allocations.end())
+      << "Deallocating a cached chunk that is not in use: " << c->ptr;
+  c->requested_size = it->second.requested_size;
+  c->allocation_id = it->second.allocation_id;
+  c->cache_index = -1;
+  cache->allocations.erase(it);
+}
+
+BFCAllocator::CachedAllocation BFCAllocator::GetCachedAllocation(
+    const Chunk* c) const {
+  ThreadCache* cache = &thread_caches_[c->cache_index];
+  mutex_lock l(cache->mu);
+  auto it = cache->allocations.find(c->ptr);
+  CHECK(it != cache->allocations.end())
+      << "Asked for a cached chunk that is not in use: " << c->ptr;
+  return it->second;
+}
+
+void BFCAllocator::ReturnCachedChunk(ThreadCache* cache, void* ptr) {
+  ChunkHandle h = region_manager_.get_handle(ptr);
+  CHECK(h != kInvalidChunkHandle);
+  Chunk* c = ChunkFromHandle(h);
+  c->cache_index = -1;
+  cache->free_bytes -= c->size;
+  FreeChunk(h);
+}
+
+void BFCAllocator::ReleaseIdleChunks(ThreadCache* cache) {
+  mutex_lock l(lock_);
+  mutex_lock cache_lock(cache->mu);
+  ReleaseIdleChunksLocked(cache);
+}
+
+void BFCAllocator::ReleaseIdleChunksLocked(ThreadCache* cache) {
+  for (int size_class = 0; size_class < kNumThreadCacheClasses;
+       ++size_class) {
+    // The free list never got shorter than its low water mark since the
+    // last flush, so that many of its oldest chunks were not needed.
+    std::vector<void*>& free_chunks = cache->free_chunks[size_class];
+    const size_t num_idle =
+        std::min(cache->low_water[size_class], free_chunks.size());
+    for (size_t i = 0; i < num_idle; ++i) {
+      ReturnCachedChunk(cache, free_chunks[i]);
+    }
+    free_chunks.erase(free_chunks.begin(), free_chunks.begin() + num_idle);
+    cache->low_water[size_class] = free_chunks.size();
+  }
+  cache->num_ops = 0;
+}
+
+bool BFCAllocator::FlushThreadCaches() {
+  bool returned_chunks = false;
+  for (int i = 0; i < kNumThreadCaches; ++i) {
+    ThreadCache* cache = &thread_caches_[i];
+    mutex_lock l(cache->mu);
+    for (int size_class = 0; size_class < kNumThreadCacheClasses;
+         ++size_class) {
+      std::vector<void*>& free_chunks = cache->free_chunks[size_class];
+      for (void* ptr : free_chunks) {
+        ReturnCachedChunk(cache, ptr);
+        returned_chunks = true;
+      }
+      free_chunks.clear();
+      cache->low_water[size_class] = 0;
+    }
+    for (const auto& allocation : cache->allocations) {
+      Chunk* c = ChunkFromHandle(region_manager_.get_handle(allocation.first));
+      c->requested_size = allocation.second.requested_size;
+      c->allocation_id = allocation.second.allocation_id;
+      c->cache_index = -1;
+    }
+    cache->allocations.clear();
+    cache->num_ops = 0;
+  }
+  return returned_chunks;
+}
+
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
 BFCAllocator::get_bin_debug_info() {
   std::array<BinDebugInfo, kNumBins> bin_infos;
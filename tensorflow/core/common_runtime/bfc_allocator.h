@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -79,6 +81,14 @@ class BFCAllocator : public Allocator {
 
   void SetTimingCounter(SharedCounter* sc) { timing_counter_ = sc; }
 
+  // Puts per-thread caches of recently freed small chunks in front of the
+  // allocator, so that threads which repeatedly allocate and free small
+  // buffers rarely contend on its lock. Each cache is bounded and returns
+  // chunks that it did not need for a while; all of them are returned when
+  // the allocator runs short of memory or records its memory map. Stats
+  // count cached chunks as free. Must be called before the first allocation.
+  void EnableThreadCaches();
+
   void SetSafeFrontier(uint64 count) override;
 
   bool ShouldRecordOpName() const { return true; }
@@ -194,6 +204,11 @@ class BFCAllocator : public Allocator {
     // Optional count when this chunk was most recently made free.
     uint64 freed_at_count = 0;
 
+    // Index of the ThreadCache that holds the chunk, or -1. A cached chunk is
+    // in use as far as the bins are concerned, and its requested_size and
+    // allocation_id are kept by the cache while it is handed out.
+    int cache_index = -1;
+
     bool in_use() const { return allocation_id != -1; }
 
 #ifdef TENSORFLOW_MEM_DEBUG
@@ -430,6 +445,96 @@ class BFCAllocator : public Allocator {
     std::vector<AllocationRegion> regions_;
   };
 
+  // Thread caches hold chunks of up to kMaxThreadCachedChunkSize bytes, and
+  // at most kMaxThreadCacheBytes free bytes each.
+  static constexpr int kNumThreadCaches = 32;
+  static constexpr size_t kMaxThreadCachedChunkSize = 8 << 10;
+  static constexpr size_t kMaxThreadCacheBytes = 256 << 10;
+  static constexpr int kNumThreadCacheClasses =
+      kMaxThreadCachedChunkSize >> kMinAllocationBits;
+  // Number of allocations and deallocations served by a thread cache after
+  // which it returns the chunks it did not need in that interval.
+  static constexpr int64 kThreadCacheFlushInterval = 1 << 14;
+
+  // An allocation served by a ThreadCache. Chunks can only be updated under
+  // lock_, so the cache keeps its metadata until the allocation is freed.
+  struct CachedAllocation {
+    size_t size;
+    size_t requested_size;
+    int64 allocation_id;
+  };
+
+  // Free chunks that are held back from the bins for the threads assigned
+  // to this cache. Lock order: lock_ before mu.
+  struct ThreadCache {
+    mutex mu;
+    // Free chunks of (i + 1) * kMinAllocationSize bytes for size class i.
+    std::vector<void*> free_chunks[kNumThreadCacheClasses] TF_GUARDED_BY(mu);
+    // The smallest size of each free list since the last flush.
+    size_t low_water[kNumThreadCacheClasses] TF_GUARDED_BY(mu) = {};
+    size_t free_bytes TF_GUARDED_BY(mu) = 0;
+    int64 num_ops TF_GUARDED_BY(mu) = 0;
+    absl::flat_hash_map<const void*, CachedAllocation> allocations
+        TF_GUARDED_BY(mu);
+    // The allocations served by this cache since the stats were cleared, and
+    // the largest of them. GetStats() adds them to stats_.
+    int64 num_allocs TF_GUARDED_BY(mu) = 0;
+    int64 largest_alloc_size TF_GUARDED_BY(mu) = 0;
+  };
+
+  static int ThreadCacheClass(size_t size) {
+    return (size >> kMinAllocationBits) - 1;
+  }
+
+  // Returns the index of the calling thread's cache if chunks of
+  // 'rounded_bytes' may be cached, and -1 otherwise.
+  int ThreadCacheIndexFor(size_t rounded_bytes) const;
+
+  // Serves an allocation from 'cache' without taking lock_. Returns nullptr
+  // if the cache holds no suitable chunk.
+  void* AllocateFromThreadCache(ThreadCache* cache, size_t rounded_bytes,
+                                size_t num_bytes)
+      TF_LOCKS_EXCLUDED(lock_, cache->mu);
+
+  // Returns 'ptr' to the calling thread's cache without taking lock_ if it
+  // was served by that cache. Returns false if lock_ is needed.
+  bool DeallocateToThreadCache(void* ptr) TF_LOCKS_EXCLUDED(lock_);
+
+  // Moves the in-use chunk 'h' into the calling thread's cache if there is
+  // room for it.
+  bool CacheChunk(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Hands the metadata of the cached allocation in chunk 'h' back to the
+  // chunk.
+  void TakeFromThreadCache(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the cached allocation held in chunk 'c'.
+  CachedAllocation GetCachedAllocation(const Chunk* c) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the free chunk at 'ptr' from 'cache' to the bins.
+  void ReturnCachedChunk(ThreadCache* cache, void* ptr)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_, cache->mu);
+
+  // Returns the chunks of 'cache' that stayed unused since its last flush.
+  void ReleaseIdleChunks(ThreadCache* cache)
+      TF_LOCKS_EXCLUDED(lock_, cache->mu);
+  void ReleaseIdleChunksLocked(ThreadCache* cache)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_, cache->mu);
+
+  // Returns every cached chunk to the bins, and the metadata of every
+  // cached allocation to its chunk. Returns true if any free chunk was
+  // returned.
+  bool FlushThreadCaches() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Adds 'bytes' handed out to a client to client_bytes_in_use_, and raises
+  // client_peak_bytes_in_use_ if that is a new peak.
+  void AddClientBytesInUse(int64 bytes);
+
+  // Returns stats_, corrected for the chunks held by thread caches and
+  // including the allocations they served.
+  AllocatorStats CurrentStats() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns 'bytes' rounded up to the next highest kMinAllocationSize.
   static size_t RoundedBytes(size_t bytes);
 
@@ -495,6 +600,10 @@ class BFCAllocator : public Allocator {
 
   void MarkFree(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Marks the chunk 'h' free and inserts it into its bin, coalescing it
+  // unless it is timestamped.
+  void FreeChunk(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   ChunkHandle TryToCoalesce(ChunkHandle h, bool ignore_freed_at)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
@@ -598,11 +707,23 @@ class BFCAllocator : public Allocator {
   ChunkHandle free_chunks_list_ TF_GUARDED_BY(lock_);
 
   // Counter containing the next unique identifier to assign to a
-  // newly-created chunk.
-  int64 next_allocation_id_ TF_GUARDED_BY(lock_);
+  // newly-created chunk. Atomic since thread caches assign identifiers
+  // without holding lock_.
+  std::atomic<int64> next_allocation_id_;
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  // Null unless EnableThreadCaches() was called.
+  std::unique_ptr<ThreadCache[]> thread_caches_;
+
+  // With thread caches, stats_ counts the chunks held by them as in use, so
+  // the bytes in use by clients and their peak are tracked here. Cache hits
+  // do not take lock_, so these are atomics, updated on every allocation and
+  // deallocation. Every increment is checked against the peak, so the peak is
+  // exact.
+  std::atomic<int64> client_bytes_in_use_{0};
+  std::atomic<int64> client_peak_bytes_in_use_{0};
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ = 0 TF_GUARDED_BY(lock_);
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
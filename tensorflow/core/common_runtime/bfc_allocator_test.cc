@@ -0,0 +1,280 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/bfc_memory_map.pb.h"
+
+namespace tensorflow {
+namespace {
+
+BFCAllocator* NewAllocator(bool thread_caches) {
+  BFCAllocator* a = new BFCAllocator(
+      new BasicCPUAllocator(port::kNUMANoAffinity, {}, {}), 1 << 30,
+      /*allow_growth=*/true, "bfc_test");
+  if (thread_caches) {
+    a->EnableThreadCaches();
+  }
+  return a;
+}
+
+void CheckStats(Allocator* a, int64 num_allocs, int64 bytes_in_use,
+                int64 peak_bytes_in_use, int64 largest_alloc_size) {
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, num_allocs);
+  EXPECT_EQ(stats->bytes_in_use, bytes_in_use);
+  EXPECT_EQ(stats->peak_bytes_in_use, peak_bytes_in_use);
+  EXPECT_EQ(stats->largest_alloc_size, largest_alloc_size);
+}
+
+// Runs `fn` on a thread of its own, which has a different thread cache than
+// the test's thread.
+void RunOnOtherThread(std::function<void()> fn) {
+  thread::ThreadPool pool(Env::Default(), "test", 1);
+  pool.Schedule(std::move(fn));
+}
+
+class BFCAllocatorTest : public ::testing::TestWithParam<bool> {
+ protected:
+  BFCAllocatorTest() : a_(NewAllocator(GetParam())) {}
+
+  std::unique_ptr<BFCAllocator> a_;
+};
+
+TEST_P(BFCAllocatorTest, Stats) {
+  void* p1 = a_->AllocateRaw(1, 1000);
+  void* p2 = a_->AllocateRaw(1, 2000);
+  CheckStats(a_.get(), 2, 3072, 3072, 2048);
+  a_->DeallocateRaw(p1);
+  CheckStats(a_.get(), 2, 2048, 3072, 2048);
+  p1 = a_->AllocateRaw(1, 1000);
+  CheckStats(a_.get(), 3, 3072, 3072, 2048);
+  a_->DeallocateRaw(p1);
+  a_->DeallocateRaw(p2);
+  CheckStats(a_.get(), 3, 0, 3072, 2048);
+
+  a_->ClearStats();
+  CheckStats(a_.get(), 0, 0, 0, 0);
+  p1 = a_->AllocateRaw(1, 1000);
+  CheckStats(a_.get(), 1, 1024, 1024, 1024);
+  a_->DeallocateRaw(p1);
+}
+
+TEST_P(BFCAllocatorTest, PeakIncludesCacheHits) {
+  void* p1 = a_->AllocateRaw(1, 1000);
+  void* p2 = a_->AllocateRaw(1, 1000);
+  a_->DeallocateRaw(p1);
+  a_->DeallocateRaw(p2);
+  a_->ClearStats();
+  // With thread caches, these are served and freed without taking the
+  // allocator lock.
+  p1 = a_->AllocateRaw(1, 1000);
+  p2 = a_->AllocateRaw(1, 1000);
+  a_->DeallocateRaw(p1);
+  a_->DeallocateRaw(p2);
+  CheckStats(a_.get(), 2, 0, 2048, 1024);
+}
+
+TEST_P(BFCAllocatorTest, AllocationMetadata) {
+  void* p1 = a_->AllocateRaw(1, 1000);
+  const int64 id1 = a_->AllocationId(p1);
+  a_->DeallocateRaw(p1);
+  void* p2 = a_->AllocateRaw(1, 900);
+  if (GetParam()) {
+    EXPECT_EQ(p1, p2);
+  }
+  EXPECT_GT(a_->AllocationId(p2), id1);
+  EXPECT_EQ(900, a_->RequestedSize(p2));
+  EXPECT_EQ(1024, a_->AllocatedSize(p2));
+
+  // Another thread sees the same metadata, and can free the allocation.
+  RunOnOtherThread([this, p2]() {
+    EXPECT_EQ(900, a_->RequestedSize(p2));
+    a_->DeallocateRaw(p2);
+  });
+  CheckStats(a_.get(), 2, 0, 1024, 1024);
+}
+
+TEST_P(BFCAllocatorTest, MemoryMapShowsCachedChunksAsFree) {
+  void* p1 = a_->AllocateRaw(1, 1000);
+  void* p2 = a_->AllocateRaw(1, 1000);
+  a_->DeallocateRaw(p1);
+  a_->DeallocateRaw(p2);
+  void* p3 = a_->AllocateRaw(1, 900);
+
+  MemoryDump dump = a_->RecordMemoryMap();
+  EXPECT_EQ(3, dump.stats().num_allocs());
+  EXPECT_EQ(1024, dump.stats().bytes_in_use());
+  EXPECT_EQ(2048, dump.stats().peak_bytes_in_use());
+  int num_in_use = 0;
+  for (const MemChunk& chunk : dump.chunk()) {
+    if (chunk.in_use()) {
+      ++num_in_use;
+      EXPECT_EQ(reinterpret_cast<uint64>(p3), chunk.address());
+      EXPECT_EQ(900, chunk.requested_size());
+    }
+  }
+  EXPECT_EQ(1, num_in_use);
+
+  // The allocation is still tracked once it is no longer cached.
+  EXPECT_EQ(900, a_->RequestedSize(p3));
+  a_->DeallocateRaw(p3);
+  CheckStats(a_.get(), 3, 0, 2048, 1024);
+}
+
+TEST_P(BFCAllocatorTest, CachedChunksAreReusedBeforeGrowing) {
+  std::unique_ptr<BFCAllocator> a(new BFCAllocator(
+      new BasicCPUAllocator(port::kNUMANoAffinity, {}, {}), 1 << 20,
+      /*allow_growth=*/false, "bfc_test"));
+  if (GetParam()) {
+    a->EnableThreadCaches();
+  }
+  // Fill the allocator with small chunks, free them, and allocate all the
+  // memory at once.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 256; ++i) {
+    ptrs.push_back(a->AllocateRaw(1, 4096));
+    ASSERT_NE(nullptr, ptrs.back());
+  }
+  for (void* p : ptrs) {
+    a->DeallocateRaw(p);
+  }
+  void* p = a->AllocateRaw(1, 1 << 20);
+  EXPECT_NE(nullptr, p);
+  a->DeallocateRaw(p);
+}
+
+TEST_P(BFCAllocatorTest, MultiThreaded) {
+  constexpr int kNumThreads = 8;
+  std::atomic<int64> num_allocs{0};
+  mutex mu;
+  std::vector<void*> shared;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([this, t, &num_allocs, &mu, &shared]() {
+        random::PhiloxRandom philox(t, 17);
+        random::SimplePhilox rand(&philox);
+        std::vector<void*> live;
+        for (int i = 0; i < 10000; ++i) {
+          const int op = rand.Uniform(4);
+          if (op < 2 || live.empty()) {
+            const size_t bytes = 1 + rand.Uniform(16 << 10);
+            void* p = a_->AllocateRaw(1, bytes);
+            ASSERT_NE(nullptr, p);
+            EXPECT_EQ(bytes, a_->RequestedSize(p));
+            live.push_back(p);
+            ++num_allocs;
+          } else if (op == 2) {
+            a_->DeallocateRaw(live.back());
+            live.pop_back();
+          } else {
+            // Hand the allocation to other threads, which may free it.
+            mutex_lock l(mu);
+            shared.push_back(live.back());
+            live.pop_back();
+            if (shared.size() > 16) {
+              a_->DeallocateRaw(shared.front());
+              shared.erase(shared.begin());
+            }
+          }
+        }
+        for (void* p : live) {
+          a_->DeallocateRaw(p);
+        }
+      });
+    }
+  }
+  absl::optional<AllocatorStats> stats = a_->GetStats();
+  EXPECT_EQ(num_allocs.load(), stats->num_allocs);
+
+  // The memory map agrees with the stats about the allocations that are
+  // still shared.
+  MemoryDump dump = a_->RecordMemoryMap();
+  int64 bytes_in_use = 0;
+  for (const MemChunk& chunk : dump.chunk()) {
+    if (chunk.in_use()) {
+      bytes_in_use += chunk.size();
+    }
+  }
+  EXPECT_EQ(stats->bytes_in_use, bytes_in_use);
+  EXPECT_EQ(stats->bytes_in_use, dump.stats().bytes_in_use());
+
+  for (void* p : shared) {
+    a_->DeallocateRaw(p);
+  }
+  EXPECT_EQ(0, a_->GetStats()->bytes_in_use);
+}
+
+INSTANTIATE_TEST_SUITE_P(BFCAllocatorTestSuite, BFCAllocatorTest,
+                         ::testing::Bool());
+
+void BM_MultiThreadedAllocation(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const bool thread_caches = state.range(1);
+  constexpr int kNumAllocs = 10000;
+  std::unique_ptr<BFCAllocator> a(NewAllocator(thread_caches));
+  thread::ThreadPool pool(Env::Default(), "test", num_threads);
+
+  for (auto s : state) {
+    BlockingCounter counter(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&a, &counter]() {
+        // Keeps a few small buffers alive, as kernels do with temporaries.
+        void* ptrs[4] = {};
+        for (int i = 0; i < kNumAllocs; ++i) {
+          void*& p = ptrs[i % 4];
+          if (p != nullptr) {
+            a->DeallocateRaw(p);
+          }
+          p = a->AllocateRaw(1, 256 * (i % 8 + 1));
+        }
+        for (void* p : ptrs) {
+          a->DeallocateRaw(p);
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(num_threads * kNumAllocs * state.iterations());
+}
+BENCHMARK(BM_MultiThreadedAllocation)
+    ->UseRealTime()
+    ->ArgPair(1, false)
+    ->ArgPair(1, true)
+    ->ArgPair(8, false)
+    ->ArgPair(8, true)
+    ->ArgPair(32, false)
+    ->ArgPair(32, true);
+
+}  // namespace
+}  // namespace tensorflow
@@ -707,13 +707,30 @@ Status DirectSession::RunInternal(
         }
       };
 
+  // Returns the allocator that serves the allocations of `item` in this step,
+  // or nullptr if it is not planned or is in use by a concurrent step. The
+  // step must call `EndStep()` on the returned allocator once `item` is done.
+  auto begin_step_arena_for_item =
+      [](const PerPartitionExecutorsAndLib& item) -> StepArenaAllocator* {
+    StepArenaAllocator* step_arena = item.step_arena_allocator.get();
+    if (step_arena != nullptr && step_arena->BeginStep()) {
+      return step_arena;
+    }
+    return nullptr;
+  };
+
   if (can_execute_synchronously) {
     PrivateIntraProcessRendezvous rendezvous(device_mgr_.get());
     args.rendezvous = &rendezvous;
 
     const auto& item = executors_and_keys->items[0];
     set_threadpool_args_for_item(item, &args);
+    StepArenaAllocator* step_arena = begin_step_arena_for_item(item);
+    args.step_allocator = step_arena;
     run_status = item.executor->Run(args);
+    if (step_arena != nullptr) {
+      step_arena->EndStep();
+    }
   } else {
     core::RefCountPtr<RefCountedIntraProcessRendezvous> rendezvous(
         new RefCountedIntraProcessRendezvous(device_mgr_.get()));
@@ -733,7 +750,19 @@ Status DirectSession::RunInternal(
 
     for (const auto& item : executors_and_keys->items) {
       set_threadpool_args_for_item(item, &args);
-      item.executor->RunAsync(args, barrier->Get());
+      StepArenaAllocator* step_arena = begin_step_arena_for_item(item);
+      args.step_allocator = step_arena;
+      Executor::DoneCallback done = barrier->Get();
+      if (step_arena != nullptr) {
+        // The step may outlive this call if it times out.
+        step_arena->Ref();
+        done = [step_arena, barrier_done = std::move(done)](const Status& s) {
+          step_arena->EndStep();
+          step_arena->Unref();
+          barrier_done(s);
+        };
+      }
+      item.executor->RunAsync(args, std::move(done));
     }
 
     WaitForNotification(&executors_done, &run_state, &step_cancellation_manager,
@@ -1411,6 +1440,11 @@ Status DirectSession::CreateExecutors(
     auto executor_type = options_.config.experimental().executor_type();
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
+    if (options_.config.experimental().use_static_memory_plan() &&
+        !run_state_args->is_partial_run) {
+      item->step_arena_allocator.reset(
+          new StepArenaAllocator(device->GetAllocator(AllocatorAttributes())));
+    }
     if (!options_.config.experimental().disable_output_partition_graphs() ||
         options_.config.graph_options().build_cost_model() > 0) {
       item->graph = std::move(partition_graph);
@@ -1662,6 +1696,9 @@ Status DirectSession::CreateGraphs(
   };
   popts.flib_def = flib_def->get();
   popts.control_flow_added = false;
+  // Every step exchanges tensors between its partitions through an
+  // IntraProcessRendezvous.
+  popts.assign_rendezvous_slots = true;
 
   std::unordered_map<string, GraphDef> partitions;
   TF_RETURN_IF_ERROR(Partition(popts, &client_graph->graph, &partitions));
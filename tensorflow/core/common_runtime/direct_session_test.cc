@@ -228,6 +228,44 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
       absl::StrContains(s.error_message(), "optimize_for_static_graph"));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_StaticMemoryPlan) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_use_static_memory_plan(true);
+  auto session = absl::WrapUnique(NewSession(options));
+
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_names = {y_ + ":0", z_ + ":0"};
+  std::vector<string> target_nodes = {};
+
+  // Keep the outputs of every step alive, so that later steps must not reuse
+  // their memory.
+  std::vector<std::vector<Tensor>> all_outputs(5);
+  for (auto& outputs : all_outputs) {
+    TF_ASSERT_OK(session->Run(inputs, output_names, target_nodes, &outputs));
+  }
+  for (const auto& outputs : all_outputs) {
+    ASSERT_EQ(2, outputs.size());
+    test::ExpectTensorEqual<float>(
+        outputs[0], test::AsTensor<float>({5, -1}, TensorShape({2, 1})));
+    test::ExpectTensorEqual<float>(
+        outputs[1], test::AsTensor<float>({-5, 1}, TensorShape({2, 1})));
+  }
+
+  RunOptions run_options;
+  run_options.set_inter_op_thread_pool(-1);
+  for (int i = 0; i < 5; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run(run_options, inputs, output_names, target_nodes,
+                              &outputs, nullptr));
+    ASSERT_EQ(2, outputs.size());
+    test::ExpectTensorEqual<float>(
+        outputs[1], test::AsTensor<float>({-5, 1}, TensorShape({2, 1})));
+  }
+}
+
 TEST_F(DirectSessionMinusAXTest,
        RunSimpleNetwork_DisableOutputPartitionGraphs) {
   Initialize({3, 2, -1, 0});
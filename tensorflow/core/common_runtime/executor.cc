@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
 #include <memory>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
@@ -56,6 +59,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -134,12 +138,279 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// A ready queue for the work-stealing mode of `ExecutorState`, in which at
+// most `num_workers()` closures on the inter-op thread pool process the ready
+// nodes of a step.
+//
+// Each worker owns a deque that only it pushes to. The owner pops the node it
+// pushed last, whose inputs it has just produced and which are most likely
+// still in its cache, while idle workers steal the oldest nodes from the front
+// of other deques. Nodes that become ready outside of a worker, i.e. the roots
+// of the graph and the successors of asynchronous kernels, are injected into a
+// shared queue.
+//
+// A worker that finds no nodes releases its slot and exits. A worker that
+// pushes nodes, or takes a node while others are pending, starts another
+// worker if `ShouldStartWorker()` returns true. Whoever injects nodes must then
+// try to become a worker itself; if all slots are busy, the worker that
+// releases a slot concurrently with the injection re-acquires it, so that no
+// injected node is left behind.
+template <class Item>
+class WorkStealingReadyQueue {
+ public:
+  explicit WorkStealingReadyQueue(int num_workers) {
+    workers_.reserve(num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+      workers_.push_back(absl::make_unique<Worker>());
+    }
+  }
+
+  int num_workers() const { return workers_.size(); }
+
+  // Claims an idle worker slot. Returns its index, or -1 if all slots are busy.
+  int TryAcquireWorker() {
+    const int num_workers = workers_.size();
+    for (int i = 0; i < num_workers; ++i) {
+      bool busy = false;
+      if (!workers_[i]->busy.load() &&
+          workers_[i]->busy.compare_exchange_strong(busy, true)) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // Releases the slot of a worker for which `Pop()` returned nullopt. Returns
+  // true if nodes were injected in the meantime and the worker holds its slot
+  // again, in which case it must keep popping.
+  bool ReleaseWorker(int worker) {
+    std::atomic<bool>& busy = workers_[worker]->busy;
+    busy.store(false);
+    if (num_injected_.load() == 0) return false;
+    bool expected = false;
+    return busy.compare_exchange_strong(expected, true);
+  }
+
+  // Returns true if the caller should start a worker, i.e. if there is an
+  // idle slot that no other started worker is about to claim. The started
+  // worker must call `AcquireStartedWorker()`.
+  bool ShouldStartWorker() {
+    int64 num_starting = num_starting_.load();
+    while (num_starting < NumIdleWorkers()) {
+      if (num_starting_.compare_exchange_weak(num_starting,
+                                              num_starting + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Like `TryAcquireWorker()`, for a worker that was started because
+  // `ShouldStartWorker()` returned true.
+  int AcquireStartedWorker() {
+    num_starting_.fetch_sub(1);
+    return TryAcquireWorker();
+  }
+
+  // Adds `item` to the deque of `worker`, which must be held by the caller.
+  void Push(int worker, Item item) {
+    Worker* w = workers_[worker].get();
+    mutex_lock l(w->mu);
+    w->items.push_back(std::move(item));
+    w->num_items.fetch_add(1, std::memory_order_release);
+    num_pending_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Adds `items` to the shared queue.
+  void Inject(std::vector<Item> items) {
+    mutex_lock l(injected_mu_);
+    for (Item& item : items) {
+      injected_.push_back(std::move(item));
+    }
+    num_pending_.fetch_add(items.size(), std::memory_order_release);
+    num_injected_.fetch_add(items.size());
+  }
+
+  // Returns true if some deque or the shared queue is probably not empty.
+  bool HasPendingItems() const {
+    return num_pending_.load(std::memory_order_relaxed) > 0;
+  }
+
+  // Takes the next item for `worker`, which must be held by the caller: the
+  // newest item of its own deque, else the oldest injected item, else the
+  // oldest item of another worker's deque. Returns nullopt if there are none.
+  absl::optional<Item> Pop(int worker) {
+    if (num_pending_.load(std::memory_order_acquire) == 0) {
+      return absl::nullopt;
+    }
+    Worker* own = workers_[worker].get();
+    if (own->num_items.load(std::memory_order_acquire) > 0) {
+      mutex_lock l(own->mu);
+      if (!own->items.empty()) {
+        absl::optional<Item> item(std::move(own->items.back()));
+        own->items.pop_back();
+        own->num_items.fetch_sub(1, std::memory_order_relaxed);
+        num_pending_.fetch_sub(1, std::memory_order_relaxed);
+        return item;
+      }
+    }
+    if (num_injected_.load(std::memory_order_acquire) > 0) {
+      mutex_lock l(injected_mu_);
+      if (!injected_.empty()) {
+        absl::optional<Item> item(std::move(injected_.front()));
+        injected_.pop_front();
+        num_injected_.fetch_sub(1);
+        num_pending_.fetch_sub(1, std::memory_order_relaxed);
+        return item;
+      }
+    }
+    const int num_workers = workers_.size();
+    for (int i = 1; i < num_workers; ++i) {
+      Worker* victim = workers_[(worker + i) % num_workers].get();
+      if (victim->num_items.load(std::memory_order_acquire) == 0) continue;
+      mutex_lock l(victim->mu);
+      if (!victim->items.empty()) {
+        absl::optional<Item> item(std::move(victim->items.front()));
+        victim->items.pop_front();
+        victim->num_items.fetch_sub(1, std::memory_order_relaxed);
+        num_pending_.fetch_sub(1, std::memory_order_relaxed);
+        return item;
+      }
+    }
+    return absl::nullopt;
+  }
+
+ private:
+  // Allocated separately, so that workers do not contend on the cache lines
+  // of their neighbours.
+  struct Worker {
+    std::atomic<bool> busy{false};
+    // Lets thieves skip empty deques without locking them.
+    std::atomic<int64> num_items{0};
+    mutex mu;
+    std::deque<Item> items TF_GUARDED_BY(mu);
+  };
+
+  int NumIdleWorkers() const {
+    int num_idle = 0;
+    for (const auto& worker : workers_) {
+      if (!worker->busy.load()) ++num_idle;
+    }
+    return num_idle;
+  }
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // The number of workers that have been started but not yet claimed a slot.
+  std::atomic<int64> num_starting_{0};
+  // The number of items in all deques and the shared queue.
+  std::atomic<int64> num_pending_{0};
+
+  std::atomic<int64> num_injected_{0};
+  mutex injected_mu_;
+  std::deque<Item> injected_ TF_GUARDED_BY(injected_mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingReadyQueue);
+};
+
+// A node in a work-stealing ready queue.
+template <class TaggedNode>
+struct WorkStealingReadyItem {
+  TaggedNode tagged_node;
+  int64 scheduled_nsec;
+};
+
+// The work-stealing ready queues of an executor. A step takes an idle queue,
+// or creates one if all are in use by concurrent steps, and the queue returns
+// to the pool once the step and all of its workers are done with it. The
+// per-worker deques are thus allocated once per executor rather than on every
+// step.
+template <class Item>
+class WorkStealingReadyQueuePool
+    : public std::enable_shared_from_this<WorkStealingReadyQueuePool<Item>> {
+ public:
+  typedef WorkStealingReadyQueue<Item> Queue;
+
+  explicit WorkStealingReadyQueuePool(int num_workers)
+      : num_workers_(num_workers) {}
+
+  std::shared_ptr<Queue> Get() {
+    std::unique_ptr<Queue> queue;
+    {
+      mutex_lock l(mu_);
+      if (!idle_.empty()) {
+        queue = std::move(idle_.back());
+        idle_.pop_back();
+      }
+    }
+    if (queue == nullptr) {
+      queue = absl::make_unique<Queue>(num_workers_);
+    }
+    // Workers may still hold the queue after the executor is deleted, so the
+    // deleter keeps the pool alive.
+    return std::shared_ptr<Queue>(
+        queue.release(),
+        [pool = this->shared_from_this()](Queue* queue) {
+          pool->Return(queue);
+        });
+  }
+
+ private:
+  void Return(Queue* queue) {
+    // All workers have released their slots and processed every node.
+    DCHECK(!queue->HasPendingItems());
+    mutex_lock l(mu_);
+    idle_.emplace_back(queue);
+  }
+
+  const int num_workers_;
+  mutex mu_;
+  std::vector<std::unique_ptr<Queue>> idle_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingReadyQueuePool);
+};
+
+template <class PropagatorStateType>
+using ReadyQueuePool = WorkStealingReadyQueuePool<
+    WorkStealingReadyItem<typename PropagatorStateType::TaggedNode>>;
+
+// The work-stealing queue, and the worker slot in it, of the
+// `ExecutorState::RunWorker()` call that the current thread is in, if any.
+thread_local const void* current_ready_queue = nullptr;
+thread_local int current_worker = -1;
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  // If `work_stealing` is true, the ready nodes of a step are processed by a
+  // bounded set of workers with work-stealing deques; see
+  // `WorkStealingReadyQueue`. If `critical_path_first` is true, ready nodes
+  // are processed in order of decreasing `NodeItem::priority`, i.e. the nodes
+  // on the longest remaining paths to the sink first.
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool work_stealing = false,
+                        bool critical_path_first = false)
+      : immutable_state_(p),
+        work_stealing_(work_stealing),
+        critical_path_first_(critical_path_first) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
+    if (critical_path_first_) {
+      immutable_state_.InitializePriorities(graph);
+    }
+    if (work_stealing_) {
+      const int num_workers = std::max(
+          std::min(port::MaxParallelism(),
+                   immutable_state_.graph_view().num_nodes()),
+          1);
+      if (immutable_state_.requires_control_flow_support()) {
+        ready_queue_pool_ =
+            std::make_shared<ReadyQueuePool<PropagatorState>>(num_workers);
+      } else {
+        simple_ready_queue_pool_ =
+            std::make_shared<ReadyQueuePool<SimplePropagatorState>>(
+                num_workers);
+      }
+    }
     kernel_stats_.Initialize(immutable_state_.graph_view());
     return Status::OK();
   }
@@ -214,6 +485,13 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  const bool work_stealing_;
+  const bool critical_path_first_;
+  // In work-stealing mode, the ready queues for the propagator that the graph
+  // uses. The other one is null.
+  std::shared_ptr<ReadyQueuePool<PropagatorState>> ready_queue_pool_;
+  std::shared_ptr<ReadyQueuePool<SimplePropagatorState>>
+      simple_ready_queue_pool_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
@@ -231,8 +509,10 @@ class ExecutorImpl : public Executor {
 //   * `const NodeItem& get_node_item() const`
 //   * `bool get_is_dead() const`
 // * A type `TaggedNodeReadyQueue`, representing a queue of nodes to be
-//   processed, with public members (having the same meanings as in an
-//   `std::vector<TaggedNode>`):
+//   processed, with an `explicit TaggedNodeReadyQueue(bool by_priority)`
+//   constructor that selects processing in order of decreasing
+//   `NodeItem::priority`, and public members (having the same meanings as in
+//   an `std::deque<TaggedNode>`):
 //   * `void push_back(const TaggedNode& node)`
 //   * `TaggedNode front() const`
 //   * `void pop_front()`
@@ -270,9 +550,12 @@ class ExecutorImpl : public Executor {
 template <class PropagatorStateType>
 class ExecutorState {
  public:
+  // If `ready_queue_pool` is not null, the ready nodes of the step are
+  // processed by work-stealing workers with a queue from the pool.
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                ReadyQueuePool<PropagatorStateType>* ready_queue_pool = nullptr);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -286,6 +569,9 @@ class ExecutorState {
 
   struct AsyncState;
 
+  typedef WorkStealingReadyItem<TaggedNode> ReadyItem;
+  typedef WorkStealingReadyQueue<ReadyItem> ReadyQueue;
+
   // Process a ready node in current thread.
   void Process(TaggedNode node, int64 scheduled_nsec);
 
@@ -317,13 +603,32 @@ class ExecutorState {
                 TaggedNodeReadyQueue* inline_ready);
 
   // Schedule all the expensive nodes in '*ready', and put all the inexpensive
-  // nodes in 'ready' into 'inline_ready'.
+  // nodes in 'ready' into 'inline_ready'. If the executor uses priorities,
+  // nodes with a higher `NodeItem::priority` are scheduled first.
   //
   // This method will clear `*ready` before returning.
   //
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Implements `ScheduleReady()` in work-stealing mode. If called from a
+  // worker of this step, splits the nodes between `inline_ready` and the
+  // worker's deque like `ScheduleReady()` splits them between `inline_ready`
+  // and the thread pool; otherwise injects all of them.
+  void ScheduleReadyWorkStealing(TaggedNodeSeq* ready,
+                                 TaggedNodeReadyQueue* inline_ready,
+                                 int64 scheduled_nsec);
+
+  // Starts another worker if `ready_queue_` has an idle slot that is not
+  // about to be claimed.
+  void MaybeStartWorker();
+
+  // Processes nodes from `queue` in the slot `worker` until there are none
+  // left. Does not access `state` after that, since the last node of the step
+  // may have deleted it.
+  static void RunWorker(ExecutorState* state, std::shared_ptr<ReadyQueue> queue,
+                        int worker);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -355,6 +660,7 @@ class ExecutorState {
   TensorStore* tensor_store_;
   // Step-local container.
   ScopedStepContainer* step_container_;
+  Allocator* const step_allocator_;
   StepStatsCollectorInterface* const stats_collector_;
   const tracing::EventCollector* const event_collector_;
   Context context_;
@@ -372,6 +678,10 @@ class ExecutorState {
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
 
+  // Non-null in work-stealing mode. Shared with the workers, which may
+  // outlive this state.
+  std::shared_ptr<ReadyQueue> ready_queue_;
+
   PropagatorStateType propagator_;
 
   // Invoked when the execution finishes.
@@ -392,7 +702,8 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats,
+    ReadyQueuePool<PropagatorStateType>* ready_queue_pool)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -404,6 +715,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       session_metadata_(immutable_state.params().session_metadata),
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
+      step_allocator_(args.step_allocator),
       stats_collector_(args.stats_collector),
       event_collector_(
           tracing::GetEventCollector(tracing::EventCategory::kCompute)),
@@ -423,6 +735,9 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (ready_queue_pool != nullptr && !run_all_kernels_inline_) {
+    ready_queue_ = ready_queue_pool->Get();
+  }
 }
 
 template <class PropagatorStateType>
@@ -682,7 +997,7 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
       profiler::TraceMeLevel::kInfo);
   WithContext wc(context_);
   TaggedNodeSeq ready;
-  TaggedNodeReadyQueue inline_ready;
+  TaggedNodeReadyQueue inline_ready(immutable_state_.has_priorities());
 
   // Parameters passed to OpKernel::Compute.
   TensorValueVec inputs;
@@ -710,6 +1025,7 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   params.function_library = immutable_state_.params().function_library;
   params.resource_manager = device->resource_manager();
   params.step_container = step_container_;
+  params.step_allocator = step_allocator_;
   params.slice_reader_cache = slice_reader_cache_;
   params.inputs = &inputs;
   params.input_alloc_attrs = &input_alloc_attrs;
@@ -1150,6 +1466,18 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready) {
   DCHECK(!ready->empty());
 
+  if (immutable_state_.has_priorities()) {
+    // Schedule the nodes on the longest remaining paths first. The ready
+    // nodes usually already are in that order, e.g. when they all have the
+    // same priority, so only sort them otherwise.
+    auto higher_priority = [](const TaggedNode& a, const TaggedNode& b) {
+      return a.get_node_item().priority > b.get_node_item().priority;
+    };
+    if (!std::is_sorted(ready->begin(), ready->end(), higher_priority)) {
+      std::stable_sort(ready->begin(), ready->end(), higher_priority);
+    }
+  }
+
   int64 scheduled_nsec = 0;
   if (stats_collector_) {
     scheduled_nsec = nodestats::NowInNsec();
@@ -1171,6 +1499,8 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         inline_ready->push_back(tagged_node);
       }
     }
+  } else if (ready_queue_ != nullptr) {
+    ScheduleReadyWorkStealing(ready, inline_ready, scheduled_nsec);
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     if (inline_ready == nullptr) {
@@ -1209,6 +1539,92 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ScheduleReadyWorkStealing(
+    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+    int64 scheduled_nsec) {
+  if (inline_ready != nullptr && current_ready_queue == ready_queue_.get()) {
+    // The inputs of the ready nodes were just produced on this thread. As in
+    // the default mode, inexpensive nodes run inline, as does one expensive
+    // node if there is nothing else to run. The other expensive nodes go to
+    // this worker's deque, from which it pops them most-recent-first unless
+    // an idle worker steals them.
+    bool pushed = false;
+    const TaggedNode* curr_expensive_node = nullptr;
+    for (auto& tagged_node : *ready) {
+      const NodeItem& item = *tagged_node.node_item;
+      if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+        inline_ready->push_back(tagged_node);
+      } else {
+        if (curr_expensive_node) {
+          ready_queue_->Push(current_worker,
+                             {*curr_expensive_node, scheduled_nsec});
+          pushed = true;
+        }
+        curr_expensive_node = &tagged_node;
+      }
+    }
+    if (curr_expensive_node) {
+      if (inline_ready->empty()) {
+        inline_ready->push_back(*curr_expensive_node);
+      } else {
+        ready_queue_->Push(current_worker,
+                           {*curr_expensive_node, scheduled_nsec});
+        pushed = true;
+      }
+    }
+    // Each worker that pushes nodes starts another one if a slot is idle, so
+    // this ramps up to as many workers as there are parallel nodes.
+    if (pushed) MaybeStartWorker();
+  } else {
+    std::vector<ReadyItem> items;
+    items.reserve(ready->size());
+    for (auto& tagged_node : *ready) {
+      items.push_back({tagged_node, scheduled_nsec});
+    }
+    // Running workers may finish the step as soon as the nodes are injected,
+    // so inject them from the task that becomes a worker, and do not touch
+    // this state after scheduling it.
+    RunTask([this, queue = ready_queue_, items = std::move(items)]() mutable {
+      queue->Inject(std::move(items));
+      const int worker = queue->TryAcquireWorker();
+      if (worker >= 0) RunWorker(this, queue, worker);
+    });
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::MaybeStartWorker() {
+  if (!ready_queue_->ShouldStartWorker()) return;
+  RunTask([this, queue = ready_queue_]() {
+    const int worker = queue->AcquireStartedWorker();
+    if (worker >= 0) RunWorker(this, queue, worker);
+  });
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorker(
+    ExecutorState* state, std::shared_ptr<ReadyQueue> queue, int worker) {
+  // A kernel may run another executor inline, so restore the outer worker
+  // when this one is done.
+  const void* const outer_ready_queue = current_ready_queue;
+  const int outer_worker = current_worker;
+  current_ready_queue = queue.get();
+  current_worker = worker;
+  while (true) {
+    absl::optional<ReadyItem> item = queue->Pop(worker);
+    if (!item) {
+      if (queue->ReleaseWorker(worker)) continue;
+      break;
+    }
+    // `state` is alive while any of its nodes is queued or being processed.
+    if (queue->HasPendingItems()) state->MaybeStartWorker();
+    state->Process(item->tagged_node, item->scheduled_nsec);
+  }
+  current_ready_queue = outer_ready_queue;
+  current_worker = outer_worker;
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1346,11 +1762,13 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
   if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        ready_queue_pool_.get()))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_,
+         simple_ready_queue_pool_.get()))
         ->RunAsync(std::move(done));
   }
 }
@@ -1389,6 +1807,10 @@ class DefaultExecutorRegistrar {
     Factory* factory = new Factory;
     ExecutorFactory::Register("", factory);
     ExecutorFactory::Register("DEFAULT", factory);
+    ExecutorFactory::Register("WORK_STEALING_EXECUTOR",
+                              new WorkStealingFactory);
+    ExecutorFactory::Register("CRITICAL_PATH_EXECUTOR",
+                              new CriticalPathFactory);
   }
 
  private:
@@ -1401,6 +1823,28 @@ class DefaultExecutorRegistrar {
       return Status::OK();
     }
   };
+
+  class WorkStealingFactory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl = absl::make_unique<ExecutorImpl>(params,
+                                                  /*work_stealing=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return Status::OK();
+    }
+  };
+
+  class CriticalPathFactory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl = absl::make_unique<ExecutorImpl>(
+          params, /*work_stealing=*/false, /*critical_path_first=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return Status::OK();
+    }
+  };
 };
 static DefaultExecutorRegistrar registrar;
 
@@ -97,6 +97,9 @@ class Executor {
     string session_handle;
     TensorStore* tensor_store = nullptr;
     ScopedStepContainer* step_container = nullptr;
+    // If not null, serves the allocations that kernels of this step make
+    // from the device's default allocator.
+    Allocator* step_allocator = nullptr;
     CollectiveExecutor* collective_executor = nullptr;
     thread::ThreadPoolInterface* user_intra_op_threadpool = nullptr;
     int64 start_time_usecs = 0;
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <set>
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
@@ -37,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -66,8 +69,10 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor of the registered type
+  // 'executor_type' based on a graph 'gdef'.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -82,7 +87,9 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    std::unique_ptr<Executor> executor;
+    TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &executor));
+    exec_ = executor.release();
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -205,6 +212,50 @@ TEST_F(ExecutorTest, SelfAdd) {
   EXPECT_EQ(1024.0, V(out));  // b=v10=2*v9=4*v8=...=1024*a=1024.0
 }
 
+TEST_F(ExecutorTest, RunsLongestPathFirst) {
+  // a -> Identity (x8)
+  // a -> Neg -> Neg -> ... -> Neg -> b
+  //
+  // The identities become ready first, but the chain is run first because it
+  // is on the longest path to the sink.
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  std::set<string> identities;
+  for (int i = 0; i < 8; ++i) {
+    identities.insert(test::graph::Identity(g.get(), in)->name());
+  }
+  Node* chain = in;
+  for (int i = 0; i < 8; ++i) {
+    chain = test::graph::Unary(g.get(), "Neg", chain);
+  }
+  const string last_in_chain =
+      test::graph::Send(g.get(), chain, "b", BOB, 1, ALICE)->name();
+  Create(std::move(g), "CRITICAL_PATH_EXECUTOR");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  Executor::Args exec_args;
+  exec_args.rendezvous = rendez_;
+  exec_args.stats_collector = &step_stats_collector_;
+  exec_args.runner = runner_;
+  exec_args.run_all_kernels_inline = true;
+  TF_ASSERT_OK(exec_->Run(exec_args));
+  step_stats_collector_.Finalize();
+
+  // With all kernels inline, the nodes finish in the order in which they run.
+  ASSERT_EQ(1, step_stats_.dev_stats_size());
+  bool chain_done = false;
+  for (const NodeExecStats& node_stats :
+       step_stats_.dev_stats(0).node_stats()) {
+    if (node_stats.node_name() == last_in_chain) {
+      chain_done = true;
+    } else if (identities.count(node_stats.node_name())) {
+      EXPECT_TRUE(chain_done) << node_stats.node_name();
+    }
+  }
+  EXPECT_TRUE(chain_done);
+}
+
 // Builds a graph which adds N copies of one variable "in". I.e.,
 //     a + a + a + ... + a
 // The returned graph is parenthesized ramdonly. I.e.,
@@ -255,6 +306,60 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING_EXECUTOR");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+// Builds 'width' independent chains of 'depth' negations of "in", and returns
+// the sum of their results.
+Node* BuildChains(int width, int depth, Node* in, Graph* g) {
+  std::vector<NodeBuilder::NodeOut> chains;
+  for (int i = 0; i < width; ++i) {
+    Node* node = in;
+    for (int j = 0; j < depth; ++j) {
+      node = test::graph::Unary(g, "Neg", node);
+    }
+    chains.emplace_back(node);
+  }
+  Node* sum;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "AddN")
+                  .Input(chains)
+                  .Finalize(g, &sum));
+  return sum;
+}
+
+TEST_F(ExecutorTest, ChainsWorkStealing) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  test::graph::Send(g.get(), BuildChains(256, 16, in, g.get()), "b", BOB, 1,
+                    ALICE);
+  Create(std::move(g), "WORK_STEALING_EXECUTOR");
+  for (int iters = 0; iters < 16; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(
+        rendez->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+    EXPECT_EQ(256.0, V(out));
+    rendez->Unref();
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -484,6 +589,47 @@ BENCHMARK(BM_executor)->UseRealTime()->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 1024);
 
+// Create a graph of 'width' independent chains of 'depth' cheap unary ops on a
+// common input, joined by a single AddN.
+static void BM_ChainsHelper(::testing::benchmark::State& state,
+                            const char* executor_type) {
+  const int width = state.range(0);
+  const int depth = state.range(1);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  BuildChains(width, depth, test::graph::Constant(g, V(1.0)), g);
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr, executor_type,
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+
+  const int64 num_nodes = width * depth + 2;
+  state.SetLabel(strings::StrCat("Nodes = ", num_nodes));
+  state.SetItemsProcessed(num_nodes * static_cast<int64>(state.iterations()));
+}
+
+static void BM_Chains(::testing::benchmark::State& state) {
+  BM_ChainsHelper(state, "");
+}
+
+static void BM_ChainsWorkStealing(::testing::benchmark::State& state) {
+  BM_ChainsHelper(state, "WORK_STEALING_EXECUTOR");
+}
+
+// Wide graphs, deep graphs, and graphs in between.
+BENCHMARK(BM_Chains)
+    ->UseRealTime()
+    ->ArgPair(1024, 1)
+    ->ArgPair(256, 16)
+    ->ArgPair(16, 256)
+    ->ArgPair(1, 1024);
+BENCHMARK(BM_ChainsWorkStealing)
+    ->UseRealTime()
+    ->ArgPair(1024, 1)
+    ->ArgPair(256, 16)
+    ->ArgPair(16, 256)
+    ->ArgPair(1, 1024);
+
 static void BM_const_identity(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int outputs_per_const = state.range(1);
@@ -346,10 +346,20 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
       LOG(ERROR) << "GetGpuHostAllocator: " << status.error_message();
     }
     int64 gpu_host_mem_limit = gpu_host_mem_limit_in_mb * (1LL << 20);
+    bool use_thread_caches = false;
+    status = ReadBoolFromEnvVar("TF_GPU_HOST_BFC_USE_THREAD_CACHES", false,
+                                &use_thread_caches);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetGpuHostAllocator: " << status.error_message();
+    }
 
-    Allocator* allocator =
+    BFCAllocator* bfc_allocator =
         new BFCAllocator(sub_allocator, gpu_host_mem_limit,
                          /*allow_growth=*/true, /*name=*/"gpu_host_bfc");
+    if (use_thread_caches) {
+      bfc_allocator->EnableThreadCaches();
+    }
+    Allocator* allocator = bfc_allocator;
 
     if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
       // Wrap the allocator to track allocation ids for better logging
@@ -101,6 +101,11 @@ struct NodeItem {
   // for this node.
   int input_start = 0;
 
+  // The number of nodes on the longest path from this node to the sink,
+  // including this node, or 0 if the executor does not use priorities. The
+  // executor then processes ready nodes with higher priority first.
+  int64 priority = 0;
+
   // Number of output edges, excluding control edges.
   int32 num_output_edges;
 
@@ -373,4 +373,41 @@ void ImmutableExecutorState::InitializePending(const Graph* graph,
     }
   }
 }
+
+void ImmutableExecutorState::InitializePriorities(const Graph& graph) {
+  has_priorities_ = true;
+  // Order the nodes topologically, ignoring the back edges of loops.
+  std::vector<int> num_pending_inputs(graph.num_node_ids(), 0);
+  std::vector<const Node*> order;
+  order.reserve(graph.num_nodes());
+  for (const Node* n : graph.nodes()) {
+    for (const Edge* e : n->in_edges()) {
+      if (!IsNextIteration(e->src())) ++num_pending_inputs[n->id()];
+    }
+    if (num_pending_inputs[n->id()] == 0) order.push_back(n);
+  }
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (IsNextIteration(order[i])) continue;
+    for (const Edge* e : order[i]->out_edges()) {
+      if (--num_pending_inputs[e->dst()->id()] == 0) {
+        order.push_back(e->dst());
+      }
+    }
+  }
+
+  // Visit the successors of each node before the node itself.
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    const Node* n = *it;
+    if (IsSink(n)) continue;
+    int64 successor_priority = 0;
+    if (!IsNextIteration(n)) {
+      for (const Node* dst : n->out_nodes()) {
+        if (IsSink(dst)) continue;
+        successor_priority =
+            std::max(successor_priority, gview_.node(dst->id())->priority);
+      }
+    }
+    gview_.node(n->id())->priority = 1 + successor_priority;
+  }
+}
 }  // namespace tensorflow
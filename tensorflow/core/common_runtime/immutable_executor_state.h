@@ -101,6 +101,15 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Sets `NodeItem::priority` for every node in `graph`, which must be the
+  // graph passed to `Initialize()`. Until this is called, every node has
+  // priority 0.
+  void InitializePriorities(const Graph& graph);
+
+  // Returns true iff `InitializePriorities()` has been called, i.e. ready
+  // nodes should be processed in order of decreasing priority.
+  bool has_priorities() const { return has_priorities_; }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -132,6 +141,7 @@ class ImmutableExecutorState {
   LocalExecutorParams params_;
   GraphView gview_;
   bool requires_control_flow_;
+  bool has_priorities_ = false;
   std::vector<PendingCounts::Handle> pending_ids_;
 
   // Root nodes (with no in edges) that should form the initial ready queue
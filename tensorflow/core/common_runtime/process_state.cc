@@ -99,10 +99,20 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
         LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
       }
       int64 cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
+      bool use_thread_caches = false;
+      status = ReadBoolFromEnvVar("TF_CPU_BFC_USE_THREAD_CACHES", false,
+                                  &use_thread_caches);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+      }
       DCHECK(sub_allocator);
-      allocator =
+      BFCAllocator* bfc_allocator =
           new BFCAllocator(sub_allocator, cpu_mem_limit, /*allow_growth=*/true,
                            /*name=*/"bfc_cpu_allocator_for_gpu");
+      if (use_thread_caches) {
+        bfc_allocator->EnableThreadCaches();
+      }
+      allocator = bfc_allocator;
       VLOG(2) << "Using BFCAllocator with memory limit of "
               << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
     } else if (sub_allocator) {
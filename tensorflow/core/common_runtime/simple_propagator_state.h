@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SIMPLE_PROPAGATOR_STATE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SIMPLE_PROPAGATOR_STATE_H_
 
+#include <algorithm>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/entry.h"
@@ -66,20 +67,36 @@ class SimplePropagatorState {
   // A drop-in replacement for std::deque<TaggedNode>.  We typically don't
   // have that many nodes in the ready queue, so we just use a vector and
   // don't free up memory from the queue as we consume nodes.
+  //
+  // If `by_priority` is true, the vector is instead kept as a binary heap that
+  // returns the node with the highest `NodeItem::priority` first, and nodes of
+  // equal priority in the order in which they were added.
   // TODO(mrry): Extract this and share it with the version in
   // `PropagatorState`. The correct constants might be different, since
   // sizeof(TaggedNode) is smaller in this version.
   class TaggedNodeReadyQueue {
    public:
-    TaggedNodeReadyQueue() : front_index_(0) {}
+    explicit TaggedNodeReadyQueue(bool by_priority = false)
+        : by_priority_(by_priority) {}
 
-    void push_back(const TaggedNode& node) { ready_.push_back(node); }
+    void push_back(const TaggedNode& node) {
+      ready_.push_back({node, next_sequence_++});
+      if (by_priority_) {
+        std::push_heap(ready_.begin(), ready_.end(), LowerPriority());
+      }
+    }
     TaggedNode front() const {
       DCHECK_LT(front_index_, ready_.size());
-      return ready_[front_index_];
+      return ready_[front_index_].node;
     }
     void pop_front() {
       DCHECK_LT(front_index_, ready_.size());
+      if (by_priority_) {
+        std::pop_heap(ready_.begin(), ready_.end(), LowerPriority());
+        ready_.pop_back();
+        if (ready_.empty()) next_sequence_ = 0;
+        return;
+      }
       front_index_++;
       if ((front_index_ == ready_.size()) || (front_index_ > kSpillThreshold)) {
         if (front_index_ == ready_.size()) {
@@ -95,11 +112,24 @@ class SimplePropagatorState {
     bool empty() const { return ready_.empty(); }
 
    private:
-    // TODO(b/152925936): Re-evaluate these constants with current usage
-    // patterns.
+    struct Entry {
+      TaggedNode node;
+      int64 sequence;
+    };
+    struct LowerPriority {
+      bool operator()(const Entry& a, const Entry& b) const {
+        const int64 a_priority = a.node.get_node_item().priority;
+        const int64 b_priority = b.node.get_node_item().priority;
+        if (a_priority != b_priority) return a_priority < b_priority;
+        return a.sequence > b.sequence;
+      }
+    };
+
     static constexpr int kSpillThreshold = 16384;
-    gtl::InlinedVector<TaggedNode, 16> ready_;
-    int front_index_;
+    const bool by_priority_;
+    gtl::InlinedVector<Entry, 16> ready_;
+    int front_index_ = 0;
+    int64 next_sequence_ = 0;
   };
 
   // TODO(b/152925936): Re-evaluate this constant with current usage patterns.
@@ -301,6 +301,7 @@ class SingleThreadedExecutorImpl : public Executor {
     params.function_library = params_.function_library;
     params.resource_manager = device->resource_manager();
     params.step_container = args.step_container;
+    params.step_allocator = args.step_allocator;
     params.slice_reader_cache = nullptr;  // TODO(mrry): Too severe?
     params.inputs = &node_inputs;
     params.input_alloc_attrs = &input_alloc_attrs;
@@ -0,0 +1,279 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+size_t RoundUpToAlignment(size_t num_bytes) {
+  return (num_bytes + Allocator::kAllocatorAlignment - 1) &
+         ~(Allocator::kAllocatorAlignment - 1);
+}
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* wrapped)
+    : wrapped_(wrapped) {}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  if (arena_ != nullptr) {
+    wrapped_->DeallocateRaw(arena_);
+  }
+}
+
+bool StepArenaAllocator::BeginStep() {
+  if (in_step_.exchange(true, std::memory_order_acquire)) {
+    return false;
+  }
+  switch (mode_.load(std::memory_order_acquire)) {
+    case kRecording: {
+      mutex_lock l(mu_);
+      recording_ = true;
+      return true;
+    }
+    case kPlanned:
+      // Tensors of an earlier step that are still alive, e.g. fetched
+      // outputs, occupy the arena until they are released.
+      if (num_live_slots_.load(std::memory_order_acquire) == 0) {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+          slot_states_[i].store(kUnused, std::memory_order_relaxed);
+        }
+        next_index_.store(0, std::memory_order_relaxed);
+        return true;
+      }
+      break;
+    case kDisabled:
+      break;
+  }
+  in_step_.store(false, std::memory_order_release);
+  return false;
+}
+
+void StepArenaAllocator::EndStep() {
+  if (mode_.load(std::memory_order_acquire) == kRecording) {
+    mutex_lock l(mu_);
+    recording_ = false;
+    BuildPlan();
+    records_.clear();
+    live_records_.clear();
+  }
+  in_step_.store(false, std::memory_order_release);
+}
+
+void StepArenaAllocator::BuildPlan() {
+  // Allocations that outlive the recorded step, e.g. fetched outputs and
+  // persistent tensors, are left to the wrapped allocator.
+  std::vector<int64> planned;
+  for (const Record& record : records_) {
+    if (record.plannable && record.free_index >= 0) {
+      planned.push_back(record.alloc_index);
+    }
+  }
+  slots_.resize(records_.size());
+
+  // Place the largest allocations first, each at the lowest offset that does
+  // not overlap an already placed allocation with an overlapping lifetime.
+  std::vector<int64> by_size = planned;
+  std::sort(by_size.begin(), by_size.end(), [this](int64 a, int64 b) {
+    if (records_[a].num_bytes != records_[b].num_bytes) {
+      return records_[a].num_bytes > records_[b].num_bytes;
+    }
+    return a < b;
+  });
+  std::vector<int64> placed;
+  std::vector<std::pair<int64, int64>> busy;
+  for (int64 index : by_size) {
+    const Record& record = records_[index];
+    const int64 num_bytes = RoundUpToAlignment(record.num_bytes);
+    busy.clear();
+    for (int64 other_index : placed) {
+      const Record& other = records_[other_index];
+      if (other.alloc_index < record.free_index &&
+          record.alloc_index < other.free_index) {
+        const Slot& other_slot = slots_[other_index];
+        busy.emplace_back(other_slot.offset,
+                          other_slot.offset + other_slot.num_bytes);
+      }
+    }
+    std::sort(busy.begin(), busy.end());
+    int64 offset = 0;
+    for (const auto& range : busy) {
+      if (range.first >= offset + num_bytes) break;
+      offset = std::max(offset, range.second);
+    }
+    slots_[index].offset = offset;
+    slots_[index].num_bytes = num_bytes;
+    arena_size_ = std::max<size_t>(arena_size_, offset + num_bytes);
+    placed.push_back(index);
+  }
+
+  // Memory that is shared by allocations must be released by the earlier
+  // one before the later one can use it.
+  for (size_t i = 0; i < planned.size(); ++i) {
+    Slot& slot = slots_[planned[i]];
+    const int64 end = slot.offset + slot.num_bytes;
+    for (size_t j = 0; j < i; ++j) {
+      const Slot& earlier = slots_[planned[j]];
+      const int64 earlier_end = earlier.offset + earlier.num_bytes;
+      if (earlier.offset < end && slot.offset < earlier_end) {
+        slot.conflicts.push_back(static_cast<int32>(planned[j]));
+      }
+    }
+    slots_by_offset_[slot.offset].push_back(static_cast<int32>(planned[i]));
+  }
+
+  if (arena_size_ > 0) {
+    arena_ = static_cast<char*>(
+        wrapped_->AllocateRaw(Allocator::kAllocatorAlignment, arena_size_));
+    if (arena_ == nullptr) {
+      LOG(WARNING) << "Failed to allocate a step arena of " << arena_size_
+                   << " bytes from " << wrapped_->Name()
+                   << "; allocations will not be planned.";
+    }
+  }
+  if (arena_ == nullptr) {
+    slots_.clear();
+    slots_by_offset_.clear();
+    arena_size_ = 0;
+    mode_.store(kDisabled, std::memory_order_release);
+    return;
+  }
+  slot_states_.reset(new std::atomic<int32>[slots_.size()]);
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    slot_states_[i].store(kUnused, std::memory_order_relaxed);
+  }
+  VLOG(1) << "Planned a step arena of " << arena_size_ << " bytes for "
+          << planned.size() << " of " << records_.size()
+          << " allocations from " << wrapped_->Name();
+  mode_.store(kPlanned, std::memory_order_release);
+}
+
+void* StepArenaAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  const int mode = mode_.load(std::memory_order_acquire);
+  if (mode == kPlanned) {
+    void* ptr = AllocateFromArena(alignment, num_bytes, allocation_attr);
+    if (ptr != nullptr) {
+      Ref();
+      return ptr;
+    }
+  }
+  void* ptr = wrapped_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr == nullptr) {
+    return nullptr;
+  }
+  Ref();
+  if (mode == kRecording) {
+    mutex_lock l(mu_);
+    if (recording_) {
+      const int64 index = records_.size();
+      const bool plannable = num_bytes > 0 &&
+                             alignment <= Allocator::kAllocatorAlignment &&
+                             allocation_attr.freed_by_func == nullptr;
+      records_.push_back({num_bytes, index, -1, plannable});
+      live_records_[ptr] = index;
+    }
+  }
+  return ptr;
+}
+
+void* StepArenaAllocator::AllocateFromArena(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  if (!in_step_.load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  const int64 index = next_index_.fetch_add(1, std::memory_order_relaxed);
+  if (index >= static_cast<int64>(slots_.size())) {
+    return nullptr;
+  }
+  const Slot& slot = slots_[index];
+  if (slot.offset < 0 || num_bytes == 0 || num_bytes > slot.num_bytes ||
+      alignment > Allocator::kAllocatorAlignment ||
+      allocation_attr.freed_by_func != nullptr || !ClaimSlot(index)) {
+    return nullptr;
+  }
+  num_arena_allocations_.fetch_add(1, std::memory_order_relaxed);
+  return arena_ + slot.offset;
+}
+
+bool StepArenaAllocator::ClaimSlot(int64 index) {
+  // Earlier allocations that have not been made yet lose their memory to
+  // this one, so that they cannot claim it while it is in use.
+  for (int32 conflict : slots_[index].conflicts) {
+    int32 state = kUnused;
+    if (!slot_states_[conflict].compare_exchange_strong(
+            state, kSkipped, std::memory_order_acq_rel) &&
+        state == kLive) {
+      return false;
+    }
+  }
+  int32 state = kUnused;
+  if (!slot_states_[index].compare_exchange_strong(state, kLive,
+                                                   std::memory_order_acq_rel)) {
+    return false;
+  }
+  num_live_slots_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void StepArenaAllocator::ReleaseSlot(void* ptr) {
+  const int64 offset = static_cast<char*>(ptr) - arena_;
+  auto it = slots_by_offset_.find(offset);
+  if (it != slots_by_offset_.end()) {
+    // Allocations at the same offset overlap, so at most one of them is live.
+    for (int32 index : it->second) {
+      int32 state = kLive;
+      if (slot_states_[index].compare_exchange_strong(
+              state, kReleased, std::memory_order_acq_rel)) {
+        num_live_slots_.fetch_sub(1, std::memory_order_release);
+        return;
+      }
+    }
+  }
+  LOG(ERROR) << "Deallocating " << ptr << " at offset " << offset
+             << " of a step arena, which is not a live allocation.";
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  const int mode = mode_.load(std::memory_order_acquire);
+  if (mode == kPlanned) {
+    char* p = static_cast<char*>(ptr);
+    if (p >= arena_ && p < arena_ + arena_size_) {
+      ReleaseSlot(ptr);
+      Unref();
+      return;
+    }
+  } else if (mode == kRecording) {
+    mutex_lock l(mu_);
+    if (recording_) {
+      auto it = live_records_.find(ptr);
+      if (it != live_records_.end()) {
+        records_[it->second].free_index = records_.size();
+        live_records_.erase(it);
+      }
+    }
+  }
+  wrapped_->DeallocateRaw(ptr);
+  Unref();
+}
+
+}  // namespace tensorflow
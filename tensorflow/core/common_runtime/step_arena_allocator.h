@@ -0,0 +1,162 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// StepArenaAllocator serves the allocations of a repeatedly executed graph
+// from a single arena whose layout is planned ahead of time.
+//
+// The first step that runs with the allocator forwards every allocation to
+// the wrapped allocator and records its size and lifetime, in the order in
+// which the allocations were made. When that step ends, the allocations
+// that were also released during the step are assigned offsets in an arena
+// such that allocations with overlapping lifetimes never share memory
+// (greedy by size, as in TFLite's ArenaPlanner). The arena is allocated once
+// from the wrapped allocator.
+//
+// Later steps serve their i-th allocation from the planned offset if it
+// fits the planned size. Before handing out memory, the allocator checks
+// that every earlier allocation planned to share it has been released in
+// this step, so steps whose allocation order or lifetimes differ from the
+// recorded step fall back to the wrapped allocator instead of overwriting
+// live tensors. The plan is most effective when the graph has static shapes
+// and the executor runs its kernels in a deterministic order, e.g. inline.
+//
+// Only one step can use the arena at a time; see `BeginStep()`.
+//
+// The allocator is reference counted, and each outstanding allocation holds
+// a reference, so tensors allocated by it may outlive its owner.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  // `wrapped` must outlive this allocator.
+  explicit StepArenaAllocator(Allocator* wrapped);
+
+  // Reserves the allocator for a step. Returns false if another step holds
+  // it, if the arena still contains allocations of an earlier step, or if no
+  // useful plan could be made; the step must then not use this allocator.
+  bool BeginStep();
+
+  // Releases the allocator after a step for which `BeginStep()` returned
+  // true. All allocations of the step must have been made by then. The
+  // first step produces the plan.
+  void EndStep();
+
+  // Returns the size of the planned arena, or 0 if no plan has been made.
+  size_t arena_size() const { return arena_size_; }
+
+  // Returns the number of allocations served from the arena so far.
+  int64 num_arena_allocations() const {
+    return num_arena_allocations_.load(std::memory_order_relaxed);
+  }
+
+  std::string Name() override { return wrapped_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  absl::optional<AllocatorStats> GetStats() override {
+    return wrapped_->GetStats();
+  }
+  bool ClearStats() override { return wrapped_->ClearStats(); }
+
+ protected:
+  ~StepArenaAllocator() override;
+
+ private:
+  enum Mode { kRecording, kPlanned, kDisabled };
+
+  // Per-step state of a planned allocation.
+  enum SlotState : int32 {
+    kUnused = 0,
+    // Served from the arena and not yet released.
+    kLive,
+    // Served from the arena and released.
+    kReleased,
+    // Not served from the arena in this step, e.g. because a later
+    // allocation claimed memory that overlaps it.
+    kSkipped,
+  };
+
+  // An allocation of the recorded step. Lifetimes are measured in number of
+  // allocations made: the allocation is live in [alloc_index, free_index).
+  struct Record {
+    size_t num_bytes;
+    int64 alloc_index;
+    int64 free_index;
+    bool plannable;
+  };
+
+  struct Slot {
+    // Offset in the arena, or -1 if the allocation is not planned.
+    int64 offset = -1;
+    // Bytes reserved in the arena.
+    size_t num_bytes = 0;
+    // Earlier planned allocations whose memory overlaps this one. They must
+    // have been released before this slot can be used.
+    std::vector<int32> conflicts;
+  };
+
+  void* AllocateFromArena(size_t alignment, size_t num_bytes,
+                          const AllocationAttributes& allocation_attr);
+  bool ClaimSlot(int64 index);
+  void ReleaseSlot(void* ptr);
+  void BuildPlan() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const wrapped_;  // Not owned.
+
+  std::atomic<int> mode_{kRecording};
+  // True while a step holds the allocator.
+  std::atomic<bool> in_step_{false};
+
+  mutex mu_;
+  bool recording_ TF_GUARDED_BY(mu_) = false;
+  std::vector<Record> records_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<void*, int64> live_records_ TF_GUARDED_BY(mu_);
+
+  // The plan. Immutable once `mode_` is kPlanned.
+  std::vector<Slot> slots_;
+  absl::flat_hash_map<int64, absl::InlinedVector<int32, 2>> slots_by_offset_;
+  char* arena_ = nullptr;
+  size_t arena_size_ = 0;
+
+  // State of the step that holds the arena.
+  std::unique_ptr<std::atomic<int32>[]> slot_states_;
+  std::atomic<int64> next_index_{0};
+  std::atomic<int64> num_live_slots_{0};
+
+  std::atomic<int64> num_arena_allocations_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
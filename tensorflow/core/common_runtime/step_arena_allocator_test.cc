@@ -0,0 +1,198 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+
+class StepArenaAllocatorTest : public ::testing::Test {
+ protected:
+  StepArenaAllocatorTest()
+      : allocator_(new StepArenaAllocator(cpu_allocator())) {}
+  ~StepArenaAllocatorTest() override { allocator_->Unref(); }
+
+  // Runs a step that allocates 100, 200 and 100 bytes, where the first
+  // allocation is released before the last one is made.
+  void RunStep(void** a, void** b, void** c) {
+    ASSERT_TRUE(allocator_->BeginStep());
+    *a = allocator_->AllocateRaw(kAlignment, 100);
+    *b = allocator_->AllocateRaw(kAlignment, 200);
+    allocator_->DeallocateRaw(*a);
+    *c = allocator_->AllocateRaw(kAlignment, 100);
+    allocator_->DeallocateRaw(*b);
+    allocator_->DeallocateRaw(*c);
+    allocator_->EndStep();
+  }
+
+  StepArenaAllocator* allocator_;
+};
+
+TEST_F(StepArenaAllocatorTest, PlansFromFirstStep) {
+  void *a, *b, *c;
+  RunStep(&a, &b, &c);
+  EXPECT_EQ(0, allocator_->num_arena_allocations());
+  // `b` overlaps both `a` and `c`, which can share memory.
+  EXPECT_EQ(384, allocator_->arena_size());
+
+  for (int i = 0; i < 3; ++i) {
+    RunStep(&a, &b, &c);
+    EXPECT_EQ(a, c);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(3 * (i + 1), allocator_->num_arena_allocations());
+  }
+}
+
+TEST_F(StepArenaAllocatorTest, FallsBackForLargerAllocations) {
+  void *a, *b, *c;
+  RunStep(&a, &b, &c);
+
+  ASSERT_TRUE(allocator_->BeginStep());
+  a = allocator_->AllocateRaw(kAlignment, 1000);
+  b = allocator_->AllocateRaw(kAlignment, 200);
+  EXPECT_EQ(1, allocator_->num_arena_allocations());
+  allocator_->DeallocateRaw(a);
+  allocator_->DeallocateRaw(b);
+  allocator_->EndStep();
+}
+
+TEST_F(StepArenaAllocatorTest, DoesNotShareMemoryWithLiveAllocations) {
+  void *a, *b, *c;
+  RunStep(&a, &b, &c);
+
+  // `c` is planned to reuse the memory of `a`, which is still alive.
+  ASSERT_TRUE(allocator_->BeginStep());
+  a = allocator_->AllocateRaw(kAlignment, 100);
+  b = allocator_->AllocateRaw(kAlignment, 200);
+  c = allocator_->AllocateRaw(kAlignment, 100);
+  EXPECT_NE(a, c);
+  EXPECT_EQ(2, allocator_->num_arena_allocations());
+  memset(a, 1, 100);
+  memset(c, 2, 100);
+  EXPECT_EQ(1, static_cast<char*>(a)[99]);
+  allocator_->DeallocateRaw(a);
+  allocator_->DeallocateRaw(b);
+  allocator_->DeallocateRaw(c);
+  allocator_->EndStep();
+
+  // The arena is used again once the order matches.
+  RunStep(&a, &b, &c);
+  EXPECT_EQ(a, c);
+  EXPECT_EQ(5, allocator_->num_arena_allocations());
+}
+
+TEST_F(StepArenaAllocatorTest, ReusesMemoryOfSkippedAllocations) {
+  void *a, *b, *c;
+  RunStep(&a, &b, &c);
+
+  // The first allocation does not fit its slot, so `c` can use the memory
+  // planned for it.
+  ASSERT_TRUE(allocator_->BeginStep());
+  void* unplanned = allocator_->AllocateRaw(kAlignment, 1000);
+  b = allocator_->AllocateRaw(kAlignment, 200);
+  c = allocator_->AllocateRaw(kAlignment, 100);
+  EXPECT_EQ(2, allocator_->num_arena_allocations());
+  allocator_->DeallocateRaw(unplanned);
+  allocator_->DeallocateRaw(b);
+  allocator_->DeallocateRaw(c);
+  allocator_->EndStep();
+}
+
+TEST_F(StepArenaAllocatorTest, OnlyOneStepHoldsTheArena) {
+  ASSERT_TRUE(allocator_->BeginStep());
+  EXPECT_FALSE(allocator_->BeginStep());
+  allocator_->DeallocateRaw(allocator_->AllocateRaw(kAlignment, 100));
+  allocator_->EndStep();
+
+  ASSERT_TRUE(allocator_->BeginStep());
+  EXPECT_FALSE(allocator_->BeginStep());
+  allocator_->EndStep();
+}
+
+TEST_F(StepArenaAllocatorTest, WaitsForOutputsOfEarlierStep) {
+  void *a, *b, *c;
+  RunStep(&a, &b, &c);
+
+  // `b` outlives the step, like a fetched output.
+  ASSERT_TRUE(allocator_->BeginStep());
+  a = allocator_->AllocateRaw(kAlignment, 100);
+  b = allocator_->AllocateRaw(kAlignment, 200);
+  allocator_->DeallocateRaw(a);
+  c = allocator_->AllocateRaw(kAlignment, 100);
+  allocator_->DeallocateRaw(c);
+  allocator_->EndStep();
+  EXPECT_FALSE(allocator_->BeginStep());
+
+  allocator_->DeallocateRaw(b);
+  RunStep(&a, &b, &c);
+  EXPECT_EQ(6, allocator_->num_arena_allocations());
+}
+
+TEST_F(StepArenaAllocatorTest, DoesNotPlanAllocationsThatOutliveTheStep) {
+  ASSERT_TRUE(allocator_->BeginStep());
+  void* persistent = allocator_->AllocateRaw(kAlignment, 1000);
+  void* temp = allocator_->AllocateRaw(kAlignment, 100);
+  allocator_->DeallocateRaw(temp);
+  allocator_->EndStep();
+  EXPECT_EQ(128, allocator_->arena_size());
+  allocator_->DeallocateRaw(persistent);
+
+  ASSERT_TRUE(allocator_->BeginStep());
+  persistent = allocator_->AllocateRaw(kAlignment, 1000);
+  temp = allocator_->AllocateRaw(kAlignment, 100);
+  EXPECT_EQ(1, allocator_->num_arena_allocations());
+  allocator_->DeallocateRaw(temp);
+  allocator_->EndStep();
+  allocator_->DeallocateRaw(persistent);
+}
+
+TEST_F(StepArenaAllocatorTest, TensorsOutliveOwner) {
+  void *a, *b, *c;
+  RunStep(&a, &b, &c);
+
+  ASSERT_TRUE(allocator_->BeginStep());
+  Tensor t(allocator_, DT_FLOAT, TensorShape({25}));
+  allocator_->EndStep();
+  allocator_->Unref();
+  t.flat<float>().setZero();
+  t = Tensor();
+  allocator_ = new StepArenaAllocator(cpu_allocator());
+}
+
+void BM_StepArenaAllocator(::testing::benchmark::State& state) {
+  const int num_allocations = state.range(0);
+  StepArenaAllocator* allocator = new StepArenaAllocator(cpu_allocator());
+  std::vector<void*> ptrs(num_allocations);
+  for (auto s : state) {
+    allocator->BeginStep();
+    for (int i = 0; i < num_allocations; ++i) {
+      ptrs[i] = allocator->AllocateRaw(kAlignment, 1024 * (i % 4 + 1));
+      if (i > 0) allocator->DeallocateRaw(ptrs[i - 1]);
+    }
+    allocator->DeallocateRaw(ptrs[num_allocations - 1]);
+    allocator->EndStep();
+  }
+  allocator->Unref();
+}
+BENCHMARK(BM_StepArenaAllocator)->Arg(16)->Arg(256);
+
+}  // namespace
+}  // namespace tensorflow
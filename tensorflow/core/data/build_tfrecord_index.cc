@@ -0,0 +1,97 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Writes record index sidecar files (see lib/io/record_index.h) for existing
+// uncompressed TFRecord files, so that they can be read with
+// RandomAccessTFRecordDataset.
+//
+// Usage:
+//   build_tfrecord_index --pattern=/path/to/data-*.tfrecord [--overwrite]
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/io/record_index.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Indexes `filename` unless it already has an up-to-date index and
+// `overwrite` is false.
+Status IndexFile(Env* env, const std::string& filename, bool overwrite) {
+  std::vector<uint64> offsets;
+  if (!overwrite && io::ReadRecordIndex(env, filename, &offsets).ok()) {
+    LOG(INFO) << "Skipping " << filename << ": index is up to date.";
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(io::BuildRecordIndex(env, filename, &offsets));
+  TF_RETURN_IF_ERROR(io::WriteRecordIndex(env, filename, offsets));
+  LOG(INFO) << "Indexed " << offsets.size() - 1 << " records of " << filename;
+  return Status::OK();
+}
+
+int Run(const std::string& pattern, bool overwrite) {
+  Env* env = Env::Default();
+  std::vector<std::string> filenames;
+  Status s = env->GetMatchingPaths(pattern, &filenames);
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to match " << pattern << ": " << s;
+    return 1;
+  }
+  if (filenames.empty()) {
+    LOG(ERROR) << "No files match " << pattern;
+    return 1;
+  }
+  int num_failures = 0;
+  for (const std::string& filename : filenames) {
+    if (absl::EndsWith(filename, io::RecordIndexFilename(""))) continue;
+    s = IndexFile(env, filename, overwrite);
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to index " << filename << ": " << s;
+      ++num_failures;
+    }
+  }
+  return num_failures == 0 ? 0 : 1;
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
+
+int main(int argc, char** argv) {
+  std::string pattern;
+  bool overwrite = false;
+  std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("pattern", &pattern,
+                       "Glob pattern of the uncompressed TFRecord files to "
+                       "index"),
+      tensorflow::Flag("overwrite", &overwrite,
+                       "Whether to rebuild indexes that are up to date"),
+  };
+  bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result || pattern.empty()) {
+    std::cerr << tensorflow::Flags::Usage(argv[0], flag_list);
+    return -1;
+  }
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  return tensorflow::data::Run(pattern, overwrite);
+}
@@ -0,0 +1,407 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/columnar_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/record_block.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/byte_order.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+bool IsSupportedType(DataType dtype) {
+  switch (dtype) {
+    case DT_INT32:
+    case DT_INT64:
+    case DT_FLOAT:
+    case DT_DOUBLE:
+    case DT_STRING:
+      return true;
+    default:
+      return false;
+  }
+}
+
+int CompressionLevel(const io::RecordWriterOptions& options) {
+  switch (options.compression_type) {
+    case io::RecordWriterOptions::ZLIB_COMPRESSION:
+      return options.zlib_options.compression_level;
+    case io::RecordWriterOptions::ZSTD_COMPRESSION:
+      return options.zstd_options.compression_level;
+    case io::RecordWriterOptions::LZ4_COMPRESSION:
+      return options.lz4_options.compression_level;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+ColumnarFileWriter::ColumnarFileWriter(WritableFile* file,
+                                       std::vector<ColumnSchema> columns,
+                                       const ColumnarFileWriterOptions& options)
+    : file_(file), columns_(std::move(columns)), options_(options) {}
+
+Status ColumnarFileWriter::Initialize() {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Columnar files can only be written on little-endian hosts.");
+  }
+  if (columns_.empty()) {
+    return errors::InvalidArgument(
+        "A columnar file needs at least one column.");
+  }
+  for (const ColumnSchema& column : columns_) {
+    if (!IsSupportedType(column.dtype)) {
+      return errors::InvalidArgument("Column ", column.name,
+                                     " has unsupported type ",
+                                     DataTypeString(column.dtype));
+    }
+  }
+  if (options_.rows_per_row_group <= 0) {
+    return errors::InvalidArgument("`rows_per_row_group` must be > 0, got ",
+                                   options_.rows_per_row_group);
+  }
+  const string& compression_type = options_.compression_type;
+  if (compression_type != io::compression::kNone &&
+      compression_type != io::compression::kZlib &&
+      compression_type != io::compression::kSnappy &&
+      compression_type != io::compression::kZstd &&
+      compression_type != io::compression::kLz4) {
+    return errors::InvalidArgument("Unsupported compression type ",
+                                   compression_type, " for columnar files.");
+  }
+  const io::RecordWriterOptions record_options =
+      io::RecordWriterOptions::CreateRecordWriterOptions(compression_type);
+  compression_type_ = record_options.compression_type;
+  compression_level_ = CompressionLevel(record_options);
+  chunks_.resize(columns_.size());
+  string_offsets_.resize(columns_.size());
+  return Status::OK();
+}
+
+Status ColumnarFileWriter::Write(const std::vector<Tensor>& columns) {
+  if (finished_) {
+    return errors::FailedPrecondition("Columnar file writer is finished.");
+  }
+  if (columns.size() != columns_.size()) {
+    return errors::InvalidArgument("Expected ", columns_.size(),
+                                   " columns, got ", columns.size());
+  }
+  for (size_t i = 0; i < columns.size(); ++i) {
+    if (columns[i].dtype() != columns_[i].dtype || columns[i].dims() != 1) {
+      return errors::InvalidArgument(
+          "Column ", columns_[i].name, " expects a vector of ",
+          DataTypeString(columns_[i].dtype), ", got a ",
+          DataTypeString(columns[i].dtype()), " tensor of shape ",
+          columns[i].shape().DebugString());
+    }
+    if (columns[i].dim_size(0) != columns[0].dim_size(0)) {
+      return errors::InvalidArgument(
+          "All columns must have the same number of rows, but column ",
+          columns_[i].name, " has ", columns[i].dim_size(0), " and column ",
+          columns_[0].name, " has ", columns[0].dim_size(0));
+    }
+  }
+  const int64 num_rows = columns[0].dim_size(0);
+  for (int64 begin = 0; begin < num_rows;) {
+    const int64 end = std::min(
+        num_rows,
+        begin + options_.rows_per_row_group - num_buffered_rows_);
+    AppendRows(columns, begin, end);
+    begin = end;
+    if (num_buffered_rows_ == options_.rows_per_row_group) {
+      TF_RETURN_IF_ERROR(FlushRowGroup());
+    }
+  }
+  return Status::OK();
+}
+
+void ColumnarFileWriter::AppendRows(const std::vector<Tensor>& columns,
+                                    int64 begin, int64 end) {
+  for (size_t i = 0; i < columns.size(); ++i) {
+    if (columns_[i].dtype == DT_STRING) {
+      auto values = columns[i].vec<tstring>();
+      std::vector<uint64>& offsets = string_offsets_[i];
+      for (int64 row = begin; row < end; ++row) {
+        chunks_[i].append(values(row).data(), values(row).size());
+        offsets.push_back(chunks_[i].size());
+      }
+    } else {
+      const StringPiece data = columns[i].tensor_data();
+      const size_t value_size = DataTypeSize(columns_[i].dtype);
+      chunks_[i].append(data.data() + begin * value_size,
+                        (end - begin) * value_size);
+    }
+  }
+  num_buffered_rows_ += end - begin;
+}
+
+Status ColumnarFileWriter::FlushRowGroup() {
+  if (num_buffered_rows_ == 0) return Status::OK();
+  core::PutVarint64(&row_groups_, num_buffered_rows_);
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    string chunk;
+    if (columns_[i].dtype == DT_STRING) {
+      const std::vector<uint64>& offsets = string_offsets_[i];
+      chunk.reserve((offsets.size() + 1) * sizeof(uint64) + chunks_[i].size());
+      core::PutFixed64(&chunk, 0);
+      for (uint64 offset : offsets) core::PutFixed64(&chunk, offset);
+      chunk.append(chunks_[i]);
+    } else {
+      chunk.swap(chunks_[i]);
+    }
+    const uint64 uncompressed_size = chunk.size();
+    if (compression_type_ != io::RecordWriterOptions::NONE) {
+      string compressed;
+      TF_RETURN_IF_ERROR(io::CompressRecordBlock(
+          compression_type_, compression_level_, chunk, &compressed));
+      chunk.swap(compressed);
+    }
+    TF_RETURN_IF_ERROR(file_->Append(chunk));
+    core::PutVarint64(&row_groups_, file_offset_);
+    core::PutVarint64(&row_groups_, chunk.size());
+    core::PutVarint64(&row_groups_, uncompressed_size);
+    file_offset_ += chunk.size();
+    chunks_[i].clear();
+    string_offsets_[i].clear();
+  }
+  ++num_row_groups_;
+  num_buffered_rows_ = 0;
+  return Status::OK();
+}
+
+Status ColumnarFileWriter::Finish() {
+  if (finished_) {
+    return errors::FailedPrecondition("Columnar file writer is finished.");
+  }
+  TF_RETURN_IF_ERROR(FlushRowGroup());
+  finished_ = true;
+  string metadata;
+  core::PutVarint32(&metadata, columns_.size());
+  for (const ColumnSchema& column : columns_) {
+    core::PutVarint32(&metadata, column.name.size());
+    metadata.append(column.name);
+    core::PutVarint32(&metadata, column.dtype);
+  }
+  core::PutVarint64(&metadata, num_row_groups_);
+  metadata.append(row_groups_);
+
+  char footer[kColumnarFooterSize];
+  core::EncodeFixed64(footer, file_offset_);
+  core::EncodeFixed64(footer + 8, metadata.size());
+  core::EncodeFixed32(footer + 16, compression_type_);
+  core::EncodeFixed32(footer + 20, crc32c::Mask(crc32c::Value(
+                                       metadata.data(), metadata.size())));
+  core::EncodeFixed64(footer + 24, kColumnarMagic);
+  metadata.append(footer, kColumnarFooterSize);
+  return file_->Append(metadata);
+}
+
+Status ColumnarFileReader::Open(Env* env, const string& filename,
+                                std::unique_ptr<ColumnarFileReader>* reader) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Columnar files can only be read on little-endian hosts.");
+  }
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  std::unique_ptr<ColumnarFileReader> result(
+      new ColumnarFileReader(filename, std::move(file)));
+  TF_RETURN_IF_ERROR(result->ReadMetadata(file_size));
+  *reader = std::move(result);
+  return Status::OK();
+}
+
+Status ColumnarFileReader::ReadMetadata(uint64 file_size) {
+  if (file_size < kColumnarFooterSize) {
+    return errors::DataLoss(filename_, " is too small to be a columnar file.");
+  }
+  char footer_scratch[kColumnarFooterSize];
+  StringPiece footer;
+  TF_RETURN_IF_ERROR(file_->Read(file_size - kColumnarFooterSize,
+                                 kColumnarFooterSize, &footer,
+                                 footer_scratch));
+  if (footer.size() != kColumnarFooterSize ||
+      core::DecodeFixed64(footer.data() + 24) != kColumnarMagic) {
+    return errors::DataLoss(filename_, " is not a columnar file.");
+  }
+  const uint64 metadata_offset = core::DecodeFixed64(footer.data());
+  const uint64 metadata_size = core::DecodeFixed64(footer.data() + 8);
+  compression_type_ = core::DecodeFixed32(footer.data() + 16);
+  const uint32 masked_crc = core::DecodeFixed32(footer.data() + 20);
+  if (metadata_offset > file_size - kColumnarFooterSize ||
+      metadata_size != file_size - kColumnarFooterSize - metadata_offset) {
+    return errors::DataLoss("Corrupted footer in columnar file ", filename_);
+  }
+
+  std::unique_ptr<char[]> scratch(new char[metadata_size]);
+  StringPiece metadata;
+  TF_RETURN_IF_ERROR(
+      file_->Read(metadata_offset, metadata_size, &metadata, scratch.get()));
+  if (metadata.size() != metadata_size ||
+      crc32c::Unmask(masked_crc) !=
+          crc32c::Value(metadata.data(), metadata.size())) {
+    return errors::DataLoss("Corrupted metadata in columnar file ", filename_);
+  }
+
+  auto corrupted = [this]() {
+    return errors::DataLoss("Corrupted metadata in columnar file ", filename_);
+  };
+  uint32 num_columns;
+  if (!core::GetVarint32(&metadata, &num_columns)) return corrupted();
+  columns_.resize(num_columns);
+  for (ColumnSchema& column : columns_) {
+    uint32 name_size;
+    uint32 dtype;
+    if (!core::GetVarint32(&metadata, &name_size) ||
+        metadata.size() < name_size) {
+      return corrupted();
+    }
+    column.name = string(metadata.substr(0, name_size));
+    metadata.remove_prefix(name_size);
+    if (!core::GetVarint32(&metadata, &dtype)) return corrupted();
+    column.dtype = static_cast<DataType>(dtype);
+    if (!IsSupportedType(column.dtype)) return corrupted();
+  }
+  uint64 num_row_groups;
+  if (!core::GetVarint64(&metadata, &num_row_groups)) return corrupted();
+  for (uint64 i = 0; i < num_row_groups; ++i) {
+    RowGroup row_group;
+    uint64 num_rows;
+    if (!core::GetVarint64(&metadata, &num_rows)) return corrupted();
+    row_group.num_rows = num_rows;
+    row_group.chunks.resize(num_columns);
+    for (ChunkHandle& chunk : row_group.chunks) {
+      if (!core::GetVarint64(&metadata, &chunk.offset) ||
+          !core::GetVarint64(&metadata, &chunk.size) ||
+          !core::GetVarint64(&metadata, &chunk.uncompressed_size) ||
+          chunk.offset > metadata_offset ||
+          chunk.size > metadata_offset - chunk.offset) {
+        return corrupted();
+      }
+    }
+    row_groups_.push_back(std::move(row_group));
+  }
+  if (!metadata.empty()) return corrupted();
+  return Status::OK();
+}
+
+int ColumnarFileReader::FindColumn(StringPiece name) const {
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    if (columns_[i].name == name) return i;
+  }
+  return -1;
+}
+
+Status ColumnarFileReader::ReadRaw(int64 row_group, const ChunkHandle& handle,
+                                   char* scratch, StringPiece* data) const {
+  TF_RETURN_IF_ERROR(file_->Read(handle.offset, handle.size, data, scratch));
+  if (data->size() != handle.size) {
+    return errors::DataLoss("Truncated chunk in row group ", row_group,
+                            " of columnar file ", filename_);
+  }
+  return Status::OK();
+}
+
+Status ColumnarFileReader::ReadChunk(int64 row_group, int column,
+                                     Allocator* allocator, Tensor* output,
+                                     uint64* bytes_read) const {
+  const RowGroup& group = row_groups_[row_group];
+  const ChunkHandle& handle = group.chunks[column];
+  const DataType dtype = columns_[column].dtype;
+  *bytes_read = handle.size;
+  Tensor result(allocator, dtype, TensorShape({group.num_rows}));
+
+  if (dtype != DT_STRING) {
+    const uint64 expected_size = group.num_rows * DataTypeSize(dtype);
+    if (handle.uncompressed_size != expected_size) {
+      return errors::DataLoss("Chunk ", column, " of row group ", row_group,
+                              " of columnar file ", filename_, " has ",
+                              handle.uncompressed_size, " bytes, expected ",
+                              expected_size);
+    }
+    char* buffer = const_cast<char*>(result.tensor_data().data());
+    if (compression_type_ == io::RecordWriterOptions::NONE) {
+      StringPiece data;
+      TF_RETURN_IF_ERROR(ReadRaw(row_group, handle, buffer, &data));
+      if (data.data() != buffer) {
+        std::memcpy(buffer, data.data(), data.size());
+      }
+    } else {
+      std::unique_ptr<char[]> scratch(new char[handle.size]);
+      StringPiece data;
+      TF_RETURN_IF_ERROR(ReadRaw(row_group, handle, scratch.get(), &data));
+      tstring uncompressed;
+      TF_RETURN_IF_ERROR(io::UncompressRecordBlock(
+          compression_type_, data, handle.uncompressed_size, &uncompressed));
+      std::memcpy(buffer, uncompressed.data(), uncompressed.size());
+    }
+    *output = std::move(result);
+    return Status::OK();
+  }
+
+  std::unique_ptr<char[]> scratch(new char[handle.size]);
+  StringPiece data;
+  TF_RETURN_IF_ERROR(ReadRaw(row_group, handle, scratch.get(), &data));
+  if (compression_type_ == io::RecordWriterOptions::NONE) {
+    TF_RETURN_IF_ERROR(DecodeStrings(row_group, data, &result));
+  } else {
+    tstring uncompressed;
+    TF_RETURN_IF_ERROR(io::UncompressRecordBlock(
+        compression_type_, data, handle.uncompressed_size, &uncompressed));
+    TF_RETURN_IF_ERROR(DecodeStrings(row_group, uncompressed, &result));
+  }
+  *output = std::move(result);
+  return Status::OK();
+}
+
+Status ColumnarFileReader::DecodeStrings(int64 row_group, StringPiece data,
+                                         Tensor* output) const {
+  auto values = output->vec<tstring>();
+  const uint64 num_rows = values.size();
+  const uint64 offsets_size = (num_rows + 1) * sizeof(uint64);
+  auto corrupted = [this, row_group]() {
+    return errors::DataLoss("Corrupted string chunk in row group ", row_group,
+                            " of columnar file ", filename_);
+  };
+  if (data.size() < offsets_size) return corrupted();
+  const char* offsets = data.data();
+  const char* bytes = data.data() + offsets_size;
+  const uint64 bytes_size = data.size() - offsets_size;
+  uint64 begin = core::DecodeFixed64(offsets);
+  for (uint64 row = 0; row < num_rows; ++row) {
+    const uint64 end =
+        core::DecodeFixed64(offsets + (row + 1) * sizeof(uint64));
+    if (end < begin || end > bytes_size) return corrupted();
+    values(row).assign(bytes + begin, end - begin);
+    begin = end;
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,206 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_COLUMNAR_FILE_H_
+#define TENSORFLOW_CORE_DATA_COLUMNAR_FILE_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// A columnar file stores a table whose columns hold one scalar per row.
+// Rows are grouped into row groups, and each row group stores every column
+// in a separate contiguous chunk, so a reader can fetch only the columns it
+// needs and decode the row groups of a file independently of each other.
+// The file layout is:
+//
+//   row group[0]: chunk[0] ... chunk[num_columns - 1]
+//   ...
+//   row group[num_row_groups - 1]: chunk[0] ... chunk[num_columns - 1]
+//   metadata
+//   footer
+//
+// A chunk is compressed as one record block (see lib/io/record_block.h) when
+// the file has a compression type. Its uncompressed content is:
+//   - numeric columns: num_rows little-endian values, i.e. the memory layout
+//     of a 1-D tensor;
+//   - string columns: num_rows + 1 little-endian uint64 offsets into the
+//     value bytes, followed by the concatenated values.
+//
+// Metadata:
+//   varint32  number of columns
+//   per column:
+//     varint32  length of the name, followed by the name
+//     varint32  DataType of the column
+//   varint64  number of row groups
+//   per row group:
+//     varint64  number of rows
+//     per column:
+//       varint64  offset of the chunk in the file
+//       varint64  size of the chunk in the file
+//       varint64  uncompressed size of the chunk
+//
+// Footer (kColumnarFooterSize bytes):
+//   uint64    offset of the metadata in the file
+//   uint64    size of the metadata
+//   uint32    compression type (a RecordWriterOptions::CompressionType)
+//   uint32    masked crc of the metadata
+//   uint64    kColumnarMagic
+
+// "TFCOLUMN" in little-endian byte order.
+constexpr uint64 kColumnarMagic = 0x4e4d554c4f434654ull;
+constexpr size_t kColumnarFooterSize = 3 * sizeof(uint64) + 2 * sizeof(uint32);
+
+struct ColumnSchema {
+  string name;
+  // One of DT_INT32, DT_INT64, DT_FLOAT, DT_DOUBLE or DT_STRING.
+  DataType dtype;
+};
+
+struct ColumnarFileWriterOptions {
+  // "", "ZLIB", "SNAPPY", "ZSTD" or "LZ4". Chunks are compressed with the
+  // default level of the codec.
+  string compression_type;
+  // Number of rows per row group. Larger row groups compress better and
+  // make reads larger; smaller ones give readers more parallelism.
+  int64 rows_per_row_group = 64 * 1024;
+};
+
+// Writes a columnar file.
+//
+// A ColumnarFileWriter is NOT safe for concurrent use by multiple threads.
+class ColumnarFileWriter {
+ public:
+  // Creates a writer that appends a table with the given columns to `file`,
+  // which must remain live while this writer is in use.
+  ColumnarFileWriter(WritableFile* file, std::vector<ColumnSchema> columns,
+                     const ColumnarFileWriterOptions& options);
+
+  // Checks the schema and options. Must be called before any other method.
+  Status Initialize();
+
+  // Appends rows to the table. `columns` holds one 1-D tensor per column, of
+  // the type of that column, and all tensors must have the same length.
+  Status Write(const std::vector<Tensor>& columns);
+
+  // Writes the buffered rows, the metadata and the footer. `file` is neither
+  // flushed nor closed.
+  Status Finish();
+
+ private:
+  // Appends rows [begin, end) of `columns` to the current row group.
+  void AppendRows(const std::vector<Tensor>& columns, int64 begin, int64 end);
+
+  // Compresses and writes out the current row group, if it has any rows.
+  Status FlushRowGroup();
+
+  WritableFile* const file_;
+  const std::vector<ColumnSchema> columns_;
+  const ColumnarFileWriterOptions options_;
+  int compression_type_ = 0;
+  int compression_level_ = 0;
+
+  // Uncompressed content of each chunk of the current row group. The values
+  // of a string column are collected apart from their offsets.
+  std::vector<string> chunks_;
+  std::vector<std::vector<uint64>> string_offsets_;
+  int64 num_buffered_rows_ = 0;
+
+  uint64 file_offset_ = 0;
+  // Metadata of the row groups written so far.
+  string row_groups_;
+  uint64 num_row_groups_ = 0;
+  bool finished_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ColumnarFileWriter);
+};
+
+// Reads chunks of a columnar file.
+//
+// A ColumnarFileReader is safe for concurrent use by multiple threads.
+class ColumnarFileReader {
+ public:
+  // Opens `filename` and reads its metadata.
+  static Status Open(Env* env, const string& filename,
+                     std::unique_ptr<ColumnarFileReader>* reader);
+
+  const std::vector<ColumnSchema>& columns() const { return columns_; }
+
+  // Returns the index of the column named `name`, or -1 if there is none.
+  int FindColumn(StringPiece name) const;
+
+  int64 num_row_groups() const { return row_groups_.size(); }
+  int64 num_rows(int64 row_group) const {
+    return row_groups_[row_group].num_rows;
+  }
+
+  // Reads chunk `column` of row group `row_group` into `*output`, a new 1-D
+  // tensor allocated with `allocator`. Numeric chunks of uncompressed files
+  // are read straight into the tensor buffer. Stores the number of bytes read
+  // from the file in `*bytes_read`.
+  Status ReadChunk(int64 row_group, int column, Allocator* allocator,
+                   Tensor* output, uint64* bytes_read) const;
+
+ private:
+  struct ChunkHandle {
+    uint64 offset = 0;
+    uint64 size = 0;
+    uint64 uncompressed_size = 0;
+  };
+  struct RowGroup {
+    int64 num_rows = 0;
+    std::vector<ChunkHandle> chunks;
+  };
+
+  ColumnarFileReader(string filename, std::unique_ptr<RandomAccessFile> file)
+      : filename_(std::move(filename)), file_(std::move(file)) {}
+
+  // Reads the footer and metadata of a file of `file_size` bytes.
+  Status ReadMetadata(uint64 file_size);
+
+  // Reads the `handle.size` bytes of a chunk into `scratch` and returns them
+  // in `*data`, which may point elsewhere.
+  Status ReadRaw(int64 row_group, const ChunkHandle& handle, char* scratch,
+                 StringPiece* data) const;
+
+  // Decodes the uncompressed content of a string chunk into `output`.
+  Status DecodeStrings(int64 row_group, StringPiece data,
+                       Tensor* output) const;
+
+  const string filename_;
+  const std::unique_ptr<RandomAccessFile> file_;
+  int compression_type_ = 0;
+  std::vector<ColumnSchema> columns_;
+  std::vector<RowGroup> row_groups_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ColumnarFileReader);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_COLUMNAR_FILE_H_
@@ -0,0 +1,179 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/columnar_file.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<ColumnSchema> TestSchema() {
+  return {{"id", DT_INT64},
+          {"score", DT_FLOAT},
+          {"weight", DT_DOUBLE},
+          {"label", DT_INT32},
+          {"name", DT_STRING}};
+}
+
+// Returns rows [begin, end) of the test table, one tensor per column.
+std::vector<Tensor> TestRows(int64 begin, int64 end) {
+  std::vector<int64> ids;
+  std::vector<float> scores;
+  std::vector<double> weights;
+  std::vector<int32> labels;
+  std::vector<tstring> names;
+  for (int64 i = begin; i < end; ++i) {
+    ids.push_back(i * 1000);
+    scores.push_back(i / 4.0f);
+    weights.push_back(i / 8.0);
+    labels.push_back(i % 3);
+    names.push_back(strings::StrCat("name", string(i % 5, 'x'), i));
+  }
+  const TensorShape shape({end - begin});
+  return {test::AsTensor<int64>(ids, shape),
+          test::AsTensor<float>(scores, shape),
+          test::AsTensor<double>(weights, shape),
+          test::AsTensor<int32>(labels, shape),
+          test::AsTensor<tstring>(names, shape)};
+}
+
+string WriteTestFile(const string& name, int64 num_rows,
+                     const ColumnarFileWriterOptions& options) {
+  const string filename = io::JoinPath(testing::TmpDir(), name);
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(Env::Default()->NewWritableFile(filename, &file));
+  ColumnarFileWriter writer(file.get(), TestSchema(), options);
+  TF_CHECK_OK(writer.Initialize());
+  // Write in pieces that do not line up with the row groups.
+  for (int64 begin = 0; begin < num_rows; begin += 7) {
+    TF_CHECK_OK(writer.Write(TestRows(begin, std::min(begin + 7, num_rows))));
+  }
+  TF_CHECK_OK(writer.Finish());
+  TF_CHECK_OK(file->Close());
+  return filename;
+}
+
+class ColumnarFileRoundTripTest : public ::testing::TestWithParam<string> {};
+
+TEST_P(ColumnarFileRoundTripTest, RoundTrip) {
+  ColumnarFileWriterOptions options;
+  options.compression_type = GetParam();
+  options.rows_per_row_group = 10;
+  const string filename =
+      WriteTestFile(strings::StrCat("round_trip_", GetParam()), 25, options);
+
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+  ASSERT_EQ(reader->columns().size(), 5);
+  EXPECT_EQ(reader->columns()[4].name, "name");
+  EXPECT_EQ(reader->columns()[4].dtype, DT_STRING);
+  ASSERT_EQ(reader->num_row_groups(), 3);
+  for (int64 row_group = 0; row_group < 3; ++row_group) {
+    const int64 begin = row_group * 10;
+    const int64 end = std::min<int64>(begin + 10, 25);
+    EXPECT_EQ(reader->num_rows(row_group), end - begin);
+    std::vector<Tensor> expected = TestRows(begin, end);
+    for (int column = 0; column < 5; ++column) {
+      Tensor chunk;
+      uint64 bytes_read;
+      TF_ASSERT_OK(reader->ReadChunk(row_group, column, cpu_allocator(),
+                                     &chunk, &bytes_read));
+      EXPECT_GT(bytes_read, 0);
+      test::ExpectEqual(chunk, expected[column]);
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Compression, ColumnarFileRoundTripTest,
+                         ::testing::Values(io::compression::kNone,
+                                           io::compression::kZlib,
+                                           io::compression::kZstd,
+                                           io::compression::kLz4));
+
+TEST(ColumnarFileTest, FindColumn) {
+  const string filename =
+      WriteTestFile("find_column", 3, ColumnarFileWriterOptions());
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+  EXPECT_EQ(reader->FindColumn("id"), 0);
+  EXPECT_EQ(reader->FindColumn("name"), 4);
+  EXPECT_EQ(reader->FindColumn("missing"), -1);
+  EXPECT_EQ(reader->num_row_groups(), 1);
+}
+
+TEST(ColumnarFileTest, EmptyTable) {
+  const string filename =
+      WriteTestFile("empty", 0, ColumnarFileWriterOptions());
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+  EXPECT_EQ(reader->columns().size(), 5);
+  EXPECT_EQ(reader->num_row_groups(), 0);
+}
+
+TEST(ColumnarFileTest, RejectsMismatchedRows) {
+  const string filename = io::JoinPath(testing::TmpDir(), "mismatched");
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(filename, &file));
+  ColumnarFileWriter writer(file.get(), {{"a", DT_INT64}, {"b", DT_FLOAT}},
+                            ColumnarFileWriterOptions());
+  TF_ASSERT_OK(writer.Initialize());
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      writer.Write({test::AsTensor<int64>({1, 2}),
+                    test::AsTensor<float>({1.0f})})));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      writer.Write({test::AsTensor<int64>({1}), test::AsTensor<int64>({1})})));
+}
+
+TEST(ColumnarFileTest, RejectsUnsupportedSchema) {
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(
+      io::JoinPath(testing::TmpDir(), "unsupported"), &file));
+  ColumnarFileWriter writer(file.get(), {{"a", DT_BOOL}},
+                            ColumnarFileWriterOptions());
+  EXPECT_TRUE(errors::IsInvalidArgument(writer.Initialize()));
+}
+
+TEST(ColumnarFileTest, DetectsCorruption) {
+  const string filename =
+      WriteTestFile("corrupt", 20, ColumnarFileWriterOptions());
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+
+  // Flip a byte of the metadata, which sits right before the footer.
+  string corrupted = contents;
+  corrupted[corrupted.size() - kColumnarFooterSize - 1] ^= 0x1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, corrupted));
+  std::unique_ptr<ColumnarFileReader> reader;
+  EXPECT_TRUE(errors::IsDataLoss(
+      ColumnarFileReader::Open(Env::Default(), filename, &reader)));
+
+  // Drop the footer.
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(), filename,
+      contents.substr(0, contents.size() - kColumnarFooterSize)));
+  EXPECT_TRUE(errors::IsDataLoss(
+      ColumnarFileReader::Open(Env::Default(), filename, &reader)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -14,18 +14,193 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <lz4frame.h>
+#include <zstd.h>
+
 #include <limits>
+#include <memory>
 
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+Status ParseCompression(const std::string& compression,
+                        CompressedElement::Compression* out) {
+  if (compression.empty() || compression == io::compression::kSnappy) {
+    *out = CompressedElement::SNAPPY;
+  } else if (compression == io::compression::kZstd) {
+    *out = CompressedElement::ZSTD;
+  } else if (compression == io::compression::kLz4) {
+    *out = CompressedElement::LZ4;
+  } else {
+    return errors::InvalidArgument(
+        "Unsupported element compression: ", compression,
+        ". Expected one of '', 'SNAPPY', 'ZSTD' or 'LZ4'.");
+  }
+  return Status::OK();
+}
+
+Status ZstdCompress(const char* input, size_t length, std::string* output) {
+  output->resize(ZSTD_compressBound(length));
+  size_t result = ZSTD_compress(&(*output)[0], output->size(), input, length,
+                                ZSTD_CLEVEL_DEFAULT);
+  if (ZSTD_isError(result)) {
+    return errors::Internal("Failed to compress using zstd: ",
+                            ZSTD_getErrorName(result));
+  }
+  output->resize(result);
+  return Status::OK();
+}
+
+Status Lz4Compress(const char* input, size_t length, std::string* output) {
+  LZ4F_preferences_t preferences;
+  memset(&preferences, 0, sizeof(preferences));
+  preferences.frameInfo.contentSize = length;
+  output->resize(LZ4F_compressFrameBound(length, &preferences));
+  size_t result = LZ4F_compressFrame(&(*output)[0], output->size(), input,
+                                     length, &preferences);
+  if (LZ4F_isError(result)) {
+    return errors::Internal("Failed to compress using LZ4: ",
+                            LZ4F_getErrorName(result));
+  }
+  output->resize(result);
+  return Status::OK();
+}
+
+Status SnappyUncompressToIOVec(const std::string& compressed,
+                               const struct iovec* iov, size_t iov_cnt,
+                               size_t total_size) {
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(
+          compressed.data(), compressed.size(), &uncompressed_size)) {
+    return errors::Internal(
+        "Could not get snappy uncompressed length. Compressed data size: ",
+        compressed.size());
+  }
+  if (uncompressed_size != total_size) {
+    return errors::Internal(
+        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+        " whereas the tensor metadata suggests ", total_size);
+  }
+  if (!port::Snappy_UncompressToIOVec(compressed.data(), compressed.size(),
+                                      iov, iov_cnt)) {
+    return errors::Internal("Failed to perform snappy decompression.");
+  }
+  return Status::OK();
+}
+
+// Streams the zstd frame in `compressed` directly into the component buffers
+// described by `iov`, avoiding an intermediate contiguous buffer.
+Status ZstdUncompressToIOVec(const std::string& compressed,
+                             const struct iovec* iov, size_t iov_cnt) {
+  std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx(ZSTD_createDCtx(),
+                                                            &ZSTD_freeDCtx);
+  if (dctx == nullptr) {
+    return errors::ResourceExhausted("Failed to create a zstd context");
+  }
+  ZSTD_inBuffer input = {compressed.data(), compressed.size(), 0};
+  size_t result = 1;
+  for (size_t i = 0; i < iov_cnt; ++i) {
+    ZSTD_outBuffer output = {iov[i].iov_base, iov[i].iov_len, 0};
+    while (output.pos < output.size) {
+      const size_t input_pos = input.pos;
+      const size_t output_pos = output.pos;
+      result = ZSTD_decompressStream(dctx.get(), &output, &input);
+      if (ZSTD_isError(result)) {
+        return errors::Internal("Failed to perform zstd decompression: ",
+                                ZSTD_getErrorName(result));
+      }
+      if (input.pos == input_pos && output.pos == output_pos) {
+        return errors::Internal(
+            "Uncompressed size mismatch. The zstd frame is shorter than the "
+            "tensor metadata suggests.");
+      }
+    }
+  }
+  if (result != 0) {
+    // Consume the frame epilogue; any remaining content is a size mismatch.
+    ZSTD_outBuffer output = {nullptr, 0, 0};
+    result = ZSTD_decompressStream(dctx.get(), &output, &input);
+  }
+  if (ZSTD_isError(result) || result != 0 || input.pos != input.size) {
+    return errors::Internal(
+        "Uncompressed size mismatch. The zstd frame is longer than the tensor "
+        "metadata suggests.");
+  }
+  return Status::OK();
+}
+
+// Streams the LZ4 frame in `compressed` directly into the component buffers
+// described by `iov`, avoiding an intermediate contiguous buffer.
+Status Lz4UncompressToIOVec(const std::string& compressed,
+                            const struct iovec* iov, size_t iov_cnt) {
+  LZ4F_dctx* raw_dctx = nullptr;
+  size_t result = LZ4F_createDecompressionContext(&raw_dctx, LZ4F_VERSION);
+  if (LZ4F_isError(result)) {
+    return errors::ResourceExhausted("Failed to create an LZ4 context: ",
+                                     LZ4F_getErrorName(result));
+  }
+  std::unique_ptr<LZ4F_dctx, decltype(&LZ4F_freeDecompressionContext)> dctx(
+      raw_dctx, &LZ4F_freeDecompressionContext);
+  const char* input = compressed.data();
+  size_t input_left = compressed.size();
+  result = 1;
+  for (size_t i = 0; i < iov_cnt; ++i) {
+    char* output = static_cast<char*>(iov[i].iov_base);
+    size_t output_left = iov[i].iov_len;
+    while (output_left > 0) {
+      size_t output_size = output_left;
+      size_t input_size = input_left;
+      result = LZ4F_decompress(dctx.get(), output, &output_size, input,
+                               &input_size, /*dOptPtr=*/nullptr);
+      if (LZ4F_isError(result)) {
+        return errors::Internal("Failed to perform LZ4 decompression: ",
+                                LZ4F_getErrorName(result));
+      }
+      if (output_size == 0 && input_size == 0) {
+        return errors::Internal(
+            "Uncompressed size mismatch. The LZ4 frame is shorter than the "
+            "tensor metadata suggests.");
+      }
+      output += output_size;
+      output_left -= output_size;
+      input += input_size;
+      input_left -= input_size;
+    }
+  }
+  if (result != 0) {
+    // Consume the frame epilogue; any remaining content is a size mismatch.
+    size_t output_size = 0;
+    size_t input_size = input_left;
+    result = LZ4F_decompress(dctx.get(), /*dstBuffer=*/nullptr, &output_size,
+                             input, &input_size, /*dOptPtr=*/nullptr);
+    input_left -= LZ4F_isError(result) ? 0 : input_size;
+  }
+  if (LZ4F_isError(result) || result != 0 || input_left != 0) {
+    return errors::Internal(
+        "Uncompressed size mismatch. The LZ4 frame is longer than the tensor "
+        "metadata suggests.");
+  }
+  return Status::OK();
+}
+
+}  // namespace
 
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
+  return CompressElement(element, io::compression::kSnappy, out);
+}
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       const std::string& compression, CompressedElement* out) {
+  CompressedElement::Compression codec;
+  TF_RETURN_IF_ERROR(ParseCompression(compression, &codec));
   // Step 1: Determine the total uncompressed size. This requires serializing
   // non-memcopyable tensors, which we save to use again later.
   std::vector<TensorProto> non_memcpy_components;
@@ -74,9 +249,21 @@ Status CompressElement(const std::vector<Tensor>& element,
   }
   DCHECK_EQ(position, uncompressed.mdata() + total_size);
 
-  if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
-                             out->mutable_data())) {
-    return errors::Internal("Failed to compress using snappy.");
+  out->set_compression(codec);
+  switch (codec) {
+    case CompressedElement::ZSTD:
+      TF_RETURN_IF_ERROR(
+          ZstdCompress(uncompressed.data(), total_size, out->mutable_data()));
+      break;
+    case CompressedElement::LZ4:
+      TF_RETURN_IF_ERROR(
+          Lz4Compress(uncompressed.data(), total_size, out->mutable_data()));
+      break;
+    default:
+      if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
+                                 out->mutable_data())) {
+        return errors::Internal("Failed to compress using snappy.");
+      }
   }
   VLOG(3) << "Compressed element from " << total_size << " bytes to "
           << out->data().size() << " bytes";
@@ -126,22 +313,22 @@ Status UncompressElement(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(total_size)) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", total_size);
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.data(),
-                                      num_components)) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  switch (compressed.compression()) {
+    case CompressedElement::ZSTD:
+      TF_RETURN_IF_ERROR(
+          ZstdUncompressToIOVec(compressed_data, iov.data(), num_components));
+      break;
+    case CompressedElement::LZ4:
+      TF_RETURN_IF_ERROR(
+          Lz4UncompressToIOVec(compressed_data, iov.data(), num_components));
+      break;
+    case CompressedElement::SNAPPY:
+      TF_RETURN_IF_ERROR(SnappyUncompressToIOVec(
+          compressed_data, iov.data(), num_components, total_size));
+      break;
+    default:
+      return errors::Internal("Unknown element compression: ",
+                              compressed.compression());
   }
 
   // Step 3: Deserialize tensor proto strings to tensors.
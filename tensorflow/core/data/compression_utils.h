@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_COMPRESSION_UTILS_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_COMPRESSION_UTILS_H_
 
+#include <string>
+
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/platform/status.h"
@@ -31,7 +33,14 @@ namespace data {
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
-// Uncompresses a `CompressedElement` into a vector of tensor components.
+// Like above, but compresses with the codec named by `compression`, which is
+// one of `io::compression::kSnappy`, `io::compression::kZstd`, or
+// `io::compression::kLz4`. The empty string selects Snappy.
+Status CompressElement(const std::vector<Tensor>& element,
+                       const std::string& compression, CompressedElement* out);
+
+// Uncompresses a `CompressedElement` into a vector of tensor components. The
+// codec is taken from `compressed.compression()`.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
 
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -35,6 +36,55 @@ TEST_P(ParameterizedCompressionUtilsTest, RoundTrip) {
       ExpectEqual(element, round_trip_element, /*compare_order=*/true));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, RoundTripWithCodec) {
+  std::vector<Tensor> element = GetParam();
+  for (const char* compression :
+       {io::compression::kSnappy, io::compression::kZstd,
+        io::compression::kLz4}) {
+    CompressedElement compressed;
+    TF_ASSERT_OK(CompressElement(element, compression, &compressed));
+    std::vector<Tensor> round_trip_element;
+    TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+    TF_EXPECT_OK(
+        ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+  }
+}
+
+TEST(CompressionUtilsTest, CodecIsRecorded) {
+  std::vector<Tensor> element = CreateTensors<int64>(TensorShape{1}, {{1}});
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, "", &compressed));
+  EXPECT_EQ(compressed.compression(), CompressedElement::SNAPPY);
+  TF_ASSERT_OK(CompressElement(element, io::compression::kZstd, &compressed));
+  EXPECT_EQ(compressed.compression(), CompressedElement::ZSTD);
+  TF_ASSERT_OK(CompressElement(element, io::compression::kLz4, &compressed));
+  EXPECT_EQ(compressed.compression(), CompressedElement::LZ4);
+}
+
+TEST(CompressionUtilsTest, UnsupportedCodec) {
+  std::vector<Tensor> element = CreateTensors<int64>(TensorShape{1}, {{1}});
+  CompressedElement compressed;
+  EXPECT_EQ(CompressElement(element, "GZIP", &compressed).code(),
+            error::INVALID_ARGUMENT);
+}
+
+TEST(CompressionUtilsTest, SizeMismatch) {
+  for (const char* compression :
+       {io::compression::kSnappy, io::compression::kZstd,
+        io::compression::kLz4}) {
+    std::vector<Tensor> element =
+        CreateTensors<int64>(TensorShape{4}, {{1, 2, 3, 4}});
+    CompressedElement compressed;
+    TF_ASSERT_OK(CompressElement(element, compression, &compressed));
+    compressed.mutable_component_metadata(0)->mutable_tensor_shape()->Clear();
+    TensorShape({2}).AsProto(
+        compressed.mutable_component_metadata(0)->mutable_tensor_shape());
+    std::vector<Tensor> round_trip_element;
+    EXPECT_EQ(UncompressElement(compressed, &round_trip_element).code(),
+              error::INTERNAL);
+  }
+}
+
 std::vector<std::vector<Tensor>> TestCases() {
   return {
       CreateTensors<int64>(TensorShape{1}, {{1}}),             // int64
@@ -155,6 +155,7 @@ Status WriteDataToTFRecordFile(const string& filename,
   auto options = io::RecordWriterOptions::CreateRecordWriterOptions(
       ToString(params.compression_type));
   options.zlib_options.input_buffer_size = params.input_buffer_size;
+  options.block_size_bytes = params.block_size_bytes;
   io::RecordWriter record_writer(file_writer.get(), options);
   for (const auto& record : records) {
     TF_RETURN_IF_ERROR(record_writer.WriteRecord(record));
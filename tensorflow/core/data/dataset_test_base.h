@@ -103,6 +103,9 @@ struct CompressionParams {
   CompressionType compression_type = CompressionType::UNCOMPRESSED;
   int32 input_buffer_size = 0;
   int32 output_buffer_size = 0;
+  // If positive, TFRecord files are written block-compressed with blocks of
+  // about this many bytes.
+  int64 block_size_bytes = 0;
 };
 
 // Writes the input data into the file without compression.
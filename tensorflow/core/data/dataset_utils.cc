@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/util/work_sharder.h"
 
@@ -72,6 +73,7 @@ constexpr char kFilterFusionOpt[] = "filter_fusion";
 constexpr char kMapAndFilterFusionOpt[] = "map_and_filter_fusion";
 constexpr char kMapFusionOpt[] = "map_fusion";
 constexpr char kParallelBatchOpt[] = "parallel_batch";
+constexpr char kParseExampleVectorizationOpt[] = "parse_example_vectorization";
 constexpr char kAutotuneBufferSizesOpt[] = "autotune_buffer_sizes";
 constexpr char kDisablePrefetchLegacyAutotuneOpt[] =
     "disable_prefetch_legacy_autotune";
@@ -164,6 +166,14 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kParallelBatchOpt);
     }
   }
+  if (optimization_options.optional_parse_example_vectorization_case() ==
+      OptimizationOptions::kParseExampleVectorization) {
+    if (optimization_options.parse_example_vectorization()) {
+      optimization_enabled->insert(kParseExampleVectorizationOpt);
+    } else {
+      optimization_disabled->insert(kParseExampleVectorizationOpt);
+    }
+  }
   if (optimization_options.optional_shuffle_and_repeat_fusion_case() ==
       OptimizationOptions::kShuffleAndRepeatFusion) {
     if (optimization_options.shuffle_and_repeat_fusion()) {
@@ -388,6 +398,22 @@ std::function<void(std::function<void()>)> RunnerWithMaxParallelism(
       std::move(runner), std::placeholders::_1);
 }
 
+int ConsumerNumaNode(int num_numa_nodes, int thread_numa_node,
+                     const string& device_type, int device_numa_node) {
+  if (num_numa_nodes <= 1) {
+    return port::kNUMANoAffinity;
+  }
+  if (!device_type.empty() && device_type != DEVICE_CPU) {
+    return port::kNUMANoAffinity;
+  }
+  int node = thread_numa_node != port::kNUMANoAffinity ? thread_numa_node
+                                                        : device_numa_node;
+  if (node < 0 || node >= num_numa_nodes) {
+    return port::kNUMANoAffinity;
+  }
+  return node;
+}
+
 Status DeterminismPolicy::FromString(const std::string& s,
                                      DeterminismPolicy* out) {
   DeterminismPolicy::Type type;
@@ -174,6 +174,16 @@ Status IsNodeStateful(const FunctionLibraryDefinition& library,
 std::function<void(std::function<void()>)> RunnerWithMaxParallelism(
     std::function<void(std::function<void()>)> runner, int max_parallelism);
 
+// Returns the NUMA node a pipeline should be placed on, given the number of
+// NUMA nodes on the machine, the NUMA node the consuming thread has been
+// explicitly pinned to, the type of the consuming device (empty if unknown),
+// and the NUMA node the consuming device has been explicitly assigned to.
+// Either node may be `port::kNUMANoAffinity`; the thread's node takes
+// precedence. Returns `port::kNUMANoAffinity` if the machine has a single
+// NUMA node, if neither node was set, or if the device is not a CPU.
+int ConsumerNumaNode(int num_numa_nodes, int thread_numa_node,
+                     const string& device_type, int device_numa_node);
+
 // Op for creating a typed dummy resource.
 //
 // This op is used to provide a resource "placeholder" for ops such as
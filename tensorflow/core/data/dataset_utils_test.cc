@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
@@ -158,6 +159,29 @@ TEST(DatasetUtilsTest, RunnerWithMaxParallelism) {
   runner(fn);
 }
 
+TEST(DatasetUtilsTest, ConsumerNumaNode) {
+  // Single NUMA node machines are never pinned.
+  EXPECT_EQ(ConsumerNumaNode(/*num_numa_nodes=*/1, /*thread_numa_node=*/0,
+                             DEVICE_CPU, /*device_numa_node=*/0),
+            port::kNUMANoAffinity);
+  // Without explicit thread affinity or device locality, nothing is pinned.
+  EXPECT_EQ(ConsumerNumaNode(2, port::kNUMANoAffinity, DEVICE_CPU,
+                             port::kNUMANoAffinity),
+            port::kNUMANoAffinity);
+  EXPECT_EQ(ConsumerNumaNode(2, port::kNUMANoAffinity, /*device_type=*/"",
+                             port::kNUMANoAffinity),
+            port::kNUMANoAffinity);
+  // The consuming thread's affinity takes precedence over the device's.
+  EXPECT_EQ(ConsumerNumaNode(2, 1, DEVICE_CPU, 0), 1);
+  EXPECT_EQ(ConsumerNumaNode(2, 1, /*device_type=*/"", port::kNUMANoAffinity),
+            1);
+  EXPECT_EQ(ConsumerNumaNode(2, port::kNUMANoAffinity, DEVICE_CPU, 1), 1);
+  // Non-CPU consumers and out-of-range nodes are never pinned.
+  EXPECT_EQ(ConsumerNumaNode(2, 1, DEVICE_GPU, 1), port::kNUMANoAffinity);
+  EXPECT_EQ(ConsumerNumaNode(2, 2, DEVICE_CPU, port::kNUMANoAffinity),
+            port::kNUMANoAffinity);
+}
+
 TEST(DatasetUtilsTest, ParseDeterminismPolicy) {
   DeterminismPolicy determinism;
   TF_ASSERT_OK(DeterminismPolicy::FromString("true", &determinism));
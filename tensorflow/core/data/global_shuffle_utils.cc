@@ -0,0 +1,187 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/global_shuffle_utils.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The finalizer of SplitMix64, a bijective mixing function.
+uint64 Mix(uint64 x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+}  // namespace
+
+RandomPermutation::RandomPermutation(uint64 size, uint64 seed) : size_(size) {
+  int bits = 0;
+  while (bits < 64 && (size > 1 ? size - 1 : 0) >> bits) ++bits;
+  half_bits_ = std::max(1, (bits + 1) / 2);
+  half_mask_ = (uint64{1} << half_bits_) - 1;
+  uint64 key = seed;
+  for (int i = 0; i < kNumRounds; ++i) {
+    key = Mix(key);
+    keys_[i] = key;
+  }
+}
+
+uint64 RandomPermutation::Encrypt(uint64 value) const {
+  uint64 left = value >> half_bits_;
+  uint64 right = value & half_mask_;
+  for (int i = 0; i < kNumRounds; ++i) {
+    const uint64 next = left ^ (Mix(right ^ keys_[i]) & half_mask_);
+    left = right;
+    right = next;
+  }
+  return (left << half_bits_) | right;
+}
+
+uint64 RandomPermutation::operator()(uint64 index) const {
+  DCHECK_LT(index, size_);
+  // The Feistel network permutes a domain of fewer than 4 * size_ values;
+  // cycle-walking restricts it to a permutation of [0, size_).
+  uint64 value = Encrypt(index);
+  while (value >= size_) value = Encrypt(value);
+  return value;
+}
+
+BlockShuffleOrder::BlockShuffleOrder(uint64 num_records, uint64 block_size,
+                                     uint64 window_blocks, uint64 seed)
+    : num_records_(num_records),
+      block_size_(std::max<uint64>(block_size, 1)),
+      window_blocks_(std::max<uint64>(window_blocks, 1)),
+      num_blocks_((num_records + block_size_ - 1) / block_size_),
+      seed_(seed),
+      block_permutation_(num_blocks_, seed) {}
+
+uint64 BlockShuffleOrder::num_windows() const {
+  return (num_blocks_ + window_blocks_ - 1) / window_blocks_;
+}
+
+std::vector<std::pair<uint64, uint64>> BlockShuffleOrder::WindowRanges(
+    uint64 window) const {
+  std::vector<std::pair<uint64, uint64>> ranges;
+  const uint64 first = window * window_blocks_;
+  const uint64 last = std::min(first + window_blocks_, num_blocks_);
+  for (uint64 i = first; i < last; ++i) {
+    const uint64 block = block_permutation_(i);
+    const uint64 begin = block * block_size_;
+    ranges.emplace_back(begin, std::min(begin + block_size_, num_records_));
+  }
+  return ranges;
+}
+
+RandomPermutation BlockShuffleOrder::WindowPermutation(
+    uint64 window, uint64 window_size) const {
+  return RandomPermutation(window_size, Mix(seed_ ^ Mix(window)));
+}
+
+BlockShuffledReader::BlockShuffledReader(uint64 num_records,
+                                         uint64 block_size,
+                                         uint64 window_blocks, uint64 seed)
+    : order_(num_records, block_size, window_blocks, seed) {}
+
+uint64 BlockShuffledReader::WindowSize(uint64 window) const {
+  uint64 size = 0;
+  for (const auto& range : order_.WindowRanges(window)) {
+    size += range.second - range.first;
+  }
+  return size;
+}
+
+void BlockShuffledReader::Unload() {
+  loaded_ = false;
+  records_.clear();
+}
+
+Status BlockShuffledReader::GetNext(const ReadRangeFn& read_range,
+                                    tstring* record, bool* end_of_sequence) {
+  while (window_ < order_.num_windows()) {
+    if (!loaded_) {
+      records_.clear();
+      Status s;
+      for (const auto& range : order_.WindowRanges(window_)) {
+        s = read_range(range.first, range.second, &records_);
+        if (!s.ok()) break;
+      }
+      if (s.ok() && records_.size() != WindowSize(window_)) {
+        s = errors::Internal("Expected ", WindowSize(window_),
+                             " records in shuffle window ", window_,
+                             " but read ", records_.size());
+      }
+      if (!s.ok()) {
+        Unload();
+        ++window_;
+        offset_ = 0;
+        return s;
+      }
+      loaded_ = true;
+      permutation_ = order_.WindowPermutation(window_, records_.size());
+    }
+    if (offset_ < records_.size()) {
+      *record = std::move(records_[permutation_(offset_)]);
+      ++offset_;
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+    Unload();
+    ++window_;
+    offset_ = 0;
+  }
+  *end_of_sequence = true;
+  return Status::OK();
+}
+
+void BlockShuffledReader::Skip(int64 num_to_skip, int64* num_skipped) {
+  *num_skipped = 0;
+  while (*num_skipped < num_to_skip && window_ < order_.num_windows()) {
+    const uint64 size = loaded_ ? records_.size() : WindowSize(window_);
+    const uint64 n = std::min<uint64>(size - std::min(offset_, size),
+                                      num_to_skip - *num_skipped);
+    offset_ += n;
+    *num_skipped += n;
+    if (offset_ >= size) {
+      Unload();
+      ++window_;
+      offset_ = 0;
+    }
+  }
+}
+
+Status BlockShuffledReader::Seek(uint64 window, uint64 offset) {
+  if (window > order_.num_windows() ||
+      (window < order_.num_windows() && offset > WindowSize(window)) ||
+      (window == order_.num_windows() && offset != 0)) {
+    return errors::InvalidArgument("Invalid shuffle position (", window, ", ",
+                                   offset, ") for ", order_.num_windows(),
+                                   " windows");
+  }
+  if (window != window_) Unload();
+  window_ = window;
+  offset_ = offset;
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,141 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_GLOBAL_SHUFFLE_UTILS_H_
+#define TENSORFLOW_CORE_DATA_GLOBAL_SHUFFLE_UTILS_H_
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// A pseudo-random bijection of [0, size) determined by `seed`. Evaluating
+// the permutation at any index takes constant time and no memory, so it can
+// be used to visit the records of arbitrarily large sources in random order.
+class RandomPermutation {
+ public:
+  RandomPermutation() : RandomPermutation(0, 0) {}
+  RandomPermutation(uint64 size, uint64 seed);
+
+  uint64 size() const { return size_; }
+
+  // Returns the image of `index`, which must be less than size().
+  uint64 operator()(uint64 index) const;
+
+ private:
+  static constexpr int kNumRounds = 4;
+
+  // A Feistel network over [0, 2^(2 * half_bits_)), which contains
+  // [0, size_).
+  uint64 Encrypt(uint64 value) const;
+
+  uint64 size_;
+  int half_bits_;
+  uint64 half_mask_;
+  uint64 keys_[kNumRounds];
+};
+
+// Defines the order in which a block-shuffled read visits the records
+// [0, num_records) of an indexed source.
+//
+// The records are split into blocks of `block_size` consecutive records, and
+// the blocks are visited in the order of a RandomPermutation. Every
+// `window_blocks` consecutive blocks of that order form a window: a window's
+// records are read block by block, so that reads stay mostly sequential, and
+// emitted in the order of another RandomPermutation. At most one window of
+// records needs to be held in memory.
+class BlockShuffleOrder {
+ public:
+  BlockShuffleOrder(uint64 num_records, uint64 block_size,
+                    uint64 window_blocks, uint64 seed);
+
+  uint64 num_records() const { return num_records_; }
+  uint64 num_windows() const;
+
+  // Returns the [begin, end) record ranges of window `window`, in read order.
+  std::vector<std::pair<uint64, uint64>> WindowRanges(uint64 window) const;
+
+  // Returns the order in which the records of window `window`, numbered in
+  // read order, are emitted.
+  RandomPermutation WindowPermutation(uint64 window, uint64 window_size) const;
+
+ private:
+  const uint64 num_records_;
+  const uint64 block_size_;
+  const uint64 window_blocks_;
+  const uint64 num_blocks_;
+  const uint64 seed_;
+  const RandomPermutation block_permutation_;
+};
+
+// Emits the records of an indexed source in the order of a
+// BlockShuffleOrder. The position of the reader is the pair
+// (window(), offset()); seeking to a saved position only re-reads the
+// records of that window.
+//
+// A BlockShuffledReader is NOT safe for concurrent use by multiple threads.
+class BlockShuffledReader {
+ public:
+  // Appends the records [begin, end) of the source to `*records`.
+  using ReadRangeFn = std::function<Status(uint64 begin, uint64 end,
+                                           std::vector<tstring>* records)>;
+
+  BlockShuffledReader(uint64 num_records, uint64 block_size,
+                      uint64 window_blocks, uint64 seed);
+
+  // Stores the next record in `*record`, reading the next window with
+  // `read_range` when the current one is exhausted. If reading a window
+  // fails, the error is returned and the reader moves on to the next window.
+  Status GetNext(const ReadRangeFn& read_range, tstring* record,
+                 bool* end_of_sequence);
+
+  // Skips up to `num_to_skip` records without reading them and stores the
+  // number of records actually skipped in `*num_skipped`.
+  void Skip(int64 num_to_skip, int64* num_skipped);
+
+  uint64 window() const { return window_; }
+  uint64 offset() const { return offset_; }
+
+  // Positions the reader so that the next record is the `offset`th record
+  // emitted from window `window`.
+  Status Seek(uint64 window, uint64 offset);
+
+ private:
+  // Returns the number of records in window `window`.
+  uint64 WindowSize(uint64 window) const;
+
+  // Drops the records of the current window.
+  void Unload();
+
+  const BlockShuffleOrder order_;
+  uint64 window_ = 0;
+  uint64 offset_ = 0;
+
+  // The records of `window_` in read order, if they have been read.
+  bool loaded_ = false;
+  std::vector<tstring> records_;
+  RandomPermutation permutation_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_GLOBAL_SHUFFLE_UTILS_H_
@@ -0,0 +1,142 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/global_shuffle_utils.h"
+
+#include <algorithm>
+#include <set>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Reads records named after their index.
+Status ReadRange(uint64 begin, uint64 end, std::vector<tstring>* records) {
+  for (uint64 i = begin; i < end; ++i) {
+    records->push_back(strings::StrCat(i));
+  }
+  return Status::OK();
+}
+
+std::vector<tstring> ReadAll(BlockShuffledReader* reader) {
+  std::vector<tstring> records;
+  tstring record;
+  bool end_of_sequence = false;
+  while (true) {
+    TF_CHECK_OK(reader->GetNext(ReadRange, &record, &end_of_sequence));
+    if (end_of_sequence) break;
+    records.push_back(record);
+  }
+  return records;
+}
+
+TEST(RandomPermutationTest, IsBijection) {
+  for (uint64 size : {0, 1, 2, 3, 7, 64, 100, 1000, 4097}) {
+    RandomPermutation permutation(size, /*seed=*/size * 31);
+    std::set<uint64> images;
+    for (uint64 i = 0; i < size; ++i) {
+      uint64 image = permutation(i);
+      EXPECT_LT(image, size);
+      images.insert(image);
+    }
+    EXPECT_EQ(images.size(), size);
+  }
+}
+
+TEST(RandomPermutationTest, DependsOnSeed) {
+  RandomPermutation a(1000, 1), b(1000, 1), c(1000, 2);
+  int num_equal_to_c = 0;
+  for (uint64 i = 0; i < 1000; ++i) {
+    EXPECT_EQ(a(i), b(i));
+    if (a(i) == c(i)) ++num_equal_to_c;
+  }
+  EXPECT_LT(num_equal_to_c, 100);
+}
+
+TEST(BlockShuffleOrderTest, WindowsCoverAllRecords) {
+  BlockShuffleOrder order(/*num_records=*/103, /*block_size=*/10,
+                          /*window_blocks=*/3, /*seed=*/7);
+  EXPECT_EQ(order.num_windows(), 4);
+  std::vector<bool> seen(103, false);
+  for (uint64 w = 0; w < order.num_windows(); ++w) {
+    auto ranges = order.WindowRanges(w);
+    EXPECT_EQ(ranges.size(), w < 3 ? 3 : 2);
+    for (const auto& range : ranges) {
+      EXPECT_EQ(range.first % 10, 0);
+      for (uint64 i = range.first; i < range.second; ++i) {
+        EXPECT_FALSE(seen[i]);
+        seen[i] = true;
+      }
+    }
+  }
+  EXPECT_EQ(std::count(seen.begin(), seen.end(), true), 103);
+}
+
+TEST(BlockShuffledReaderTest, EmitsPermutation) {
+  BlockShuffledReader reader(/*num_records=*/250, /*block_size=*/8,
+                             /*window_blocks=*/4, /*seed=*/3);
+  std::vector<tstring> records = ReadAll(&reader);
+  ASSERT_EQ(records.size(), 250);
+  std::set<tstring> unique(records.begin(), records.end());
+  EXPECT_EQ(unique.size(), 250);
+  EXPECT_NE(records[0], "0");
+
+  BlockShuffledReader same_seed(250, 8, 4, 3);
+  EXPECT_EQ(ReadAll(&same_seed), records);
+}
+
+TEST(BlockShuffledReaderTest, SkipAndSeek) {
+  BlockShuffledReader reference(/*num_records=*/100, /*block_size=*/5,
+                                /*window_blocks=*/2, /*seed=*/11);
+  std::vector<tstring> records = ReadAll(&reference);
+
+  BlockShuffledReader reader(100, 5, 2, 11);
+  int64 num_skipped;
+  reader.Skip(17, &num_skipped);
+  EXPECT_EQ(num_skipped, 17);
+  std::vector<tstring> rest = ReadAll(&reader);
+  EXPECT_EQ(rest, std::vector<tstring>(records.begin() + 17, records.end()));
+  reader.Skip(1, &num_skipped);
+  EXPECT_EQ(num_skipped, 0);
+
+  BlockShuffledReader restored(100, 5, 2, 11);
+  TF_ASSERT_OK(restored.Seek(/*window=*/3, /*offset=*/4));
+  rest = ReadAll(&restored);
+  EXPECT_EQ(rest, std::vector<tstring>(records.begin() + 34, records.end()));
+  EXPECT_FALSE(restored.Seek(/*window=*/3, /*offset=*/11).ok());
+}
+
+TEST(BlockShuffledReaderTest, ReadErrorSkipsWindow) {
+  BlockShuffledReader reader(/*num_records=*/20, /*block_size=*/5,
+                             /*window_blocks=*/2, /*seed=*/5);
+  auto fail_first = [](uint64 begin, uint64 end,
+                       std::vector<tstring>* records) {
+    return errors::DataLoss("corrupt");
+  };
+  tstring record;
+  bool end_of_sequence = false;
+  EXPECT_TRUE(errors::IsDataLoss(
+      reader.GetNext(fail_first, &record, &end_of_sequence)));
+  EXPECT_EQ(reader.window(), 1);
+  EXPECT_EQ(ReadAll(&reader).size(), 10);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -18,7 +18,11 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/unbounded_thread_pool.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
 namespace tensorflow {
@@ -31,8 +35,10 @@ constexpr char kCpuBudget[] = "cpu_budget";
 constexpr char kRamBudget[] = "ram_budget_bytes";
 constexpr char kHillClimb[] = "hill_climb";
 constexpr char kGradientDescent[] = "gradient_descent";
+constexpr char kCpuTimeHillClimb[] = "cpu_time_hill_climb";
 constexpr char kIntraOpParallelism[] = "intra_op_parallelism";
 constexpr char kPrivateThreadpoolSize[] = "threadpool_size";
+constexpr char kNumaAware[] = "numa_aware";
 
 // Default share of available RAM that can be used by model's internal buffers.
 constexpr double kRamBudgetShare = 0.5;
@@ -42,6 +48,41 @@ inline int64 value_or_default(int64 x, int64 y, int64 z) {
   return x == y ? z : x;
 }
 
+const char* AlgorithmName(model::AutotuneAlgorithm algorithm) {
+  switch (algorithm) {
+    case model::AutotuneAlgorithm::GRADIENT_DESCENT:
+      return kGradientDescent;
+    case model::AutotuneAlgorithm::CPU_TIME_HILL_CLIMB:
+      return kCpuTimeHillClimb;
+    default:
+      return kHillClimb;
+  }
+}
+
+// Returns the NUMA node of the thread consuming the dataset, falling back to
+// the NUMA node of the consuming device. Only placement that was requested
+// explicitly counts: the thread's node affinity, or the device locality that
+// CPU devices are given when `use_numa_affinity` is set in the session config.
+int ConsumerNumaNodeFromContext(IteratorContext* ctx) {
+  if (!port::NUMAEnabled()) {
+    return port::kNUMANoAffinity;
+  }
+  string device_type;
+  int device_numa_node = port::kNUMANoAffinity;
+  if (ctx->flr() != nullptr) {
+    // NOTE: need reinterpret_cast because function.h forward-declares Device.
+    DeviceBase* device = reinterpret_cast<DeviceBase*>(ctx->flr()->device());
+    device_type = device->attributes().device_type();
+    const ConfigProto* config = ctx->flr()->config_proto();
+    if (config != nullptr && config->experimental().use_numa_affinity()) {
+      device_numa_node = device->NumaNode();
+    }
+  }
+  return ConsumerNumaNode(port::NUMANumNodes(),
+                          port::NUMAGetThreadNodeAffinity(), device_type,
+                          device_numa_node);
+}
+
 }  // namespace
 
 // static
@@ -56,11 +97,15 @@ Status RootDataset::FromOptions(DatasetBase* input, DatasetBase** output) {
     params.private_threadpool_size =
         options.threading_options().private_threadpool_size();
   }
+  params.numa_aware = options.threading_options().numa_aware();
   params.autotune = ShouldUseAutotuning(options);
   if (params.autotune) {
     params.autotune_algorithm = model::AutotuneAlgorithm::HILL_CLIMB;
     if (options.optimization_options().autotune_buffers()) {
       params.autotune_algorithm = model::AutotuneAlgorithm::GRADIENT_DESCENT;
+    } else if (options.optimization_options().autotune_cpu_time()) {
+      params.autotune_algorithm =
+          model::AutotuneAlgorithm::CPU_TIME_HILL_CLIMB;
     }
     params.autotune_cpu_budget =
         value_or_default(options.optimization_options().autotune_cpu_budget(),
@@ -79,6 +124,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       : DatasetIterator<RootDataset>(params) {
     if (dataset()->params_.autotune) {
       model_ = std::make_shared<model::Model>();
+      model_->set_record_cpu_time(
+          dataset()->params_.autotune_algorithm ==
+          model::AutotuneAlgorithm::CPU_TIME_HILL_CLIMB);
     }
     if (dataset()->params_.max_intra_op_parallelism >= 0) {
       max_intra_op_parallelism_ =
@@ -89,9 +137,6 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       threadpool_size_ =
           value_or_default(dataset()->params_.private_threadpool_size, 0,
                            port::MaxParallelism());
-      thread_pool_ = absl::make_unique<thread::ThreadPool>(
-          Env::Default(), ThreadOptions{}, "data_private_threadpool",
-          threadpool_size_);
     }
     cancellation_manager_ = absl::make_unique<CancellationManager>();
   }
@@ -99,6 +144,21 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   ~Iterator() override { cancellation_manager_->StartCancel(); }
 
   Status Initialize(IteratorContext* ctx) override {
+    if (dataset()->params_.numa_aware) {
+      numa_node_ = ConsumerNumaNodeFromContext(ctx);
+    }
+    ThreadOptions thread_options;
+    thread_options.numa_node = numa_node_;
+    if (dataset()->params_.private_threadpool_size >= 0) {
+      thread_pool_ = absl::make_unique<thread::ThreadPool>(
+          Env::Default(), thread_options, "data_private_threadpool",
+          threadpool_size_);
+    }
+    if (numa_node_ != port::kNUMANoAffinity) {
+      VLOG(2) << "Placing tf.data pipeline on NUMA node " << numa_node_;
+      numa_thread_pool_ = absl::make_unique<UnboundedThreadPool>(
+          Env::Default(), "tf_data_numa", thread_options);
+    }
     return dataset()->input_->MakeIterator(IteratorContext(CreateParams(ctx)),
                                            this, prefix(), &input_impl_);
   }
@@ -151,6 +211,14 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       params.runner =
           RunnerWithMaxParallelism(params.runner, max_intra_op_parallelism_);
     }
+    if (numa_node_ != port::kNUMANoAffinity) {
+      // Background threads of the pipeline run on the consumer's NUMA node.
+      // The allocator is left alone: buffers are first touched by these
+      // threads, and a device with explicit locality already allocates from
+      // its own node.
+      params.numa_node = numa_node_;
+      params.thread_factory = numa_thread_pool_->get_thread_factory();
+    }
     return params;
   }
 
@@ -180,6 +248,8 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   int64 max_intra_op_parallelism_;
   int64 threadpool_size_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
+  int numa_node_ = port::kNUMANoAffinity;
+  std::unique_ptr<UnboundedThreadPool> numa_thread_pool_;
 
   // Must be ordered last as its execution may depend on other members.
   std::unique_ptr<IteratorBase> input_impl_;
@@ -192,10 +262,7 @@ RootDataset::RootDataset(const DatasetBase* input, Params params)
       params_(std::move(params)) {
   if (params_.autotune) {
     traceme_metadata_.push_back(std::make_pair(
-        kAlgorithm,
-        params_.autotune_algorithm == model::AutotuneAlgorithm::HILL_CLIMB
-            ? kHillClimb
-            : kGradientDescent));
+        kAlgorithm, AlgorithmName(params_.autotune_algorithm)));
     traceme_metadata_.push_back(std::make_pair(
         kCpuBudget, strings::Printf("%lld", static_cast<long long>(
                                                 params_.autotune_cpu_budget))));
@@ -217,6 +284,9 @@ RootDataset::RootDataset(const DatasetBase* input, Params params)
                                     params_.private_threadpool_size, 0,
                                     port::MaxParallelism())))));
   }
+  if (params_.numa_aware) {
+    traceme_metadata_.push_back(std::make_pair(kNumaAware, "true"));
+  }
   input_->Ref();
 }
 
@@ -33,6 +33,7 @@ class RootDataset : public DatasetBase {
     int64 autotune_ram_budget = 0;
     int64 max_intra_op_parallelism = 1;
     int64 private_threadpool_size = 0;
+    bool numa_aware = false;
   };
 
   static Status FromOptions(DatasetBase* input, DatasetBase** output);
@@ -18,12 +18,14 @@ limitations under the License.
 #include <string>
 #include <utility>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
 
 namespace tensorflow {
 namespace data {
@@ -35,6 +37,9 @@ constexpr char kNumComponents[] = "num_components";
 constexpr char kNumElements[] = "num_elements";
 constexpr char kIsDataset[] = ".is_dataset";
 constexpr char kOutputNode[] = ".output_node";
+constexpr char kDeterministic[] = "deterministic";
+constexpr char kReshuffleEachIteration[] = "reshuffle_each_iteration";
+constexpr char kSloppy[] = "sloppy";
 
 // We assume that all keys are of the form <iterator_prefix>:<name>. We extract
 // the iterator name by getting rid of everything post the final colon.
@@ -54,6 +59,79 @@ Status GetIteratorName(StringPiece key, string* name) {
   return Status::OK();
 }
 
+// Writes the element with the given index under `key_prefix`.
+Status WriteElement(IteratorStateWriter* writer, StringPiece key_prefix,
+                    int64 index, const std::vector<Tensor>& element) {
+  std::string element_prefix = absl::StrCat(key_prefix, "::", index);
+  TF_RETURN_IF_ERROR(
+      writer->WriteScalar(element_prefix, kNumComponents, element.size()));
+  for (int j = 0; j < element.size(); ++j) {
+    TF_RETURN_IF_ERROR(writer->WriteTensor(
+        element_prefix, absl::StrCat(kComponent, "[", j, "]"), element[j]));
+  }
+  return Status::OK();
+}
+
+// Sets `value` to the value of the scalar int64 Const node in `nodes` that
+// `input` refers to. Returns false if there is no such node.
+template <typename NodeDefs>
+bool GetConstInt64(const NodeDefs& nodes, const string& input, int64* value) {
+  const string name = input.substr(0, input.find(':'));
+  for (const NodeDef& node : nodes) {
+    if (node.name() != name) continue;
+    const AttrValue* tensor_value = gtl::FindOrNull(node.attr(), "value");
+    if (node.op() != "Const" || tensor_value == nullptr) return false;
+    Tensor tensor;
+    if (!tensor.FromProto(tensor_value->tensor()) ||
+        tensor.dtype() != DT_INT64 || tensor.NumElements() != 1) {
+      return false;
+    }
+    *value = tensor.flat<int64>()(0);
+    return true;
+  }
+  return false;
+}
+
+// Checks one node of the dataset graph, or of one of its functions, whose
+// sibling nodes are `nodes`. See `CheckReplayable`.
+template <typename NodeDefs>
+Status CheckReplayableNode(const NodeDefs& nodes, const NodeDef& node) {
+  const string& op = node.op();
+  if (op == "RandomDataset" || op == "ExperimentalRandomDataset" ||
+      op == "SamplingDataset" || op == "ShuffleDatasetV2") {
+    return errors::FailedPrecondition(op, " produces random elements.");
+  }
+  if (op == "ShuffleDataset" || op == "ShuffleDatasetV3" ||
+      op == "ShuffleAndRepeatDataset" || op == "ShuffleAndRepeatDatasetV2") {
+    const AttrValue* reshuffle =
+        gtl::FindOrNull(node.attr(), kReshuffleEachIteration);
+    if (reshuffle == nullptr || reshuffle->b()) {
+      return errors::FailedPrecondition(op, " reshuffles each iteration.");
+    }
+    // Inputs 2 and 3 are the seeds. If both are zero, the dataset picks
+    // random seeds.
+    int64 seed = 0;
+    int64 seed2 = 0;
+    if (node.input_size() < 4 || !GetConstInt64(nodes, node.input(2), &seed) ||
+        !GetConstInt64(nodes, node.input(3), &seed2) ||
+        (seed == 0 && seed2 == 0)) {
+      return errors::FailedPrecondition(op, " does not have fixed seeds.");
+    }
+  }
+  if (const AttrValue* deterministic =
+          gtl::FindOrNull(node.attr(), kDeterministic)) {
+    if (deterministic->s() == "false") {
+      return errors::FailedPrecondition(op, " is not deterministic.");
+    }
+  }
+  if (const AttrValue* sloppy = gtl::FindOrNull(node.attr(), kSloppy)) {
+    if (sloppy->b()) {
+      return errors::FailedPrecondition(op, " is not deterministic.");
+    }
+  }
+  return Status::OK();
+}
+
 Status FromGraphDef(FunctionLibraryRuntime* flr, const GraphDef& graph_def,
                     const std::vector<std::pair<string, Tensor>>& input_list,
                     const string& output_node, Tensor* result) {
@@ -106,17 +184,36 @@ Status ReadElementsFromCheckpoint(IteratorContext* ctx,
                                   IteratorStateReader* reader,
                                   StringPiece key_prefix,
                                   std::vector<std::vector<Tensor>>* elements) {
+  return ReadElementsFromCheckpoint(
+      ctx, reader, key_prefix, [elements](std::vector<Tensor> element) {
+        elements->push_back(std::move(element));
+        return Status::OK();
+      });
+}
+
+Status WriteElementsToCheckpoint(
+    IteratorStateWriter* writer, StringPiece key_prefix,
+    const std::vector<std::vector<Tensor>>& elements) {
+  TF_RETURN_IF_ERROR(
+      writer->WriteScalar(key_prefix, kNumElements, elements.size()));
+  for (int i = 0; i < elements.size(); ++i) {
+    TF_RETURN_IF_ERROR(WriteElement(writer, key_prefix, i, elements[i]));
+  }
+  return Status::OK();
+}
+
+Status ReadElementsFromCheckpoint(
+    IteratorContext* ctx, IteratorStateReader* reader, StringPiece key_prefix,
+    const std::function<Status(std::vector<Tensor>)>& add_element) {
   int64 num_elements;
   TF_RETURN_IF_ERROR(
       reader->ReadScalar(key_prefix, kNumElements, &num_elements));
-  elements->reserve(num_elements);
-  for (int i = 0; i < num_elements; ++i) {
+  for (int64 i = 0; i < num_elements; ++i) {
     std::string element_prefix = absl::StrCat(key_prefix, "::", i);
     int64 num_components;
     TF_RETURN_IF_ERROR(
         reader->ReadScalar(element_prefix, kNumComponents, &num_components));
-    elements->emplace_back();
-    std::vector<Tensor>& element = elements->at(i);
+    std::vector<Tensor> element;
     element.reserve(num_components);
     for (int j = 0; j < num_components; ++j) {
       element.emplace_back();
@@ -124,24 +221,20 @@ Status ReadElementsFromCheckpoint(IteratorContext* ctx,
           ctx->flr(), element_prefix, absl::StrCat(kComponent, "[", j, "]"),
           &element.back()));
     }
+    TF_RETURN_IF_ERROR(add_element(std::move(element)));
   }
   return Status::OK();
 }
 
 Status WriteElementsToCheckpoint(
-    IteratorStateWriter* writer, StringPiece key_prefix,
-    const std::vector<std::vector<Tensor>>& elements) {
+    IteratorStateWriter* writer, StringPiece key_prefix, int64 num_elements,
+    const std::function<Status(int64, std::vector<Tensor>*)>& get_element) {
   TF_RETURN_IF_ERROR(
-      writer->WriteScalar(key_prefix, kNumElements, elements.size()));
-  for (int i = 0; i < elements.size(); ++i) {
-    const std::vector<Tensor>& element = elements[i];
-    std::string element_prefix = absl::StrCat(key_prefix, "::", i);
-    TF_RETURN_IF_ERROR(
-        writer->WriteScalar(element_prefix, kNumComponents, element.size()));
-    for (int j = 0; j < elements[i].size(); ++j) {
-      TF_RETURN_IF_ERROR(writer->WriteTensor(
-          element_prefix, absl::StrCat(kComponent, "[", j, "]"), element[j]));
-    }
+      writer->WriteScalar(key_prefix, kNumElements, num_elements));
+  for (int64 i = 0; i < num_elements; ++i) {
+    std::vector<Tensor> element;
+    TF_RETURN_IF_ERROR(get_element(i, &element));
+    TF_RETURN_IF_ERROR(WriteElement(writer, key_prefix, i, element));
   }
   return Status::OK();
 }
@@ -437,6 +530,28 @@ Status AsGraphDefMinimal(OpKernelContext* ctx, const DatasetBase* input,
   return Status::OK();
 }
 
+Status CheckReplayable(const GraphDef& graph_def) {
+  for (const NodeDef& node : graph_def.node()) {
+    TF_RETURN_IF_ERROR(CheckReplayableNode(graph_def.node(), node));
+  }
+  for (const FunctionDef& function : graph_def.library().function()) {
+    for (const NodeDef& node : function.node_def()) {
+      TF_RETURN_IF_ERROR(CheckReplayableNode(function.node_def(), node));
+      // Unlike `IsNodeStateful`, this does not allow random ops.
+      const OpDef* op_def;
+      if (OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() &&
+          op_def->is_stateful() && op_def->name() != "Assert" &&
+          !absl::EndsWith(op_def->name(), "Dataset") &&
+          !absl::EndsWith(op_def->name(), "DatasetV2")) {
+        return errors::FailedPrecondition(
+            "Function ", function.signature().name(), " uses stateful op ",
+            node.op(), ".");
+      }
+    }
+  }
+  return Status::OK();
+}
+
 Status AsGraphDef(OpKernelContext* ctx, const DatasetBase* dataset,
                   SerializationContext&& serialization_ctx,
                   GraphDef* graph_def) {
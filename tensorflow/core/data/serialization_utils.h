@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERIALIZATION_UTILS_H_
 #define TENSORFLOW_CORE_DATA_SERIALIZATION_UTILS_H_
 
+#include <functional>
 #include <string>
 
 #include "tensorflow/core/framework/dataset.h"
@@ -38,6 +39,19 @@ Status WriteElementsToCheckpoint(
     IteratorStateWriter* writer, StringPiece key_prefix,
     const std::vector<std::vector<Tensor>>& elements);
 
+// Like `ReadElementsFromCheckpoint`, but passes the elements to `add_element`
+// one at a time instead of collecting them in a vector.
+Status ReadElementsFromCheckpoint(
+    IteratorContext* ctx, IteratorStateReader* reader, StringPiece key_prefix,
+    const std::function<Status(std::vector<Tensor>)>& add_element);
+
+// Like `WriteElementsToCheckpoint`, but writes `num_elements` elements that
+// are produced one at a time by `get_element(index, &element)`, so that they
+// do not all need to be materialized at once.
+Status WriteElementsToCheckpoint(
+    IteratorStateWriter* writer, StringPiece key_prefix, int64 num_elements,
+    const std::function<Status(int64, std::vector<Tensor>*)>& get_element);
+
 // Helper class for reading data from a vector of VariantTensorData objects.
 class VariantTensorDataReader : public IteratorStateReader {
  public:
@@ -134,6 +148,15 @@ Status AsGraphDefMinimal(OpKernelContext* ctx, const DatasetBase* input,
                          std::vector<std::pair<string, Tensor>>* input_list,
                          GraphDef* result, string* dataset_node);
 
+// Checks that every iterator over the dataset represented by `graph_def`
+// produces the same elements in the same order, which symbolic checkpoints
+// rely on when they restore an iterator by skipping a fresh one. Returns
+// `errors::FailedPrecondition` identifying the first source of randomness or
+// non-determinism otherwise: random datasets, shuffles without fixed seeds or
+// that reshuffle each iteration, non-deterministic parallel transformations
+// and functions with stateful (e.g. random) ops.
+Status CheckReplayable(const GraphDef& graph_def);
+
 }  // namespace data
 }  // namespace tensorflow
 
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -212,6 +213,78 @@ TEST(SerializationUtilsTest, VariantTensorDataWriteAfterFlushing) {
             writer.WriteTensor(full_name("Tensor"), input_tensor).code());
 }
 
+NodeDef ConstNode(const string& name, int64 value) {
+  NodeDef node;
+  node.set_name(name);
+  node.set_op("Const");
+  AddNodeAttr("dtype", DT_INT64, &node);
+  AddNodeAttr("value", Tensor(value), &node);
+  return node;
+}
+
+NodeDef ShuffleNode(bool reshuffle) {
+  NodeDef node;
+  node.set_name("shuffle");
+  node.set_op("ShuffleDataset");
+  node.add_input("range");
+  node.add_input("buffer_size");
+  node.add_input("seed");
+  node.add_input("seed2");
+  AddNodeAttr("reshuffle_each_iteration", reshuffle, &node);
+  return node;
+}
+
+GraphDef ShuffleGraph(int64 seed, int64 seed2, bool reshuffle) {
+  GraphDef graph_def;
+  NodeDef* range = graph_def.add_node();
+  range->set_name("range");
+  range->set_op("RangeDataset");
+  *graph_def.add_node() = ConstNode("buffer_size", 10);
+  *graph_def.add_node() = ConstNode("seed", seed);
+  *graph_def.add_node() = ConstNode("seed2", seed2);
+  *graph_def.add_node() = ShuffleNode(reshuffle);
+  return graph_def;
+}
+
+TEST(SerializationUtilsTest, CheckReplayableSeededShuffle) {
+  TF_EXPECT_OK(CheckReplayable(ShuffleGraph(1, 2, /*reshuffle=*/false)));
+}
+
+TEST(SerializationUtilsTest, CheckReplayableReshuffle) {
+  EXPECT_EQ(error::FAILED_PRECONDITION,
+            CheckReplayable(ShuffleGraph(1, 2, /*reshuffle=*/true)).code());
+}
+
+TEST(SerializationUtilsTest, CheckReplayableRandomSeeds) {
+  EXPECT_EQ(error::FAILED_PRECONDITION,
+            CheckReplayable(ShuffleGraph(0, 0, /*reshuffle=*/false)).code());
+}
+
+TEST(SerializationUtilsTest, CheckReplayableNonDeterministic) {
+  GraphDef graph_def;
+  NodeDef* map = graph_def.add_node();
+  map->set_name("map");
+  map->set_op("ParallelMapDatasetV2");
+  AddNodeAttr("deterministic", "true", map);
+  TF_EXPECT_OK(CheckReplayable(graph_def));
+  (*map->mutable_attr())["deterministic"].set_s("false");
+  EXPECT_EQ(error::FAILED_PRECONDITION, CheckReplayable(graph_def).code());
+}
+
+TEST(SerializationUtilsTest, CheckReplayableStatefulFunction) {
+  GraphDef graph_def;
+  FunctionDef* function = graph_def.mutable_library()->add_function();
+  function->mutable_signature()->set_name("f");
+  NodeDef* node = function->add_node_def();
+  node->set_name("x");
+  node->set_op("Identity");
+  TF_EXPECT_OK(CheckReplayable(graph_def));
+  node = function->add_node_def();
+  node->set_name("y");
+  node->set_op("RandomUniform");
+  EXPECT_EQ(error::FAILED_PRECONDITION, CheckReplayable(graph_def).code());
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
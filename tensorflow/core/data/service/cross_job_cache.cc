@@ -0,0 +1,118 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/cross_job_cache.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+CrossJobCache::CrossJobCache(std::unique_ptr<TaskIterator> iterator,
+                             int64 max_cache_size_bytes)
+    : iterator_(std::move(iterator)),
+      max_cache_size_bytes_(max_cache_size_bytes) {}
+
+Status CrossJobCache::GetNext(int64 consumer_id, std::vector<Tensor>& element,
+                              bool& end_of_sequence) {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      auto it = next_index_.find(consumer_id);
+      // Elements before the window have been evicted; skip them.
+      const int64 index =
+          it == next_index_.end() ? first_index_
+                                  : std::max(it->second, first_index_);
+      if (index < first_index_ + static_cast<int64>(cache_.size())) {
+        element = cache_[index - first_index_].components;
+        end_of_sequence = false;
+        next_index_[consumer_id] = index + 1;
+        return Status::OK();
+      }
+      TF_RETURN_IF_ERROR(status_);
+      if (end_of_sequence_) {
+        end_of_sequence = true;
+        return Status::OK();
+      }
+      if (extending_) {
+        cv_.wait(l);
+        continue;
+      }
+      extending_ = true;
+    }
+    ExtendCache();
+  }
+}
+
+void CrossJobCache::ExtendCache() {
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  Status s = iterator_->GetNext(element, end_of_sequence);
+  mutex_lock l(mu_);
+  extending_ = false;
+  cv_.notify_all();
+  if (!s.ok()) {
+    status_ = s;
+    return;
+  }
+  if (end_of_sequence) {
+    end_of_sequence_ = true;
+    return;
+  }
+  const int64 size_bytes = GetTotalBytes(element);
+  cache_.push_back({std::move(element), size_bytes});
+  cache_size_bytes_ += size_bytes;
+  // Always keep the newest element, so that an element larger than the budget
+  // can still be served.
+  while (cache_size_bytes_ > max_cache_size_bytes_ && cache_.size() > 1) {
+    cache_size_bytes_ -= cache_.front().size_bytes;
+    cache_.pop_front();
+    ++first_index_;
+  }
+}
+
+void CrossJobCache::RemoveConsumer(int64 consumer_id) {
+  mutex_lock l(mu_);
+  next_index_.erase(consumer_id);
+}
+
+int64 CrossJobCache::Cardinality() const { return iterator_->Cardinality(); }
+
+CrossJobCacheTaskIterator::CrossJobCacheTaskIterator(
+    std::shared_ptr<CrossJobCache> cache, int64 consumer_id)
+    : cache_(std::move(cache)), consumer_id_(consumer_id) {}
+
+CrossJobCacheTaskIterator::~CrossJobCacheTaskIterator() {
+  cache_->RemoveConsumer(consumer_id_);
+}
+
+Status CrossJobCacheTaskIterator::GetNext(std::vector<Tensor>& element,
+                                          bool& end_of_sequence) {
+  return cache_->GetNext(consumer_id_, element, end_of_sequence);
+}
+
+int64 CrossJobCacheTaskIterator::Cardinality() const {
+  return cache_->Cardinality();
+}
+
+}  // namespace data
+}  // namespace tensorflow
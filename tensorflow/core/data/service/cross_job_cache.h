@@ -0,0 +1,115 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_JOB_CACHE_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_CROSS_JOB_CACHE_H_
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/data/service/task_runner.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Shares the elements of one task iterator between several consumers, so that
+// jobs which read the same dataset in parallel_epochs mode run its pipeline
+// once instead of once per job.
+//
+// The cache keeps a sliding window of the most recently produced elements,
+// bounded by `max_cache_size_bytes`. Each consumer reads the window in order,
+// and the element after the window is produced by the first consumer that asks
+// for it. A consumer that falls behind the window skips the evicted elements,
+// so consumers see the same sequence of elements but may not see all of them.
+// Elements are shared by reference: consumers get tensors that alias the
+// cached ones and must not modify them.
+//
+// Consumers only get an unbiased view of the data if the input is infinite,
+// e.g. a shuffled and repeated dataset.
+class CrossJobCache {
+ public:
+  CrossJobCache(std::unique_ptr<TaskIterator> iterator,
+                int64 max_cache_size_bytes);
+
+  // Stores the next element for `consumer_id` in `element`. A consumer that
+  // has not read before starts at the oldest cached element.
+  Status GetNext(int64 consumer_id, std::vector<Tensor>& element,
+                 bool& end_of_sequence) TF_LOCKS_EXCLUDED(mu_);
+
+  // Forgets the read position of `consumer_id`.
+  void RemoveConsumer(int64 consumer_id) TF_LOCKS_EXCLUDED(mu_);
+
+  // Reports the cardinality of the input iterator.
+  int64 Cardinality() const;
+
+ private:
+  struct CachedElement {
+    std::vector<Tensor> components;
+    int64 size_bytes;
+  };
+
+  // Produces the element after the cache window and appends it to the cache,
+  // evicting the oldest elements while the cache is over budget. Must be
+  // called by the consumer that set `extending_`.
+  void ExtendCache() TF_LOCKS_EXCLUDED(mu_);
+
+  const std::unique_ptr<TaskIterator> iterator_;
+  const int64 max_cache_size_bytes_;
+
+  mutex mu_;
+  condition_variable cv_;
+  // The window of cached elements. `cache_[i]` is element
+  // `first_index_ + i` of the input.
+  std::deque<CachedElement> cache_ TF_GUARDED_BY(mu_);
+  int64 first_index_ TF_GUARDED_BY(mu_) = 0;
+  int64 cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Index of the next element to read, per consumer.
+  absl::flat_hash_map<int64, int64> next_index_ TF_GUARDED_BY(mu_);
+  // Whether a consumer is producing the element after the window.
+  bool extending_ TF_GUARDED_BY(mu_) = false;
+  // Set once the input is exhausted or has failed.
+  bool end_of_sequence_ TF_GUARDED_BY(mu_) = false;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CrossJobCache);
+};
+
+// A task iterator that reads a task's elements from a `CrossJobCache` shared
+// with the tasks of other jobs.
+class CrossJobCacheTaskIterator : public TaskIterator {
+ public:
+  // `consumer_id` identifies the task among the readers of `cache`.
+  CrossJobCacheTaskIterator(std::shared_ptr<CrossJobCache> cache,
+                            int64 consumer_id);
+  ~CrossJobCacheTaskIterator() override;
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override;
+  int64 Cardinality() const override;
+
+ private:
+  const std::shared_ptr<CrossJobCache> cache_;
+  const int64 consumer_id_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_CROSS_JOB_CACHE_H_
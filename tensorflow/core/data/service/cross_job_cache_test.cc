@@ -0,0 +1,204 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/cross_job_cache.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/task_runner.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Produces 0, 1, 2, ... up to `num_elements` elements, and counts the
+// elements it produced.
+class RangeTaskIterator : public TaskIterator {
+ public:
+  explicit RangeTaskIterator(int64 num_elements, int64* num_produced)
+      : num_elements_(num_elements), num_produced_(num_produced) {}
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    end_of_sequence = next_ >= num_elements_;
+    if (!end_of_sequence) {
+      element = {Tensor(next_++)};
+      ++*num_produced_;
+    }
+    return Status::OK();
+  }
+
+  int64 Cardinality() const override { return kInfiniteCardinality; }
+
+ private:
+  const int64 num_elements_;
+  int64* const num_produced_;
+  int64 next_ = 0;
+};
+
+class ErrorTaskIterator : public TaskIterator {
+ public:
+  explicit ErrorTaskIterator(Status status) : status_(std::move(status)) {}
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    return status_;
+  }
+
+  int64 Cardinality() const override { return kInfiniteCardinality; }
+
+ private:
+  const Status status_;
+};
+
+// Reads `num_elements` elements for `consumer_id`.
+StatusOr<std::vector<int64>> Read(CrossJobCache& cache, int64 consumer_id,
+                                  int64 num_elements) {
+  std::vector<int64> result;
+  for (int64 i = 0; i < num_elements; ++i) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    TF_RETURN_IF_ERROR(cache.GetNext(consumer_id, element, end_of_sequence));
+    if (end_of_sequence) {
+      break;
+    }
+    result.push_back(element[0].scalar<int64>()());
+  }
+  return result;
+}
+
+std::vector<int64> Range(int64 begin, int64 end) {
+  std::vector<int64> result;
+  for (int64 i = begin; i < end; ++i) {
+    result.push_back(i);
+  }
+  return result;
+}
+
+TEST(CrossJobCacheTest, ConsumersShareElements) {
+  int64 num_produced = 0;
+  CrossJobCache cache(absl::make_unique<RangeTaskIterator>(kint64max,
+                                                           &num_produced),
+                      /*max_cache_size_bytes=*/1 << 20);
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64> first, Read(cache, 1, 10));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64> second, Read(cache, 2, 10));
+  EXPECT_EQ(first, Range(0, 10));
+  EXPECT_EQ(second, Range(0, 10));
+  EXPECT_EQ(num_produced, 10);
+}
+
+TEST(CrossJobCacheTest, SlowConsumerSkipsEvictedElements) {
+  int64 num_produced = 0;
+  // Room for three int64 scalars.
+  CrossJobCache cache(absl::make_unique<RangeTaskIterator>(kint64max,
+                                                           &num_produced),
+                      /*max_cache_size_bytes=*/3 * sizeof(int64));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64> first, Read(cache, 1, 2));
+  EXPECT_EQ(first, Range(0, 2));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64> second, Read(cache, 2, 10));
+  EXPECT_EQ(second, Range(0, 10));
+  // Elements 0 to 6 have been evicted.
+  TF_ASSERT_OK_AND_ASSIGN(first, Read(cache, 1, 5));
+  EXPECT_EQ(first, Range(7, 12));
+  EXPECT_EQ(num_produced, 12);
+}
+
+TEST(CrossJobCacheTest, ElementLargerThanCache) {
+  int64 num_produced = 0;
+  CrossJobCache cache(absl::make_unique<RangeTaskIterator>(kint64max,
+                                                           &num_produced),
+                      /*max_cache_size_bytes=*/1);
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64> first, Read(cache, 1, 3));
+  EXPECT_EQ(first, Range(0, 3));
+  // The newest element stays cached.
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64> second, Read(cache, 2, 3));
+  EXPECT_EQ(second, Range(2, 5));
+}
+
+TEST(CrossJobCacheTest, EndOfSequence) {
+  int64 num_produced = 0;
+  CrossJobCache cache(absl::make_unique<RangeTaskIterator>(3, &num_produced),
+                      /*max_cache_size_bytes=*/1 << 20);
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64> first, Read(cache, 1, 10));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64> second, Read(cache, 2, 10));
+  EXPECT_EQ(first, Range(0, 3));
+  EXPECT_EQ(second, Range(0, 3));
+}
+
+TEST(CrossJobCacheTest, Error) {
+  CrossJobCache cache(
+      absl::make_unique<ErrorTaskIterator>(errors::Aborted("Aborted")),
+      /*max_cache_size_bytes=*/1 << 20);
+  EXPECT_TRUE(errors::IsAborted(Read(cache, 1, 1).status()));
+  EXPECT_TRUE(errors::IsAborted(Read(cache, 2, 1).status()));
+}
+
+TEST(CrossJobCacheTest, ConcurrentConsumers) {
+  const int64 kNumConsumers = 10;
+  const int64 kNumElements = 1000;
+  int64 num_produced = 0;
+  CrossJobCache cache(absl::make_unique<RangeTaskIterator>(kint64max,
+                                                           &num_produced),
+                      /*max_cache_size_bytes=*/1 << 20);
+  mutex mu;
+  std::vector<std::vector<int64>> results(kNumConsumers);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64 i = 0; i < kNumConsumers; ++i) {
+    threads.push_back(absl::WrapUnique(Env::Default()->StartThread(
+        /*thread_options=*/{}, /*name=*/absl::StrCat("Consumer_", i),
+        [&, i]() {
+          StatusOr<std::vector<int64>> result = Read(cache, i, kNumElements);
+          TF_CHECK_OK(result.status());
+          mutex_lock l(mu);
+          results[i] = std::move(result).ValueOrDie();
+        })));
+  }
+  threads.clear();
+  for (const std::vector<int64>& result : results) {
+    EXPECT_EQ(result, Range(0, kNumElements));
+  }
+  EXPECT_EQ(num_produced, kNumElements);
+}
+
+TEST(CrossJobCacheTaskIteratorTest, RemovesConsumer) {
+  int64 num_produced = 0;
+  auto cache = std::make_shared<CrossJobCache>(
+      absl::make_unique<RangeTaskIterator>(kint64max, &num_produced),
+      /*max_cache_size_bytes=*/1 << 20);
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  {
+    CrossJobCacheTaskIterator iterator(cache, /*consumer_id=*/1);
+    EXPECT_EQ(iterator.Cardinality(), kInfiniteCardinality);
+    TF_ASSERT_OK(iterator.GetNext(element, end_of_sequence));
+    TF_ASSERT_OK(iterator.GetNext(element, end_of_sequence));
+    EXPECT_EQ(element[0].scalar<int64>()(), 1);
+  }
+  // A new task with the same id starts over at the oldest cached element.
+  CrossJobCacheTaskIterator iterator(cache, /*consumer_id=*/1);
+  TF_ASSERT_OK(iterator.GetNext(element, end_of_sequence));
+  EXPECT_FALSE(end_of_sequence);
+  EXPECT_EQ(element[0].scalar<int64>()(), 0);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
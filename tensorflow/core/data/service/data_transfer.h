@@ -47,6 +47,9 @@ struct GetElementResult {
   // reading from the worker. This is used for load balancing when doing round
   // robin reads.
   bool skip;
+  // The number of elements the task had ready to serve after producing this
+  // one. Clients use it to prefer tasks that can answer without waiting.
+  int64 num_ready_elements = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(GetElementResult);
 };
@@ -165,8 +165,9 @@ Status DataServiceDispatcherImpl::Start() {
     started_ = true;
     return Status::OK();
   }
-  journal_writer_ = absl::make_unique<FileJournalWriter>(
-      env_, JournalDir(config_.work_dir()));
+  journal_writer_ = absl::make_unique<GroupCommitJournalWriter>(
+      absl::make_unique<FileJournalWriter>(env_,
+                                           JournalDir(config_.work_dir())));
   LOG(INFO) << "Attempting to restore dispatcher state from journal in "
             << JournalDir(config_.work_dir());
   Update update;
@@ -922,11 +923,33 @@ Status DataServiceDispatcherImpl::ApplyWithoutJournaling(const Update& update)
 Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (journal_writer_.has_value()) {
-    TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+    journal_writer_.value()->Add(update);
   }
   return state_.Apply(update);
 }
 
+Status DataServiceDispatcherImpl::SyncJournal() TF_LOCKS_EXCLUDED(mu_) {
+  GroupCommitJournalWriter* journal_writer;
+  {
+    mutex_lock l(mu_);
+    if (!journal_writer_.has_value()) {
+      return Status::OK();
+    }
+    journal_writer = journal_writer_.value().get();
+  }
+  Status s = journal_writer->Sync();
+  if (!s.ok()) {
+    // `Apply` has already updated the in-memory state with the updates that
+    // failed to reach the journal, and other requests may have read it. None
+    // of them have been acknowledged yet, since they all wait for this sync.
+    // Crash instead of acknowledging anything, so that the restarted
+    // dispatcher recovers a state consistent with the journal.
+    LOG(FATAL) << "Failed to sync the tf.data service dispatcher journal in "
+               << JournalDir(config_.work_dir()) << ": " << s;
+  }
+  return s;
+}
+
 void DataServiceDispatcherImpl::JobGcThread() {
   int64 next_check_micros = 0;
   while (true) {
@@ -161,6 +161,14 @@ class DataServiceDispatcherImpl {
   Status GetWorkers(const GetWorkersRequest* request,
                     GetWorkersResponse* response);
 
+  // Blocks until the journal updates applied so far are durable. The methods
+  // above journal their updates without waiting for them, so that concurrent
+  // requests can share one journal sync. Callers must call `SyncJournal`
+  // after a successful request and before acknowledging it. If the sync
+  // fails, the in-memory state is ahead of the journal, so the process is
+  // terminated before any request depending on it is acknowledged.
+  Status SyncJournal() TF_LOCKS_EXCLUDED(mu_);
+
  private:
   // Restores split providers from the state in `job` and stores them in
   // `restored`.
@@ -260,6 +268,8 @@ class DataServiceDispatcherImpl {
                              int64 split_provider_index, bool finished)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, updating both the journal and the in-memory state.
+  // The journal update only becomes durable on the next `SyncJournal`, which
+  // crashes the dispatcher if it can't make it durable.
   Status Apply(const Update& update) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, but doesn't update the journal. Only meant to be
   // used when recovering state when the dispatcher starts.
@@ -302,7 +312,7 @@ class DataServiceDispatcherImpl {
   absl::flat_hash_map<int64, std::shared_ptr<TaskRemover>> remove_task_requests_
       TF_GUARDED_BY(mu_);
 
-  absl::optional<std::unique_ptr<JournalWriter>> journal_writer_
+  absl::optional<std::unique_ptr<GroupCommitJournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the job gc thread.
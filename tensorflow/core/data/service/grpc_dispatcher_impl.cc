@@ -38,7 +38,11 @@ Status GrpcDispatcherImpl::Start() { return impl_.Start(); }
   grpc::Status GrpcDispatcherImpl::method(ServerContext* context,         \
                                           const method##Request* request, \
                                           method##Response* response) {   \
-    return ToGrpcStatus(impl_.method(request, response));                 \
+    Status s = impl_.method(request, response);                           \
+    if (s.ok()) {                                                         \
+      s = impl_.SyncJournal();                                            \
+    }                                                                     \
+    return ToGrpcStatus(s);                                               \
   }
 HANDLER(WorkerHeartbeat);
 HANDLER(WorkerUpdate);
@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/journal.h"
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "absl/memory/memory.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
@@ -71,21 +76,76 @@ Status FileJournalWriter::EnsureInitialized() {
 }
 
 Status FileJournalWriter::Write(const Update& update) {
+  return WriteBatch(absl::MakeConstSpan(&update, 1));
+}
+
+Status FileJournalWriter::WriteBatch(absl::Span<const Update> updates) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
-  std::string s = update.SerializeAsString();
-  if (s.empty()) {
-    return errors::Internal("Failed to serialize update ", update.DebugString(),
-                            " to string");
+  for (const Update& update : updates) {
+    std::string s = update.SerializeAsString();
+    if (s.empty()) {
+      return errors::Internal("Failed to serialize update ",
+                              update.DebugString(), " to string");
+    }
+    TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
   }
-  TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
   TF_RETURN_IF_ERROR(writer_->Flush());
   TF_RETURN_IF_ERROR(file_->Sync());
   if (VLOG_IS_ON(4)) {
-    VLOG(4) << "Wrote journal entry: " << update.DebugString();
+    for (const Update& update : updates) {
+      VLOG(4) << "Wrote journal entry: " << update.DebugString();
+    }
   }
   return Status::OK();
 }
 
+GroupCommitJournalWriter::GroupCommitJournalWriter(
+    std::unique_ptr<JournalWriter> writer)
+    : writer_(std::move(writer)) {}
+
+Status GroupCommitJournalWriter::EnsureInitialized() TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  while (writing_) {
+    cv_.wait(l);
+  }
+  return writer_->EnsureInitialized();
+}
+
+void GroupCommitJournalWriter::Add(const Update& update)
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  pending_updates_.push_back(update);
+  num_added_++;
+}
+
+Status GroupCommitJournalWriter::Sync() TF_LOCKS_EXCLUDED(mu_) {
+  std::vector<Update> batch;
+  int64 batch_end;
+  {
+    mutex_lock l(mu_);
+    const int64 target = num_added_;
+    while (writing_ && status_.ok() && num_synced_ < target) {
+      cv_.wait(l);
+    }
+    if (!status_.ok() || num_synced_ >= target) {
+      return status_;
+    }
+    writing_ = true;
+    batch.swap(pending_updates_);
+    batch_end = num_added_;
+  }
+  Status s = writer_->WriteBatch(batch);
+  mutex_lock l(mu_);
+  writing_ = false;
+  if (s.ok()) {
+    num_synced_ = batch_end;
+  } else {
+    status_ = s;
+  }
+  cv_.notify_all();
+  return status_;
+}
+
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -15,11 +15,17 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 
+#include <memory>
+#include <vector>
+
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 namespace data {
@@ -34,6 +40,8 @@ class JournalWriter {
   virtual ~JournalWriter() = default;
   // Writes and syncs an update to the journal.
   virtual Status Write(const Update& update) = 0;
+  // Writes a batch of updates to the journal, syncing once for the batch.
+  virtual Status WriteBatch(absl::Span<const Update> updates) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
 };
@@ -64,6 +72,7 @@ class FileJournalWriter : public JournalWriter {
   FileJournalWriter& operator=(const FileJournalWriter&) = delete;
 
   Status Write(const Update& update) override;
+  Status WriteBatch(absl::Span<const Update> updates) override;
   Status EnsureInitialized() override;
 
  private:
@@ -73,6 +82,47 @@ class FileJournalWriter : public JournalWriter {
   std::unique_ptr<io::RecordWriter> writer_;
 };
 
+// GroupCommitJournalWriter is thread-safe.
+//
+// GroupCommitJournalWriter lets concurrent callers share journal syncs. `Add`
+// only queues an update, so it is cheap enough to call while holding the lock
+// that protects the journaled state. `Sync` makes every update added so far
+// durable: the first caller to find no write in progress writes all queued
+// updates with a single `WriteBatch`, and callers that arrive meanwhile wait
+// and are covered by the next batch.
+//
+// If a write fails, the updates queued before it may be lost, so the error is
+// returned by all later `Sync` calls.
+class GroupCommitJournalWriter {
+ public:
+  explicit GroupCommitJournalWriter(std::unique_ptr<JournalWriter> writer);
+  GroupCommitJournalWriter(const GroupCommitJournalWriter&) = delete;
+  GroupCommitJournalWriter& operator=(const GroupCommitJournalWriter&) = delete;
+
+  // Initializes the underlying writer if it is not yet initialized.
+  Status EnsureInitialized() TF_LOCKS_EXCLUDED(mu_);
+  // Queues `update` to be written to the journal.
+  void Add(const Update& update) TF_LOCKS_EXCLUDED(mu_);
+  // Blocks until all updates added before the call are durable.
+  Status Sync() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Only accessed by the caller that set `writing_`, or during
+  // `EnsureInitialized`.
+  const std::unique_ptr<JournalWriter> writer_;
+
+  mutex mu_;
+  condition_variable cv_;
+  std::vector<Update> pending_updates_ TF_GUARDED_BY(mu_);
+  // Number of updates added so far.
+  int64 num_added_ TF_GUARDED_BY(mu_) = 0;
+  // Number of updates known to be durable.
+  int64 num_synced_ TF_GUARDED_BY(mu_) = 0;
+  // Whether a caller is writing a batch.
+  bool writing_ TF_GUARDED_BY(mu_) = false;
+  Status status_ TF_GUARDED_BY(mu_);
+};
+
 // Interface for reading from a journal.
 class JournalReader {
  public:
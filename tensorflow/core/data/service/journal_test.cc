@@ -14,10 +14,16 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/journal.h"
 
+#include <memory>
+#include <vector>
+
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
@@ -79,6 +85,24 @@ Status CheckJournalContent(StringPiece journal_dir,
   EXPECT_TRUE(end_of_journal);
   return Status::OK();
 }
+
+// Fails every write and counts the attempts.
+class FailingJournalWriter : public JournalWriter {
+ public:
+  explicit FailingJournalWriter(int64* num_writes) : num_writes_(num_writes) {}
+
+  Status Write(const Update& update) override {
+    return WriteBatch(absl::MakeConstSpan(&update, 1));
+  }
+  Status WriteBatch(absl::Span<const Update> updates) override {
+    ++*num_writes_;
+    return errors::Unavailable("Failed to write");
+  }
+  Status EnsureInitialized() override { return Status::OK(); }
+
+ private:
+  int64* const num_writes_;
+};
 }  // namespace
 
 TEST(Journal, RoundTripMultiple) {
@@ -109,6 +133,67 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, WriteBatch) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateJobUpdate(),
+                                 MakeRegisterDatasetUpdate(),
+                                 MakeFinishTaskUpdate()};
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.WriteBatch(updates));
+  TF_EXPECT_OK(writer.Write(MakeCreateJobUpdate()));
+  updates.push_back(MakeCreateJobUpdate());
+
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
+TEST(Journal, GroupCommit) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  const int kNumThreads = 10;
+  const int kUpdatesPerThread = 20;
+  GroupCommitJournalWriter writer(
+      absl::make_unique<FileJournalWriter>(Env::Default(), journal_dir));
+  TF_ASSERT_OK(writer.EnsureInitialized());
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.push_back(absl::WrapUnique(Env::Default()->StartThread(
+          /*thread_options=*/{}, /*name=*/absl::StrCat("writer_thread_", i),
+          [&writer]() {
+            for (int j = 0; j < kUpdatesPerThread; ++j) {
+              writer.Add(MakeFinishTaskUpdate());
+              TF_EXPECT_OK(writer.Sync());
+            }
+          })));
+    }
+  }
+  TF_EXPECT_OK(writer.Sync());
+
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, std::vector<Update>(kNumThreads * kUpdatesPerThread,
+                                       MakeFinishTaskUpdate())));
+}
+
+TEST(Journal, GroupCommitNothingToSync) {
+  int64 num_writes = 0;
+  GroupCommitJournalWriter writer(
+      absl::make_unique<FailingJournalWriter>(&num_writes));
+  TF_EXPECT_OK(writer.Sync());
+  EXPECT_EQ(num_writes, 0);
+}
+
+TEST(Journal, GroupCommitErrorIsSticky) {
+  int64 num_writes = 0;
+  GroupCommitJournalWriter writer(
+      absl::make_unique<FailingJournalWriter>(&num_writes));
+  writer.Add(MakeFinishTaskUpdate());
+  EXPECT_TRUE(errors::IsUnavailable(writer.Sync()));
+  writer.Add(MakeFinishTaskUpdate());
+  EXPECT_TRUE(errors::IsUnavailable(writer.Sync()));
+  EXPECT_EQ(num_writes, 1);
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
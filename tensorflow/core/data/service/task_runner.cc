@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/task_runner.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -71,15 +72,16 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
                                                   task_def.num_consumers(),
                                                   task_def.worker_address());
   } else {
-    out =
-        absl::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
+    out = absl::make_unique<FirstComeFirstServedTaskRunner>(
+        std::move(iterator),
+        std::max<int64>(worker_config.task_prefetch_buffer_size(), 1));
   }
   return Status::OK();
 }
 
 FirstComeFirstServedTaskRunner::FirstComeFirstServedTaskRunner(
-    std::unique_ptr<TaskIterator> iterator)
-    : iterator_(std::move(iterator)), buffer_(/*buffer_size=*/1) {
+    std::unique_ptr<TaskIterator> iterator, int64 buffer_size)
+    : iterator_(std::move(iterator)), buffer_(buffer_size) {
   RunPrefetchThread();
 }
 
@@ -88,12 +90,19 @@ FirstComeFirstServedTaskRunner::~FirstComeFirstServedTaskRunner() { Cancel(); }
 Status FirstComeFirstServedTaskRunner::GetNext(const GetElementRequest& req,
                                                GetElementResult& result) {
   TF_ASSIGN_OR_RETURN(result, buffer_.Pop());
+  mutex_lock l(ready_mu_);
+  result.num_ready_elements = --num_ready_elements_;
   return Status::OK();
 }
 
 Status FirstComeFirstServedTaskRunner::PrefetchFn() {
   while (true) {
-    TF_RETURN_IF_ERROR(buffer_.Push(GetNextFromInputIterator()));
+    StatusOr<GetElementResult> result = GetNextFromInputIterator();
+    {
+      mutex_lock l(ready_mu_);
+      ++num_ready_elements_;
+    }
+    TF_RETURN_IF_ERROR(buffer_.Push(std::move(result)));
   }
   return Status::OK();
 }
@@ -82,8 +82,9 @@ class TaskRunner {
 // It does not consider which consumer is making the request.
 class FirstComeFirstServedTaskRunner : public TaskRunner {
  public:
+  // Prepares up to `buffer_size` elements ahead of requests.
   explicit FirstComeFirstServedTaskRunner(
-      std::unique_ptr<TaskIterator> iterator);
+      std::unique_ptr<TaskIterator> iterator, int64 buffer_size = 1);
   ~FirstComeFirstServedTaskRunner() override;
 
   Status GetNext(const GetElementRequest& req,
@@ -105,6 +106,13 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
   std::unique_ptr<TaskIterator> iterator_ TF_GUARDED_BY(mu_);
   int64 element_index_ TF_GUARDED_BY(mu_) = 0;
 
+  // Guards `num_ready_elements_` separately from `mu_`, which is held while
+  // the input iterator produces an element.
+  mutex ready_mu_;
+  // The number of produced elements not yet handed out. This includes the
+  // element the prefetch thread holds while it waits for space in `buffer_`.
+  int64 num_ready_elements_ TF_GUARDED_BY(ready_mu_) = 0;
+
   ThreadSafeBuffer<GetElementResult> buffer_;
   std::unique_ptr<Thread> prefetch_thread_;
 
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
@@ -179,6 +180,36 @@ TEST(FirstComeFirstServedTaskRunnerTest, Error) {
               testing::StatusIs(error::ABORTED));
 }
 
+TEST(FirstComeFirstServedTaskRunnerTest, ReportsReadyElements) {
+  const int64 kBufferSize = 5;
+  std::vector<std::vector<Tensor>> elements = GetRangeDataset(10);
+  FirstComeFirstServedTaskRunner runner(
+      absl::make_unique<TestTaskIterator>(elements, /*repeat=*/false),
+      kBufferSize);
+  // Waits for the prefetch thread to fill the buffer.
+  Env::Default()->SleepForMicroseconds(100000);
+  GetElementResult result;
+  TF_ASSERT_OK(runner.GetNext(GetElementRequest(), result));
+  test::ExpectEqual(result.components[0], elements[0][0]);
+  EXPECT_GE(result.num_ready_elements, kBufferSize - 1);
+}
+
+TEST(FirstComeFirstServedTaskRunnerTest,
+     ReportsReadyElementsWithDefaultBufferSize) {
+  std::vector<std::vector<Tensor>> elements = GetRangeDataset(10);
+  FirstComeFirstServedTaskRunner runner(
+      absl::make_unique<TestTaskIterator>(elements, /*repeat=*/false));
+  // Waits for the prefetch thread to fill the buffer and produce the element
+  // after it.
+  Env::Default()->SleepForMicroseconds(100000);
+  GetElementResult result;
+  TF_ASSERT_OK(runner.GetNext(GetElementRequest(), result));
+  test::ExpectEqual(result.components[0], elements[0][0]);
+  // The element held by the prefetch thread counts as ready, so clients can
+  // prefer this task even with a one-element buffer.
+  EXPECT_EQ(result.num_ready_elements, 1);
+}
+
 class ConsumeParallelTest
     : public ::testing::Test,
       public ::testing::WithParamInterface<std::tuple<int64, int64>> {};
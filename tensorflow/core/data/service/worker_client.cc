@@ -108,6 +108,7 @@ class GrpcDataTransferClient : public DataTransferClient {
     grpc::Status s = stub_->GetElement(&ctx, req, &resp);
     result.end_of_sequence = resp.end_of_sequence();
     result.skip = resp.skip_task();
+    result.num_ready_elements = resp.num_ready_elements();
     switch (resp.element_case()) {
       case GetElementResponse::kCompressed: {
         Tensor tensor(DT_VARIANT, TensorShape{});
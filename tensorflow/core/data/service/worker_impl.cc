@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
+#include "tensorflow/core/data/service/cross_job_cache.h"
 #include "tensorflow/core/data/service/data_service.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
@@ -38,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/utils.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
@@ -233,13 +235,43 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
   if (task.initialized) {
     return Status::OK();
   }
-  TF_ASSIGN_OR_RETURN(DatasetDef dataset_def, GetDatasetDef(task.task_def));
-  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Dataset> dataset,
-                      MakeDataset(dataset_def));
-  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Iterator> iterator,
-                      MakeDatasetIterator(*dataset, task.task_def));
-  auto task_iterator = absl::make_unique<StandaloneTaskIterator>(
-      std::move(dataset), std::move(iterator));
+  const bool share_across_jobs = CanShareAcrossJobs(task.task_def);
+  const int64 dataset_id = task.task_def.dataset_id();
+  std::unique_ptr<TaskIterator> task_iterator;
+  if (share_across_jobs) {
+    auto it = cross_job_caches_.find(dataset_id);
+    if (it != cross_job_caches_.end()) {
+      if (std::shared_ptr<CrossJobCache> cache = it->second.lock()) {
+        VLOG(1) << "Task " << task.task_def.task_id() << " of job "
+                << task.task_def.job_id()
+                << " shares the elements of dataset " << dataset_id
+                << " with other jobs";
+        task_iterator = absl::make_unique<CrossJobCacheTaskIterator>(
+            std::move(cache), task.task_def.task_id());
+      } else {
+        cross_job_caches_.erase(it);
+      }
+    }
+  }
+  if (!task_iterator) {
+    TF_ASSIGN_OR_RETURN(DatasetDef dataset_def, GetDatasetDef(task.task_def));
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Dataset> dataset,
+                        MakeDataset(dataset_def));
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Iterator> iterator,
+                        MakeDatasetIterator(*dataset, task.task_def));
+    task_iterator = absl::make_unique<StandaloneTaskIterator>(
+        std::move(dataset), std::move(iterator));
+    // Only infinite datasets are shared: with a finite dataset, a job that
+    // starts late would miss the start of the epoch.
+    if (share_across_jobs &&
+        task_iterator->Cardinality() == kInfiniteCardinality) {
+      auto cache = std::make_shared<CrossJobCache>(
+          std::move(task_iterator), config_.cross_job_cache_size_bytes());
+      cross_job_caches_[dataset_id] = cache;
+      task_iterator = absl::make_unique<CrossJobCacheTaskIterator>(
+          std::move(cache), task.task_def.task_id());
+    }
+  }
   TF_RETURN_IF_ERROR(TaskRunner::Create(
       config_, task.task_def, std::move(task_iterator), task.task_runner));
 
@@ -248,6 +280,12 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
   return Status::OK();
 }
 
+bool DataServiceWorkerImpl::CanShareAcrossJobs(const TaskDef& task_def) const {
+  return config_.cross_job_cache_size_bytes() > 0 &&
+         task_def.processing_mode() == PARALLEL_EPOCHS &&
+         task_def.optional_num_consumers_case() != TaskDef::kNumConsumers;
+}
+
 StatusOr<DatasetDef> DataServiceWorkerImpl::GetDatasetDef(
     const TaskDef& task_def) const {
   switch (task_def.dataset_case()) {
@@ -326,6 +364,7 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   TF_RETURN_IF_ERROR(GetElementResult(request, &result));
   response->set_end_of_sequence(result.end_of_sequence);
   response->set_skip_task(result.skip);
+  response->set_num_ready_elements(result.num_ready_elements);
   if (!response->end_of_sequence() && !response->skip_task()) {
     TF_RETURN_IF_ERROR(
         MoveElementToResponse(std::move(result.components), *response));
@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/cross_job_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
@@ -92,7 +93,10 @@ class DataServiceWorkerImpl {
   // Creates an iterator to process a task.
   Status ProcessTaskInternal(const TaskDef& task)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
-  Status EnsureTaskInitialized(Task& task);
+  Status EnsureTaskInitialized(Task& task) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns whether `task_def` may share its elements with the tasks of other
+  // jobs that read the same dataset.
+  bool CanShareAcrossJobs(const TaskDef& task_def) const;
   // Stops a task, cancelling the task's outstanding requests and waiting for
   // them to finish.
   void StopTask(Task& task) TF_LOCKS_EXCLUDED(mu_);
@@ -122,6 +126,11 @@ class DataServiceWorkerImpl {
   // Information about tasks, keyed by task ids. The tasks are updated based on
   // the heartbeat responses from the dispatcher.
   absl::flat_hash_map<int64, std::shared_ptr<Task>> tasks_ TF_GUARDED_BY(mu_);
+  // Element caches shared by the tasks of different jobs, keyed by dataset
+  // id. The dispatcher gives datasets with the same fingerprint the same id.
+  // A cache lives as long as one of its tasks.
+  absl::flat_hash_map<int64, std::weak_ptr<CrossJobCache>> cross_job_caches_
+      TF_GUARDED_BY(mu_);
   // Ids of tasks that have finished.
   absl::flat_hash_set<int64> finished_tasks_ TF_GUARDED_BY(mu_);
   // Completed tasks which haven't yet been communicated to the dispatcher.
@@ -28,6 +28,9 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
+#include "tensorflow/core/lib/io/lz4_compression_options.h"
+#include "tensorflow/core/lib/io/lz4_inputstream.h"
+#include "tensorflow/core/lib/io/lz4_outputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/lib/io/snappy/snappy_inputbuffer.h"
@@ -35,6 +38,9 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/core/lib/io/zstd_compression_options.h"
+#include "tensorflow/core/lib/io/zstd_inputstream.h"
+#include "tensorflow/core/lib/io/zstd_outputbuffer.h"
 #include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -189,15 +195,31 @@ Status CustomWriter::Initialize(tensorflow::Env* env) {
   }
 #else   // IS_SLIM_BUILD
   if (compression_type_ == io::compression::kGzip) {
-    zlib_underlying_dest_.swap(dest_);
+    underlying_dest_.swap(dest_);
     io::ZlibCompressionOptions zlib_options;
     zlib_options = io::ZlibCompressionOptions::GZIP();
 
     io::ZlibOutputBuffer* zlib_output_buffer = new io::ZlibOutputBuffer(
-        zlib_underlying_dest_.get(), zlib_options.input_buffer_size,
+        underlying_dest_.get(), zlib_options.input_buffer_size,
         zlib_options.output_buffer_size, zlib_options);
     TF_CHECK_OK(zlib_output_buffer->Init());
     dest_.reset(zlib_output_buffer);
+  } else if (compression_type_ == io::compression::kZstd) {
+    underlying_dest_.swap(dest_);
+    io::ZstdCompressionOptions zstd_options;
+    auto zstd_output_buffer = absl::make_unique<io::ZstdOutputBuffer>(
+        underlying_dest_.get(), zstd_options.output_buffer_size,
+        zstd_options);
+    TF_RETURN_IF_ERROR(zstd_output_buffer->Init());
+    dest_ = std::move(zstd_output_buffer);
+  } else if (compression_type_ == io::compression::kLz4) {
+    underlying_dest_.swap(dest_);
+    io::Lz4CompressionOptions lz4_options;
+    auto lz4_output_buffer = absl::make_unique<io::Lz4OutputBuffer>(
+        underlying_dest_.get(), lz4_options.input_buffer_size,
+        lz4_options.output_buffer_size, lz4_options);
+    TF_RETURN_IF_ERROR(lz4_output_buffer->Init());
+    dest_ = std::move(lz4_output_buffer);
   }
 #endif  // IS_SLIM_BUILD
   simple_tensor_mask_.reserve(dtypes_.size());
@@ -304,9 +326,9 @@ Status CustomWriter::Close() {
     TF_RETURN_IF_ERROR(dest_->Close());
     dest_ = nullptr;
   }
-  if (zlib_underlying_dest_ != nullptr) {
-    TF_RETURN_IF_ERROR(zlib_underlying_dest_->Close());
-    zlib_underlying_dest_ = nullptr;
+  if (underlying_dest_ != nullptr) {
+    TF_RETURN_IF_ERROR(underlying_dest_->Close());
+    underlying_dest_ = nullptr;
   }
   return Status::OK();
 }
@@ -767,6 +789,16 @@ Status CustomReader::Initialize(Env* env) {
     input_stream_ = absl::make_unique<io::ZlibInputStream>(
         input_stream_.release(), zlib_options.input_buffer_size,
         zlib_options.output_buffer_size, zlib_options, true);
+  } else if (compression_type_ == io::compression::kZstd) {
+    io::ZstdCompressionOptions zstd_options;
+    input_stream_ = absl::make_unique<io::ZstdInputStream>(
+        input_stream_.release(), zstd_options.input_buffer_size,
+        zstd_options.output_buffer_size, zstd_options, true);
+  } else if (compression_type_ == io::compression::kLz4) {
+    io::Lz4CompressionOptions lz4_options;
+    input_stream_ = absl::make_unique<io::Lz4InputStream>(
+        input_stream_.release(), lz4_options.input_buffer_size,
+        lz4_options.output_buffer_size, true);
   } else if (compression_type_ == io::compression::kSnappy) {
     if (version_ == 0) {
       input_stream_ = absl::make_unique<io::SnappyInputBuffer>(
@@ -1029,22 +1061,85 @@ Status DetermineOpState(const std::string& mode_string, bool file_exists,
   }
 }
 
+namespace {
+
+int64 ElementSizeBytes(const std::vector<Tensor>& tensors) {
+  int64 bytes = 0;
+  for (const auto& tensor : tensors) {
+    bytes += tensor.TotalBytes();
+  }
+  return bytes;
+}
+
+}  // namespace
+
+bool WriterBufferBudget::Acquire(int64 bytes) {
+  mutex_lock l(mu_);
+  while (!cancelled_ && buffered_bytes_ > 0 &&
+         buffered_bytes_ + bytes > limit_bytes_) {
+    cond_var_.wait(l);
+  }
+  if (cancelled_) {
+    return false;
+  }
+  buffered_bytes_ += bytes;
+  return true;
+}
+
+void WriterBufferBudget::Release(int64 bytes) {
+  mutex_lock l(mu_);
+  buffered_bytes_ -= bytes;
+  cond_var_.notify_all();
+}
+
+void WriterBufferBudget::Cancel() {
+  mutex_lock l(mu_);
+  cancelled_ = true;
+  cond_var_.notify_all();
+}
+
+int64 WriterBufferBudget::buffered_bytes() {
+  mutex_lock l(mu_);
+  return buffered_bytes_;
+}
+
 AsyncWriter::AsyncWriter(Env* env, int64 file_index,
                          const std::string& shard_directory,
                          uint64 checkpoint_id, const std::string& compression,
                          int64 version, const DataTypeVector& output_types,
-                         std::function<void(Status)> done) {
+                         std::function<void(Status)> done,
+                         WriterBufferBudget* budget)
+    : budget_(budget) {
   thread_ = absl::WrapUnique(env->StartThread(
       ThreadOptions(), absl::StrCat("writer_thread_", file_index),
       [this, env, shard_directory, checkpoint_id, compression, version,
        &output_types, done = std::move(done)] {
-        done(WriterThread(env, shard_directory, checkpoint_id, compression,
-                          version, output_types));
+        Status s = WriterThread(env, shard_directory, checkpoint_id,
+                                compression, version, output_types);
+        Finish();
+        done(s);
       }));
 }
 
 void AsyncWriter::Write(const std::vector<Tensor>& tensors) {
+  {
+    mutex_lock l(mu_);
+    if (finished_) {
+      return;
+    }
+  }
+  const int64 bytes = ElementSizeBytes(tensors);
+  if (budget_ != nullptr && !budget_->Acquire(bytes)) {
+    return;
+  }
   mutex_lock l(mu_);
+  if (finished_) {
+    // The writer thread failed while we were waiting for the budget.
+    if (budget_ != nullptr) {
+      budget_->Release(bytes);
+    }
+    return;
+  }
   ElementOrEOF element;
   element.value = tensors;
   deque_.push_back(std::move(element));
@@ -1066,6 +1161,17 @@ void AsyncWriter::Consume(ElementOrEOF* be) {
 
 bool AsyncWriter::ElementAvailable() { return !deque_.empty(); }
 
+void AsyncWriter::Finish() {
+  mutex_lock l(mu_);
+  finished_ = true;
+  if (budget_ != nullptr) {
+    for (const auto& element : deque_) {
+      budget_->Release(ElementSizeBytes(element.value));
+    }
+  }
+  deque_.clear();
+}
+
 Status AsyncWriter::WriterThread(Env* env, const std::string& shard_directory,
                                  uint64 checkpoint_id,
                                  const std::string& compression, int64 version,
@@ -1086,7 +1192,11 @@ Status AsyncWriter::WriterThread(Env* env, const std::string& shard_directory,
       break;
     }
 
-    TF_RETURN_IF_ERROR(writer->WriteTensors(be.value));
+    Status s = writer->WriteTensors(be.value);
+    if (budget_ != nullptr) {
+      budget_->Release(ElementSizeBytes(be.value));
+    }
+    TF_RETURN_IF_ERROR(s);
   }
   return Status::OK();
 }
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 
@@ -155,10 +156,11 @@ class CustomWriter : public Writer {
   const std::string filename_;
   const std::string compression_type_;
   const DataTypeVector dtypes_;
-  // We hold zlib_dest_ because we may create a ZlibOutputBuffer and put that
-  // in dest_ if we want compression. ZlibOutputBuffer doesn't own the original
-  // dest_ and so we need somewhere to store the original one.
-  std::unique_ptr<WritableFile> zlib_underlying_dest_;
+  // We hold underlying_dest_ because we may create a compressing output buffer
+  // (zlib, zstd or LZ4) and put that in dest_ if we want compression. These
+  // buffers don't own the original dest_ and so we need somewhere to store the
+  // original one.
+  std::unique_ptr<WritableFile> underlying_dest_;
   std::vector<bool> simple_tensor_mask_;  // true for simple, false for complex.
   int num_simple_ = 0;
   int num_complex_ = 0;
@@ -335,9 +337,41 @@ struct ElementOrEOF {
   bool end_of_sequence = false;
 };
 
+// Bounds the number of bytes buffered by a group of `AsyncWriter`s that have
+// not yet been written out. `Acquire` blocks while the budget is exhausted,
+// which applies backpressure to the producer of the elements.
+class WriterBufferBudget {
+ public:
+  explicit WriterBufferBudget(int64 limit_bytes) : limit_bytes_(limit_bytes) {}
+
+  // Blocks until `bytes` fit within the budget, and reserves them. An
+  // acquisition is always admitted when nothing else is buffered, so that
+  // elements larger than the budget do not block forever. Returns false if the
+  // budget was cancelled.
+  bool Acquire(int64 bytes) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns `bytes` previously reserved by `Acquire` to the budget.
+  void Release(int64 bytes) TF_LOCKS_EXCLUDED(mu_);
+
+  // Unblocks all pending and future `Acquire` calls.
+  void Cancel() TF_LOCKS_EXCLUDED(mu_);
+
+  int64 buffered_bytes() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const int64 limit_bytes_;
+  mutex mu_;
+  condition_variable cond_var_;
+  int64 buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+};
+
 // AsyncWriter provides API for asynchronously writing dataset elements
 // (each represented as a vector of tensors) to a file.
 //
+// If a `WriterBufferBudget` is given, the bytes of elements buffered by the
+// writer are accounted against it and `Write` blocks while it is exhausted.
+//
 // The expected use of this API is:
 //
 // std::unique_ptr<AsyncWriter> writer = absl_make_unique<AsyncWriter>(...);
@@ -354,10 +388,12 @@ class AsyncWriter {
                        const std::string& shard_directory, uint64 checkpoint_id,
                        const std::string& compression, int64 version,
                        const DataTypeVector& output_types,
-                       std::function<void(Status)> done);
+                       std::function<void(Status)> done,
+                       WriterBufferBudget* budget = nullptr);
 
-  // Writes the given tensors. The method is non-blocking and returns without
-  // waiting for the element to be written.
+  // Writes the given tensors. The method returns without waiting for the
+  // element to be written, but blocks while the buffer budget (if any) is
+  // exhausted.
   void Write(const std::vector<Tensor>& tensors) TF_LOCKS_EXCLUDED(mu_);
 
   // Signals the end of input. The method is non-blocking and returns without
@@ -370,9 +406,14 @@ class AsyncWriter {
   Status WriterThread(Env* env, const std::string& shard_directory,
                       uint64 checkpoint_id, const std::string& compression,
                       int64 version, DataTypeVector output_types);
+  // Releases the budget held by elements that will never be written.
+  void Finish() TF_LOCKS_EXCLUDED(mu_);
 
+  WriterBufferBudget* const budget_;  // Not owned; may be null.
   mutex mu_;
   std::deque<ElementOrEOF> deque_ TF_GUARDED_BY(mu_);
+  // Set once the writer thread stops consuming elements.
+  bool finished_ TF_GUARDED_BY(mu_) = false;
 
   // This has to be last. During destruction, we need to make sure that the
   // Thread object is destroyed first as its destructor blocks on thread
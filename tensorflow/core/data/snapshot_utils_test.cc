@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -85,10 +86,79 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kNone, 1);
   SnapshotRoundTrip(io::compression::kGzip, 1);
   SnapshotRoundTrip(io::compression::kSnappy, 1);
+  SnapshotRoundTrip(io::compression::kZstd, 1);
+  SnapshotRoundTrip(io::compression::kLz4, 1);
 
   SnapshotRoundTrip(io::compression::kNone, 2);
   SnapshotRoundTrip(io::compression::kGzip, 2);
   SnapshotRoundTrip(io::compression::kSnappy, 2);
+  SnapshotRoundTrip(io::compression::kZstd, 2);
+  SnapshotRoundTrip(io::compression::kLz4, 2);
+}
+
+TEST(SnapshotUtilTest, WriterBufferBudget) {
+  WriterBufferBudget budget(/*limit_bytes=*/100);
+  EXPECT_TRUE(budget.Acquire(60));
+  EXPECT_EQ(budget.buffered_bytes(), 60);
+
+  // Blocks until the first acquisition is released.
+  Notification acquired;
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "acquire", [&budget, &acquired] {
+        EXPECT_TRUE(budget.Acquire(60));
+        acquired.Notify();
+      }));
+  EXPECT_FALSE(acquired.WaitForNotificationWithTimeout(/*timeout_in_us=*/1000));
+  budget.Release(60);
+  acquired.WaitForNotification();
+  EXPECT_EQ(budget.buffered_bytes(), 60);
+  budget.Release(60);
+
+  // Elements larger than the budget are admitted when nothing is buffered.
+  EXPECT_TRUE(budget.Acquire(1000));
+  budget.Release(1000);
+
+  budget.Cancel();
+  EXPECT_FALSE(budget.Acquire(1));
+}
+
+TEST(SnapshotUtilTest, AsyncWriterReleasesBudget) {
+  tensorflow::DataTypeVector dtypes;
+  std::vector<Tensor> tensors;
+  GenerateTensorVector(dtypes, tensors);
+
+  std::string shard_directory;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&shard_directory));
+
+  // The budget only fits a single element, so every write waits for the
+  // previous element to be written out.
+  WriterBufferBudget budget(/*limit_bytes=*/1);
+  Status writer_status;
+  {
+    AsyncWriter writer(
+        Env::Default(), /*file_index=*/0, shard_directory,
+        /*checkpoint_id=*/0, io::compression::kSnappy, /*version=*/2, dtypes,
+        [&writer_status](Status s) { writer_status = s; }, &budget);
+    for (int i = 0; i < 10; ++i) {
+      writer.Write(tensors);
+    }
+    writer.SignalEOF();
+  }
+  TF_EXPECT_OK(writer_status);
+  EXPECT_EQ(budget.buffered_bytes(), 0);
+
+  std::unique_ptr<Reader> reader;
+  TF_ASSERT_OK(Reader::Create(Env::Default(),
+                              GetCheckpointFileName(shard_directory, 0),
+                              io::compression::kSnappy, 2, dtypes, &reader));
+  for (int i = 0; i < 10; ++i) {
+    std::vector<Tensor> read_tensors;
+    TF_ASSERT_OK(reader->ReadTensors(&read_tensors));
+    EXPECT_EQ(read_tensors.size(), tensors.size());
+  }
+  int64 undeleted_files, undeleted_dirs;
+  TF_ASSERT_OK(Env::Default()->DeleteRecursively(
+      shard_directory, &undeleted_files, &undeleted_dirs));
 }
 
 void SnapshotReaderBenchmarkLoop(::testing::benchmark::State& state,
@@ -133,6 +203,14 @@ void SnapshotCustomReaderSnappyBenchmark(::testing::benchmark::State& state) {
   SnapshotReaderBenchmarkLoop(state, io::compression::kSnappy, 1);
 }
 
+void SnapshotCustomReaderZstdBenchmark(::testing::benchmark::State& state) {
+  SnapshotReaderBenchmarkLoop(state, io::compression::kZstd, 1);
+}
+
+void SnapshotCustomReaderLz4Benchmark(::testing::benchmark::State& state) {
+  SnapshotReaderBenchmarkLoop(state, io::compression::kLz4, 1);
+}
+
 void SnapshotTFRecordReaderNoneBenchmark(::testing::benchmark::State& state) {
   SnapshotReaderBenchmarkLoop(state, io::compression::kNone, 2);
 }
@@ -144,6 +222,8 @@ void SnapshotTFRecordReaderGzipBenchmark(::testing::benchmark::State& state) {
 BENCHMARK(SnapshotCustomReaderNoneBenchmark);
 BENCHMARK(SnapshotCustomReaderGzipBenchmark);
 BENCHMARK(SnapshotCustomReaderSnappyBenchmark);
+BENCHMARK(SnapshotCustomReaderZstdBenchmark);
+BENCHMARK(SnapshotCustomReaderLz4Benchmark);
 BENCHMARK(SnapshotTFRecordReaderNoneBenchmark);
 BENCHMARK(SnapshotTFRecordReaderGzipBenchmark);
 
@@ -180,6 +260,14 @@ void SnapshotCustomWriterSnappyBenchmark(::testing::benchmark::State& state) {
   SnapshotWriterBenchmarkLoop(state, io::compression::kSnappy, 1);
 }
 
+void SnapshotCustomWriterZstdBenchmark(::testing::benchmark::State& state) {
+  SnapshotWriterBenchmarkLoop(state, io::compression::kZstd, 1);
+}
+
+void SnapshotCustomWriterLz4Benchmark(::testing::benchmark::State& state) {
+  SnapshotWriterBenchmarkLoop(state, io::compression::kLz4, 1);
+}
+
 void SnapshotTFRecordWriterNoneBenchmark(::testing::benchmark::State& state) {
   SnapshotWriterBenchmarkLoop(state, io::compression::kNone, 2);
 }
@@ -195,6 +283,8 @@ void SnapshotTFRecordWriterSnappyBenchmark(::testing::benchmark::State& state) {
 BENCHMARK(SnapshotCustomWriterNoneBenchmark);
 BENCHMARK(SnapshotCustomWriterGzipBenchmark);
 BENCHMARK(SnapshotCustomWriterSnappyBenchmark);
+BENCHMARK(SnapshotCustomWriterZstdBenchmark);
+BENCHMARK(SnapshotCustomWriterLz4Benchmark);
 BENCHMARK(SnapshotTFRecordWriterNoneBenchmark);
 BENCHMARK(SnapshotTFRecordWriterGzipBenchmark);
 BENCHMARK(SnapshotTFRecordWriterSnappyBenchmark);
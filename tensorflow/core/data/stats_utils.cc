@@ -32,6 +32,9 @@ ABSL_CONST_INIT const char kDroppedElements[] = "dropped_elements";
 ABSL_CONST_INIT const char kFeaturesCount[] = "features_count";
 ABSL_CONST_INIT const char kFeatureValuesCount[] = "feature_values_count";
 ABSL_CONST_INIT const char kExamplesCount[] = "examples_count";
+ABSL_CONST_INIT const char kCacheMemoryElements[] = "cache_memory_elements";
+ABSL_CONST_INIT const char kCacheDiskElements[] = "cache_disk_elements";
+ABSL_CONST_INIT const char kCacheMemoryHitRatio[] = "cache_memory_hit_ratio";
 
 string ExecutionTimeHistogramName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kExecutionTime);
@@ -69,6 +72,18 @@ string FeatureValueHistogramName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kFeatureValuesCount);
 }
 
+string CacheMemoryElementsScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kCacheMemoryElements);
+}
+
+string CacheDiskElementsScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kCacheDiskElements);
+}
+
+string CacheMemoryHitRatioScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kCacheMemoryHitRatio);
+}
+
 }  // namespace stats_utils
 }  // namespace data
 }  // namespace tensorflow
@@ -31,6 +31,9 @@ extern const char kDroppedElements[];
 extern const char kFeaturesCount[];
 extern const char kFeatureValuesCount[];
 extern const char kExamplesCount[];
+extern const char kCacheMemoryElements[];
+extern const char kCacheDiskElements[];
+extern const char kCacheMemoryHitRatio[];
 
 // Name for tf.data function execution time (in ns) histogram metrics.
 string ExecutionTimeHistogramName(const string& prefix);
@@ -61,6 +64,16 @@ string FeatureHistogramName(const string& prefix);
 // Name for feature-values count histogram metrics.
 string FeatureValueHistogramName(const string& prefix);
 
+// Name for the number of cached elements held in memory scalar metrics.
+string CacheMemoryElementsScalarName(const string& prefix);
+
+// Name for the number of cached elements spilled to disk scalar metrics.
+string CacheDiskElementsScalarName(const string& prefix);
+
+// Name for cache memory hit ratio (ratio of cached elements served from memory
+// and all cached elements served) scalar metrics.
+string CacheMemoryHitRatioScalarName(const string& prefix);
+
 }  // namespace stats_utils
 }  // namespace data
 }  // namespace tensorflow
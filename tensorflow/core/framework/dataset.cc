@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/framework/dataset.h"
 
+#include <algorithm>
+#include <limits>
 #include <unordered_map>
 
 #include "tensorflow/core/framework/device_base.h"
@@ -389,6 +391,37 @@ Status IteratorBase::InitializeBase(IteratorContext* ctx,
   return Status::OK();
 }
 
+Status IteratorBase::SkipInput(IteratorContext* ctx, int64 num_elements,
+                               const std::unique_ptr<IteratorBase>& input) {
+  // Marks the skip as part of a restore, which lets transformations skip
+  // their input without recomputing the skipped elements.
+  IteratorContext::Params params(ctx);
+  params.is_restoring = true;
+  IteratorContext restore_ctx(std::move(params));
+  int64 num_remaining = num_elements;
+  while (num_remaining > 0) {
+    const int num_to_skip = static_cast<int>(
+        std::min<int64>(num_remaining, std::numeric_limits<int>::max()));
+    bool end_of_sequence = false;
+    int num_skipped = 0;
+    TF_RETURN_IF_ERROR(
+        input->Skip(&restore_ctx, num_to_skip, &end_of_sequence, &num_skipped));
+    num_remaining -= num_skipped;
+    if (end_of_sequence) {
+      break;
+    }
+  }
+  if (num_remaining > 0) {
+    return errors::FailedPrecondition(
+        "Failed to restore iterator ", input->prefix(), " to position ",
+        num_elements, " because its input ended after ",
+        num_elements - num_remaining,
+        " elements. Symbolic checkpoints require the input to produce the "
+        "same elements each time it is iterated.");
+  }
+  return Status::OK();
+}
+
 int64 GetAllocatedBytes(const std::vector<Tensor>& element) {
   int64 allocated_bytes = 0;
   DatasetBase* dataset;
@@ -43,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 
 // Polymorphic datasets should support all primitive TensorFlow
@@ -385,6 +386,7 @@ class IteratorContext {
           is_restoring(ctx->is_restoring()),
           resource_mgr(ctx->resource_mgr()),
           model(ctx->model()),
+          numa_node(ctx->numa_node()),
           runner(*(ctx->runner())),
           runner_threadpool_size(ctx->runner_threadpool_size()),
           split_providers(ctx->split_providers()),
@@ -452,6 +454,10 @@ class IteratorContext {
     // If non-null, identifies the object used for performance modeling.
     std::shared_ptr<model::Model> model = nullptr;
 
+    // If not `port::kNUMANoAffinity`, the NUMA node that threads created for
+    // the pipeline should be pinned to.
+    int numa_node = port::kNUMANoAffinity;
+
     // Function call support.
     std::function<void(std::function<void()>)> runner = nullptr;
 
@@ -507,6 +513,8 @@ class IteratorContext {
 
   const std::shared_ptr<model::Model>& model() { return params_.model; }
 
+  int numa_node() { return params_.numa_node; }
+
   std::function<void(std::function<void()>)>* runner() {
     return &params_.runner;
   }
@@ -536,7 +544,9 @@ class IteratorContext {
       // created `ThreadPool` instance.
       return absl::make_unique<thread::ThreadPool>(params_.thread_pool);
     } else {
-      return absl::make_unique<thread::ThreadPool>(params_.env, ThreadOptions(),
+      ThreadOptions thread_options;
+      thread_options.numa_node = params_.numa_node;
+      return absl::make_unique<thread::ThreadPool>(params_.env, thread_options,
                                                    name, num_threads,
                                                    /*low_latency_hint=*/false);
     }
@@ -547,8 +557,10 @@ class IteratorContext {
     if (params_.thread_factory) {
       return params_.thread_factory->StartThread(name, std::move(fn));
     } else {
+      ThreadOptions thread_options;
+      thread_options.numa_node = params_.numa_node;
       return absl::WrapUnique(
-          Env::Default()->StartThread({}, name, std::move(fn)));
+          Env::Default()->StartThread(thread_options, name, std::move(fn)));
     }
   }
 
@@ -622,6 +634,14 @@ class SerializationContext {
     // seeds will always be preserved.
     bool preserve_random_seeds = true;
 
+    // Indicates whether iterators with internal buffers (e.g. shuffle,
+    // prefetch and parallel map) should save only the positions of their
+    // inputs instead of the buffered elements. On restore, such iterators
+    // re-create their input and skip to the saved positions to recompute the
+    // buffers. This keeps checkpoints small, but requires the input to produce
+    // the same elements each time it is iterated.
+    bool symbolic_checkpoint = false;
+
     // A resource manager for looking up resources during serialization.
     ResourceMgr* resource_mgr;
 
@@ -645,6 +665,8 @@ class SerializationContext {
 
   bool preserve_random_seeds() const { return params_.preserve_random_seeds; }
 
+  bool symbolic_checkpoint() const { return params_.symbolic_checkpoint; }
+
   const ResourceMgr* resource_mgr() const { return params_.resource_mgr; }
 
   const std::string& device_name() const { return params_.device_name; }
@@ -771,6 +793,12 @@ class IteratorBase {
     return RestoreInput(&ctx, reader, input);
   }
 
+  // Restores a freshly created `input` iterator to the position after its
+  // first `num_elements` elements by skipping them. This is used by iterators
+  // that were saved with `SerializationContext::symbolic_checkpoint()`.
+  Status SkipInput(IteratorContext* ctx, int64 num_elements,
+                   const std::unique_ptr<IteratorBase>& input);
+
   // Saves the state of this iterator.
   //
   // This method is used to store the state of the iterator in a checkpoint.
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/local_rendezvous.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -97,15 +99,210 @@ void LocalRendezvous::ItemQueue::push_back(Item* item) {
 }
 
 LocalRendezvous::~LocalRendezvous() {
-  if (!table_.empty()) {
+  if (!table_.empty() || num_used_slots_.load(std::memory_order_relaxed) > 0) {
     StartAbort(errors::Cancelled("LocalRendezvous deleted"));
   }
+  for (auto& chunk : slot_chunks_) {
+    delete[] chunk.load(std::memory_order_relaxed);
+  }
 }
 
 namespace {
 uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
 }  // namespace
 
+LocalRendezvous::Slot* LocalRendezvous::GetSlot(
+    const Rendezvous::ParsedKey& key, uint64 key_hash) {
+  static_assert(alignof(Item) > kRecvTag,
+                "Slots tag the address of an item with kRecvTag");
+  if (key.slot < 0 || key.slot >= kNumSlotChunks * kSlotsPerChunk ||
+      key_hash == 0 || aborted_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  std::atomic<Slot*>* chunk_ptr = &slot_chunks_[key.slot / kSlotsPerChunk];
+  Slot* chunk = chunk_ptr->load(std::memory_order_acquire);
+  if (chunk == nullptr) {
+    Slot* new_chunk = new Slot[kSlotsPerChunk];
+    if (chunk_ptr->compare_exchange_strong(chunk, new_chunk,
+                                           std::memory_order_acq_rel)) {
+      chunk = new_chunk;
+    } else {
+      delete[] new_chunk;
+    }
+  }
+  Slot* slot = &chunk[key.slot % kSlotsPerChunk];
+
+  // Raised before the caller can leave an item in the slot, so that
+  // StartAbort() either visits the slot or the caller sees `aborted_` when it
+  // re-checks it.
+  int64 num_used_slots = num_used_slots_.load();
+  while (num_used_slots <= key.slot &&
+         !num_used_slots_.compare_exchange_weak(num_used_slots,
+                                                key.slot + 1)) {
+  }
+
+  // Slot ids are only unique within one partitioning of a graph, so another
+  // key may have claimed the slot first.
+  uint64 bound_hash = slot->key_hash.load(std::memory_order_acquire);
+  if (bound_hash == 0 && slot->key_hash.compare_exchange_strong(
+                             bound_hash, key_hash, std::memory_order_acq_rel)) {
+    return slot;
+  }
+  return bound_hash == key_hash ? slot : nullptr;
+}
+
+bool LocalRendezvous::SendToSlot(Slot* slot, const Rendezvous::Args& send_args,
+                                 const Tensor& val, const bool is_dead) {
+  uintptr_t state = slot->state.load(std::memory_order_acquire);
+  if (state == kEmptySlot) {
+    // There is no waiter for this message; leave it in the slot.
+    Item* message = new Item(send_args, val, is_dead);
+    const uintptr_t message_state = reinterpret_cast<uintptr_t>(message);
+    if (slot->state.compare_exchange_strong(state, message_state)) {
+      if (aborted_.load()) {
+        // StartAbort() may have cleared the slots before `message` was added.
+        // Take it back, unless StartAbort() already deleted it, and let the
+        // caller report the abort status.
+        uintptr_t expected = message_state;
+        if (slot->state.compare_exchange_strong(expected, kConsumedSlot)) {
+          delete message;
+        }
+        return false;
+      }
+      return true;
+    }
+    delete message;
+  }
+  if (!(state & kRecvTag) ||
+      !slot->state.compare_exchange_strong(state, kConsumedSlot)) {
+    return false;
+  }
+  DoneWaiting(reinterpret_cast<Item*>(state & ~kRecvTag), Status::OK(),
+              send_args, val, is_dead);
+  return true;
+}
+
+bool LocalRendezvous::RecvFromSlot(Slot* slot,
+                                   const Rendezvous::Args& recv_args,
+                                   Rendezvous::DoneCallback* done) {
+  uintptr_t state = slot->state.load(std::memory_order_acquire);
+  if (state != kEmptySlot) {
+    // Consume the message in the slot, if any.
+    if (state == kConsumedSlot || (state & kRecvTag) ||
+        !slot->state.compare_exchange_strong(state, kConsumedSlot)) {
+      return false;
+    }
+    Item* item = reinterpret_cast<Item*>(state);
+    (*done)(Status::OK(), item->args, recv_args, *item->send_state.value,
+            item->send_state.is_dead);
+    delete item;
+    return true;
+  }
+
+  // There is no message to pick up, so wait in the slot. The refcount of the
+  // owner is managed as in RecvAsync(), and DoneWaiting() deregisters the
+  // cancellation callback.
+  CancellationManager* cm = recv_args.cancellation_manager;
+  CancellationToken token = CancellationManager::kInvalidToken;
+  if (cm != nullptr) {
+    if (rc_owner_) rc_owner_->Ref();
+    token = cm->get_cancellation_token();
+  }
+  Item* waiter = new Item(recv_args, std::move(*done), token);
+  const uintptr_t waiter_state = reinterpret_cast<uintptr_t>(waiter) | kRecvTag;
+  if (cm != nullptr) {
+    // The callback cancels `waiter` if it is in the slot, and marks an empty
+    // slot as consumed so that `waiter` cannot be added after it ran. It only
+    // compares against `waiter`, which may have been deleted by then.
+    const bool already_cancelled =
+        !cm->RegisterCallback(token, [this, slot, waiter, waiter_state] {
+          uintptr_t current = slot->state.load(std::memory_order_acquire);
+          while (current == kEmptySlot || current == waiter_state) {
+            if (slot->state.compare_exchange_weak(current, kConsumedSlot)) {
+              if (current == waiter_state) {
+                (*waiter->recv_state.waiter)(
+                    StatusGroup::MakeDerived(
+                        errors::Cancelled("RecvAsync is cancelled.")),
+                    Rendezvous::Args(), waiter->args, Tensor(),
+                    /*is_dead=*/false);
+                delete waiter;
+              }
+              break;
+            }
+          }
+          if (rc_owner_) rc_owner_->Unref();
+        });
+    if (already_cancelled) {
+      if (rc_owner_) rc_owner_->Unref();
+      (*waiter->recv_state.waiter)(
+          StatusGroup::MakeDerived(
+              errors::Cancelled("RecvAsync is cancelled.")),
+          Rendezvous::Args(), recv_args, Tensor(), /*is_dead=*/false);
+      delete waiter;
+      return true;
+    }
+  }
+
+  state = kEmptySlot;
+  if (slot->state.compare_exchange_strong(state, waiter_state)) {
+    if (aborted_.load()) {
+      // StartAbort() may have cleared the slots before `waiter` was added.
+      uintptr_t expected = waiter_state;
+      if (slot->state.compare_exchange_strong(expected, kConsumedSlot)) {
+        Status s;
+        {
+          mutex_lock l(mu_);
+          s = status_;
+        }
+        DoneWaiting(waiter, s, Rendezvous::Args(), Tensor(), false);
+      }
+    }
+    return true;
+  }
+
+  // A message may have arrived in the meantime.
+  if (state != kConsumedSlot && !(state & kRecvTag) &&
+      slot->state.compare_exchange_strong(state, kConsumedSlot)) {
+    Item* item = reinterpret_cast<Item*>(state);
+    DoneWaiting(waiter, Status::OK(), item->args, *item->send_state.value,
+                item->send_state.is_dead);
+    delete item;
+    return true;
+  }
+
+  // Otherwise use `table_`, which registers its own cancellation callback.
+  if (cm != nullptr) {
+    if (!cm->TryDeregisterCallback(token)) {
+      // The callback runs or has run, and drops the refcount.
+      (*waiter->recv_state.waiter)(
+          StatusGroup::MakeDerived(
+              errors::Cancelled("RecvAsync is cancelled.")),
+          Rendezvous::Args(), recv_args, Tensor(), /*is_dead=*/false);
+      delete waiter;
+      return true;
+    }
+    if (rc_owner_) rc_owner_->Unref();
+  }
+  *done = std::move(*waiter->recv_state.waiter);
+  delete waiter;
+  return false;
+}
+
+void LocalRendezvous::DoneWaiting(Item* item, const Status& status,
+                                  const Rendezvous::Args& send_args,
+                                  const Tensor& val, const bool is_dead) {
+  DCHECK_EQ(item->type, Item::kRecv);
+  CancellationManager* cm = item->args.cancellation_manager;
+  // As in RecvAsync(), the cancellation callback must be deregistered before
+  // `done` is called, and drops the refcount if it cannot be deregistered.
+  if (cm != nullptr &&
+      cm->TryDeregisterCallback(item->recv_state.cancellation_token)) {
+    if (rc_owner_) rc_owner_->Unref();
+  }
+  (*item->recv_state.waiter)(status, send_args, item->args, val, is_dead);
+  delete item;
+}
+
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
@@ -122,6 +319,11 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
         ->IncrementBy(1);
   }
 
+  Slot* slot = GetSlot(key, key_hash);
+  if (slot != nullptr && SendToSlot(slot, send_args, val, is_dead)) {
+    return Status::OK();
+  }
+
   mu_.lock();
   if (!status_.ok()) {
     // Rendezvous has been aborted.
@@ -170,6 +372,11 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   uint64 key_hash = KeyHash(key.FullKey());
   DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
 
+  Slot* slot = GetSlot(key, key_hash);
+  if (slot != nullptr && RecvFromSlot(slot, recv_args, &done)) {
+    return;
+  }
+
   mu_.lock();
   if (!status_.ok()) {
     // Rendezvous has been aborted.
@@ -319,6 +526,24 @@ void LocalRendezvous::StartAbort(const Status& status) {
     status_.Update(status);
     table_.swap(table);
   }
+  aborted_.store(true);
+  const int64 num_used_slots = num_used_slots_.load();
+  for (int64 c = 0; c * kSlotsPerChunk < num_used_slots; ++c) {
+    Slot* chunk = slot_chunks_[c].load(std::memory_order_acquire);
+    if (chunk == nullptr) continue;
+    const int64 num_slots =
+        std::min(kSlotsPerChunk, num_used_slots - c * kSlotsPerChunk);
+    for (int64 i = 0; i < num_slots; ++i) {
+      const uintptr_t state = chunk[i].state.exchange(kConsumedSlot);
+      if (state == kEmptySlot || state == kConsumedSlot) continue;
+      if (state & kRecvTag) {
+        DoneWaiting(reinterpret_cast<Item*>(state & ~kRecvTag), status,
+                    Rendezvous::Args(), Tensor(), false);
+      } else {
+        delete reinterpret_cast<Item*>(state);
+      }
+    }
+  }
   for (auto& p : table) {
     Item* item = p.second.head;
     while (item != nullptr) {
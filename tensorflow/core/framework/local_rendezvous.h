@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
+
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -66,9 +68,57 @@ class LocalRendezvous {
 
   typedef gtl::FlatMap<uint64, ItemQueue> Table;
 
+  // Keys with a rendezvous slot (see Rendezvous::ParsedKey::slot) are matched
+  // without taking `mu_`. A slot is bound to the first key that uses it, and
+  // holds at most one item over the lifetime of the rendezvous: it goes from
+  // empty to holding a Send or Recv item, and to consumed once the item has
+  // been matched, cancelled or aborted. Calls that find their slot bound to
+  // another key, holding an item of the same type or consumed use `table_`
+  // instead, which keeps the messages of a key in order: the item in the slot
+  // is always older than the items of the same key in `table_`.
+  struct Slot {
+    // Hash of the key the slot is bound to, or 0 if it is unbound.
+    std::atomic<uint64> key_hash{0};
+    // kEmptySlot, kConsumedSlot, or the address of the pending item, tagged
+    // with kRecvTag if it is a waiter. The tag lets callers tell the state of
+    // the slot without dereferencing an item another thread may consume.
+    std::atomic<uintptr_t> state{0};
+  };
+  static constexpr uintptr_t kEmptySlot = 0;
+  static constexpr uintptr_t kConsumedSlot = 1;
+  static constexpr uintptr_t kRecvTag = 2;
+
+  // Slots are allocated in chunks on first use. Keys with larger slot ids
+  // always use `table_`.
+  static constexpr int64 kSlotsPerChunk = 256;
+  static constexpr int kNumSlotChunks = 64;
+
+  // Returns the slot for `key`, or nullptr if the key must use `table_`.
+  Slot* GetSlot(const Rendezvous::ParsedKey& key, uint64 key_hash);
+
+  // Try to match a Send or Recv through `slot`. Return false if the call must
+  // use `table_` instead, in which case `*done` is left unchanged.
+  bool SendToSlot(Slot* slot, const Rendezvous::Args& send_args,
+                  const Tensor& val, const bool is_dead);
+  bool RecvFromSlot(Slot* slot, const Rendezvous::Args& recv_args,
+                    Rendezvous::DoneCallback* done);
+
+  // Invokes and deletes the waiter `item` that has been taken out of its
+  // slot.
+  void DoneWaiting(Item* item, const Status& status,
+                   const Rendezvous::Args& send_args, const Tensor& val,
+                   const bool is_dead);
+
   // Pointer to the owner class of this LocalRendezvous if it is refcounted.
   const Rendezvous* rc_owner_;
 
+  std::atomic<Slot*> slot_chunks_[kNumSlotChunks] = {};
+  // One more than the largest slot id used so far. StartAbort() only visits
+  // the slots below it.
+  std::atomic<int64> num_used_slots_{0};
+  // Set by StartAbort() after `status_`.
+  std::atomic<bool> aborted_{false};
+
   // TODO(zhifengc): shard table_.
   mutex mu_;
   Table table_ TF_GUARDED_BY(mu_);
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
 
 namespace tensorflow {
@@ -85,6 +86,32 @@ auto* tf_data_bytes_fetched_counter = monitoring::Counter<0>::New(
     "/tensorflow/data/bytes_fetched",
     "The number of bytes fetched from tf.data Dataset iterator.");
 
+auto* tf_data_cache_reads_counter = monitoring::Counter<1>::New(
+    "/tensorflow/data/cache_reads",
+    "The number of elements served by a tf.data cache from each tier.",
+    "tier");
+
+auto* tf_data_cache_spilled_bytes_counter = monitoring::Counter<0>::New(
+    "/tensorflow/data/cache_spilled_bytes",
+    "The number of bytes spilled to disk by tf.data caches that exceeded "
+    "their memory budget.");
+
+auto* tf_data_autotune_ram_budget_gauge = monitoring::Gauge<int64, 0>::New(
+    "/tensorflow/data/autotune_ram_budget",
+    "The RAM budget (in bytes) shared by the autotuned buffers of all tf.data "
+    "input pipelines.");
+
+auto* tf_data_autotune_buffer_limit_bytes_gauge =
+    monitoring::Gauge<int64, 0>::New(
+        "/tensorflow/data/autotune_buffer_limit_bytes",
+        "The number of bytes that the autotuned buffers of all tf.data input "
+        "pipelines may hold when full.");
+
+auto* tf_data_autotune_buffer_shrinks_counter = monitoring::Counter<0>::New(
+    "/tensorflow/data/autotune_buffer_shrinks",
+    "The number of times tf.data autotuning shrunk a buffer to stay within "
+    "the RAM budget.");
+
 auto* tf_data_elements_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/elements", "tf.data elements", "name");
 
@@ -204,6 +231,30 @@ void RecordTFDataBytesFetched(int64 num_bytes) {
   tf_data_bytes_fetched_counter->GetCell()->IncrementBy(num_bytes);
 }
 
+monitoring::CounterCell* GetTFDataCacheReadsCounter(const string& tier) {
+  return tf_data_cache_reads_counter->GetCell(tier);
+}
+
+void RecordTFDataCacheSpilledBytes(int64 num_bytes) {
+  static auto* tf_data_cache_spilled_bytes_cell =
+      tf_data_cache_spilled_bytes_counter->GetCell();
+  tf_data_cache_spilled_bytes_cell->IncrementBy(num_bytes);
+}
+
+void RecordTFDataAutotuneRamBudget(int64 num_bytes) {
+  tf_data_autotune_ram_budget_gauge->GetCell()->Set(num_bytes);
+}
+
+void RecordTFDataAutotuneBufferLimitBytes(int64 num_bytes) {
+  tf_data_autotune_buffer_limit_bytes_gauge->GetCell()->Set(num_bytes);
+}
+
+void RecordTFDataAutotuneBufferShrink() {
+  static auto* tf_data_autotune_buffer_shrinks_cell =
+      tf_data_autotune_buffer_shrinks_counter->GetCell();
+  tf_data_autotune_buffer_shrinks_cell->IncrementBy(1);
+}
+
 void RecordTFDataExperiment(const string& name) {
   tf_data_experiment_counter->GetCell(name)->IncrementBy(1);
 }
@@ -56,6 +56,28 @@ monitoring::CounterCell* GetTFDataElementsCounter(const string& name);
 // Records the number of bytes fetched from tf.data.Dataset iterator.
 void RecordTFDataBytesFetched(int64 num_bytes);
 
+// Returns a counter that can be used to record the number of elements served
+// by a tf.data cache from a given tier.
+//
+// The `tier` argument identifies the cache tier ("memory" or "disk").
+monitoring::CounterCell* GetTFDataCacheReadsCounter(const string& tier);
+
+// Records the number of bytes that a tf.data cache spilled to disk because
+// they did not fit in its memory budget.
+void RecordTFDataCacheSpilledBytes(int64 num_bytes);
+
+// Records the RAM budget (in bytes) shared by the autotuned buffers of all
+// tf.data input pipelines in the process.
+void RecordTFDataAutotuneRamBudget(int64 num_bytes);
+
+// Records the number of bytes that the autotuned buffers of all tf.data input
+// pipelines in the process may hold when full.
+void RecordTFDataAutotuneBufferLimitBytes(int64 num_bytes);
+
+// Records that tf.data autotuning shrunk a buffer to stay within the RAM
+// budget.
+void RecordTFDataAutotuneBufferShrink();
+
 // Records the number of times tf.data experiment is applied to input pipelines.
 void RecordTFDataExperiment(const string& name);
 
@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/framework/model.h"
 
+#include <time.h>
+
 #include <memory>
 
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/mem.h"
 
 namespace tensorflow {
 namespace data {
@@ -31,6 +34,10 @@ constexpr int64 Model::kOptimizationPeriodMaxMs;
 
 namespace {
 
+// Share of the available RAM that the autotuned buffers of all input pipelines
+// of a process may use.
+constexpr double kRamBudgetShare = 0.5;
+
 // Helper function for node traversal that doesn't skip any nodes.
 inline bool IsAnyNode(const std::shared_ptr<Node> node) { return true; }
 
@@ -927,6 +934,7 @@ class Unknown : public Node {
 }  // namespace
 
 thread_local int64 Node::work_start_;
+thread_local int64 Node::cpu_work_start_;
 
 std::shared_ptr<Parameter> MakeParameter(const string& name,
                                          std::shared_ptr<SharedState> state,
@@ -934,6 +942,17 @@ std::shared_ptr<Parameter> MakeParameter(const string& name,
   return std::make_shared<Parameter>(name, state, min, max);
 }
 
+int64 ThreadCpuTimeNanos() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+    return static_cast<int64>(ts.tv_sec) * EnvTime::kSecondsToNanos +
+           ts.tv_nsec;
+  }
+#endif
+  return EnvTime::NowNanos();
+}
+
 std::shared_ptr<Node> MakeInterleaveManyNode(Node::Args args) {
   return std::make_shared<InterleaveMany>(std::move(args));
 }
@@ -1351,7 +1370,10 @@ double Node::SelfProcessingTimeLocked() const {
   if (num_elements_ == 0) {
     return 0;
   }
-  return static_cast<double>(processing_time_) /
+  // Wall-clock time overstates the work done by threads that wait for a CPU,
+  // so nodes that record CPU time use it instead.
+  const int64 processing_time = record_cpu_time_ ? cpu_time_ : processing_time_;
+  return static_cast<double>(processing_time) /
          static_cast<double>(num_elements_);
 }
 
@@ -1444,6 +1466,8 @@ std::shared_ptr<Node> Node::SnapshotHelper(
     cloned_current->num_elements_.store(num_elements_);
     cloned_current->record_metrics_.store(false);
     cloned_current->processing_time_.store(processing_time_);
+    cloned_current->cpu_time_.store(cpu_time_);
+    cloned_current->record_cpu_time_.store(record_cpu_time_);
     mutex_lock l2(cloned_current->mu_);
     cloned_current->parameters_ = parameters_;
   }
@@ -1504,6 +1528,8 @@ Status Node::ToProto(ModelProto::Node* node_proto) const {
   node_proto->set_bytes_produced(bytes_produced_);
   node_proto->set_num_elements(num_elements_);
   node_proto->set_processing_time(processing_time_);
+  node_proto->set_cpu_time(cpu_time_);
+  node_proto->set_record_cpu_time(record_cpu_time_);
   node_proto->set_record_metrics(record_metrics_);
 
   // Produce protos for all parameters.
@@ -1534,6 +1560,8 @@ Status Node::FromProtoHelper(ModelProto::Node node_proto,
   node->bytes_produced_.store(node_proto.bytes_produced());
   node->num_elements_.store(node_proto.num_elements());
   node->processing_time_.store(node_proto.processing_time());
+  node->cpu_time_.store(node_proto.cpu_time());
+  node->record_cpu_time_.store(node_proto.record_cpu_time());
   node->record_metrics_.store(node_proto.record_metrics());
 
   // Restore parameters.
@@ -1589,6 +1617,55 @@ Status Node::FromProto(ModelProto::Node node_proto,
   return FromProtoHelper(node_proto, *node);
 }
 
+RamBudgetManager::RamBudgetManager(int64 budget, bool record_metrics)
+    : budget_(budget), record_metrics_(record_metrics) {
+  if (record_metrics_) {
+    metrics::RecordTFDataAutotuneRamBudget(budget_);
+  }
+}
+
+RamBudgetManager* RamBudgetManager::Global() {
+  static RamBudgetManager* const manager = new RamBudgetManager(
+      static_cast<int64>(kRamBudgetShare * port::AvailableRam()),
+      /*record_metrics=*/true);
+  return manager;
+}
+
+int64 RamBudgetManager::AvailableFor(const void* owner) {
+  mutex_lock l(mu_);
+  auto it = allocations_.find(owner);
+  const int64 own = it == allocations_.end() ? 0 : it->second;
+  return std::max(int64{0}, budget_ - (total_allocation_ - own));
+}
+
+void RamBudgetManager::SetAllocation(const void* owner, int64 bytes) {
+  mutex_lock l(mu_);
+  int64& allocation = allocations_[owner];
+  total_allocation_ += bytes - allocation;
+  allocation = bytes;
+  if (record_metrics_) {
+    metrics::RecordTFDataAutotuneBufferLimitBytes(total_allocation_);
+  }
+}
+
+void RamBudgetManager::RemoveAllocation(const void* owner) {
+  mutex_lock l(mu_);
+  auto it = allocations_.find(owner);
+  if (it == allocations_.end()) {
+    return;
+  }
+  total_allocation_ -= it->second;
+  allocations_.erase(it);
+  if (record_metrics_) {
+    metrics::RecordTFDataAutotuneBufferLimitBytes(total_allocation_);
+  }
+}
+
+int64 RamBudgetManager::TotalAllocation() {
+  mutex_lock l(mu_);
+  return total_allocation_;
+}
+
 bool Model::publish_ = false;
 
 void Model::AddNode(Node::Factory factory, const string& name,
@@ -1599,6 +1676,7 @@ void Model::AddNode(Node::Factory factory, const string& name,
   auto node_name = str_util::Split(name, ':', str_util::SkipEmpty()).back();
   mutex_lock l(mu_);
   std::shared_ptr<Node> node = factory({id_counter_++, node_name, parent});
+  node->set_record_cpu_time(record_cpu_time_);
   if (!output_) {
     output_ = node;
   }
@@ -1641,6 +1719,9 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
     tf_shared_lock l(mu_);
     snapshot = output_->Snapshot();
   }
+  // The buffers of this model may only use the part of the process-wide budget
+  // that other input pipelines leave unused.
+  ram_budget = std::min(ram_budget, ram_budget_manager_->AvailableFor(this));
   OptimizationParams optimization_params;
   optimization_params.set_algorithm(algorithm);
   optimization_params.set_cpu_budget(cpu_budget);
@@ -1648,6 +1729,7 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
   optimization_params.set_model_input_time(model_input_time);
   switch (algorithm) {
     case AutotuneAlgorithm::HILL_CLIMB:
+    case AutotuneAlgorithm::CPU_TIME_HILL_CLIMB:
       OptimizeHillClimb(snapshot, optimization_params, cancellation_manager);
       break;
     case AutotuneAlgorithm::GRADIENT_DESCENT:
@@ -1659,6 +1741,8 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
                  "optimization.";
       return;
   }
+  ram_budget_manager_->SetAllocation(
+      this, static_cast<int64>(TotalMaximumBufferedBytes(snapshot)));
   if (publish() || !save_dir_.empty()) {
     mutex_lock l(*snapshot_buffer_mu_);
     if (snapshot_buffer_->size() >= kMaxNumBufferedSnapshots) {
@@ -1692,6 +1776,31 @@ Model::ModelParameters Model::CollectTunableParameters(
   return node->CollectTunableParameters();
 }
 
+void Model::ShrinkBuffers(std::shared_ptr<Node> snapshot, int64 ram_budget,
+                          const ModelParameters& parameters) {
+  while (TotalMaximumBufferedBytes(snapshot) > ram_budget) {
+    Parameter* largest = nullptr;
+    for (auto& pair : parameters) {
+      Parameter* parameter = pair.second.get();
+      if (parameter->name == kBufferSize &&
+          parameter->value > parameter->min &&
+          (!largest || parameter->value > largest->value)) {
+        largest = parameter;
+      }
+    }
+    if (!largest) {
+      VLOG(2) << "All buffer sizes are at their minimum but the buffers still "
+                 "exceed the RAM budget of "
+              << ram_budget << " bytes.";
+      return;
+    }
+    largest->value = std::max(largest->min, std::floor(largest->value / 2.0));
+    metrics::RecordTFDataAutotuneBufferShrink();
+    VLOG(2) << "Shrinking buffer size to " << largest->value
+            << " to stay within the RAM budget of " << ram_budget << " bytes.";
+  }
+}
+
 bool Model::ShouldStop(int64 cpu_budget, int64 ram_budget,
                        const Model::ModelParameters& parameters,
                        const Model::ModelParameters& parallelism_parameters,
@@ -1837,6 +1946,7 @@ void Model::OptimizeGradientDescent(
   for (auto& pair : parameters) {
     pair.second->value = std::round(pair.second->value);
   }
+  ShrinkBuffers(snapshot, optimization_params.ram_budget(), parameters);
   UpdateStateValues(&parameters);
 }
 
@@ -1857,6 +1967,12 @@ void Model::OptimizeHillClimb(std::shared_ptr<Node> snapshot,
   // improvement is greater than this constant.
   constexpr double kBufferSizeMinDelta = 1.0L;
 
+  // With per-element CPU time, the model no longer assumes that threads beyond
+  // the number of cores can make progress, so parallelism is only handed out
+  // while the total stays within the CPU budget.
+  const bool limit_parallelism = optimization_params.algorithm() ==
+                                 AutotuneAlgorithm::CPU_TIME_HILL_CLIMB;
+
   // Initialize the parameter values to minimal before tuning.
   for (auto& pair : parameters) {
     pair.second->value = pair.second->min;
@@ -1880,8 +1996,20 @@ void Model::OptimizeHillClimb(std::shared_ptr<Node> snapshot,
     }
     double best_delta = -1.0L;
     Parameter* best_parameter = nullptr;
+    bool parallelism_exhausted = false;
+    if (limit_parallelism) {
+      double total_parallelism = 0;
+      for (auto& pair : parameters) {
+        if (pair.second->name == kParallelism) {
+          total_parallelism += pair.second->value;
+        }
+      }
+      parallelism_exhausted =
+          total_parallelism >= optimization_params.cpu_budget();
+    }
     for (auto& pair : parameters) {
-      if (pair.second->value >= pair.second->max) {
+      if (pair.second->value >= pair.second->max ||
+          (parallelism_exhausted && pair.second->name == kParallelism)) {
         continue;
       }
       pair.second->value++;
@@ -1905,6 +2033,7 @@ void Model::OptimizeHillClimb(std::shared_ptr<Node> snapshot,
     }
     best_parameter->value++;
   }
+  ShrinkBuffers(snapshot, optimization_params.ram_budget(), parameters);
   UpdateStateValues(&parameters);
 }
 
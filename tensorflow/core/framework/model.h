@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 
@@ -109,6 +110,10 @@ std::shared_ptr<Parameter> MakeParameter(const string& name,
                                          std::shared_ptr<SharedState> state,
                                          double min, double max);
 
+// Returns the CPU time consumed by the calling thread in nanoseconds. Falls
+// back to wall-clock time on platforms without a per-thread CPU clock.
+int64 ThreadCpuTimeNanos();
+
 // Abstract representation of a TensorFlow input pipeline node. It collects
 // information about inputs to this node, processing time spent executing the
 // node logic, number of elements produced by the node, various other
@@ -157,6 +162,8 @@ class Node {
         bytes_produced_(0),
         num_elements_(0),
         processing_time_(0),
+        cpu_time_(0),
+        record_cpu_time_(false),
         record_metrics_(true),
         metrics_(name_),
         output_(args.output.get()) {}
@@ -223,6 +230,9 @@ class Node {
     return bytes_produced_;
   }
 
+  // Returns the aggregate thread CPU time.
+  int64 cpu_time() const TF_LOCKS_EXCLUDED(mu_) { return cpu_time_; }
+
   // Indicates whether the node has tunable parameters.
   bool has_tunable_parameters() const TF_LOCKS_EXCLUDED(mu_) {
     tf_shared_lock l(mu_);
@@ -287,6 +297,9 @@ class Node {
   void record_start(int64 time_nanos) TF_LOCKS_EXCLUDED(mu_) {
     DCHECK_EQ(work_start_, 0);
     work_start_ = time_nanos;
+    if (record_cpu_time_) {
+      cpu_work_start_ = ThreadCpuTimeNanos();
+    }
   }
 
   // Records that a node thread has stopped executing.
@@ -295,6 +308,10 @@ class Node {
     if (work_start_ != 0) {
       processing_time_ += time_nanos - work_start_;
       work_start_ = 0;
+      if (record_cpu_time_ && cpu_work_start_ != 0) {
+        cpu_time_ += ThreadCpuTimeNanos() - cpu_work_start_;
+        cpu_work_start_ = 0;
+      }
     } else {
       VLOG(1) << "Encountered a stop event without a matching start event.";
     }
@@ -315,6 +332,14 @@ class Node {
     autotune_.store(autotune);
   }
 
+  // Sets the value that determines whether this node records the CPU time its
+  // threads spend in addition to wall-clock time. A node that records CPU time
+  // reports it as its processing time. Must be set before the node records
+  // any work.
+  void set_record_cpu_time(bool record_cpu_time) TF_LOCKS_EXCLUDED(mu_) {
+    record_cpu_time_.store(record_cpu_time);
+  }
+
   // Given the average time between events when the elements in the buffer are
   // produced (`producer_time`), the average time between events when elements
   // in the buffer are consumed (`consumer_time`) and the buffer size, the
@@ -554,6 +579,11 @@ class Node {
   // to `Node::record_start()` (for any node).
   static thread_local int64 work_start_;  // Will be initialized to zero.
 
+  // Stores the thread CPU time at the last call to `Node::record_start()` on
+  // the current thread, for nodes that record CPU time. Relies on the same
+  // invariant as `work_start_`.
+  static thread_local int64 cpu_work_start_;  // Will be initialized to zero.
+
   mutable mutex mu_;
   const int64 id_;
   const string name_;
@@ -568,6 +598,8 @@ class Node {
   std::atomic<int64> bytes_produced_;
   std::atomic<int64> num_elements_;
   std::atomic<int64> processing_time_;
+  std::atomic<int64> cpu_time_;
+  std::atomic<bool> record_cpu_time_;
   std::atomic<bool> record_metrics_;
   Metrics metrics_;
   absl::flat_hash_map<string, std::shared_ptr<Parameter>> parameters_
@@ -623,6 +655,50 @@ std::shared_ptr<Node> MakeUnknownRatioNode(Node::Args args);
 // as pass-through between inputs and output.
 std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 
+// Shares a RAM budget between the buffers of all autotuned input pipelines of
+// a process. Each owner (a model or a legacy prefetch autotuner) reports the
+// number of bytes its buffers may hold when full, and may only grow into the
+// part of the budget that the other owners leave unused. Owners are expected
+// to shrink their buffers when their allocation exceeds what is available to
+// them, e.g. because another input pipeline has started.
+//
+// This class is thread-safe.
+class RamBudgetManager {
+ public:
+  explicit RamBudgetManager(int64 budget) : RamBudgetManager(budget, false) {}
+
+  // Returns the manager shared by all input pipelines of the process. Its
+  // budget is a fixed share of the RAM available when it is first used, and
+  // its budget and allocations are exported as metrics.
+  static RamBudgetManager* Global();
+
+  int64 budget() const { return budget_; }
+
+  // Returns the number of bytes that the buffers of `owner` may hold, i.e.
+  // the budget minus the allocations of all other owners.
+  int64 AvailableFor(const void* owner) TF_LOCKS_EXCLUDED(mu_);
+
+  // Records that the buffers of `owner` may hold up to `bytes` bytes.
+  void SetAllocation(const void* owner, int64 bytes) TF_LOCKS_EXCLUDED(mu_);
+
+  // Forgets the allocation of `owner`.
+  void RemoveAllocation(const void* owner) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the sum of the allocations of all owners.
+  int64 TotalAllocation() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  RamBudgetManager(int64 budget, bool record_metrics);
+
+  const int64 budget_;
+  const bool record_metrics_;
+  mutex mu_;
+  absl::flat_hash_map<const void*, int64> allocations_ TF_GUARDED_BY(mu_);
+  int64 total_allocation_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RamBudgetManager);
+};
+
 // Abstract representation of a TensorFlow input pipeline that can be used
 // for collecting runtime information and optimizing performance. It collects
 // runtime information about execution of the input pipeline that is used to
@@ -683,11 +759,28 @@ class Model {
       mutex_lock l(*publish_mu());
       (*snapshot_buffers()).erase(this);
     }
+    ram_budget_manager_->RemoveAllocation(this);
   }
 
   // Indicates whether to collect resource usage.
   bool collect_resource_usage() const { return collect_resource_usage_; }
 
+  // Sets the value that determines whether nodes added from now on record the
+  // thread CPU time they spend. This is required by the `CPU_TIME_HILL_CLIMB`
+  // algorithm and should be set before any node is added.
+  void set_record_cpu_time(bool record_cpu_time) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    record_cpu_time_ = record_cpu_time;
+  }
+
+  // Sets the manager of the RAM budget that the buffers of this model share
+  // with other input pipelines. Defaults to `RamBudgetManager::Global()`. The
+  // manager must outlive the model.
+  void set_ram_budget_manager(RamBudgetManager* ram_budget_manager) {
+    ram_budget_manager_->RemoveAllocation(this);
+    ram_budget_manager_ = ram_budget_manager;
+  }
+
   // Returns a pointer to the model's output node.
   const std::shared_ptr<Node> output() {
     mutex_lock l(mu_);
@@ -814,6 +907,12 @@ class Model {
                                const OptimizationParams& optimization_params,
                                CancellationManager* cancellation_manager);
 
+  // Halves the largest tunable buffer size parameters of the given snapshot
+  // until the buffers of its subtree fit into `ram_budget` or all buffer sizes
+  // are at their minimum.
+  void ShrinkBuffers(std::shared_ptr<Node> snapshot, int64 ram_budget,
+                     const ModelParameters& parameters);
+
   // Determines if we should stop the gradient descent optimization iterations
   // based on number of increasable parameters, CPU budget, RAM budget and
   // current resource usage.
@@ -862,6 +961,12 @@ class Model {
   // the parameter) and never stops.
   std::atomic<bool> collect_resource_usage_;
 
+  // Indicates whether nodes added to the model record thread CPU time.
+  bool record_cpu_time_ TF_GUARDED_BY(mu_) = false;
+
+  // Shares the RAM budget of the buffers of this model with other models.
+  RamBudgetManager* ram_budget_manager_ = RamBudgetManager::Global();
+
   // Determines the time the optimization loop should wait between
   // running optimizations.
   int64 optimization_period_ms_ TF_GUARDED_BY(mu_);
@@ -20,6 +20,8 @@ limitations under the License.
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -1168,7 +1170,131 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 }
 
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
-                         ::testing::Values(0, 1));
+                         ::testing::Values(0, 1, 2));
+
+TEST(RamBudgetManagerTest, SharesBudget) {
+  RamBudgetManager ram_budget_manager(/*budget=*/100);
+  int first, second;
+  EXPECT_EQ(ram_budget_manager.AvailableFor(&first), 100);
+  ram_budget_manager.SetAllocation(&first, 60);
+  EXPECT_EQ(ram_budget_manager.AvailableFor(&first), 100);
+  EXPECT_EQ(ram_budget_manager.AvailableFor(&second), 40);
+  ram_budget_manager.SetAllocation(&second, 70);
+  EXPECT_EQ(ram_budget_manager.TotalAllocation(), 130);
+  // An owner over its share is expected to shrink.
+  EXPECT_EQ(ram_budget_manager.AvailableFor(&second), 40);
+  EXPECT_EQ(ram_budget_manager.AvailableFor(&first), 30);
+  ram_budget_manager.RemoveAllocation(&second);
+  EXPECT_EQ(ram_budget_manager.AvailableFor(&first), 100);
+  EXPECT_EQ(ram_budget_manager.TotalAllocation(), 60);
+}
+
+class OptimizeSharedRamBudgetTest
+    : public ::testing::TestWithParam<model::AutotuneAlgorithm> {};
+
+TEST_P(OptimizeSharedRamBudgetTest, Model) {
+  const model::AutotuneAlgorithm algorithm = GetParam();
+
+  std::shared_ptr<mutex> mutex1 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv1 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node1 = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 2,
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex1, cv1),
+                            /*min=*/1, /*max=*/5)});
+  node1->record_buffer_event(100, 1);
+  node1->record_element();
+
+  std::shared_ptr<mutex> mutex2 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv2 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node2 = model::MakeAsyncKnownRatioNode(
+      {2, "2", node1}, 5,
+      {model::MakeParameter("buffer_size",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex2, cv2),
+                            /*min=*/0, /*max=*/6)});
+  node2->record_buffer_event(1, 1);
+  node2->record_element();
+
+  RamBudgetManager ram_budget_manager(/*budget=*/1 << 30);
+  // Another input pipeline holds the entire budget.
+  int other_pipeline;
+  ram_budget_manager.SetAllocation(&other_pipeline, 1 << 30);
+
+  model::Model model;
+  model.set_ram_budget_manager(&ram_budget_manager);
+  model.AddNode([&node1](model::Node::Args args) { return node1; }, "1",
+                nullptr, &node1);
+  model.AddNode([&node2](model::Node::Args args) { return node2; }, "2", node1,
+                &node2);
+
+  CancellationManager cancellation_manager;
+  model.Optimize(algorithm, 40, /*ram_budget=*/1 << 30, 0,
+                 &cancellation_manager);
+  EXPECT_EQ(node1->parameter_value("parallelism"), 1);
+  EXPECT_EQ(node2->parameter_value("buffer_size"), 0);
+  // The model reports the buffers it may hold at its tuned values.
+  EXPECT_EQ(ram_budget_manager.TotalAllocation(), (1 << 30) + 25);
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, OptimizeSharedRamBudgetTest,
+                         ::testing::Values(0, 1, 2));
+
+class OptimizeParallelismWithinCpuBudgetTest
+    : public ::testing::TestWithParam<model::AutotuneAlgorithm> {};
+
+TEST_P(OptimizeParallelismWithinCpuBudgetTest, Model) {
+  const model::AutotuneAlgorithm algorithm = GetParam();
+  const int64 kCpuBudget = 4;
+
+  std::shared_ptr<mutex> mutex1 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv1 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node1 = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 1,
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex1, cv1),
+                            /*min=*/1, /*max=*/16)});
+  node1->add_processing_time(100);
+  node1->record_element();
+
+  std::shared_ptr<mutex> mutex2 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv2 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node2 = model::MakeAsyncKnownRatioNode(
+      {2, "2", node1}, 1,
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex2, cv2),
+                            /*min=*/1, /*max=*/16)});
+  node2->add_processing_time(100);
+  node2->record_element();
+
+  model::Model model;
+  model.AddNode([&node1](model::Node::Args args) { return node1; }, "1",
+                nullptr, &node1);
+  model.AddNode([&node2](model::Node::Args args) { return node2; }, "2", node1,
+                &node2);
+
+  CancellationManager cancellation_manager;
+  model.Optimize(algorithm, kCpuBudget, /*ram_budget=*/1 << 30,
+                 /*model_input_time=*/0, &cancellation_manager);
+  const double total_parallelism =
+      node1->parameter_value("parallelism") +
+      node2->parameter_value("parallelism");
+  if (algorithm == model::AutotuneAlgorithm::CPU_TIME_HILL_CLIMB) {
+    EXPECT_EQ(total_parallelism, kCpuBudget);
+  } else {
+    EXPECT_GT(total_parallelism, kCpuBudget);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, OptimizeParallelismWithinCpuBudgetTest,
+                         ::testing::Values(0, 2));
 
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
@@ -1179,6 +1305,30 @@ TEST(RecordTimeTest, RecordTimeTest) {
   EXPECT_FALSE(source->is_recording());
 }
 
+TEST(RecordTimeTest, RecordCpuTime) {
+  std::shared_ptr<Node> source = model::MakeSourceNode({});
+  source->set_record_cpu_time(true);
+  const int64 kSleepMicros = 50 * 1000;
+  source->record_start(EnvTime::NowNanos());
+  Env::Default()->SleepForMicroseconds(kSleepMicros);
+  source->record_stop(EnvTime::NowNanos());
+  source->record_element();
+  EXPECT_GE(source->processing_time(),
+            kSleepMicros * EnvTime::kMicrosToNanos);
+  // Sleeping does not consume CPU time.
+  EXPECT_LT(source->cpu_time(), source->processing_time());
+  EXPECT_EQ(source->SelfProcessingTime(), source->cpu_time());
+}
+
+TEST(RecordTimeTest, ThreadCpuTimeIsMonotonic) {
+  const int64 start = ThreadCpuTimeNanos();
+  volatile int64 sum = 0;
+  for (int64 i = 0; i < 1000000; ++i) {
+    sum += i;
+  }
+  EXPECT_GT(ThreadCpuTimeNanos(), start);
+}
+
 }  // namespace
 }  // namespace model
 }  // namespace data
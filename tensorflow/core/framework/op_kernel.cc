@@ -344,6 +344,10 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
     CHECK(allocator);
   } else {
     allocator = params_->device->GetAllocator(attr);
+    if (TF_PREDICT_FALSE(params_->step_allocator != nullptr) &&
+        allocator == params_->device->GetAllocator(AllocatorAttributes())) {
+      allocator = params_->step_allocator;
+    }
   }
   if (TF_PREDICT_FALSE(track_allocations())) {
     DCHECK(tracking_state_);
@@ -595,6 +595,10 @@ class OpKernelContext {
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
+    // If not null, serves the allocations of this step that would otherwise
+    // be made from the device's default allocator. Not owned.
+    Allocator* step_allocator = nullptr;
+
     // Shared resources accessible by this op kernel invocation.
     ResourceMgr* resource_manager = nullptr;
 
@@ -47,6 +47,7 @@ Rendezvous::ParsedKey& Rendezvous::ParsedKey::operator=(const ParsedKey& b) {
   dst = b.dst;
   edge_name = StringPiece(buf_.data() + (b.edge_name.data() - b_base),
                           b.edge_name.size());
+  slot = b.slot;
   return *this;
 }
 
@@ -95,6 +96,7 @@ Status Rendezvous::ParseKey(StringPiece key, ParsedKey* out) {
     // for the lifetime of the ParsedKey object.
     out->buf_.assign(key.data(), key.size());
   }
+  out->slot = -1;
   StringPiece s(out->buf_);
   StringPiece parts[5];
   for (int i = 0; i < 5; i++) {
@@ -64,6 +64,13 @@ class RendezvousInterface {
     DeviceNameUtils::ParsedName dst;
     StringPiece edge_name;
 
+    // Rendezvous slot shared by the Send and Recv of this key, or -1 if none
+    // was assigned. Slots are assigned to intra-process Send/Recv pairs at
+    // graph partition time and let LocalRendezvous match the pair without
+    // taking its lock. They are a hint: the full key still identifies the
+    // message. Reset by ParseKey().
+    int64 slot = -1;
+
     ParsedKey() {}
     ParsedKey(const ParsedKey& b) { *this = b; }
 
@@ -97,12 +97,13 @@ string V(const Tensor& tensor) {
   return tensor.scalar<tstring>()();
 }
 
-Rendezvous::ParsedKey MakeKey(const string& name) {
+Rendezvous::ParsedKey MakeKey(const string& name, int64 slot = -1) {
   string s = Rendezvous::CreateKey("/job:mnist/replica:1/task:2/CPU:0", 7890,
                                    "/job:mnist/replica:1/task:2/device:GPU:0",
                                    name, FrameAndIter(0, 0));
   Rendezvous::ParsedKey k;
   TF_EXPECT_OK(Rendezvous::ParseKey(s, &k));
+  k.slot = slot;
   return k;
 }
 
@@ -394,6 +395,108 @@ TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
       errors::IsAborted(rendez_->Recv(KeyFoo(), args, &val, &val_dead)));
 }
 
+TEST_F(LocalRendezvousTest, SlotSendRecv) {
+  const Rendezvous::ParsedKey key = MakeKey("foo", 3);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(key, args, V("hello"), false));
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(key, args, &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+TEST_F(LocalRendezvousTest, SlotRecvSend) {
+  const Rendezvous::ParsedKey key = MakeKey("foo", 3);
+  SchedClosure([this, key]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(key, args, V("hello"), false));
+  });
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Recv(key, args, &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+TEST_F(LocalRendezvousTest, SlotSharedByTwoKeys) {
+  // Slot ids are only unique within one partitioning, so a second key with
+  // the same slot must still be matched.
+  const Rendezvous::ParsedKey key_foo = MakeKey("foo", 0);
+  const Rendezvous::ParsedKey key_bar = MakeKey("bar", 0);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(key_foo, args, V("foo"), false));
+  TF_ASSERT_OK(rendez_->Send(key_bar, args, V("bar"), false));
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(key_bar, args, &val, &is_dead));
+  EXPECT_EQ("bar", V(val));
+  TF_ASSERT_OK(rendez_->Recv(key_foo, args, &val, &is_dead));
+  EXPECT_EQ("foo", V(val));
+}
+
+TEST_F(LocalRendezvousTest, SlotMultiSends) {
+  // Messages that do not fit in the slot are matched in order.
+  static const int N = 100;
+  const Rendezvous::ParsedKey key = MakeKey("foo", 1);
+  Rendezvous::Args args;
+  SchedClosure([=]() {
+    for (int i = 0; i < N; ++i) {
+      TF_ASSERT_OK(rendez_->Send(key, args, V(strings::StrCat(i)), false));
+      RandomSleep();
+    }
+  });
+  Tensor val;
+  bool val_dead;
+  for (int i = 0; i < N; ++i) {
+    TF_ASSERT_OK(rendez_->Recv(key, args, &val, &val_dead));
+    EXPECT_EQ(strings::StrCat(i), V(val));
+    RandomSleep();
+  }
+}
+
+TEST_F(LocalRendezvousTest, SlotCancelAfterRecv) {
+  const Rendezvous::ParsedKey key = MakeKey("foo", 2);
+  auto* cm = new CancellationManager();
+  Notification n;
+  SchedClosure([cm, &n]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    cm->StartCancel();
+    n.Notify();
+  });
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  Rendezvous::Args args;
+  args.cancellation_manager = cm;
+  auto s = rendez_->Recv(key, args, &val, &is_dead);
+  EXPECT_TRUE(errors::IsCancelled(s));
+  EXPECT_EQ("[_Derived_]RecvAsync is cancelled.", s.error_message());
+  n.WaitForNotification();
+  delete cm;
+
+  // Later messages under the key are still delivered.
+  args.cancellation_manager = nullptr;
+  TF_ASSERT_OK(rendez_->Send(key, args, V("hello"), false));
+  TF_ASSERT_OK(rendez_->Recv(key, args, &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+TEST_F(LocalRendezvousTest, SlotRecvAbort) {
+  const Rendezvous::ParsedKey key = MakeKey("foo", 2);
+  rendez_->Ref();
+  SchedClosure([this]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    rendez_->StartAbort(errors::Aborted(""));  // abort
+    rendez_->Unref();
+  });
+  Tensor val(DT_STRING);
+  bool val_dead = false;
+  Rendezvous::Args args;
+  Status status = rendez_->Recv(key, args, &val, &val_dead);
+  EXPECT_TRUE(errors::IsAborted(status));
+  EXPECT_TRUE(errors::IsAborted(rendez_->Send(key, args, val, val_dead)));
+}
+
 class DummyDeviceContext : public DeviceContext {
  public:
   explicit DummyDeviceContext(int stream_id) : stream_id_(stream_id) {}
@@ -478,6 +581,35 @@ void BM_RecvSend(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_RecvSend);
 
+// Sends and receives `num_keys` tensors per step, with or without rendezvous
+// slots, on a new rendezvous for every step.
+void BM_StepSendRecv(::testing::benchmark::State& state) {
+  const bool use_slots = state.range(0);
+  const int num_keys = state.range(1);
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < num_keys; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("edge_", i), use_slots ? i : -1));
+  }
+  Tensor orig = V("val");
+  Tensor val(DT_STRING, TensorShape({}));
+  bool is_dead = false;
+  Rendezvous::Args args;
+
+  for (auto s : state) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    for (const auto& key : keys) {
+      TF_CHECK_OK(rendez->Send(key, args, orig, is_dead));
+    }
+    for (const auto& key : keys) {
+      TF_CHECK_OK(rendez->Recv(key, args, &val, &is_dead));
+    }
+    rendez->Unref();
+  }
+  CHECK_EQ(V(val), V(orig));
+  state.SetItemsProcessed(num_keys * state.iterations());
+}
+BENCHMARK(BM_StepSendRecv)->ArgPair(0, 64)->ArgPair(1, 64);
+
 void BM_PingPong(::testing::benchmark::State& state) {
   const int messages_count = state.range(0);
   auto* cm = new CancellationManager();
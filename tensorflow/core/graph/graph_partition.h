@@ -76,6 +76,12 @@ struct PartitionOptions {
   // in the graph as a node attribute.
   bool need_to_record_start_times = false;
   std::vector<Microseconds> start_times;
+
+  // If true, each Send/Recv pair whose devices share an address space gets a
+  // "_rendezvous_slot" attr with an id that is unique within this partitioning,
+  // which lets LocalRendezvous match the pair without a lock. Only set this
+  // when the partitions exchange tensors through a LocalRendezvous.
+  bool assign_rendezvous_slots = false;
 };
 
 // Partition "input" graph into a set of graphs, one per location.
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <map>
+#include <set>
 #include <unordered_map>
 #include <utility>
 
@@ -74,7 +76,8 @@ string DeviceName(const Node* node) {
 }
 
 void Partition(const GraphDef& graph_def,
-               std::unordered_map<string, GraphDef>* partitions) {
+               std::unordered_map<string, GraphDef>* partitions,
+               bool assign_rendezvous_slots = false) {
   Graph g(OpRegistry::Global());
   GraphConstructorOptions opts;
   TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &g));
@@ -94,6 +97,7 @@ void Partition(const GraphDef& graph_def,
   popts.get_incarnation = [](const string& name) {
     return (name[0] - 'A') + 100;
   };
+  popts.assign_rendezvous_slots = assign_rendezvous_slots;
   Status s = Partition(popts, &g, partitions);
   CHECK(s.ok()) << s;
 
@@ -522,6 +526,42 @@ TEST_F(GraphPartitionTest, SetIncarnation) {
   }
 }
 
+TEST_F(GraphPartitionTest, AssignRendezvousSlots) {
+  auto a1 = FloatInput(in_.WithOpName("A1"));
+  auto b1 = FloatInput(in_.WithOpName("B1"));
+  auto c1 = FloatInput(
+      in_.WithOpName("C1").WithDevice("/job:a/replica:0/task:1/cpu:0"));
+  Combine(in_.WithOpName("A2"), b1, b1);
+  Combine(in_.WithOpName("B2"), a1, c1);
+
+  Partition(ToGraphDef(), &partitions_, /*assign_rendezvous_slots=*/true);
+  EXPECT_EQ(3, partitions_.size());
+
+  // Both nodes of a pair share a slot, and pairs that cross tasks have none.
+  std::map<string, std::vector<int64>> slots;
+  for (const auto& kv : partitions_) {
+    for (const NodeDef& ndef : kv.second.node()) {
+      if (ndef.op() != "_Send" && ndef.op() != "_Recv") continue;
+      string tensor_name;
+      TF_ASSERT_OK(GetNodeAttr(ndef, "tensor_name", &tensor_name));
+      int64 slot;
+      if (GetNodeAttr(ndef, "_rendezvous_slot", &slot).ok()) {
+        slots[tensor_name].push_back(slot);
+      } else {
+        EXPECT_TRUE(absl::StrContains(tensor_name, "C1")) << tensor_name;
+      }
+    }
+  }
+  ASSERT_EQ(2, slots.size());
+  std::set<int64> distinct;
+  for (const auto& kv : slots) {
+    ASSERT_EQ(2, kv.second.size());
+    EXPECT_EQ(kv.second[0], kv.second[1]);
+    distinct.insert(kv.second[0]);
+  }
+  EXPECT_EQ(std::set<int64>({0, 1}), distinct);
+}
+
 TEST(TopologicalSortNodesWithTimePriorityTest, NoDependencies) {
   // Create placeholders, shuffle them so the order in the graph is not strictly
   // increasing.
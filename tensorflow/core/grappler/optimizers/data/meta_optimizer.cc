@@ -35,7 +35,7 @@ using ConfigMap =
     std::map<string, tensorflow::RewriterConfig_CustomGraphOptimizer>;
 
 // tf.data optimizations, in the order we want to perform them.
-constexpr std::array<const char*, 16> kTFDataOptimizations = {
+constexpr std::array<const char*, 17> kTFDataOptimizations = {
     "noop_elimination",
     "disable_intra_op_parallelism",
     "use_private_thread_pool",
@@ -44,6 +44,7 @@ constexpr std::array<const char*, 16> kTFDataOptimizations = {
     "filter_fusion",
     "map_and_filter_fusion",
     "map_parallelization",
+    "parse_example_vectorization",
     "map_and_batch_fusion",
     "batch_parallelization",
     "make_sloppy",
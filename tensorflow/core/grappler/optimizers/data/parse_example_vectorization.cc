@@ -0,0 +1,443 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/parse_example_vectorization.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+constexpr char kMapAndBatchDataset[] = "MapAndBatchDataset";
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDataset[] = "ParallelMapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+constexpr char kParseExampleDataset[] = "ParseExampleDatasetV2";
+constexpr char kParseExampleV2[] = "ParseExampleV2";
+constexpr char kParseSingleExample[] = "ParseSingleExample";
+
+// The dense features parsed by a map function that can be vectorized.
+struct ParseExampleFunction {
+  std::vector<string> dense_keys;
+  // The Const nodes of the function that hold the default values.
+  std::vector<const NodeDef*> dense_defaults;
+  AttrValue dense_types;
+  AttrValue dense_shapes;
+};
+
+// Follows `ref`, a tensor reference local to `function`, through Identity
+// nodes.
+string SkipIdentities(const FunctionDef& function, string ref) {
+  while (true) {
+    std::vector<string> parts = absl::StrSplit(ref, ':');
+    if (parts.size() < 2) return ref;
+    int index = function_utils::FindFunctionNodeWithName(parts[0], function);
+    if (index < 0) return ref;
+    const NodeDef& node = function.node_def(index);
+    if (node.op() != "Identity" || node.input_size() < 1) return ref;
+    ref = node.input(0);
+  }
+}
+
+// Returns the function node that produces the tensor `ref` refers to, and
+// stores the name and index of the output in `*output_name` and
+// `*output_index`. Returns nullptr if `ref` does not refer to a node output.
+const NodeDef* FindOutputNode(const FunctionDef& function, const string& ref,
+                              string* output_name, int* output_index) {
+  // References have the form "node:output_name[:output_index]".
+  std::vector<string> parts =
+      absl::StrSplit(SkipIdentities(function, ref), ':');
+  *output_index = 0;
+  if (parts.size() < 2 || parts.size() > 3 ||
+      (parts.size() == 3 && !absl::SimpleAtoi(parts[2], output_index))) {
+    return nullptr;
+  }
+  int index = function_utils::FindFunctionNodeWithName(parts[0], function);
+  if (index < 0) return nullptr;
+  *output_name = parts[1];
+  return &function.node_def(index);
+}
+
+// Returns the Const node of `function` that `ref` refers to, or nullptr.
+const NodeDef* FindConstNode(const FunctionDef& function, const string& ref) {
+  string output_name;
+  int output_index;
+  const NodeDef* node =
+      FindOutputNode(function, ref, &output_name, &output_index);
+  if (node == nullptr || !IsConstant(*node) || output_index != 0) {
+    return nullptr;
+  }
+  return node;
+}
+
+// Stores the elements of the string tensor held by the Const node `node` in
+// `*values`.
+bool GetStringConstant(const NodeDef* node, std::vector<string>* values) {
+  if (node == nullptr) return false;
+  Tensor tensor;
+  if (!tensor.FromProto(node->attr().at("value").tensor()) ||
+      tensor.dtype() != DT_STRING) {
+    return false;
+  }
+  values->clear();
+  for (int64 i = 0; i < tensor.NumElements(); ++i) {
+    values->push_back(tensor.flat<tstring>()(i));
+  }
+  return true;
+}
+
+// Returns true if `function` only parses its single argument with
+// ParseExampleV2 or ParseSingleExample and returns all parsed features, which
+// must be dense and have fully defined shapes, in the order in which
+// ParseExampleDataset emits them (sorted by key). Fills in `*parse`.
+bool MatchParseExampleFunction(const FunctionLibraryDefinition& library,
+                               const FunctionDef& function,
+                               ParseExampleFunction* parse) {
+  const OpDef& signature = function.signature();
+  if (signature.input_arg_size() != 1 ||
+      signature.input_arg(0).type() != DT_STRING ||
+      signature.output_arg_size() == 0 || !function.control_ret().empty() ||
+      function_utils::IsFunctionStateful(library, function, true)) {
+    return false;
+  }
+
+  // Each output must be a different dense output of the same parse node.
+  const NodeDef* parse_node = nullptr;
+  std::vector<int> output_indices;
+  for (const auto& output_arg : signature.output_arg()) {
+    auto it = function.ret().find(output_arg.name());
+    if (it == function.ret().end()) return false;
+    string output_name;
+    int output_index;
+    const NodeDef* node =
+        FindOutputNode(function, it->second, &output_name, &output_index);
+    if (node == nullptr || output_name != "dense_values" ||
+        (parse_node != nullptr && node != parse_node)) {
+      return false;
+    }
+    parse_node = node;
+    output_indices.push_back(output_index);
+  }
+
+  const bool is_v2 = parse_node->op() == kParseExampleV2;
+  if (!is_v2 && parse_node->op() != kParseSingleExample) return false;
+  const auto& attrs = parse_node->attr();
+  if (attrs.at("num_sparse").i() != 0) return false;
+  if (is_v2 && attrs.at("ragged_value_types").list().type_size() != 0) {
+    return false;
+  }
+  parse->dense_types = attrs.at("Tdense");
+  parse->dense_shapes = attrs.at("dense_shapes");
+  const int num_dense = parse->dense_types.list().type_size();
+  if (num_dense != output_indices.size()) return false;
+  for (const auto& shape : parse->dense_shapes.list().shape()) {
+    if (!PartialTensorShape(shape).IsFullyDefined()) return false;
+  }
+
+  // The parsed examples must be the function argument.
+  if (SkipIdentities(function, parse_node->input(0)) !=
+      signature.input_arg(0).name()) {
+    return false;
+  }
+
+  // Input 1 of ParseExampleV2 holds names that are only used in error
+  // messages, so it is dropped.
+  const int first_default = is_v2 ? 5 : 1;
+  if (parse_node->input_size() < first_default + num_dense) return false;
+  if (is_v2) {
+    std::vector<string> keys;
+    if (!GetStringConstant(FindConstNode(function, parse_node->input(2)),
+                           &keys) ||
+        !keys.empty() ||
+        !GetStringConstant(FindConstNode(function, parse_node->input(4)),
+                           &keys) ||
+        !keys.empty() ||
+        !GetStringConstant(FindConstNode(function, parse_node->input(3)),
+                           &parse->dense_keys)) {
+      return false;
+    }
+  } else {
+    parse->dense_keys.clear();
+    for (const auto& key : attrs.at("dense_keys").list().s()) {
+      parse->dense_keys.push_back(key);
+    }
+  }
+  if (parse->dense_keys.size() != num_dense) return false;
+
+  parse->dense_defaults.clear();
+  for (int i = 0; i < num_dense; ++i) {
+    const NodeDef* node =
+        FindConstNode(function, parse_node->input(first_default + i));
+    if (node == nullptr) return false;
+    parse->dense_defaults.push_back(node);
+  }
+
+  // The outputs must be sorted by key, which also rules out duplicates.
+  for (int i = 0; i < output_indices.size(); ++i) {
+    if (output_indices[i] < 0 || output_indices[i] >= num_dense) return false;
+    if (i > 0 && parse->dense_keys[output_indices[i - 1]] >=
+                     parse->dense_keys[output_indices[i]]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Stores the shape of the elements of the dataset produced by `input_node` in
+// `*element_shape`. Returns false if the dataset does not produce a single
+// component or its shape is unknown.
+bool GetElementShape(const NodeDef& input_node,
+                     PartialTensorShape* element_shape) {
+  if (const AttrValue* shapes =
+          gtl::FindOrNull(input_node.attr(), "output_shapes")) {
+    if (shapes->list().shape_size() != 1 ||
+        shapes->list().shape(0).unknown_rank()) {
+      return false;
+    }
+    *element_shape = PartialTensorShape(shapes->list().shape(0));
+    return true;
+  }
+  // The record datasets produce scalar strings but have no `output_shapes`
+  // attr.
+  for (const char* op :
+       {"FixedLengthRecordDataset", "FixedLengthRecordDatasetV2",
+        "RandomAccessTFRecordDataset", "TextLineDataset", "TFRecordDataset"}) {
+    if (input_node.op() == op) {
+      *element_shape = PartialTensorShape({});
+      return true;
+    }
+  }
+  return false;
+}
+
+// Adds a copy of the Const node `node` of a function to `graph`.
+NodeDef* AddConstNode(const NodeDef& node, MutableGraphView* graph) {
+  NodeDef const_node;
+  const_node.set_op(node.op());
+  graph_utils::SetUniqueGraphNodeName(node.op(), graph->graph(), &const_node);
+  for (auto key : {"dtype", "value"}) {
+    graph_utils::CopyAttribute(key, node, &const_node);
+  }
+  return graph->AddNode(std::move(const_node));
+}
+
+// Adds a BatchDatasetV2 node that batches the serialized examples.
+NodeDef* AddBatchNode(const string& input,
+                      const PartialTensorShape& element_shape,
+                      const string& batch_size, const string& drop_remainder,
+                      const NodeDef& original_batch_node,
+                      MutableGraphView* graph) {
+  NodeDef batch_node;
+  batch_node.set_op(kBatchDatasetV2);
+  graph_utils::SetUniqueGraphNodeName(kBatchDatasetV2, graph->graph(),
+                                      &batch_node);
+  batch_node.add_input(input);
+  batch_node.add_input(batch_size);
+  batch_node.add_input(drop_remainder);
+
+  // The batch dimension is the same as that of the original outputs.
+  int64 batch_dim = -1;
+  const auto& shapes = original_batch_node.attr().at("output_shapes").list();
+  if (shapes.shape_size() > 0 && !shapes.shape(0).unknown_rank() &&
+      shapes.shape(0).dim_size() > 0) {
+    batch_dim = shapes.shape(0).dim(0).size();
+  }
+  PartialTensorShape shape =
+      PartialTensorShape({batch_dim}).Concatenate(element_shape);
+  AddNodeAttr("output_shapes", gtl::ArraySlice<PartialTensorShape>{shape},
+              &batch_node);
+  AddNodeAttr("output_types", gtl::ArraySlice<DataType>{DT_STRING},
+              &batch_node);
+  AddNodeAttr("parallel_copy", false, &batch_node);
+  return graph->AddNode(std::move(batch_node));
+}
+
+// Adds a ParseExampleDatasetV2 node that parses the batches produced by
+// `input`.
+NodeDef* AddParseExampleNode(const string& input,
+                             const string& num_parallel_calls,
+                             const string& deterministic,
+                             const ParseExampleFunction& parse,
+                             const NodeDef& original_batch_node,
+                             MutableGraphView* graph) {
+  NodeDef parse_node;
+  parse_node.set_op(kParseExampleDataset);
+  graph_utils::SetUniqueGraphNodeName(kParseExampleDataset, graph->graph(),
+                                      &parse_node);
+  parse_node.add_input(input);
+  parse_node.add_input(num_parallel_calls);
+  for (const NodeDef* dense_default : parse.dense_defaults) {
+    parse_node.add_input(AddConstNode(*dense_default, graph)->name());
+  }
+  AddNodeAttr("sparse_keys", gtl::ArraySlice<string>{}, &parse_node);
+  AddNodeAttr("dense_keys", parse.dense_keys, &parse_node);
+  AddNodeAttr("sparse_types", gtl::ArraySlice<DataType>{}, &parse_node);
+  (*parse_node.mutable_attr())["Tdense"] = parse.dense_types;
+  (*parse_node.mutable_attr())["dense_shapes"] = parse.dense_shapes;
+  for (auto key : {"output_shapes", "output_types"}) {
+    graph_utils::CopyAttribute(key, original_batch_node, &parse_node);
+  }
+  AddNodeAttr("deterministic", deterministic, &parse_node);
+  AddNodeAttr("ragged_keys", gtl::ArraySlice<string>{}, &parse_node);
+  AddNodeAttr("ragged_value_types", gtl::ArraySlice<DataType>{},
+              &parse_node);
+  AddNodeAttr("ragged_split_types", gtl::ArraySlice<DataType>{},
+              &parse_node);
+  return graph->AddNode(std::move(parse_node));
+}
+
+bool HasOtherArguments(const NodeDef& map_node) {
+  return map_node.attr().at("Targuments").list().type_size() != 0;
+}
+
+}  // namespace
+
+Status ParseExampleVectorization::OptimizeAndCollectStats(
+    Cluster* cluster, const GrapplerItem& item, GraphDef* output,
+    OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& node : item.graph.node()) {
+    // The map node is the batch node in the case of MapAndBatchDataset.
+    const NodeDef* map_node;
+    if (node.op() == kMapAndBatchDataset) {
+      map_node = &node;
+    } else if (node.op() == kBatchDataset || node.op() == kBatchDatasetV2) {
+      map_node = graph_utils::GetInputNode(node, graph);
+      if (map_node == nullptr ||
+          (map_node->op() != kMapDataset &&
+           map_node->op() != kParallelMapDataset &&
+           map_node->op() != kParallelMapDatasetV2)) {
+        continue;
+      }
+    } else {
+      continue;
+    }
+    const NodeDef& batch_node = node;
+    if (HasOtherArguments(*map_node)) continue;
+    // The map node is deleted, so the batch node must be its only consumer.
+    if (map_node != &batch_node &&
+        graph.NumFanouts(*map_node, /*include_controlled_nodes=*/true) != 1) {
+      continue;
+    }
+    // ParseExampleDataset parses one example per element, so the map function
+    // must be applied to scalars. Otherwise batching the map input would
+    // produce batches of `batch_size` times as many examples.
+    const NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+    PartialTensorShape element_shape;
+    if (input_node == nullptr ||
+        !GetElementShape(*input_node, &element_shape) ||
+        element_shape.dims() != 0) {
+      continue;
+    }
+    // ParallelMapDataset takes an int32 `num_parallel_calls`, whereas
+    // ParseExampleDatasetV2 takes an int64, so it must be a constant.
+    const NodeDef* parallel_map_calls = nullptr;
+    if (map_node->op() == kParallelMapDataset) {
+      parallel_map_calls = graph.GetNode(map_node->input(1));
+      if (parallel_map_calls == nullptr || !IsConstant(*parallel_map_calls)) {
+        continue;
+      }
+    }
+
+    const FunctionDef* function =
+        function_library.Find(map_node->attr().at("f").func().name());
+    ParseExampleFunction parse;
+    if (function == nullptr ||
+        !MatchParseExampleFunction(function_library, *function, &parse)) {
+      continue;
+    }
+
+    // Determine the batch size, drop_remainder, parallelism and determinism
+    // of the fused transformation.
+    string batch_size = batch_node.input(1);
+    string drop_remainder;
+    string num_parallel_calls;
+    string deterministic = "default";
+    if (batch_node.op() == kMapAndBatchDataset) {
+      num_parallel_calls = batch_node.input(2);
+      drop_remainder = batch_node.input(3);
+    } else {
+      drop_remainder =
+          batch_node.op() == kBatchDatasetV2
+              ? batch_node.input(2)
+              : graph_utils::AddScalarConstNode<bool>(false, &graph)->name();
+      if (map_node->op() == kParallelMapDatasetV2) {
+        num_parallel_calls = map_node->input(1);
+      } else if (parallel_map_calls != nullptr) {
+        num_parallel_calls =
+            graph_utils::AddScalarConstNode<int64>(
+                parallel_map_calls->attr().at("value").tensor().int_val(0),
+                &graph)
+                ->name();
+      } else {
+        num_parallel_calls =
+            graph_utils::AddScalarConstNode<int64>(1, &graph)->name();
+      }
+      if (const AttrValue* attr =
+              gtl::FindOrNull(map_node->attr(), "deterministic")) {
+        deterministic = attr->s();
+      } else if (const AttrValue* attr =
+                     gtl::FindOrNull(map_node->attr(), "sloppy")) {
+        if (attr->b()) deterministic = "false";
+      }
+    }
+
+    NodeDef* new_batch_node =
+        AddBatchNode(map_node->input(0), element_shape, batch_size,
+                     drop_remainder, batch_node, &graph);
+    NodeDef* parse_node =
+        AddParseExampleNode(new_batch_node->name(), num_parallel_calls,
+                            deterministic, parse, batch_node, &graph);
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(batch_node.name(), parse_node->name()));
+
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return Status::OK();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(ParseExampleVectorization,
+                            "parse_example_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
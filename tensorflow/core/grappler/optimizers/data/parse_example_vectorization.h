@@ -0,0 +1,56 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PARSE_EXAMPLE_VECTORIZATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PARSE_EXAMPLE_VECTORIZATION_H_
+
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// This optimization replaces a map transformation whose function only parses
+// its input with `parse_single_example`, followed by a batch transformation,
+// with a batch of the serialized examples followed by a ParseExampleDataset.
+// The whole batch is then parsed by a single, multi-threaded
+// FastParseExample call that writes directly into the batched output tensors,
+// instead of producing per-example tensors that are copied into the batch.
+//
+// Only functions whose outputs are exactly the dense features of the parse,
+// with fully defined shapes, are rewritten, so that the result is the same
+// with and without the optimization.
+class ParseExampleVectorization : public TFDataOptimizerBase {
+ public:
+  ParseExampleVectorization() = default;
+  ~ParseExampleVectorization() override = default;
+
+  string name() const override { return "parse_example_vectorization"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return Status::OK();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PARSE_EXAMPLE_VECTORIZATION_H_
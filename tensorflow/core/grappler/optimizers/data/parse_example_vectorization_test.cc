@@ -0,0 +1,238 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/parse_example_vectorization.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeBatchV2Node;
+using graph_tests_utils::MakeMapAndBatchNode;
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+
+constexpr char kFunctionName[] = "ParseFeatures";
+constexpr char kParseExampleDataset[] = "ParseExampleDatasetV2";
+
+// Returns a function that parses features "a" (int64) and "b" (float[2]) with
+// ParseSingleExample and returns the features named in `outputs`, in order.
+// `b_shape` is the shape of feature "b".
+FunctionDef ParseFeatures(const std::vector<string>& outputs,
+                          const PartialTensorShape& b_shape = {2}) {
+  std::vector<string> out_def;
+  std::vector<std::pair<string, string>> ret_def;
+  for (const string& output : outputs) {
+    out_def.push_back(
+        strings::StrCat(output, ": ", output == "a" ? "int64" : "float"));
+    ret_def.emplace_back(
+        output, strings::StrCat("parse:dense_values:", output == "a" ? 0 : 1));
+  }
+  return FunctionDefHelper::Create(
+      kFunctionName, {"serialized: string"}, out_def, {},
+      {{{"default_a"},
+        "Const",
+        {},
+        {{"value", test::AsScalar<int64>(0)}, {"dtype", DT_INT64}}},
+       {{"default_b"},
+        "Const",
+        {},
+        {{"value", test::AsTensor<float>({})}, {"dtype", DT_FLOAT}}},
+       {{"parse"},
+        "ParseSingleExample",
+        {"serialized", "default_a:output:0", "default_b:output:0"},
+        {{"num_sparse", 0},
+         {"sparse_keys", gtl::ArraySlice<string>{}},
+         {"dense_keys", gtl::ArraySlice<string>{"a", "b"}},
+         {"sparse_types", gtl::ArraySlice<DataType>{}},
+         {"Tdense", gtl::ArraySlice<DataType>{DT_INT64, DT_FLOAT}},
+         {"dense_shapes",
+          gtl::ArraySlice<PartialTensorShape>{PartialTensorShape({}),
+                                              b_shape}}}}},
+      ret_def);
+}
+
+GrapplerItem MakeMapAndBatchItem(const FunctionDef& function) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("filenames", "Const", {},
+            {{"value", test::AsScalar<tstring>("file")}, {"dtype", DT_STRING}}),
+       NDef("records", "TFRecordDataset", {"filenames"}, {}),
+       MakeMapNode("map", "records", kFunctionName),
+       NDef("batch_size", "Const", {}, {{"value", 4}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", true}, {"dtype", DT_BOOL}}),
+       MakeBatchV2Node("batch", "map", "batch_size", "drop_remainder",
+                       /*parallel_copy=*/false),
+       NDef("Sink", "Identity", {"batch"}, {})},
+      {function});
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+TEST(ParseExampleVectorizationTest, MapAndBatch) {
+  GrapplerItem item = MakeMapAndBatchItem(ParseFeatures({"a", "b"}));
+  ParseExampleVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  ASSERT_TRUE(graph_utils::ContainsNodeWithOp(kParseExampleDataset, output));
+  const NodeDef& parse_node = output.node(
+      graph_utils::FindGraphNodeWithOp(kParseExampleDataset, output));
+  const NodeDef& batch_node =
+      output.node(graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  const NodeDef& sink_node =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  EXPECT_EQ(sink_node.input(0), parse_node.name());
+  EXPECT_EQ(parse_node.input(0), batch_node.name());
+  ASSERT_EQ(parse_node.input_size(), 4);
+  EXPECT_EQ(batch_node.input(0), "records");
+  EXPECT_EQ(batch_node.input(1), "batch_size");
+  EXPECT_EQ(batch_node.input(2), "drop_remainder");
+  const auto& batch_shapes = batch_node.attr().at("output_shapes").list();
+  ASSERT_EQ(batch_shapes.shape_size(), 1);
+  EXPECT_TRUE(PartialTensorShape(batch_shapes.shape(0))
+                  .IsIdenticalTo(PartialTensorShape({-1})));
+
+  const auto& dense_keys = parse_node.attr().at("dense_keys").list();
+  ASSERT_EQ(dense_keys.s_size(), 2);
+  EXPECT_EQ(dense_keys.s(0), "a");
+  EXPECT_EQ(dense_keys.s(1), "b");
+  const NodeDef& default_b =
+      output.node(graph_utils::FindGraphNodeWithName(parse_node.input(3),
+                                                     output));
+  EXPECT_EQ(default_b.op(), "Const");
+  EXPECT_EQ(default_b.attr().at("dtype").type(), DT_FLOAT);
+}
+
+TEST(ParseExampleVectorizationTest, FusedMapAndBatch) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("filenames", "Const", {},
+            {{"value", test::AsScalar<tstring>("file")}, {"dtype", DT_STRING}}),
+       NDef("records", "TFRecordDataset", {"filenames"}, {}),
+       NDef("batch_size", "Const", {}, {{"value", 4}, {"dtype", DT_INT64}}),
+       NDef("num_parallel_calls", "Const", {},
+            {{"value", 2}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       MakeMapAndBatchNode("map_and_batch", "records", "batch_size",
+                           "num_parallel_calls", "drop_remainder",
+                           kFunctionName),
+       NDef("Sink", "Identity", {"map_and_batch"}, {})},
+      {ParseFeatures({"a", "b"})});
+  item.fetch.push_back("Sink");
+
+  ParseExampleVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map_and_batch", output));
+  ASSERT_TRUE(graph_utils::ContainsNodeWithOp(kParseExampleDataset, output));
+  const NodeDef& parse_node = output.node(
+      graph_utils::FindGraphNodeWithOp(kParseExampleDataset, output));
+  EXPECT_EQ(parse_node.input(1), "num_parallel_calls");
+}
+
+TEST(ParseExampleVectorizationTest, UnsortedOutputs) {
+  GrapplerItem item = MakeMapAndBatchItem(ParseFeatures({"b", "a"}));
+  ParseExampleVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp(kParseExampleDataset, output));
+}
+
+TEST(ParseExampleVectorizationTest, SubsetOfFeatures) {
+  GrapplerItem item = MakeMapAndBatchItem(ParseFeatures({"a"}));
+  ParseExampleVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp(kParseExampleDataset, output));
+}
+
+TEST(ParseExampleVectorizationTest, VariableLengthFeature) {
+  GrapplerItem item =
+      MakeMapAndBatchItem(ParseFeatures({"a", "b"}, PartialTensorShape({-1})));
+  ParseExampleVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp(kParseExampleDataset, output));
+}
+
+TEST(ParseExampleVectorizationTest, VectorElements) {
+  // Equivalent to `ds.batch(2).map(parse_example).batch(4)`, which must not be
+  // rewritten to parse batches of 4 examples.
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("filenames", "Const", {},
+            {{"value", test::AsScalar<tstring>("file")}, {"dtype", DT_STRING}}),
+       NDef("records", "TFRecordDataset", {"filenames"}, {}),
+       NDef("record_batch_size", "Const", {},
+            {{"value", 2}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", true}, {"dtype", DT_BOOL}}),
+       NDef("record_batch", "BatchDatasetV2",
+            {"records", "record_batch_size", "drop_remainder"},
+            {{"parallel_copy", false},
+             {"output_shapes",
+              gtl::ArraySlice<PartialTensorShape>{PartialTensorShape({2})}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_STRING}}}),
+       MakeMapNode("map", "record_batch", kFunctionName),
+       NDef("batch_size", "Const", {}, {{"value", 4}, {"dtype", DT_INT64}}),
+       MakeBatchV2Node("batch", "map", "batch_size", "drop_remainder",
+                       /*parallel_copy=*/false),
+       NDef("Sink", "Identity", {"batch"}, {})},
+      {ParseFeatures({"a", "b"})});
+  item.fetch.push_back("Sink");
+
+  ParseExampleVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp(kParseExampleDataset, output));
+}
+
+TEST(ParseExampleVectorizationTest, MapWithOtherConsumers) {
+  // The map node also feeds another dataset, so it must be kept.
+  GrapplerItem item = MakeMapAndBatchItem(ParseFeatures({"a", "b"}));
+  *item.graph.add_node() = NDef("other_sink", "Identity", {"map"}, {});
+  item.fetch.push_back("other_sink");
+
+  ParseExampleVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp(kParseExampleDataset, output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -17,17 +17,27 @@ limitations under the License.
 #include <string>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/stats_utils.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/stats_aggregator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -41,6 +51,9 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kMemoryMapped;
+/* static */ constexpr const char* const CacheDatasetOp::kMemoryBudget;
+/* static */ constexpr const char* const CacheDatasetOp::kSpillDirectory;
 
 namespace {
 
@@ -65,16 +78,54 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+constexpr char kMemoryMappedAllocatorName[] = "CacheMemoryMapped";
+constexpr char kMemoryTier[] = "memory";
+constexpr char kDiskTier[] = "disk";
+
+// When reading a memory-mapped cache, the reader faults in the next
+// `kReadaheadBytes` of a shard ahead of time by touching one byte every
+// `kReadaheadStride` bytes.
+constexpr uint64 kReadaheadBytes = 16 << 20;  // 16 MB
+constexpr uint64 kReadaheadStride = 4 << 10;  // 4 KB
+
+// A `TensorBuffer` that aliases a region of a memory-mapped cache file. Every
+// buffer holds a reference to the mapping, which therefore stays valid for as
+// long as any tensor produced from it is alive.
+class MemoryMappedTensorBuffer : public TensorBuffer {
+ public:
+  MemoryMappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                           const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64>(size_));
+    proto->set_allocator_name(kMemoryMappedAllocatorName);
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
 
 }  // namespace
 
 class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  public:
   FileDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                  string filename, Env* env)
+                  string filename, Env* env, bool memory_mapped)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         filename_(std::move(filename)),
+        memory_mapped_(memory_mapped),
         env_(env),
         num_tensors_(input->output_dtypes().size()),
         tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
@@ -122,8 +173,23 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
   }
 
  protected:
+  // Returns the attrs to serialize. `memory_mapped` is only added when set, so
+  // that graphs of datasets that don't use it can be loaded by binaries that
+  // predate the attr.
+  std::vector<std::pair<StringPiece, AttrValue>> GraphDefAttrs(
+      DatasetGraphDefBuilder* b) const {
+    std::vector<std::pair<StringPiece, AttrValue>> attrs;
+    if (memory_mapped_) {
+      AttrValue memory_mapped;
+      b->BuildAttrValue(memory_mapped_, &memory_mapped);
+      attrs.emplace_back(kMemoryMapped, memory_mapped);
+    }
+    return attrs;
+  }
+
   const DatasetBase* const input_;
   const tstring filename_;
+  const bool memory_mapped_;
 
  private:
   static size_t StringPaddingSize(size_t num_tensors) {
@@ -135,6 +201,16 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
                            tensor_index);
   }
 
+  BundleWriter::Options WriterOptions() const {
+    BundleWriter::Options options;
+    if (memory_mapped_) {
+      // Aligning the tensor data in the cache files to the allocator alignment
+      // lets readers hand out tensors that alias the memory-mapped files.
+      options.data_alignment = Allocator::kAllocatorAlignment;
+    }
+    return options;
+  }
+
   class FileIterator : public DatasetIterator<FileDatasetBase> {
    public:
     explicit FileIterator(const Params& params)
@@ -375,7 +451,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                  dataset()->WriterOptions());
         return Status::OK();
       }
 
@@ -437,7 +514,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                  dataset()->WriterOptions());
         lockfile_created_ = true;
         return Status::OK();
       }
@@ -486,13 +564,49 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       bool iteration_completed_ TF_GUARDED_BY(mu_);
     };  // FileWriterIterator
 
+    // FileReaderIterator produces the elements of a fully written cache.
+    //
+    // If the dataset was created with `memory_mapped` set, the data files of
+    // the cache are memory-mapped and the produced tensors alias the mapped
+    // pages instead of being copied out of the files. Tensors whose data
+    // cannot be aliased (e.g. strings, variants, or data that is not suitably
+    // aligned because the cache was written without `memory_mapped`) and
+    // file systems that do not support memory mapping fall back to reading
+    // through `BundleReader`.
     class FileReaderIterator : public DatasetIterator<FileDatasetBase> {
      public:
       explicit FileReaderIterator(const Params& params)
           : DatasetIterator<FileDatasetBase>(params),
             cur_index_(0),
             reader_(dataset()->env_, dataset()->filename_),
-            iterator_restored_(false) {}
+            iterator_restored_(false),
+            use_mmap_(dataset()->memory_mapped_),
+            num_shards_(0) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        if (!use_mmap_) {
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(reader_.status());
+        // A freshly constructed `BundleReader` is positioned at the header
+        // entry, which records the sharding and the endianness of the data.
+        BundleHeaderProto header;
+        if (!reader_.Valid() || reader_.key() != kHeaderEntryKey ||
+            !header.ParseFromArray(reader_.value().data(),
+                                   reader_.value().size())) {
+          return errors::DataLoss("Failed to read the header of cache ",
+                                  dataset()->filename_);
+        }
+        num_shards_ = header.num_shards();
+        if ((header.endianness() == BundleHeaderProto::BIG) ==
+            port::kLittleEndian) {
+          VLOG(1) << "Cache " << dataset()->filename_ << " was written with a "
+                  << "different endianness; not memory-mapping it.";
+          use_mmap_ = false;
+        }
+        return Status::OK();
+      }
 
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
@@ -523,7 +637,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           }
           StringPiece key = reader_.key();
           DCHECK_EQ(key, dataset()->FormatName(cur_index_, i));
-          TF_RETURN_IF_ERROR(reader_.ReadCurrent(&(*out_tensors)[i]));
+          TF_RETURN_IF_ERROR(ReadCurrent(ctx, &(*out_tensors)[i]));
           TF_RETURN_IF_ERROR(reader_.status());
         }
         cur_index_++;
@@ -569,10 +683,131 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       }
 
      private:
+      // A memory-mapped cache data file.
+      struct MappedShard {
+        std::shared_ptr<ReadOnlyMemoryRegion> region;
+        // Offset up to which the shard has been faulted in by readahead.
+        uint64 readahead_offset = 0;
+      };
+
+      // Reads the tensor at the current position of `reader_` into `val`,
+      // aliasing the memory-mapped cache file when possible.
+      Status ReadCurrent(IteratorContext* ctx, Tensor* val)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!use_mmap_) {
+          return reader_.ReadCurrent(val);
+        }
+        BundleEntryProto entry;
+        if (!entry.ParseFromArray(reader_.value().data(),
+                                  reader_.value().size())) {
+          return errors::DataLoss("Failed to parse the cache entry for key ",
+                                  reader_.key());
+        }
+        if (!DataTypeCanUseMemcpy(entry.dtype()) || entry.slices_size() > 0 ||
+            entry.size() == 0 ||
+            entry.offset() % Allocator::kAllocatorAlignment != 0) {
+          return reader_.ReadCurrent(val);
+        }
+        MappedShard* shard = nullptr;
+        TF_RETURN_IF_ERROR(GetMappedShard(entry.shard_id(), &shard));
+        if (shard == nullptr) {
+          return reader_.ReadCurrent(val);
+        }
+        const TensorShape shape(entry.shape());
+        const int64 expected_size =
+            shape.num_elements() * DataTypeSize(entry.dtype());
+        if (entry.size() != expected_size ||
+            static_cast<uint64>(entry.offset() + entry.size()) >
+                shard->region->length()) {
+          return errors::DataLoss("Invalid cache entry for key ",
+                                  reader_.key(), ": offset ", entry.offset(),
+                                  ", size ", entry.size(), ", expected size ",
+                                  expected_size, ", shard length ",
+                                  shard->region->length());
+        }
+        const char* data =
+            static_cast<const char*>(shard->region->data()) + entry.offset();
+        const uint32 expected_crc32c = crc32c::Unmask(entry.crc32c());
+        const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+        if (expected_crc32c != actual_crc32c) {
+          return errors::DataLoss(
+              "Checksum does not match for cache entry ", reader_.key(),
+              ": stored ", expected_crc32c, " vs. calculated on the mapped "
+              "bytes ", actual_crc32c);
+        }
+        MaybeReadahead(ctx, entry.offset() + entry.size(), shard);
+        core::RefCountPtr<TensorBuffer> buffer(
+            new MemoryMappedTensorBuffer(shard->region, data, entry.size()));
+        *val = Tensor(entry.dtype(), shape, std::move(buffer));
+        return Status::OK();
+      }
+
+      // Stores the mapping of data file `shard_id` in `*shard`, creating it if
+      // necessary. Leaves `*shard` null (and disables memory mapping) if the
+      // file system does not support memory-mapped files.
+      Status GetMappedShard(int32 shard_id, MappedShard** shard)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        auto it = mapped_shards_.find(shard_id);
+        if (it != mapped_shards_.end()) {
+          *shard = &it->second;
+          return Status::OK();
+        }
+        const string data_filename =
+            DataFilename(dataset()->filename_, shard_id, num_shards_);
+        std::unique_ptr<ReadOnlyMemoryRegion> region;
+        Status s = dataset()->env_->NewReadOnlyMemoryRegionFromFile(
+            data_filename, &region);
+        if (errors::IsUnimplemented(s)) {
+          VLOG(1) << "The file system of " << data_filename
+                  << " does not support memory-mapped files; reading the "
+                  << "cache through buffered reads instead.";
+          use_mmap_ = false;
+          *shard = nullptr;
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(s);
+        MappedShard& mapped_shard = mapped_shards_[shard_id];
+        mapped_shard.region = std::move(region);
+        *shard = &mapped_shard;
+        return Status::OK();
+      }
+
+      // Once the reader gets within half a readahead window of the end of the
+      // range that has already been faulted in, schedules touching the pages
+      // of the next window on the iterator's runner. This takes page faults
+      // for upcoming elements off the critical path of `GetNext`.
+      void MaybeReadahead(IteratorContext* ctx, uint64 offset,
+                          MappedShard* shard) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (offset + kReadaheadBytes / 2 < shard->readahead_offset) {
+          return;
+        }
+        const uint64 begin = std::max(offset, shard->readahead_offset);
+        const uint64 end =
+            std::min(begin + kReadaheadBytes, shard->region->length());
+        if (begin >= end) {
+          return;
+        }
+        shard->readahead_offset = end;
+        std::shared_ptr<ReadOnlyMemoryRegion> region = shard->region;
+        (*ctx->runner())([region, begin, end]() {
+          const volatile char* data =
+              static_cast<const volatile char*>(region->data());
+          for (uint64 i = begin; i < end; i += kReadaheadStride) {
+            static_cast<void>(data[i]);
+          }
+        });
+      }
+
       mutex mu_;
       size_t cur_index_ TF_GUARDED_BY(mu_);
       BundleReader reader_ TF_GUARDED_BY(mu_);
       bool iterator_restored_ TF_GUARDED_BY(mu_);
+      // Whether tensors are read by aliasing memory-mapped cache files.
+      bool use_mmap_ TF_GUARDED_BY(mu_);
+      // Number of data files in the cache, read from the cache header.
+      int32 num_shards_ TF_GUARDED_BY(mu_);
+      absl::flat_hash_map<int32, MappedShard> mapped_shards_
+          TF_GUARDED_BY(mu_);
     };  // FileReaderIterator
 
     Status InitializeIterator(IteratorContext* ctx)
@@ -626,7 +861,8 @@ class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph));
     Node* filename = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename));
-    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename}, output));
+    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename},
+                                     GraphDefAttrs(b), output));
     return Status::OK();
   }
 };
@@ -634,9 +870,9 @@ class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
 class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
  public:
   explicit FileDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
-                         string filename, Env* env,
+                         string filename, Env* env, bool memory_mapped,
                          const Tensor& resource_handle)
-      : FileDatasetBase(ctx, input, filename, env),
+      : FileDatasetBase(ctx, input, filename, env, memory_mapped),
         resource_handle_(resource_handle) {}
 
  protected:
@@ -649,8 +885,9 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
     Node* resource_handle_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {input_node, filename_node, resource_handle_node},
+                      GraphDefAttrs(b), output));
     return Status::OK();
   }
 
@@ -661,10 +898,14 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
 class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
  public:
   explicit MemoryDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                             std::shared_ptr<MemoryCache> cache)
+                             std::shared_ptr<MemoryCache> cache,
+                             int64 memory_budget, string spill_directory)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
-        cache_(std::move(cache)) {
+        cache_(std::move(cache)),
+        env_(ctx->env()),
+        memory_budget_(memory_budget),
+        spill_directory_(std::move(spill_directory)) {
     input_->Ref();
   }
 
@@ -706,6 +947,16 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
   }
 
  protected:
+  std::vector<std::pair<StringPiece, AttrValue>> MemoryCacheAttrs(
+      DatasetGraphDefBuilder* b) const {
+    AttrValue memory_budget;
+    b->BuildAttrValue(memory_budget_, &memory_budget);
+    AttrValue spill_directory;
+    b->BuildAttrValue(spill_directory_, &spill_directory);
+    return {std::make_pair(kMemoryBudget, memory_budget),
+            std::make_pair(kSpillDirectory, spill_directory)};
+  }
+
   class MemoryIterator : public DatasetIterator<MemoryDatasetBase> {
    public:
     explicit MemoryIterator(const Params& params, MemoryCache* cache)
@@ -735,8 +986,14 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex_lock l(mu_);
       if (cache_->IsCompleted()) {
         TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCacheCompleted), ""));
-        TF_RETURN_IF_ERROR(
-            WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
+        // Spilled elements are read back one at a time instead of all at
+        // once.
+        MemoryCache* cache = cache_;
+        TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+            writer, prefix(), cache->size(),
+            [cache](int64 index, std::vector<Tensor>* element) {
+              return cache->Get(index, element);
+            }));
       }
       return SaveInput(ctx, writer, iterator_);
     }
@@ -747,10 +1004,14 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       iterator_.reset();
       cache_->Reset();
       if (reader->Contains(full_name(kCacheCompleted))) {
-        std::vector<std::vector<Tensor>> temp_cache;
-        TF_RETURN_IF_ERROR(
-            ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache));
-        cache_->Complete(std::move(temp_cache));
+        // Re-applies the memory budget to the restored elements.
+        MemoryCacheBuilder builder(dataset()->env_, dataset()->memory_budget_,
+                                   dataset()->spill_directory_);
+        TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+            ctx, reader, prefix(), [&builder](std::vector<Tensor> element) {
+              return builder.Add(std::move(element));
+            }));
+        TF_RETURN_IF_ERROR(builder.CompleteCache(cache_));
       }
       TF_RETURN_IF_ERROR(InitializeIterator(ctx));
       return RestoreInput(ctx, reader, iterator_);
@@ -760,7 +1021,10 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
     class MemoryWriterIterator : public DatasetIterator<MemoryDatasetBase> {
      public:
       explicit MemoryWriterIterator(const Params& params, MemoryCache* cache)
-          : DatasetIterator<MemoryDatasetBase>(params), cache_(cache) {}
+          : DatasetIterator<MemoryDatasetBase>(params),
+            cache_(cache),
+            temp_cache_(params.dataset->env_, params.dataset->memory_budget_,
+                        params.dataset->spill_directory_) {}
 
       ~MemoryWriterIterator() override {
         mutex_lock l(mu_);
@@ -784,16 +1048,18 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           if (!cache_->IsCompleted()) {
             VLOG(2) << "Finalizing the cache because EOF has been reached.";
-            cache_->Complete(std::move(temp_cache_));
+            TF_RETURN_IF_ERROR(temp_cache_.CompleteCache(cache_));
           }
           return Status::OK();
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
+        TF_RETURN_IF_ERROR(temp_cache_.Add(*out_tensors));
+        if (!temp_cache_.spilling()) {
+          RecordBufferEnqueue(ctx, *out_tensors);
+        }
         if (temp_cache_.size() == dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
-          cache_->Complete(std::move(temp_cache_));
+          TF_RETURN_IF_ERROR(temp_cache_.CompleteCache(cache_));
         }
         return Status::OK();
       }
@@ -809,8 +1075,15 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         if (!cache_->IsCompleted()) {
-          TF_RETURN_IF_ERROR(
-              WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          // Spilled elements are read back one at a time instead of all at
+          // once.
+          MemoryCacheBuilder* temp_cache = &temp_cache_;
+          TF_RETURN_IF_ERROR(temp_cache->Flush());
+          TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+              writer, prefix(), temp_cache->size(),
+              [temp_cache](int64 index, std::vector<Tensor>* element) {
+                return temp_cache->Get(index, element);
+              }));
         }
         return SaveInput(ctx, writer, input_impl_);
       }
@@ -819,8 +1092,11 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              IteratorStateReader* reader) override {
         mutex_lock l(mu_);
         if (!reader->Contains(full_name(kCacheCompleted))) {
-          TF_RETURN_IF_ERROR(
-              ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache_));
+          MemoryCacheBuilder* temp_cache = &temp_cache_;
+          TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+              ctx, reader, prefix(), [temp_cache](std::vector<Tensor> element) {
+                return temp_cache->Add(std::move(element));
+              }));
         }
         return RestoreInput(ctx, reader, input_impl_);
       }
@@ -829,7 +1105,7 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
-      std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
+      MemoryCacheBuilder temp_cache_ TF_GUARDED_BY(mu_);
     };  // MemoryWriterIterator
 
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
@@ -837,7 +1113,13 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       explicit MemoryReaderIterator(const Params& params, MemoryCache* cache)
           : DatasetIterator<MemoryDatasetBase>(params),
             cache_(cache),
-            index_(0) {}
+            index_(0),
+            memory_reads_counter_(
+                metrics::GetTFDataCacheReadsCounter(kMemoryTier)),
+            disk_reads_counter_(
+                metrics::GetTFDataCacheReadsCounter(kDiskTier)),
+            memory_hit_ratio_name_(stats_utils::CacheMemoryHitRatioScalarName(
+                params.dataset->node_name())) {}
 
       Status Initialize(IteratorContext* ctx) override {
         // The memory allocated for the cache is owned by the parent
@@ -846,9 +1128,23 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         // is that this is incorrect if there are concurrent instances of this
         // iterator.
         tf_shared_lock l(mu_);
-        for (size_t i = 0; i < cache_->size(); ++i) {
+        const size_t memory_size = cache_->memory_size();
+        for (size_t i = 0; i < memory_size; ++i) {
           RecordBufferEnqueue(ctx, cache_->at(i));
         }
+        // The cache is complete, so how it is split between memory and disk
+        // only needs to be reported once.
+        const auto& stats_aggregator = ctx->stats_aggregator();
+        if (stats_aggregator) {
+          const string& node_name = dataset()->node_name();
+          stats_aggregator->AddScalar(
+              stats_utils::CacheMemoryElementsScalarName(node_name),
+              static_cast<float>(memory_size), num_elements());
+          stats_aggregator->AddScalar(
+              stats_utils::CacheDiskElementsScalarName(node_name),
+              static_cast<float>(cache_->size() - memory_size),
+              num_elements());
+        }
         return Status::OK();
       }
 
@@ -857,10 +1153,30 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         if (index_ < cache_->size()) {
-          const std::vector<Tensor>& cache_tensors = cache_->at(index_);
-          out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
-                              cache_tensors.end());
+          if (index_ < cache_->memory_size()) {
+            const std::vector<Tensor>& cache_tensors = cache_->at(index_);
+            out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
+                                cache_tensors.end());
+            memory_reads_counter_->IncrementBy(1);
+            num_memory_reads_++;
+          } else {
+            std::vector<Tensor> cache_tensors;
+            TF_RETURN_IF_ERROR(cache_->Get(index_, &cache_tensors));
+            out_tensors->insert(out_tensors->begin(),
+                                std::make_move_iterator(cache_tensors.begin()),
+                                std::make_move_iterator(cache_tensors.end()));
+            disk_reads_counter_->IncrementBy(1);
+            num_disk_reads_++;
+          }
           index_++;
+          const auto& stats_aggregator = ctx->stats_aggregator();
+          if (stats_aggregator) {
+            stats_aggregator->AddScalar(
+                memory_hit_ratio_name_,
+                static_cast<float>(num_memory_reads_) /
+                    static_cast<float>(num_memory_reads_ + num_disk_reads_),
+                num_elements());
+          }
           *end_of_sequence = false;
           return Status::OK();
         } else {
@@ -902,6 +1218,13 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex mu_;
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       size_t index_ TF_GUARDED_BY(mu_);
+      monitoring::CounterCell* const memory_reads_counter_;
+      monitoring::CounterCell* const disk_reads_counter_;
+      // Name of the stats aggregator scalar for the fraction of elements
+      // served from memory.
+      const string memory_hit_ratio_name_;
+      int64 num_memory_reads_ TF_GUARDED_BY(mu_) = 0;
+      int64 num_disk_reads_ TF_GUARDED_BY(mu_) = 0;
     };  // MemoryReaderIterator
 
     Status InitializeIterator(IteratorContext* ctx)
@@ -928,6 +1251,13 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 
   const DatasetBase* const input_;
   const std::shared_ptr<MemoryCache> cache_;
+  Env* const env_;
+  // Number of bytes of elements held in memory before the remaining elements
+  // are spilled to disk. Zero means that the budget is unlimited.
+  const int64 memory_budget_;
+  // Directory for the spill file. If empty, a local temporary directory is
+  // used.
+  const string spill_directory_;
 };  // MemoryDatasetBase
 
 // This version of memory dataset has an exclusive ownership of the memory cache
@@ -936,8 +1266,10 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 class CacheDatasetOp::MemoryDataset : public CacheDatasetOp::MemoryDatasetBase {
  public:
   MemoryDataset(OpKernelContext* ctx, const DatasetBase* input,
-                MemoryCacheManager* manager, ResourceHandle&& resource_handle)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                MemoryCacheManager* manager, ResourceHandle&& resource_handle,
+                int64 memory_budget, string spill_directory)
+      : MemoryDatasetBase(ctx, input, manager->get(), memory_budget,
+                          std::move(spill_directory)),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()) {}
@@ -959,8 +1291,8 @@ class CacheDatasetOp::MemoryDataset : public CacheDatasetOp::MemoryDatasetBase {
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
     Node* filename_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(tstring(""), &filename_node));
-    TF_RETURN_IF_ERROR(
-        b->AddDataset(this, {input_node, filename_node}, output));
+    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_node, filename_node},
+                                     MemoryCacheAttrs(b), output));
     return Status::OK();
   }
 
@@ -978,8 +1310,10 @@ class CacheDatasetOp::MemoryDatasetV2
  public:
   MemoryDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
                   MemoryCacheManager* manager, ResourceHandle&& resource_handle,
-                  bool owns_resource)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                  bool owns_resource, int64 memory_budget,
+                  string spill_directory)
+      : MemoryDatasetBase(ctx, input, manager->get(), memory_budget,
+                          std::move(spill_directory)),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -1009,7 +1343,8 @@ class CacheDatasetOp::MemoryDatasetV2
     handle.scalar<ResourceHandle>()() = resource_handle_;
     TF_RETURN_IF_ERROR(b->AddTensor(handle, &resource_handle_node));
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+        this, {input_node, filename_node, resource_handle_node},
+        MemoryCacheAttrs(b), output));
     return Status::OK();
   }
 
@@ -1022,7 +1357,21 @@ class CacheDatasetOp::MemoryDatasetV2
 
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  if (ctx->HasAttr(kMemoryMapped)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kMemoryMapped, &memory_mapped_));
+  }
+  if (ctx->HasAttr(kMemoryBudget)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kMemoryBudget, &memory_budget_));
+    OP_REQUIRES(
+        ctx, memory_budget_ >= 0,
+        errors::InvalidArgument("`memory_budget` must be non-negative, got ",
+                                memory_budget_));
+  }
+  if (ctx->HasAttr(kSpillDirectory)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kSpillDirectory, &spill_directory_));
+  }
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
@@ -1055,7 +1404,8 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       }
       // Ownership of manager is transferred onto `MemoryDatasetV2`.
       *output = new MemoryDatasetV2(ctx, input, manager, std::move(handle),
-                                    owns_resource);
+                                    owns_resource, memory_budget_,
+                                    spill_directory_);
     } else {
       MemoryCacheManager* manager;
       OP_REQUIRES_OK(
@@ -1067,14 +1417,16 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       auto handle =
           MakeResourceHandle<MemoryCacheManager>(ctx, container, name);
       // Ownership of manager is transferred onto `MemoryDataset`.
-      *output = new MemoryDataset(ctx, input, manager, std::move(handle));
+      *output = new MemoryDataset(ctx, input, manager, std::move(handle),
+                                  memory_budget_, spill_directory_);
     }
   } else {
     if (op_version_ == 2) {
-      *output =
-          new FileDatasetV2(ctx, input, filename, ctx->env(), ctx->input(2));
+      *output = new FileDatasetV2(ctx, input, filename, ctx->env(),
+                                  memory_mapped_, ctx->input(2));
     } else {
-      *output = new FileDataset(ctx, input, filename, ctx->env());
+      *output =
+          new FileDataset(ctx, input, filename, ctx->env(), memory_mapped_);
     }
   }
 }
@@ -30,6 +30,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kFileName = "filename";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kMemoryMapped = "memory_mapped";
+  static constexpr const char* const kMemoryBudget = "memory_budget";
+  static constexpr const char* const kSpillDirectory = "spill_directory";
 
   explicit CacheDatasetOp(OpKernelConstruction* ctx);
 
@@ -44,6 +47,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   class MemoryDatasetV2;
 
   const int op_version_;
+  bool memory_mapped_ = false;
+  int64 memory_budget_ = 0;
+  std::string spill_directory_;
 };
 
 }  // namespace data
@@ -17,6 +17,7 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/platform/path.h"
 
 namespace tensorflow {
@@ -33,10 +34,14 @@ class CacheDatasetParams : public DatasetParams {
   CacheDatasetParams(T input_dataset_params, string filename,
                      DataTypeVector output_dtypes,
                      std::vector<PartialTensorShape> output_shapes,
-                     string node_name)
+                     string node_name, bool memory_mapped = false,
+                     int64 memory_budget = 0, string spill_directory = "")
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
-        filename_(filename) {
+        filename_(filename),
+        memory_mapped_(memory_mapped),
+        memory_budget_(memory_budget),
+        spill_directory_(std::move(spill_directory)) {
     input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -56,7 +61,10 @@ class CacheDatasetParams : public DatasetParams {
 
   Status GetAttributes(AttributeVector* attr_vector) const override {
     *attr_vector = {{CacheDatasetOp::kOutputTypes, output_dtypes_},
-                    {CacheDatasetOp::kOutputShapes, output_shapes_}};
+                    {CacheDatasetOp::kOutputShapes, output_shapes_},
+                    {CacheDatasetOp::kMemoryMapped, memory_mapped_},
+                    {CacheDatasetOp::kMemoryBudget, memory_budget_},
+                    {CacheDatasetOp::kSpillDirectory, spill_directory_}};
     return Status::OK();
   }
 
@@ -66,6 +74,9 @@ class CacheDatasetParams : public DatasetParams {
 
  private:
   string filename_;
+  bool memory_mapped_;
+  int64 memory_budget_;
+  string spill_directory_;
 };
 
 class CacheDatasetOpTest : public DatasetOpsTestBase {
@@ -149,6 +160,47 @@ CacheDatasetParams CacheDatasetParams4() {
                             kNodeName);
 }
 
+// Test case 5: cache data in a memory-mapped file.
+CacheDatasetParams CacheDatasetParams5() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{3, 3, 1},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8}),
+                      CreateTensor<tstring>(TensorShape{3}, {"a", "b", "c"})},
+      /*node_name=*/"tensor_slice");
+  return CacheDatasetParams(
+      std::move(tensor_slice_dataset_params),
+      /*filename=*/io::JoinPath(testing::TmpDir(), "cache_data"),
+      /*output_dtypes=*/{DT_INT64, DT_STRING},
+      /*output_shapes=*/{PartialTensorShape({3, 1}), PartialTensorShape({})},
+      kNodeName, /*memory_mapped=*/true);
+}
+
+std::vector<Tensor> CacheDatasetParams5Outputs() {
+  return {CreateTensor<int64>(TensorShape({3, 1}), {0, 1, 2}),
+          CreateTensor<tstring>(TensorShape({}), {"a"}),
+          CreateTensor<int64>(TensorShape({3, 1}), {3, 4, 5}),
+          CreateTensor<tstring>(TensorShape({}), {"b"}),
+          CreateTensor<int64>(TensorShape({3, 1}), {6, 7, 8}),
+          CreateTensor<tstring>(TensorShape({}), {"c"})};
+}
+
+// Test case 6: cache data in memory with a memory budget that only fits the
+// first element, spilling the remaining elements to disk.
+CacheDatasetParams CacheDatasetParams6() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{3, 3, 1},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8})},
+      /*node_name=*/"tensor_slice");
+  return CacheDatasetParams(std::move(tensor_slice_dataset_params),
+                            /*filename=*/"",
+                            /*output_dtypes=*/{DT_INT64},
+                            /*output_shapes=*/{PartialTensorShape({3, 1})},
+                            kNodeName, /*memory_mapped=*/false,
+                            /*memory_budget=*/3 * sizeof(int64),
+                            /*spill_directory=*/
+                            io::JoinPath(testing::TmpDir(), "cache_spill"));
+}
+
 std::vector<GetNextTestCase<CacheDatasetParams>> GetNextTestCases() {
   return {{/*dataset_params=*/CacheDatasetParams1(),
            /*expected_outputs=*/
@@ -161,7 +213,13 @@ std::vector<GetNextTestCase<CacheDatasetParams>> GetNextTestCases() {
            CreateTensors<int64>(TensorShape({3, 1}),
                                 {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
           {/*dataset_params=*/CacheDatasetParams4(),
-           /*expected_outputs=*/{}}};
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/CacheDatasetParams5(),
+           /*expected_outputs=*/CacheDatasetParams5Outputs()},
+          {/*dataset_params=*/CacheDatasetParams6(),
+           /*expected_outputs=*/
+           CreateTensors<int64>(TensorShape({3, 1}),
+                                {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})}};
 }
 
 class ParameterizedGetNextTest : public CacheDatasetOpTest,
@@ -203,6 +261,76 @@ TEST_P(ParameterizedGetNextTest, GetNext) {
 INSTANTIATE_TEST_SUITE_P(CacheDatasetOpTest, ParameterizedGetNextTest,
                          ::testing::ValuesIn(GetNextTestCases()));
 
+TEST_F(CacheDatasetOpTest, MemoryMappedRead) {
+  auto dataset_params = CacheDatasetParams5();
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  // Write the cache.
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  while (!end_of_sequence) {
+    TF_EXPECT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+  }
+
+  // Read the cache back. Numeric components alias the mapped cache file,
+  // while string components fall back to buffered reads.
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+  std::vector<Tensor> read_tensors;
+  end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_EXPECT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    for (const Tensor& t : next) {
+      TensorDescription description;
+      t.FillDescription(&description);
+      if (t.dtype() == DT_INT64) {
+        EXPECT_EQ(description.allocation_description().allocator_name(),
+                  "CacheMemoryMapped");
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(t.tensor_data().data()) %
+                      Allocator::kAllocatorAlignment,
+                  0);
+      } else {
+        EXPECT_NE(description.allocation_description().allocator_name(),
+                  "CacheMemoryMapped");
+      }
+    }
+    read_tensors.insert(read_tensors.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(read_tensors, CacheDatasetParams5Outputs(),
+                           /*compare_order=*/true));
+}
+
+TEST_F(CacheDatasetOpTest, SpillToDisk) {
+  auto dataset_params = CacheDatasetParams6();
+  const string spill_directory = io::JoinPath(testing::TmpDir(), "cache_spill");
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  while (!end_of_sequence) {
+    TF_EXPECT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+  }
+
+  // Only the first element fits in the memory budget; the remaining elements
+  // are held in a single spill file.
+  std::vector<string> spill_files;
+  TF_ASSERT_OK(device_->env()->GetChildren(spill_directory, &spill_files));
+  EXPECT_EQ(spill_files.size(), 1);
+
+  // The spill file is deleted together with the cache.
+  iterator_.reset();
+  dataset_->Unref();
+  dataset_ = nullptr;
+  spill_files.clear();
+  TF_ASSERT_OK(device_->env()->GetChildren(spill_directory, &spill_files));
+  EXPECT_TRUE(spill_files.empty());
+}
+
 TEST_F(CacheDatasetOpTest, DatasetNodeName) {
   auto dataset_params = CacheDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -302,7 +430,12 @@ IteratorSaveAndRestoreTestCases() {
                                 {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
           {/*dataset_params=*/CacheDatasetParams4(),
            /*breakpoints=*/{0, 2, 4, 11},
-           /*expected_outputs=*/{}}};
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/CacheDatasetParams6(),
+           /*breakpoints=*/{0, 2, 4, 11},
+           /*expected_outputs=*/
+           CreateTensors<int64>(TensorShape({3, 1}),
+                                {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})}};
 }
 
 class ParameterizedIteratorSaveAndRestoreTest
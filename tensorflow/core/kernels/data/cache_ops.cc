@@ -16,27 +16,146 @@ limitations under the License.
 
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/errors.h"
 
 namespace tensorflow {
 namespace data {
 namespace {
 
 constexpr char kMemoryCache[] = "MemoryCache";
+constexpr char kSpillFilePrefix[] = "tf_data_cache_spill";
 
 }  // namespace
 
 string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 
-void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+CacheSpillFile::CacheSpillFile(Env* env, string filename,
+                               std::unique_ptr<WritableFile> file)
+    : env_(env),
+      filename_(std::move(filename)),
+      file_(std::move(file)),
+      writer_(absl::make_unique<io::RecordWriter>(file_.get())) {}
+
+CacheSpillFile::~CacheSpillFile() {
+  writer_.reset();
+  file_.reset();
+  reader_file_.reset();
+  Status s = env_->DeleteFile(filename_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete cache spill file " << filename_ << ": "
+                 << s.ToString();
+  }
+}
+
+Status CacheSpillFile::Create(Env* env, const string& directory,
+                              std::unique_ptr<CacheSpillFile>* out) {
+  string filename;
+  if (directory.empty()) {
+    if (!env->LocalTempFilename(&filename)) {
+      return errors::Internal(
+          "Failed to create a local temporary file name for the cache spill "
+          "file.");
+    }
+  } else {
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+    filename = io::JoinPath(directory, kSpillFilePrefix);
+    if (!env->CreateUniqueFileName(&filename, "")) {
+      return errors::Internal("Failed to create a unique file name in ",
+                              directory, " for the cache spill file.");
+    }
+  }
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  out->reset(new CacheSpillFile(env, std::move(filename), std::move(file)));
+  return Status::OK();
+}
+
+Status CacheSpillFile::Append(const std::vector<Tensor>& element) {
+  if (writer_ == nullptr) {
+    return errors::FailedPrecondition("Cache spill file ", filename_,
+                                      " has been closed for writing.");
+  }
+  offsets_.push_back(bytes_);
+  num_components_.push_back(element.size());
+  for (const Tensor& t : element) {
+    TensorProto proto;
+    t.AsProtoTensorContent(&proto);
+    string record;
+    if (!proto.SerializeToString(&record)) {
+      return errors::Internal("Failed to serialize a tensor of size ",
+                              proto.ByteSizeLong(),
+                              " for the cache spill file.");
+    }
+    TF_RETURN_IF_ERROR(writer_->WriteRecord(record));
+    bytes_ += io::RecordWriter::kHeaderSize + record.size() +
+              io::RecordWriter::kFooterSize;
+  }
+  return Status::OK();
+}
+
+Status CacheSpillFile::Flush() {
+  if (writer_ != nullptr) {
+    TF_RETURN_IF_ERROR(writer_->Flush());
+  }
+  if (reader_file_ == nullptr) {
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename_, &reader_file_));
+  }
+  return Status::OK();
+}
+
+Status CacheSpillFile::Finish() {
+  if (writer_ != nullptr) {
+    TF_RETURN_IF_ERROR(writer_->Close());
+    writer_.reset();
+    TF_RETURN_IF_ERROR(file_->Close());
+    file_.reset();
+  }
+  return Flush();
+}
+
+Status CacheSpillFile::Read(int64 index, std::vector<Tensor>* element) const {
+  if (reader_file_ == nullptr || index < 0 || index >= size()) {
+    return errors::OutOfRange("Element ", index,
+                              " is not available in cache spill file ",
+                              filename_);
+  }
+  io::RecordReader reader(reader_file_.get());
+  uint64 offset = offsets_[index];
+  element->clear();
+  element->reserve(num_components_[index]);
+  for (int64 i = 0; i < num_components_[index]; ++i) {
+    tstring record;
+    TF_RETURN_IF_ERROR(reader.ReadRecord(&offset, &record));
+    TensorProto proto;
+    if (!proto.ParseFromArray(record.data(), record.size())) {
+      return errors::DataLoss("Failed to parse a tensor of element ", index,
+                              " in cache spill file ", filename_);
+    }
+    element->emplace_back();
+    if (!element->back().FromProto(proto)) {
+      return errors::DataLoss("Invalid tensor in element ", index,
+                              " of cache spill file ", filename_);
+    }
+  }
+  return Status::OK();
+}
+
+void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache,
+                           std::unique_ptr<CacheSpillFile> spill_file) {
   mutex_lock l(mu_);
   if (!completed_) {
     cache_ = std::move(cache);
+    spill_file_ = std::move(spill_file);
     completed_ = true;
   }
 }
@@ -50,6 +169,7 @@ void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
   cache_.clear();
+  spill_file_.reset();
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64 index) {
@@ -58,7 +178,32 @@ const std::vector<Tensor>& MemoryCache::at(int64 index) {
   return cache_[index];
 }
 
+Status MemoryCache::Get(int64 index, std::vector<Tensor>* element) {
+  std::shared_ptr<const CacheSpillFile> spill_file;
+  int64 memory_size;
+  {
+    tf_shared_lock l(mu_);
+    memory_size = cache_.size();
+    if (index < memory_size) {
+      *element = cache_[index];
+      return Status::OK();
+    }
+    spill_file = spill_file_;
+  }
+  if (spill_file == nullptr) {
+    return errors::OutOfRange("Element ", index, " is not in the cache.");
+  }
+  // The spill file is read outside of the lock so that readers of in-memory
+  // elements are not blocked on disk reads.
+  return spill_file->Read(index - memory_size, element);
+}
+
 size_t MemoryCache::size() {
+  tf_shared_lock l(mu_);
+  return cache_.size() + (spill_file_ ? spill_file_->size() : 0);
+}
+
+size_t MemoryCache::memory_size() {
   tf_shared_lock l(mu_);
   return cache_.size();
 }
@@ -68,6 +213,68 @@ const std::vector<std::vector<Tensor>>& MemoryCache::data() {
   return cache_;
 }
 
+MemoryCacheBuilder::MemoryCacheBuilder(Env* env, int64 memory_budget,
+                                       string spill_directory)
+    : env_(env),
+      memory_budget_(memory_budget),
+      spill_directory_(std::move(spill_directory)) {}
+
+Status MemoryCacheBuilder::Add(std::vector<Tensor> element) {
+  const int64 element_bytes = GetAllocatedBytes(element);
+  if (spill_file_ == nullptr &&
+      (memory_budget_ == 0 ||
+       memory_bytes_ + element_bytes <= memory_budget_)) {
+    memory_bytes_ += element_bytes;
+    elements_.push_back(std::move(element));
+    return Status::OK();
+  }
+  // Once an element has been spilled, all subsequent elements are spilled as
+  // well so that the spilled elements form a suffix of the cache.
+  if (spill_file_ == nullptr) {
+    VLOG(1) << "The cache exceeded its memory budget of " << memory_budget_
+            << " bytes after " << elements_.size()
+            << " elements; spilling the remaining elements to disk.";
+    TF_RETURN_IF_ERROR(
+        CacheSpillFile::Create(env_, spill_directory_, &spill_file_));
+  }
+  const int64 bytes_before = spill_file_->bytes();
+  TF_RETURN_IF_ERROR(spill_file_->Append(element));
+  metrics::RecordTFDataCacheSpilledBytes(spill_file_->bytes() - bytes_before);
+  return Status::OK();
+}
+
+int64 MemoryCacheBuilder::size() const {
+  return elements_.size() + (spill_file_ ? spill_file_->size() : 0);
+}
+
+Status MemoryCacheBuilder::Flush() {
+  if (spill_file_ == nullptr) {
+    return Status::OK();
+  }
+  return spill_file_->Flush();
+}
+
+Status MemoryCacheBuilder::Get(int64 index,
+                               std::vector<Tensor>* element) const {
+  if (index < elements_.size()) {
+    *element = elements_[index];
+    return Status::OK();
+  }
+  DCHECK(spill_file_ != nullptr);
+  return spill_file_->Read(index - elements_.size(), element);
+}
+
+Status MemoryCacheBuilder::CompleteCache(MemoryCache* cache) {
+  if (spill_file_ != nullptr) {
+    TF_RETURN_IF_ERROR(spill_file_->Finish());
+  }
+  cache->Complete(std::move(elements_), std::move(spill_file_));
+  elements_.clear();
+  spill_file_.reset();
+  memory_bytes_ = 0;
+  return Status::OK();
+}
+
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
     OpKernelConstruction* ctx)
     : AnonymousResourceOp<MemoryCacheManager>(ctx) {}
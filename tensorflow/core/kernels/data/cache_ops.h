@@ -18,21 +18,82 @@ limitations under the License.
 
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace data {
 
+// An append-only local file holding the elements of a `MemoryCache` that do
+// not fit in its memory budget. Each element is stored as a sequence of
+// records, one serialized `TensorProto` per component.
+//
+// Elements are appended by a single writer. Once `Finish()` has been called,
+// the file can be read concurrently by any number of readers.
+class CacheSpillFile {
+ public:
+  // Creates an empty spill file in `directory`, or in a local temporary
+  // directory if `directory` is empty.
+  static Status Create(Env* env, const string& directory,
+                       std::unique_ptr<CacheSpillFile>* out);
+
+  // Deletes the underlying file.
+  ~CacheSpillFile();
+
+  // Appends `element` to the file.
+  Status Append(const std::vector<Tensor>& element);
+
+  // Flushes the appended elements so that they can be read.
+  Status Flush();
+
+  // Closes the file for writing.
+  Status Finish();
+
+  // Reads the element with the given index.
+  //
+  // REQUIRES: The element has been flushed by `Flush()` or `Finish()`.
+  Status Read(int64 index, std::vector<Tensor>* element) const;
+
+  // Returns the number of elements in the file.
+  int64 size() const { return offsets_.size(); }
+
+  // Returns the number of bytes written to the file.
+  int64 bytes() const { return bytes_; }
+
+ private:
+  CacheSpillFile(Env* env, string filename,
+                 std::unique_ptr<WritableFile> file);
+
+  Env* const env_;
+  const string filename_;
+  std::unique_ptr<WritableFile> file_;
+  std::unique_ptr<io::RecordWriter> writer_;
+  std::unique_ptr<RandomAccessFile> reader_file_;
+  // Offset of the first record of each element.
+  std::vector<uint64> offsets_;
+  // Number of components of each element.
+  std::vector<int64> num_components_;
+  int64 bytes_ = 0;
+};
+
 // A thread-safe data structure for caching dataset elements.
 //
 // The expected use is that a single `MemoryWriterIterator` populates the
 // cache with dataset elements. Once all elements are cached, the cache can
 // be used by one or more `MemoryReaderIterator`s.
+//
+// The cache consists of two tiers: elements held in memory and, if the cache
+// was written with a memory budget, the elements that did not fit in the
+// budget and were spilled to a `CacheSpillFile`. The spilled elements follow
+// the in-memory elements.
 class MemoryCache {
  public:
   MemoryCache() = default;
 
-  // Marks the cache as completed.
-  void Complete(std::vector<std::vector<Tensor>>&& cache);
+  // Marks the cache as completed. If `spill_file` is non-null, it holds the
+  // elements that follow those in `cache`.
+  void Complete(std::vector<std::vector<Tensor>>&& cache,
+                std::unique_ptr<CacheSpillFile> spill_file = nullptr);
 
   // Returns whether the cache is completed.
   bool IsCompleted();
@@ -40,14 +101,24 @@ class MemoryCache {
   // Resets the cache.
   void Reset();
 
-  // Returns the element at the given index.
+  // Returns the in-memory element at the given index.
+  //
+  // REQUIRES: `index < memory_size()`.
   const std::vector<Tensor>& at(int64 index);
 
-  // Returns the size of the cache.
+  // Stores the element at the given index in `element`, reading it from the
+  // spill file if it is not held in memory.
+  Status Get(int64 index, std::vector<Tensor>* element);
+
+  // Returns the size of the cache, including spilled elements.
   size_t size();
 
-  // Returns a reference to the cache's data. The returned reference will be
-  // invalidated by any call to Reset().
+  // Returns the number of elements held in memory. The elements with indices
+  // in `[memory_size(), size())` are stored in the spill file.
+  size_t memory_size();
+
+  // Returns a reference to the cache's in-memory data. The returned reference
+  // will be invalidated by any call to Reset().
   const std::vector<std::vector<Tensor>>& data();
 
  private:
@@ -55,6 +126,56 @@ class MemoryCache {
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<const CacheSpillFile> spill_file_ TF_GUARDED_BY(mu_);
+};
+
+// Accumulates the elements of a `MemoryCache` that is being written. Elements
+// are held in memory until their total size reaches `memory_budget` bytes;
+// subsequent elements are appended to a `CacheSpillFile` in
+// `spill_directory`. A `memory_budget` of 0 means that the budget is
+// unlimited.
+//
+// Not thread-safe.
+class MemoryCacheBuilder {
+ public:
+  MemoryCacheBuilder(Env* env, int64 memory_budget, string spill_directory);
+
+  // Adds `element` to the end of the cache.
+  Status Add(std::vector<Tensor> element);
+
+  // Returns the number of elements that have been added.
+  int64 size() const;
+
+  bool empty() const { return size() == 0; }
+
+  // Returns whether the memory budget has been exhausted, in which case
+  // elements are added to the spill file.
+  bool spilling() const { return spill_file_ != nullptr; }
+
+  // Returns the number of bytes held in memory.
+  int64 memory_bytes() const { return memory_bytes_; }
+
+  // Flushes the spilled elements so that they can be read by `Get()`.
+  Status Flush();
+
+  // Stores the element at the given index in `element`, reading it from the
+  // spill file if it is not held in memory.
+  //
+  // REQUIRES: `index < size()`, and `Flush()` has been called after the
+  // element was added.
+  Status Get(int64 index, std::vector<Tensor>* element) const;
+
+  // Transfers the elements that have been added to `cache` and marks it as
+  // completed. Resets the builder.
+  Status CompleteCache(MemoryCache* cache);
+
+ private:
+  Env* const env_;
+  const int64 memory_budget_;
+  const string spill_directory_;
+  int64 memory_bytes_ = 0;
+  std::vector<std::vector<Tensor>> elements_;
+  std::unique_ptr<CacheSpillFile> spill_file_;
 };
 
 // A resource wrapping a shared instance of a memory cache.
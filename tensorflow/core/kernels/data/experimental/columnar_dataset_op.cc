@@ -0,0 +1,530 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/common_runtime/metrics.h"
+#include "tensorflow/core/data/columnar_file.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// See documentation in ../../ops/experimental_dataset_ops.cc for a high-level
+// description of the following op.
+
+/* static */ constexpr const char* const ColumnarDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFileNames;
+/* static */ constexpr const char* const ColumnarDatasetOp::kColumns;
+/* static */ constexpr const char* const ColumnarDatasetOp::kBatchSize;
+/* static */ constexpr const char* const ColumnarDatasetOp::kNumParallelReads;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputShapes;
+
+constexpr char kFileIndex[] = "file_index";
+constexpr char kRowGroup[] = "row_group";
+constexpr char kRow[] = "row";
+
+class ColumnarDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          std::vector<string> columns, int64 batch_size,
+          int64 num_parallel_reads, const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)),
+        batch_size_(batch_size),
+        num_parallel_reads_(num_parallel_reads),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override { return Status::OK(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    Node* columns = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(columns_, &columns));
+    Node* batch_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+    Node* num_parallel_reads = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(num_parallel_reads_, &num_parallel_reads));
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {filenames, columns, batch_size, num_parallel_reads}, output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          mu_(std::make_shared<mutex>()),
+          cond_var_(std::make_shared<condition_variable>()),
+          num_parallel_reads_(std::make_shared<model::SharedState>(
+              params.dataset->num_parallel_reads_, mu_, cond_var_)) {}
+
+    ~Iterator() override {
+      mutex_lock l(*mu_);
+      while (num_outstanding_ > 0) {
+        cond_var_->wait(l);
+      }
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(*mu_);
+      // Row groups are large, so an autotuned iterator starts by reading one
+      // row group ahead and lets the model raise that if it helps.
+      read_on_demand_ = num_parallel_reads_->value == 1;
+      if (num_parallel_reads_->value == model::kAutotune) {
+        num_parallel_reads_->value = 1;
+      }
+      files_.resize(dataset()->filenames_.size());
+      return Status::OK();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(*mu_);
+      // The rows of the batch, as [begin, begin + size) ranges of row groups.
+      struct Piece {
+        std::shared_ptr<RowGroup> row_group;
+        int64 begin;
+        int64 size;
+      };
+      std::vector<Piece> pieces;
+      int64 num_rows = 0;
+      while (num_rows < dataset()->batch_size_) {
+        if (current_ == nullptr || current_row_ >= current_->num_rows) {
+          TF_RETURN_IF_ERROR(AdvanceRowGroupLocked(ctx, l));
+          if (current_ == nullptr) break;
+          continue;
+        }
+        const int64 size = std::min(dataset()->batch_size_ - num_rows,
+                                    current_->num_rows - current_row_);
+        pieces.push_back({current_, current_row_, size});
+        current_row_ += size;
+        num_rows += size;
+      }
+      if (num_rows == 0) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+
+      const int num_columns = dataset()->columns_.size();
+      out_tensors->reserve(num_columns);
+      for (int i = 0; i < num_columns; ++i) {
+        // A batch that lies within one row group is a slice of its chunk, as
+        // long as the slice keeps the alignment the kernels expect.
+        if (pieces.size() == 1) {
+          const Tensor& chunk = pieces[0].row_group->columns[i];
+          Tensor slice =
+              chunk.Slice(pieces[0].begin, pieces[0].begin + pieces[0].size);
+          if (slice.IsAligned()) {
+            out_tensors->push_back(std::move(slice));
+            continue;
+          }
+        }
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  dataset()->output_types_[i],
+                                  TensorShape({num_rows}));
+        int64 offset = 0;
+        for (const Piece& piece : pieces) {
+          TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+              piece.row_group->columns[i], piece.begin, offset, piece.size,
+              &out_tensors->back()));
+          offset += piece.size;
+        }
+      }
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeAsyncKnownRatioNode(
+          std::move(args),
+          /*ratio=*/1,
+          {model::MakeParameter("parallelism", num_parallel_reads_, /*min=*/1,
+                                /*max=*/ctx->runner_threadpool_size())});
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(*mu_);
+      int64 file_index = schedule_file_;
+      int64 row_group = schedule_row_group_;
+      int64 row = 0;
+      if (current_ != nullptr) {
+        file_index = current_->file_index;
+        row_group = current_->row_group;
+        row = current_row_;
+      } else if (!pending_.empty()) {
+        file_index = pending_.front()->file_index;
+        row_group = pending_.front()->row_group;
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kFileIndex), file_index));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kRowGroup), row_group));
+      return writer->WriteScalar(full_name(kRow), row);
+    }
+
+    // Restoring only repositions the iterator: reading resumes at the saved
+    // row group, and no row group before it is read.
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(*mu_);
+      int64 file_index;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kFileIndex), &file_index));
+      int64 row_group;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRowGroup), &row_group));
+      int64 row;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRow), &row));
+      if (file_index < 0 || file_index > static_cast<int64>(files_.size()) ||
+          row_group < 0 || row < 0) {
+        return errors::FailedPrecondition(
+            "Invalid checkpointed position: file ", file_index,
+            ", row group ", row_group, ", row ", row);
+      }
+      // In-flight reads finish into row groups that are no longer referenced.
+      for (const auto& row_group : pending_) {
+        ReleaseRowGroupLocked(ctx, row_group.get());
+      }
+      pending_.clear();
+      if (current_ != nullptr) {
+        ReleaseRowGroupLocked(ctx, current_.get());
+        current_.reset();
+      }
+      current_row_ = 0;
+      schedule_file_ = file_index;
+      schedule_row_group_ = row_group;
+      skip_rows_ = row;
+      return Status::OK();
+    }
+
+   private:
+    // An open file and the positions of the selected columns in it.
+    struct File {
+      std::unique_ptr<const ColumnarFileReader> reader;
+      std::vector<int> columns;
+    };
+
+    // The selected columns of one row group.
+    struct RowGroup {
+      RowGroup(std::shared_ptr<const File> file, int64 file_index,
+               int64 row_group)
+          : file(std::move(file)),
+            file_index(file_index),
+            row_group(row_group),
+            num_rows(this->file->reader->num_rows(row_group)) {}
+
+      const std::shared_ptr<const File> file;
+      const int64 file_index;
+      const int64 row_group;
+      const int64 num_rows;
+      // Written by the reading thread before `done` is set; read by the
+      // consumer only after it observes `done` under `mu_`.
+      Status status;
+      std::vector<Tensor> columns;
+      bool done = false;
+      // Whether `columns` is counted in the model's buffered bytes.
+      bool buffered = false;
+      // Set once the iterator no longer references the row group.
+      bool released = false;
+    };
+
+    // Stops counting `row_group` in the model's buffered bytes.
+    void ReleaseRowGroupLocked(IteratorContext* ctx, RowGroup* row_group)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      if (row_group->buffered) {
+        RecordBufferDequeue(ctx, row_group->columns);
+        row_group->buffered = false;
+      }
+      row_group->released = true;
+    }
+
+    // Reads the selected columns of `row_group` into `row_group->columns`.
+    static Status ReadRowGroup(Allocator* allocator, RowGroup* row_group) {
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      const File& file = *row_group->file;
+      row_group->columns.resize(file.columns.size());
+      for (size_t i = 0; i < file.columns.size(); ++i) {
+        uint64 bytes_read = 0;
+        TF_RETURN_IF_ERROR(file.reader->ReadChunk(
+            row_group->row_group, file.columns[i], allocator,
+            &row_group->columns[i], &bytes_read));
+        bytes_counter->IncrementBy(bytes_read);
+      }
+      return Status::OK();
+    }
+
+    // Opens file `file_index` unless it is already open, and checks that it
+    // has the selected columns with the expected types.
+    Status OpenFileLocked(IteratorContext* ctx, int64 file_index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      if (files_[file_index] != nullptr) return Status::OK();
+      const string& filename = dataset()->filenames_[file_index];
+      std::unique_ptr<ColumnarFileReader> reader;
+      TF_RETURN_IF_ERROR(
+          ColumnarFileReader::Open(ctx->env(), filename, &reader));
+      auto file = std::make_shared<File>();
+      for (size_t i = 0; i < dataset()->columns_.size(); ++i) {
+        const string& name = dataset()->columns_[i];
+        const int column = reader->FindColumn(name);
+        if (column < 0) {
+          return errors::InvalidArgument("Columnar file ", filename,
+                                         " has no column named ", name);
+        }
+        const DataType dtype = reader->columns()[column].dtype;
+        if (dtype != dataset()->output_types_[i]) {
+          return errors::InvalidArgument(
+              "Column ", name, " of columnar file ", filename, " has type ",
+              DataTypeString(dtype), " but the dataset expects ",
+              DataTypeString(dataset()->output_types_[i]));
+        }
+        file->columns.push_back(column);
+      }
+      file->reader = std::move(reader);
+      files_[file_index] = std::move(file);
+      return Status::OK();
+    }
+
+    // Queues reads of upcoming row groups until `num_parallel_reads_` row
+    // groups are pending or all of them have been queued.
+    Status ScheduleRowGroupsLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      while (pending_.size() < num_parallel_reads_->value) {
+        while (schedule_file_ < files_.size()) {
+          Status s = OpenFileLocked(ctx, schedule_file_);
+          if (!s.ok()) {
+            // Move past the file so that callers which ignore errors make
+            // progress.
+            ++schedule_file_;
+            schedule_row_group_ = 0;
+            return s;
+          }
+          if (schedule_row_group_ <
+              files_[schedule_file_]->reader->num_row_groups()) {
+            break;
+          }
+          // Queued row groups keep the file open while they need it.
+          files_[schedule_file_].reset();
+          ++schedule_file_;
+          schedule_row_group_ = 0;
+        }
+        if (schedule_file_ >= files_.size()) return Status::OK();
+        auto row_group = std::make_shared<RowGroup>(
+            files_[schedule_file_], schedule_file_, schedule_row_group_);
+        ++schedule_row_group_;
+        pending_.push_back(row_group);
+        if (read_on_demand_) {
+          // Read on demand in AdvanceRowGroupLocked().
+          continue;
+        }
+        ++num_outstanding_;
+        auto ctx_copy = std::make_shared<IteratorContext>(*ctx);
+        (*ctx->runner())([this, ctx_copy, row_group]() {
+          RecordStart(ctx_copy.get());
+          Status s = ReadRowGroup(ctx_copy->allocator({}), row_group.get());
+          RecordStop(ctx_copy.get());
+          mutex_lock l(*mu_);
+          row_group->status = s;
+          row_group->done = true;
+          if (s.ok() && !row_group->released) {
+            RecordBufferEnqueue(ctx_copy.get(), row_group->columns);
+            row_group->buffered = true;
+          }
+          --num_outstanding_;
+          cond_var_->notify_all();
+        });
+      }
+      return Status::OK();
+    }
+
+    // Makes the next row group current, waiting for it to be read. Leaves
+    // `current_` null at the end of the input.
+    Status AdvanceRowGroupLocked(IteratorContext* ctx, mutex_lock& l)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      if (current_ != nullptr) {
+        ReleaseRowGroupLocked(ctx, current_.get());
+        current_.reset();
+      }
+      current_row_ = 0;
+      TF_RETURN_IF_ERROR(ScheduleRowGroupsLocked(ctx));
+      if (pending_.empty()) return Status::OK();
+      std::shared_ptr<RowGroup> row_group = std::move(pending_.front());
+      pending_.pop_front();
+      if (read_on_demand_) {
+        row_group->status = ReadRowGroup(ctx->allocator({}), row_group.get());
+      } else if (!row_group->done) {
+        RecordStop(ctx);
+        while (!row_group->done) {
+          cond_var_->wait(l);
+        }
+        RecordStart(ctx);
+      }
+      // Keep the reads going while the consumer works through this row group.
+      TF_RETURN_IF_ERROR(ScheduleRowGroupsLocked(ctx));
+      // A failed row group is skipped so that callers which ignore errors
+      // make progress.
+      TF_RETURN_IF_ERROR(row_group->status);
+      current_ = std::move(row_group);
+      current_row_ = std::min(skip_rows_, current_->num_rows);
+      skip_rows_ = 0;
+      return Status::OK();
+    }
+
+    const std::shared_ptr<mutex> mu_;
+    const std::shared_ptr<condition_variable> cond_var_;
+    // Number of row groups read ahead of the consumer, on the iterator's
+    // runner.
+    const std::shared_ptr<model::SharedState> num_parallel_reads_;
+    // Whether row groups are read by the consumer as it reaches them, which
+    // is the case when `num_parallel_reads` is 1.
+    bool read_on_demand_ TF_GUARDED_BY(*mu_) = false;
+    int64 num_outstanding_ TF_GUARDED_BY(*mu_) = 0;
+
+    // `files_[i]` is set while row groups of file `i` remain to be queued.
+    std::vector<std::shared_ptr<const File>> files_ TF_GUARDED_BY(*mu_);
+    // The next row group to queue.
+    int64 schedule_file_ TF_GUARDED_BY(*mu_) = 0;
+    int64 schedule_row_group_ TF_GUARDED_BY(*mu_) = 0;
+    // Queued row groups in input order, some of which may still be read.
+    std::deque<std::shared_ptr<RowGroup>> pending_ TF_GUARDED_BY(*mu_);
+    std::shared_ptr<RowGroup> current_ TF_GUARDED_BY(*mu_);
+    int64 current_row_ TF_GUARDED_BY(*mu_) = 0;
+    // Rows of the next row group that were consumed before a checkpoint.
+    int64 skip_rows_ TF_GUARDED_BY(*mu_) = 0;
+  };
+
+  const std::vector<string> filenames_;
+  const std::vector<string> columns_;
+  const int64 batch_size_;
+  const int64 num_parallel_reads_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+ColumnarDatasetOp::ColumnarDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  OP_REQUIRES(ctx, output_types_.size() == output_shapes_.size(),
+              errors::InvalidArgument(
+                  "`output_types` and `output_shapes` must have the same "
+                  "length, got ",
+                  output_types_.size(), " and ", output_shapes_.size()));
+  for (const PartialTensorShape& shape : output_shapes_) {
+    OP_REQUIRES(ctx, shape.IsCompatibleWith(PartialTensorShape({-1})),
+                errors::InvalidArgument(
+                    "Every component of a columnar dataset is a vector, got "
+                    "shape ",
+                    shape.DebugString()));
+  }
+}
+
+void ColumnarDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                    DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+  std::vector<string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    metrics::RecordTFDataFilename(kDatasetType, filenames[i]);
+  }
+
+  const Tensor* columns_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kColumns, &columns_tensor));
+  OP_REQUIRES(ctx, columns_tensor->dims() == 1,
+              errors::InvalidArgument("`columns` must be a vector."));
+  std::vector<string> columns;
+  columns.reserve(columns_tensor->NumElements());
+  for (int i = 0; i < columns_tensor->NumElements(); ++i) {
+    columns.push_back(columns_tensor->flat<tstring>()(i));
+  }
+  OP_REQUIRES(ctx, columns.size() == output_types_.size(),
+              errors::InvalidArgument(
+                  "Expected one output type per column, got ", columns.size(),
+                  " columns and ", output_types_.size(), " output types."));
+
+  int64 batch_size;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kBatchSize, &batch_size));
+  OP_REQUIRES(ctx, batch_size > 0,
+              errors::InvalidArgument("`batch_size` must be > 0"));
+
+  int64 num_parallel_reads;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kNumParallelReads,
+                                                 &num_parallel_reads));
+  OP_REQUIRES(
+      ctx, num_parallel_reads > 0 || num_parallel_reads == model::kAutotune,
+      errors::InvalidArgument("`num_parallel_reads` must be > 0 or ",
+                              model::kAutotune, " (AUTOTUNE)"));
+
+  *output = new Dataset(ctx, std::move(filenames), std::move(columns),
+                        batch_size, num_parallel_reads, output_types_,
+                        output_shapes_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,295 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include "tensorflow/core/data/columnar_file.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "columnar_dataset";
+
+class ColumnarDatasetParams : public DatasetParams {
+ public:
+  ColumnarDatasetParams(std::vector<tstring> filenames,
+                        std::vector<tstring> columns, int64 batch_size,
+                        int64 num_parallel_reads, DataTypeVector output_dtypes,
+                        string node_name)
+      : DatasetParams(output_dtypes,
+                      std::vector<PartialTensorShape>(output_dtypes.size(),
+                                                      PartialTensorShape({-1})),
+                      std::move(node_name)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)),
+        batch_size_(batch_size),
+        num_parallel_reads_(num_parallel_reads) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    int num_files = filenames_.size();
+    int num_columns = columns_.size();
+    return {CreateTensor<tstring>(TensorShape({num_files}), filenames_),
+            CreateTensor<tstring>(TensorShape({num_columns}), columns_),
+            CreateTensor<int64>(TensorShape({}), {batch_size_}),
+            CreateTensor<int64>(TensorShape({}), {num_parallel_reads_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    input_names->clear();
+    *input_names = {
+        ColumnarDatasetOp::kFileNames,
+        ColumnarDatasetOp::kColumns,
+        ColumnarDatasetOp::kBatchSize,
+        ColumnarDatasetOp::kNumParallelReads,
+    };
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{ColumnarDatasetOp::kOutputTypes, output_dtypes_},
+                    {ColumnarDatasetOp::kOutputShapes, output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return ColumnarDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<tstring> filenames_;
+  std::vector<tstring> columns_;
+  int64 batch_size_;
+  int64 num_parallel_reads_;
+};
+
+class ColumnarDatasetOpTest : public DatasetOpsTestBase {};
+
+// Writes two columnar files with the columns `id`, `score` and `name`. The
+// first file holds rows 0-4 in row groups of sizes 2, 2 and 1; the second one
+// holds rows 5-7 in row groups of sizes 2 and 1.
+std::vector<tstring> CreateTestFiles() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/columnar_1"),
+      absl::StrCat(testing::TmpDir(), "/columnar_2")};
+  std::vector<std::pair<int64, int64>> rows = {{0, 5}, {5, 8}};
+  ColumnarFileWriterOptions options;
+  options.rows_per_row_group = 2;
+  for (int i = 0; i < filenames.size(); ++i) {
+    std::vector<int64> ids;
+    std::vector<float> scores;
+    std::vector<tstring> names;
+    for (int64 row = rows[i].first; row < rows[i].second; ++row) {
+      ids.push_back(row);
+      scores.push_back(row / 2.0f);
+      names.push_back(absl::StrCat("row", row));
+    }
+    const TensorShape shape({rows[i].second - rows[i].first});
+    std::unique_ptr<WritableFile> file;
+    Status s = Env::Default()->NewWritableFile(filenames[i], &file);
+    if (s.ok()) {
+      ColumnarFileWriter writer(
+          file.get(),
+          {{"id", DT_INT64}, {"score", DT_FLOAT}, {"name", DT_STRING}},
+          options);
+      s = writer.Initialize();
+      if (s.ok()) {
+        s = writer.Write({CreateTensor<int64>(shape, ids),
+                          CreateTensor<float>(shape, scores),
+                          CreateTensor<tstring>(shape, names)});
+      }
+      if (s.ok()) s = writer.Finish();
+      if (s.ok()) s = file->Close();
+    }
+    if (!s.ok()) {
+      VLOG(WARNING) << "Failed to create the test file " << filenames[i]
+                    << ": " << s;
+    }
+  }
+  return filenames;
+}
+
+// Returns the `name` and `id` columns of rows [begin, end).
+std::vector<Tensor> NameAndIdBatch(int64 begin, int64 end) {
+  std::vector<int64> ids;
+  std::vector<tstring> names;
+  for (int64 row = begin; row < end; ++row) {
+    ids.push_back(row);
+    names.push_back(absl::StrCat("row", row));
+  }
+  const TensorShape shape({end - begin});
+  return {CreateTensor<tstring>(shape, names), CreateTensor<int64>(shape, ids)};
+}
+
+// Returns the elements of test case 1.
+std::vector<Tensor> NameAndIdBatches() {
+  std::vector<Tensor> outputs;
+  for (int64 begin = 0; begin < 8; begin += 3) {
+    for (Tensor& t : NameAndIdBatch(begin, std::min<int64>(begin + 3, 8))) {
+      outputs.push_back(std::move(t));
+    }
+  }
+  return outputs;
+}
+
+// Test case 1: two columns, in a different order than in the files, read in
+// parallel. Batches span row groups and files.
+ColumnarDatasetParams ColumnarDatasetParams1() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"name", "id"},
+                               /*batch_size=*/3,
+                               /*num_parallel_reads=*/4,
+                               /*output_dtypes=*/{DT_STRING, DT_INT64},
+                               /*node_name=*/kNodeName);
+}
+
+// Test case 2: one column, read sequentially. Every batch is a row group.
+ColumnarDatasetParams ColumnarDatasetParams2() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"score"},
+                               /*batch_size=*/2,
+                               /*num_parallel_reads=*/1,
+                               /*output_dtypes=*/{DT_FLOAT},
+                               /*node_name=*/kNodeName);
+}
+
+// Test case 3: a column that the files do not have.
+ColumnarDatasetParams MissingColumnParams() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"missing"},
+                               /*batch_size=*/2,
+                               /*num_parallel_reads=*/1,
+                               /*output_dtypes=*/{DT_INT64},
+                               /*node_name=*/kNodeName);
+}
+
+// Test case 4: a column with a different type than in the files.
+ColumnarDatasetParams MismatchedTypeParams() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"id"},
+                               /*batch_size=*/2,
+                               /*num_parallel_reads=*/1,
+                               /*output_dtypes=*/{DT_INT32},
+                               /*node_name=*/kNodeName);
+}
+
+// Test case 5: an invalid batch size.
+ColumnarDatasetParams InvalidBatchSizeParams() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"id"},
+                               /*batch_size=*/0,
+                               /*num_parallel_reads=*/1,
+                               /*output_dtypes=*/{DT_INT64},
+                               /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<ColumnarDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/ColumnarDatasetParams1(),
+           /*expected_outputs=*/NameAndIdBatches()},
+          {/*dataset_params=*/ColumnarDatasetParams2(),
+           /*expected_outputs=*/
+           {CreateTensor<float>(TensorShape({2}), {0.0f, 0.5f}),
+            CreateTensor<float>(TensorShape({2}), {1.0f, 1.5f}),
+            CreateTensor<float>(TensorShape({2}), {2.0f, 2.5f}),
+            CreateTensor<float>(TensorShape({2}), {3.0f, 3.5f})}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                         GetNextTestCases())
+
+std::vector<SkipTestCase<ColumnarDatasetParams>> SkipTestCases() {
+  return {{/*dataset_params=*/ColumnarDatasetParams1(),
+           /*num_to_skip*/ 2, /*expected_num_skipped*/ 2, /*get_next*/ true,
+           /*expected_outputs=*/NameAndIdBatch(6, 8)},
+          {/*dataset_params=*/ColumnarDatasetParams1(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 3}};
+}
+
+ITERATOR_SKIP_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                     SkipTestCases())
+
+TEST_F(ColumnarDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(ColumnarDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(ColumnarDatasetOp::kDatasetType)));
+}
+
+TEST_F(ColumnarDatasetOpTest, DatasetOutputDtypes) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputDtypes({DT_STRING, DT_INT64}));
+}
+
+TEST_F(ColumnarDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes(
+      {PartialTensorShape({-1}), PartialTensorShape({-1})}));
+}
+
+TEST_F(ColumnarDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(name_utils::IteratorPrefix(
+      ColumnarDatasetOp::kDatasetType, dataset_params.iterator_prefix())));
+}
+
+TEST_F(ColumnarDatasetOpTest, MissingColumn) {
+  auto dataset_params = MissingColumnParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST_F(ColumnarDatasetOpTest, MismatchedType) {
+  auto dataset_params = MismatchedTypeParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST_F(ColumnarDatasetOpTest, InvalidBatchSize) {
+  auto dataset_params = InvalidBatchSizeParams();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<ColumnarDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/ColumnarDatasetParams1(),
+           /*breakpoints=*/{0, 1, 2, 4},
+           /*expected_outputs=*/NameAndIdBatches()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -23,7 +23,11 @@ namespace data {
 namespace experimental {
 
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx) {}
+    : OpKernel(ctx) {
+  if (ctx->HasAttr(kCompression)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompression, &compression_));
+  }
+}
 
 void CompressElementOp::Compute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
@@ -31,7 +35,7 @@ void CompressElementOp::Compute(OpKernelContext* ctx) {
     components.push_back(ctx->input(i));
   }
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  OP_REQUIRES_OK(ctx, CompressElement(components, compression_, &compressed));
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
@@ -406,6 +406,9 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       bool in_use TF_GUARDED_BY(&Iterator::mu_) = false;
       // Indicates whether the worker has returned end_of_sequence for the task.
       bool end_of_sequence TF_GUARDED_BY(&Iterator::mu_) = false;
+      // The number of elements the worker had ready for the task when it
+      // answered the last request.
+      int64 num_ready_elements TF_GUARDED_BY(&Iterator::mu_) = 0;
     };
 
     struct Result {
@@ -534,12 +537,31 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       worker_thread_cv_.notify_all();
     }
 
+    // Returns whether to read `task_info` through the local transfer protocol,
+    // which hands elements over by reference instead of serializing them.
+    bool UseLocalProtocol(const TaskInfo& task_info) const {
+      if (dataset()->target_workers_ == TargetWorkers::LOCAL) {
+        return true;
+      }
+      // Local reads don't support cancelling in-flight requests, which
+      // coordinated reads rely on.
+      return !StrictRoundRobin() &&
+             LocalWorkers::Get(task_info.worker_address()) != nullptr;
+    }
+
     Status AddTask(const TaskInfo& task_info) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::string address = task_info.transfer_address();
+      std::string transfer_protocol = dataset()->data_transfer_protocol_;
+      if (UseLocalProtocol(task_info)) {
+        // Local workers are registered under their worker address, which may
+        // differ from their transfer address.
+        address = task_info.worker_address();
+        transfer_protocol = kLocalTransferProtocol;
+      }
       TF_ASSIGN_OR_RETURN(
           std::unique_ptr<DataServiceWorkerClient> worker,
-          CreateDataServiceWorkerClient(task_info.transfer_address(),
-                                        dataset()->protocol_,
-                                        dataset()->data_transfer_protocol_));
+          CreateDataServiceWorkerClient(address, dataset()->protocol_,
+                                        transfer_protocol));
       tasks_.push_back(std::make_shared<Task>(task_info, std::move(worker)));
       worker_thread_cv_.notify_one();
       if (StrictRoundRobin()) {
@@ -685,6 +707,27 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     // Searches for a task to process, returning nullptr if none is found.
     std::shared_ptr<Task> GetTaskToProcess() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       VLOG(4) << "Searching for task to process";
+      // Prefer tasks whose worker has an element ready, so that a slow worker
+      // does not hold up requests other workers can answer at once. Tasks
+      // picked this way don't advance the round-robin position. After
+      // `tasks_.size()` such picks in a row, the next pick is round robin, so
+      // tasks that report no ready elements are still read from and refresh
+      // their count.
+      if (!StrictRoundRobin() && num_preferred_picks_ < tasks_.size()) {
+        for (int i = 0; i < tasks_.size(); ++i) {
+          std::shared_ptr<Task>& task =
+              tasks_[(next_task_index_ + i) % tasks_.size()];
+          if (task->num_ready_elements > 0 && !task->in_use &&
+              !task->end_of_sequence && !task->removed &&
+              current_round_ >= task->info.starting_round()) {
+            VLOG(3) << "Picking task " << task->info.task_id()
+                    << " with ready elements";
+            task->round = current_round_;
+            ++num_preferred_picks_;
+            return task;
+          }
+        }
+      }
       for (int i = 0; i < tasks_.size(); ++i) {
         std::shared_ptr<Task>& task = tasks_[next_task_index_];
         if (StrictRoundRobin() &&
@@ -710,6 +753,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         }
         task->round = current_round_;
         AdvanceTaskIndex();
+        num_preferred_picks_ = 0;
         return task;
       }
       return nullptr;
@@ -802,6 +846,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       result.ready = true;
       result.end_of_sequence = get_element_result.end_of_sequence;
       result.skip = get_element_result.skip;
+      task.num_ready_elements = get_element_result.num_ready_elements;
       if (!get_element_result.end_of_sequence && !get_element_result.skip) {
         task.skipped_previous_round = false;
         result.element = std::move(get_element_result.components);
@@ -958,6 +1003,10 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     // The index of the next task in `tasks_` to read from.
     int64 next_task_index_ TF_GUARDED_BY(mu_) = 0;
 
+    // The number of tasks picked for having ready elements since the last
+    // round-robin pick.
+    int64 num_preferred_picks_ TF_GUARDED_BY(mu_) = 0;
+
     // The number tasks in the `tasks_` list that have reached end_of_sequence.
     int64 finished_tasks_ TF_GUARDED_BY(mu_) = 0;
 
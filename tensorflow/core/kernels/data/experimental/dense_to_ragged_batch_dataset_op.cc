@@ -0,0 +1,457 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/dense_to_ragged_batch_dataset_op.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/kernels/ragged_tensor_variant.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const
+    DenseToRaggedBatchDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    DenseToRaggedBatchDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    DenseToRaggedBatchDatasetOp::kBatchSize;
+/* static */ constexpr const char* const
+    DenseToRaggedBatchDatasetOp::kDropRemainder;
+/* static */ constexpr const char* const
+    DenseToRaggedBatchDatasetOp::kParallelCopy;
+/* static */ constexpr const char* const DenseToRaggedBatchDatasetOp::kTsplits;
+/* static */ constexpr const char* const
+    DenseToRaggedBatchDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const
+    DenseToRaggedBatchDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kInputImplEmpty[] = "input_impl_empty";
+
+// Copies component `component_index` of every batch element into a dense
+// batch tensor.
+Status CopyDenseComponent(IteratorContext* ctx, size_t component_index,
+                          std::vector<std::vector<Tensor>>* batch_elements,
+                          Tensor* out) {
+  const int64 num_batch_elements = batch_elements->size();
+  const TensorShape first_element_shape =
+      (*batch_elements)[0][component_index].shape();
+  TensorShape batch_component_shape({num_batch_elements});
+  batch_component_shape.AppendShape(first_element_shape);
+  *out = Tensor(ctx->allocator({}),
+                (*batch_elements)[0][component_index].dtype(),
+                batch_component_shape);
+  if (!out->IsInitialized()) {
+    return errors::ResourceExhausted(
+        "Failed to allocate memory for the batch of component ",
+        component_index);
+  }
+  for (int64 i = 0; i < num_batch_elements; ++i) {
+    Tensor& element = (*batch_elements)[i][component_index];
+    if (element.shape() != first_element_shape) {
+      return errors::InvalidArgument(
+          "Cannot batch tensors with different shapes in component ",
+          component_index, ". First element had shape ",
+          first_element_shape.DebugString(), " and element ", i,
+          " had shape ", element.shape().DebugString(), ".");
+    }
+    TF_RETURN_IF_ERROR(
+        batch_util::CopyElementToSlice(std::move(element), out, i));
+  }
+  return Status::OK();
+}
+
+// Copies component `component_index` of every batch element into the flat
+// values of a ragged tensor whose row splits are the cumulative lengths of the
+// elements, and stores the ragged tensor in `out` as a scalar variant.
+template <typename SPLITS_TYPE>
+Status CopyRaggedComponent(
+    IteratorContext* ctx, size_t component_index,
+    const std::vector<std::vector<Tensor>>& batch_elements, Tensor* out) {
+  const int64 num_batch_elements = batch_elements.size();
+  const Tensor& first_element = batch_elements[0][component_index];
+  TensorShape row_shape = first_element.shape();
+  row_shape.RemoveDim(0);
+
+  // Compute the row splits from the element lengths in a single pass.
+  Tensor row_splits(ctx->allocator({}), DataTypeToEnum<SPLITS_TYPE>::value,
+                    TensorShape({num_batch_elements + 1}));
+  auto row_splits_vec = row_splits.vec<SPLITS_TYPE>();
+  int64 num_rows = 0;
+  row_splits_vec(0) = 0;
+  for (int64 i = 0; i < num_batch_elements; ++i) {
+    const Tensor& element = batch_elements[i][component_index];
+    bool compatible = element.dims() == first_element.dims();
+    for (int d = 1; compatible && d < element.dims(); ++d) {
+      compatible = element.dim_size(d) == first_element.dim_size(d);
+    }
+    if (!compatible) {
+      return errors::InvalidArgument(
+          "Cannot batch tensors with different inner shapes in component ",
+          component_index, ". First element had shape ",
+          first_element.shape().DebugString(), " and element ", i,
+          " had shape ", element.shape().DebugString(), ".");
+    }
+    num_rows += element.dim_size(0);
+    if (num_rows > std::numeric_limits<SPLITS_TYPE>::max()) {
+      return errors::InvalidArgument(
+          "The batch of component ", component_index, " has more rows than ",
+          "can be represented by row splits of type ",
+          DataTypeString(row_splits.dtype()), ".");
+    }
+    row_splits_vec(i + 1) = num_rows;
+  }
+
+  TensorShape values_shape({num_rows});
+  values_shape.AppendShape(row_shape);
+  Tensor values(ctx->allocator({}), first_element.dtype(), values_shape);
+  if (!values.IsInitialized()) {
+    return errors::ResourceExhausted(
+        "Failed to allocate memory for the batch of component ",
+        component_index);
+  }
+  for (int64 i = 0; i < num_batch_elements; ++i) {
+    const Tensor& element = batch_elements[i][component_index];
+    if (element.dim_size(0) > 0) {
+      TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+          element, /*src_offset=*/0, /*dst_offset=*/row_splits_vec(i),
+          /*num_slices=*/element.dim_size(0), &values));
+    }
+  }
+
+  *out = Tensor(DT_VARIANT, TensorShape({}));
+  out->scalar<Variant>()() =
+      RaggedTensorVariant(std::move(values), {std::move(row_splits)});
+  return Status::OK();
+}
+
+}  // namespace
+
+class DenseToRaggedBatchDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, int64 batch_size, bool drop_remainder,
+          bool parallel_copy, DataType splits_type, const DatasetBase* input)
+      : DatasetBase(DatasetContext(ctx)),
+        batch_size_(batch_size),
+        // See the comment on `reserve_size_` in `BatchDatasetOp`.
+        reserve_size_(drop_remainder ? batch_size
+                                     : std::min<int64>(batch_size, 1 << 16)),
+        drop_remainder_(drop_remainder),
+        parallel_copy_(parallel_copy),
+        splits_type_(splits_type),
+        input_(input),
+        traceme_metadata_(
+            {{"batch_size",
+              strings::Printf("%lld", static_cast<long long>(batch_size))},
+             {"drop_remainder", drop_remainder ? "true" : "false"},
+             {"parallel_copy", parallel_copy ? "true" : "false"}}) {
+    input_->Ref();
+
+    const auto& input_shapes = input_->output_shapes();
+    ragged_.reserve(input_shapes.size());
+    output_types_.reserve(input_shapes.size());
+    output_shapes_.reserve(input_shapes.size());
+    for (size_t i = 0; i < input_shapes.size(); ++i) {
+      ragged_.push_back(IsRaggedComponent(input_shapes[i]));
+      if (ragged_.back()) {
+        output_types_.push_back(DT_VARIANT);
+        output_shapes_.emplace_back(TensorShape({}));
+      } else {
+        output_types_.push_back(input_->output_dtypes()[i]);
+        output_shapes_.emplace_back(
+            PartialTensorShape({drop_remainder_ ? batch_size_ : -1})
+                .Concatenate(input_shapes[i]));
+      }
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override { return output_types_; }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(batch_size_);
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64 Cardinality() const override {
+    int64 n = input_->Cardinality();
+    if (n == kInfiniteCardinality || n == kUnknownCardinality) {
+      return n;
+    }
+    return n / batch_size_ + (n % batch_size_ == 0 || drop_remainder_ ? 0 : 1);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* batch_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+    Node* drop_remainder = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder));
+    AttrValue parallel_copy;
+    b->BuildAttrValue(parallel_copy_, &parallel_copy);
+    AttrValue splits_type;
+    b->BuildAttrValue(splits_type_, &splits_type);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_graph_node, batch_size, drop_remainder},
+        {{kParallelCopy, parallel_copy}, {kTsplits, splits_type}}, output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      std::vector<std::vector<Tensor>> batch_elements;
+      {
+        mutex_lock l(mu_);
+        if (!input_impl_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        batch_elements.reserve(dataset()->reserve_size_);
+        *end_of_sequence = false;
+        for (int i = 0; i < dataset()->batch_size_ && !*end_of_sequence; ++i) {
+          std::vector<Tensor> batch_element_tuple;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &batch_element_tuple, end_of_sequence));
+          if (!*end_of_sequence) {
+            batch_elements.emplace_back(std::move(batch_element_tuple));
+          } else {
+            input_impl_.reset();
+          }
+        }
+      }
+
+      if (batch_elements.empty()) {
+        DCHECK(*end_of_sequence);
+        return Status::OK();
+      }
+
+      if (dataset()->drop_remainder_ &&
+          batch_elements.size() < dataset()->batch_size_) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+
+      TF_RETURN_IF_ERROR(CopyBatch(ctx, &batch_elements, out_tensors));
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args), dataset()->batch_size_);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (!input_impl_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kInputImplEmpty), ""));
+      } else {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      if (!reader->Contains(full_name(kInputImplEmpty))) {
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      } else {
+        input_impl_.reset();
+      }
+      return Status::OK();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return dataset()->traceme_metadata_;
+    }
+
+   private:
+    // Copies the retrieved batch elements into one output tensor per tuple
+    // component. If `parallel_copy` is set, the components are copied in
+    // parallel.
+    Status CopyBatch(IteratorContext* ctx,
+                     std::vector<std::vector<Tensor>>* batch_elements,
+                     std::vector<Tensor>* out_tensors) {
+      const size_t num_components = dataset()->ragged_.size();
+      out_tensors->resize(num_components);
+      auto copy_component_fn = [this, ctx, batch_elements,
+                                out_tensors](size_t component_index) {
+        Tensor* out = &(*out_tensors)[component_index];
+        if (!dataset()->ragged_[component_index]) {
+          return CopyDenseComponent(ctx, component_index, batch_elements, out);
+        }
+        if (dataset()->splits_type_ == DT_INT32) {
+          return CopyRaggedComponent<int32>(ctx, component_index,
+                                            *batch_elements, out);
+        }
+        return CopyRaggedComponent<int64>(ctx, component_index,
+                                          *batch_elements, out);
+      };
+      if (!dataset()->parallel_copy_ || num_components == 1) {
+        for (size_t i = 0; i < num_components; ++i) {
+          TF_RETURN_IF_ERROR(copy_component_fn(i));
+        }
+        return Status::OK();
+      }
+      Status status;
+      mutex status_mu;
+      BlockingCounter counter(num_components);
+      for (size_t i = 0; i < num_components; ++i) {
+        (*ctx->runner())(
+            [i, &status, &status_mu, &counter, &copy_component_fn]() {
+              Status s = copy_component_fn(i);
+              {
+                mutex_lock l(status_mu);
+                status.Update(s);
+              }
+              counter.DecrementCount();
+            });
+      }
+      counter.Wait();
+      return status;
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+  };
+
+  const int64 batch_size_;
+  const int64 reserve_size_;
+  const bool drop_remainder_;
+  const bool parallel_copy_;
+  const DataType splits_type_;
+  const DatasetBase* const input_;
+  std::vector<bool> ragged_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const TraceMeMetadata traceme_metadata_;
+};
+
+DenseToRaggedBatchDatasetOp::DenseToRaggedBatchDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kParallelCopy, &parallel_copy_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kTsplits, &splits_type_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+// static
+bool DenseToRaggedBatchDatasetOp::IsRaggedComponent(
+    const PartialTensorShape& shape) {
+  if (shape.unknown_rank() || shape.dims() < 1 || shape.dim_size(0) >= 0) {
+    return false;
+  }
+  for (int d = 1; d < shape.dims(); ++d) {
+    if (shape.dim_size(d) < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DenseToRaggedBatchDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                              DatasetBase* input,
+                                              DatasetBase** output) {
+  int64 batch_size = 0;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kBatchSize, &batch_size));
+  OP_REQUIRES(ctx, batch_size > 0,
+              errors::InvalidArgument("Batch size must be greater than zero."));
+
+  bool drop_remainder = false;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<bool>(ctx, kDropRemainder, &drop_remainder));
+
+  const auto& input_shapes = input->output_shapes();
+  OP_REQUIRES(ctx, output_types_.size() == input_shapes.size(),
+              errors::InvalidArgument(
+                  "Expected ", input_shapes.size(), " output types but got ",
+                  output_types_.size(), "."));
+  for (size_t i = 0; i < input_shapes.size(); ++i) {
+    const DataType expected_type = IsRaggedComponent(input_shapes[i])
+                                       ? DT_VARIANT
+                                       : input->output_dtypes()[i];
+    OP_REQUIRES(ctx, output_types_[i] == expected_type,
+                errors::InvalidArgument(
+                    "Component ", i, " with shape ",
+                    input_shapes[i].DebugString(), " is batched into type ",
+                    DataTypeString(expected_type), " but the output type is ",
+                    DataTypeString(output_types_[i]), "."));
+  }
+
+  *output = new Dataset(ctx, batch_size, drop_remainder, parallel_copy_,
+                        splits_type_, input);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("DenseToRaggedBatchDataset").Device(DEVICE_CPU),
+                        DenseToRaggedBatchDatasetOp);
+}  // namespace
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
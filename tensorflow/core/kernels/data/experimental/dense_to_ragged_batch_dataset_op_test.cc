@@ -0,0 +1,233 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/dense_to_ragged_batch_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/kernels/ragged_tensor_variant.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "dense_to_ragged_batch_dataset";
+
+class DenseToRaggedBatchDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  DenseToRaggedBatchDatasetParams(T input_dataset_params, int64 batch_size,
+                                  bool drop_remainder, bool parallel_copy,
+                                  DataType splits_type,
+                                  DataTypeVector output_dtypes,
+                                  std::vector<PartialTensorShape> output_shapes,
+                                  string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        batch_size_(batch_size),
+        drop_remainder_(drop_remainder),
+        parallel_copy_(parallel_copy),
+        splits_type_(splits_type) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64>(TensorShape({}), {batch_size_}),
+            CreateTensor<bool>(TensorShape({}), {drop_remainder_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {DenseToRaggedBatchDatasetOp::kInputDataset,
+                    DenseToRaggedBatchDatasetOp::kBatchSize,
+                    DenseToRaggedBatchDatasetOp::kDropRemainder};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {DenseToRaggedBatchDatasetOp::kParallelCopy, parallel_copy_},
+        {DenseToRaggedBatchDatasetOp::kTsplits, splits_type_},
+        {DenseToRaggedBatchDatasetOp::kOutputTypes, output_dtypes_},
+        {DenseToRaggedBatchDatasetOp::kOutputShapes, output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return DenseToRaggedBatchDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64 batch_size_;
+  bool drop_remainder_;
+  bool parallel_copy_;
+  DataType splits_type_;
+};
+
+// Produces the elements ([0, 1], 10), ([2, 3], 11), ([4, 5], 12), ([6], 13)
+// and ([7], 14), whose first component has an unknown length.
+ConcatenateDatasetParams VariableLengthDatasetParams() {
+  auto tensor_slice_dataset_params_0 = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{3, 2},
+                                          {0, 1, 2, 3, 4, 5}),
+                      CreateTensor<int64>(TensorShape{3}, {10, 11, 12})},
+      /*node_name=*/"tensor_slice_0");
+  auto tensor_slice_dataset_params_1 = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{2, 1}, {6, 7}),
+                      CreateTensor<int64>(TensorShape{2}, {13, 14})},
+      /*node_name=*/"tensor_slice_1");
+  return ConcatenateDatasetParams(
+      std::move(tensor_slice_dataset_params_0),
+      std::move(tensor_slice_dataset_params_1),
+      /*output_dtypes=*/{DT_INT64, DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1}), PartialTensorShape({})},
+      /*node_name=*/"concatenate");
+}
+
+DenseToRaggedBatchDatasetParams RaggedBatchParams(bool drop_remainder,
+                                                  bool parallel_copy,
+                                                  DataType splits_type) {
+  return DenseToRaggedBatchDatasetParams(
+      VariableLengthDatasetParams(),
+      /*batch_size=*/2, drop_remainder, parallel_copy, splits_type,
+      /*output_dtypes=*/{DT_VARIANT, DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({}), PartialTensorShape({-1})},
+      /*node_name=*/kNodeName);
+}
+
+DenseToRaggedBatchDatasetParams MismatchedOutputTypeParams() {
+  return DenseToRaggedBatchDatasetParams(
+      VariableLengthDatasetParams(),
+      /*batch_size=*/2, /*drop_remainder=*/false, /*parallel_copy=*/false,
+      DT_INT64,
+      /*output_dtypes=*/{DT_INT64, DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1}),
+                         PartialTensorShape({-1})},
+      /*node_name=*/kNodeName);
+}
+
+// Checks that `encoded` is a ragged tensor with the given values and row
+// splits.
+void ExpectRaggedBatch(const Tensor& encoded, const Tensor& expected_values,
+                       const Tensor& expected_splits) {
+  ASSERT_EQ(encoded.dtype(), DT_VARIANT);
+  ASSERT_EQ(encoded.dims(), 0);
+  const RaggedTensorVariant* ragged =
+      encoded.scalar<Variant>()().get<RaggedTensorVariant>();
+  ASSERT_NE(ragged, nullptr);
+  ASSERT_EQ(ragged->ragged_rank(), 1);
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(ragged->values(),
+                                               expected_values));
+  TF_EXPECT_OK(
+      DatasetOpsTestBase::ExpectEqual(ragged->splits(0), expected_splits));
+}
+
+class DenseToRaggedBatchDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Checks the batches produced from `VariableLengthDatasetParams()`.
+  void CheckGetNext(bool parallel_copy) {
+    auto dataset_params = RaggedBatchParams(/*drop_remainder=*/false,
+                                            parallel_copy, DT_INT64);
+    TF_ASSERT_OK(Initialize(dataset_params));
+    std::vector<std::vector<Tensor>> batches;
+    bool end_of_sequence = false;
+    while (!end_of_sequence) {
+      std::vector<Tensor> out_tensors;
+      TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                      &end_of_sequence));
+      if (!end_of_sequence) {
+        batches.push_back(std::move(out_tensors));
+      }
+    }
+    ASSERT_EQ(batches.size(), 3);
+    ExpectRaggedBatch(batches[0][0],
+                      CreateTensor<int64>(TensorShape({4}), {0, 1, 2, 3}),
+                      CreateTensor<int64>(TensorShape({3}), {0, 2, 4}));
+    ExpectRaggedBatch(batches[1][0],
+                      CreateTensor<int64>(TensorShape({3}), {4, 5, 6}),
+                      CreateTensor<int64>(TensorShape({3}), {0, 2, 3}));
+    ExpectRaggedBatch(batches[2][0],
+                      CreateTensor<int64>(TensorShape({1}), {7}),
+                      CreateTensor<int64>(TensorShape({2}), {0, 1}));
+    TF_EXPECT_OK(ExpectEqual(batches[0][1],
+                             CreateTensor<int64>(TensorShape({2}), {10, 11})));
+    TF_EXPECT_OK(ExpectEqual(batches[1][1],
+                             CreateTensor<int64>(TensorShape({2}), {12, 13})));
+    TF_EXPECT_OK(ExpectEqual(batches[2][1],
+                             CreateTensor<int64>(TensorShape({1}), {14})));
+  }
+};
+
+TEST_F(DenseToRaggedBatchDatasetOpTest, GetNext) {
+  CheckGetNext(/*parallel_copy=*/false);
+}
+
+TEST_F(DenseToRaggedBatchDatasetOpTest, GetNextParallelCopy) {
+  CheckGetNext(/*parallel_copy=*/true);
+}
+
+TEST_F(DenseToRaggedBatchDatasetOpTest, DropRemainderAndInt32Splits) {
+  auto dataset_params = RaggedBatchParams(
+      /*drop_remainder=*/true, /*parallel_copy=*/false, DT_INT32);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  int num_batches = 0;
+  bool end_of_sequence = false;
+  while (true) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+    if (end_of_sequence) {
+      break;
+    }
+    if (num_batches == 1) {
+      ExpectRaggedBatch(out_tensors[0],
+                        CreateTensor<int64>(TensorShape({3}), {4, 5, 6}),
+                        CreateTensor<int32>(TensorShape({3}), {0, 2, 3}));
+    }
+    ++num_batches;
+  }
+  EXPECT_EQ(num_batches, 2);
+}
+
+TEST_F(DenseToRaggedBatchDatasetOpTest, DatasetOutputDtypes) {
+  auto dataset_params = RaggedBatchParams(
+      /*drop_remainder=*/false, /*parallel_copy=*/false, DT_INT64);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputDtypes({DT_VARIANT, DT_INT64}));
+}
+
+TEST_F(DenseToRaggedBatchDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = RaggedBatchParams(
+      /*drop_remainder=*/true, /*parallel_copy=*/false, DT_INT64);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes(
+      {PartialTensorShape({}), PartialTensorShape({2})}));
+}
+
+TEST_F(DenseToRaggedBatchDatasetOpTest, Cardinality) {
+  auto dataset_params = RaggedBatchParams(
+      /*drop_remainder=*/false, /*parallel_copy=*/false, DT_INT64);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(3));
+}
+
+TEST_F(DenseToRaggedBatchDatasetOpTest, MismatchedOutputType) {
+  auto dataset_params = MismatchedOutputTypeParams();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,483 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/random_access_tf_record_dataset_op.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/metrics.h"
+#include "tensorflow/core/data/global_shuffle_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_index.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// See documentation in ../../ops/experimental_dataset_ops.cc for a high-level
+// description of the following op.
+
+/* static */ constexpr const char* const
+    RandomAccessTFRecordDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    RandomAccessTFRecordDatasetOp::kFileNames;
+/* static */ constexpr const char* const
+    RandomAccessTFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const
+    RandomAccessTFRecordDatasetOp::kNumShards;
+/* static */ constexpr const char* const
+    RandomAccessTFRecordDatasetOp::kShardIndex;
+/* static */ constexpr const char* const
+    RandomAccessTFRecordDatasetOp::kShuffle;
+/* static */ constexpr const char* const
+    RandomAccessTFRecordDatasetOp::kShuffleSeed;
+/* static */ constexpr const char* const
+    RandomAccessTFRecordDatasetOp::kShuffleBlockSize;
+/* static */ constexpr const char* const
+    RandomAccessTFRecordDatasetOp::kShuffleWindowBlocks;
+
+constexpr char kNextRecord[] = "next_record";
+constexpr char kSeed[] = "seed";
+constexpr char kWindow[] = "window";
+constexpr char kOffset[] = "offset";
+
+class RandomAccessTFRecordDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          int64 buffer_size, int64 num_shards, int64 shard_index, bool shuffle,
+          int64 shuffle_seed, int64 shuffle_block_size,
+          int64 shuffle_window_blocks)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        buffer_size_(buffer_size),
+        num_shards_(num_shards),
+        shard_index_(shard_index),
+        shuffle_(shuffle),
+        shuffle_seed_(shuffle_seed),
+        shuffle_block_size_(shuffle_block_size),
+        shuffle_window_blocks_(shuffle_window_blocks) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+    return *dtypes;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    static std::vector<PartialTensorShape>* shapes =
+        new std::vector<PartialTensorShape>({{}});
+    return *shapes;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override { return Status::OK(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    Node* buffer_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+    Node* num_shards = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(num_shards_, &num_shards));
+    Node* shard_index = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(shard_index_, &shard_index));
+    AttrValue shuffle;
+    b->BuildAttrValue(shuffle_, &shuffle);
+    AttrValue shuffle_seed;
+    b->BuildAttrValue(shuffle_seed_, &shuffle_seed);
+    AttrValue shuffle_block_size;
+    b->BuildAttrValue(shuffle_block_size_, &shuffle_block_size);
+    AttrValue shuffle_window_blocks;
+    b->BuildAttrValue(shuffle_window_blocks_, &shuffle_window_blocks);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {filenames, buffer_size, num_shards, shard_index},
+        {std::make_pair(kShuffle, shuffle),
+         std::make_pair(kShuffleSeed, shuffle_seed),
+         std::make_pair(kShuffleBlockSize, shuffle_block_size),
+         std::make_pair(kShuffleWindowBlocks, shuffle_window_blocks)},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      Env* env = ctx->env();
+      const std::vector<string>& filenames = dataset()->filenames_;
+      offsets_.resize(filenames.size());
+      file_start_.assign(1, 0);
+      for (size_t i = 0; i < filenames.size(); ++i) {
+        // Only the index footer is read here; the offsets are loaded when the
+        // file is first read from.
+        uint64 num_records;
+        Status s = io::ReadRecordIndexSize(env, filenames[i], &num_records);
+        if (errors::IsNotFound(s) || errors::IsFailedPrecondition(s)) {
+          LOG(WARNING) << "Scanning " << filenames[i]
+                       << " because it has no up-to-date record index: " << s;
+          s = dataset()->ScanFile(env, i, &offsets_[i]);
+          if (s.ok()) {
+            num_records = offsets_[i]->size() - 1;
+          }
+        }
+        TF_RETURN_IF_ERROR(s);
+        file_start_.push_back(file_start_.back() + num_records);
+      }
+
+      // Shard `i` holds records [ShardStart(i), ShardStart(i + 1)).
+      const uint64 num_records = file_start_.back();
+      const uint64 num_shards = dataset()->num_shards_;
+      auto shard_start = [num_records, num_shards](uint64 shard) {
+        return num_records / num_shards * shard +
+               num_records % num_shards * shard / num_shards;
+      };
+      shard_begin_ = shard_start(dataset()->shard_index_);
+      shard_end_ = shard_start(dataset()->shard_index_ + 1);
+      next_record_ = shard_begin_;
+      if (dataset()->shuffle_) {
+        seed_ = dataset()->shuffle_seed_ != 0 ? dataset()->shuffle_seed_
+                                              : random::New64();
+        shuffled_reader_ = absl::make_unique<BlockShuffledReader>(
+            shard_end_ - shard_begin_, dataset()->shuffle_block_size_,
+            dataset()->shuffle_window_blocks_, seed_);
+      }
+      return Status::OK();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (shuffled_reader_ != nullptr) {
+        return GetNextShuffledLocked(ctx, out_tensors, end_of_sequence);
+      }
+      if (next_record_ >= shard_end_) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      const size_t file_index = FileIndexLocked(next_record_);
+      if (reader_ == nullptr || file_index != current_file_index_) {
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env(), file_index));
+      }
+      const uint64 record = next_record_ - file_start_[file_index];
+      // Move past a corrupt record too, so that this works with
+      // ignore_errors.
+      ++next_record_;
+      out_tensors->reserve(1);
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                TensorShape({}));
+      Status s =
+          reader_->ReadRecord(record, &out_tensors->back().scalar<tstring>()());
+      if (!s.ok()) {
+        out_tensors->pop_back();
+        return s;
+      }
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      bytes_counter->IncrementBy(
+          out_tensors->back().scalar<tstring>()().size());
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
+    Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                        bool* end_of_sequence, int* num_skipped) override {
+      mutex_lock l(mu_);
+      if (shuffled_reader_ != nullptr) {
+        int64 num_skipped_records;
+        shuffled_reader_->Skip(num_to_skip, &num_skipped_records);
+        *num_skipped = static_cast<int>(num_skipped_records);
+        *end_of_sequence = *num_skipped < num_to_skip;
+        return Status::OK();
+      }
+      *num_skipped = static_cast<int>(
+          std::min<uint64>(num_to_skip, shard_end_ - next_record_));
+      next_record_ += *num_skipped;
+      *end_of_sequence = *num_skipped < num_to_skip;
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (shuffled_reader_ != nullptr) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kSeed), static_cast<int64>(seed_)));
+        const int64 window = shuffled_reader_->window();
+        const int64 offset = shuffled_reader_->offset();
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kWindow), window));
+        return writer->WriteScalar(full_name(kOffset), offset);
+      }
+      return writer->WriteScalar(full_name(kNextRecord),
+                                 static_cast<int64>(next_record_));
+    }
+
+    // Restoring only repositions the iterator; the records before the saved
+    // position are located through the index and never read. A shuffled
+    // iterator re-reads the records of the current window.
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      if (shuffled_reader_ != nullptr) {
+        int64 seed;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed), &seed));
+        int64 window;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kWindow), &window));
+        int64 offset;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset));
+        seed_ = seed;
+        shuffled_reader_ = absl::make_unique<BlockShuffledReader>(
+            shard_end_ - shard_begin_, dataset()->shuffle_block_size_,
+            dataset()->shuffle_window_blocks_, seed_);
+        Status s = shuffled_reader_->Seek(window, offset);
+        if (!s.ok()) {
+          return errors::FailedPrecondition(
+              s.error_message(), ". The input files may have changed.");
+        }
+        return Status::OK();
+      }
+      int64 next_record;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNextRecord), &next_record));
+      if (next_record < static_cast<int64>(shard_begin_) ||
+          next_record > static_cast<int64>(shard_end_)) {
+        return errors::FailedPrecondition(
+            "Checkpointed record ", next_record,
+            " is outside of the shard's records [", shard_begin_, ", ",
+            shard_end_, "). The input files may have changed.");
+      }
+      next_record_ = next_record;
+      return Status::OK();
+    }
+
+   private:
+    Status GetNextShuffledLocked(IteratorContext* ctx,
+                                 std::vector<Tensor>* out_tensors,
+                                 bool* end_of_sequence)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Env* env = ctx->env();
+      auto read_range = [this, env](uint64 begin, uint64 end,
+                                    std::vector<tstring>* records)
+                            TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+                              return ReadRangeLocked(env, begin, end, records);
+                            };
+      tstring record;
+      TF_RETURN_IF_ERROR(
+          shuffled_reader_->GetNext(read_range, &record, end_of_sequence));
+      if (*end_of_sequence) return Status::OK();
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      bytes_counter->IncrementBy(record.size());
+      out_tensors->reserve(1);
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                TensorShape({}));
+      out_tensors->back().scalar<tstring>()() = std::move(record);
+      return Status::OK();
+    }
+
+    // Appends records [begin, end) of the shard to `*records`.
+    Status ReadRangeLocked(Env* env, uint64 begin, uint64 end,
+                           std::vector<tstring>* records)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (uint64 i = shard_begin_ + begin; i < shard_begin_ + end; ++i) {
+        const size_t file_index = FileIndexLocked(i);
+        if (reader_ == nullptr || file_index != current_file_index_) {
+          TF_RETURN_IF_ERROR(SetupStreamsLocked(env, file_index));
+        }
+        records->emplace_back();
+        TF_RETURN_IF_ERROR(
+            reader_->ReadRecord(i - file_start_[file_index], &records->back()));
+      }
+      return Status::OK();
+    }
+
+    // Returns the index of the file that holds global record `record`.
+    size_t FileIndexLocked(uint64 record) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return std::upper_bound(file_start_.begin(), file_start_.end(),
+                              record) -
+             file_start_.begin() - 1;
+    }
+
+    // Sets up the reader for the file at `file_index`.
+    Status SetupStreamsLocked(Env* env, size_t file_index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      reader_.reset();
+      const string& filename = dataset()->filenames_[file_index];
+      if (offsets_[file_index] == nullptr) {
+        auto offsets = std::make_shared<std::vector<uint64>>();
+        TF_RETURN_IF_ERROR(io::ReadRecordIndex(env, filename, offsets.get()));
+        if (offsets->size() - 1 !=
+            file_start_[file_index + 1] - file_start_[file_index]) {
+          return errors::FailedPrecondition(
+              "The record index of ", filename, " changed while reading it.");
+        }
+        offsets_[file_index] = std::move(offsets);
+      }
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file_));
+      reader_ = absl::make_unique<io::IndexedRecordReader>(
+          file_.get(), offsets_[file_index].get(), dataset()->buffer_size_);
+      current_file_index_ = file_index;
+      return Status::OK();
+    }
+
+    mutex mu_;
+    // `offsets_[i]` is the record index of file `i`, or null if it has not
+    // been read from yet.
+    std::vector<std::shared_ptr<const std::vector<uint64>>> offsets_
+        TF_GUARDED_BY(mu_);
+    // `file_start_[i]` is the global ordinal of the first record of file `i`;
+    // the last element is the total number of records.
+    std::vector<uint64> file_start_ TF_GUARDED_BY(mu_);
+    uint64 shard_begin_ TF_GUARDED_BY(mu_) = 0;
+    uint64 shard_end_ TF_GUARDED_BY(mu_) = 0;
+    uint64 next_record_ TF_GUARDED_BY(mu_) = 0;
+    // Used instead of `next_record_` when the dataset shuffles.
+    uint64 seed_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<BlockShuffledReader> shuffled_reader_ TF_GUARDED_BY(mu_);
+
+    size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+    // `reader_` borrows the object that `file_` points to, so it must be
+    // destroyed before `file_`.
+    std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<io::IndexedRecordReader> reader_ TF_GUARDED_BY(mu_);
+  };
+
+  // Stores in `*offsets` the record index of file `file_index`, found by
+  // scanning the file. Files without an up-to-date index are scanned once and
+  // the result is shared by all iterators of this dataset.
+  Status ScanFile(Env* env, size_t file_index,
+                  std::shared_ptr<const std::vector<uint64>>* offsets) const {
+    {
+      mutex_lock l(mu_);
+      auto it = scanned_offsets_.find(file_index);
+      if (it != scanned_offsets_.end()) {
+        *offsets = it->second;
+        return Status::OK();
+      }
+    }
+    auto scanned = std::make_shared<std::vector<uint64>>();
+    TF_RETURN_IF_ERROR(
+        io::BuildRecordIndex(env, filenames_[file_index], scanned.get()));
+    mutex_lock l(mu_);
+    *offsets = scanned_offsets_.emplace(file_index, std::move(scanned))
+                   .first->second;
+    return Status::OK();
+  }
+
+  const std::vector<string> filenames_;
+  const int64 buffer_size_;
+  const int64 num_shards_;
+  const int64 shard_index_;
+  const bool shuffle_;
+  const int64 shuffle_seed_;
+  const int64 shuffle_block_size_;
+  const int64 shuffle_window_blocks_;
+
+  mutable mutex mu_;
+  mutable absl::flat_hash_map<size_t,
+                              std::shared_ptr<const std::vector<uint64>>>
+      scanned_offsets_ TF_GUARDED_BY(mu_);
+};
+
+RandomAccessTFRecordDatasetOp::RandomAccessTFRecordDatasetOp(
+    OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kShuffle, &shuffle_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kShuffleSeed, &shuffle_seed_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kShuffleBlockSize, &shuffle_block_size_));
+  OP_REQUIRES(ctx, shuffle_block_size_ > 0,
+              errors::InvalidArgument("`shuffle_block_size` must be > 0"));
+  OP_REQUIRES_OK(ctx,
+                 ctx->GetAttr(kShuffleWindowBlocks, &shuffle_window_blocks_));
+  OP_REQUIRES(ctx, shuffle_window_blocks_ > 0,
+              errors::InvalidArgument("`shuffle_window_blocks` must be > 0"));
+}
+
+void RandomAccessTFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                                DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+  std::vector<string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    metrics::RecordTFDataFilename(kDatasetType, filenames[i]);
+  }
+
+  int64 buffer_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64>(ctx, kBufferSize, &buffer_size));
+  OP_REQUIRES(ctx, buffer_size >= 0,
+              errors::InvalidArgument(
+                  "`buffer_size` must be >= 0 (0 == no buffering)"));
+
+  int64 num_shards;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kNumShards, &num_shards));
+  OP_REQUIRES(ctx, num_shards > 0,
+              errors::InvalidArgument("`num_shards` must be > 0"));
+
+  int64 shard_index;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64>(ctx, kShardIndex, &shard_index));
+  OP_REQUIRES(ctx, shard_index >= 0 && shard_index < num_shards,
+              errors::InvalidArgument("`shard_index` must be in [0, ",
+                                      num_shards, ")"));
+
+  *output = new Dataset(ctx, std::move(filenames), buffer_size, num_shards,
+                        shard_index, shuffle_, shuffle_seed_,
+                        shuffle_block_size_, shuffle_window_blocks_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("RandomAccessTFRecordDataset").Device(DEVICE_CPU),
+                        RandomAccessTFRecordDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
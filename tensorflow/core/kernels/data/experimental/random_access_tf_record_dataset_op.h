@@ -0,0 +1,55 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_RANDOM_ACCESS_TF_RECORD_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_RANDOM_ACCESS_TF_RECORD_DATASET_OP_H_
+
+#include "tensorflow/core/framework/dataset.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+class RandomAccessTFRecordDatasetOp : public DatasetOpKernel {
+ public:
+  static constexpr const char* const kDatasetType = "RandomAccessTFRecord";
+  static constexpr const char* const kFileNames = "filenames";
+  static constexpr const char* const kBufferSize = "buffer_size";
+  static constexpr const char* const kNumShards = "num_shards";
+  static constexpr const char* const kShardIndex = "shard_index";
+  static constexpr const char* const kShuffle = "shuffle";
+  static constexpr const char* const kShuffleSeed = "shuffle_seed";
+  static constexpr const char* const kShuffleBlockSize = "shuffle_block_size";
+  static constexpr const char* const kShuffleWindowBlocks =
+      "shuffle_window_blocks";
+
+  explicit RandomAccessTFRecordDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override;
+
+ private:
+  class Dataset;
+
+  bool shuffle_ = false;
+  int64 shuffle_seed_ = 0;
+  int64 shuffle_block_size_ = 0;
+  int64 shuffle_window_blocks_ = 0;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_RANDOM_ACCESS_TF_RECORD_DATASET_OP_H_
@@ -0,0 +1,322 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/random_access_tf_record_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/lib/io/record_index.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "random_access_tf_record_dataset";
+
+class RandomAccessTFRecordDatasetParams : public DatasetParams {
+ public:
+  RandomAccessTFRecordDatasetParams(std::vector<tstring> filenames,
+                                    int64 buffer_size, int64 num_shards,
+                                    int64 shard_index, bool shuffle,
+                                    int64 shuffle_seed,
+                                    int64 shuffle_block_size,
+                                    int64 shuffle_window_blocks,
+                                    string node_name)
+      : DatasetParams({DT_STRING}, {PartialTensorShape({})},
+                      std::move(node_name)),
+        filenames_(std::move(filenames)),
+        buffer_size_(buffer_size),
+        num_shards_(num_shards),
+        shard_index_(shard_index),
+        shuffle_(shuffle),
+        shuffle_seed_(shuffle_seed),
+        shuffle_block_size_(shuffle_block_size),
+        shuffle_window_blocks_(shuffle_window_blocks) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    int num_files = filenames_.size();
+    return {CreateTensor<tstring>(TensorShape({num_files}), filenames_),
+            CreateTensor<int64>(TensorShape({}), {buffer_size_}),
+            CreateTensor<int64>(TensorShape({}), {num_shards_}),
+            CreateTensor<int64>(TensorShape({}), {shard_index_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    input_names->clear();
+    *input_names = {
+        RandomAccessTFRecordDatasetOp::kFileNames,
+        RandomAccessTFRecordDatasetOp::kBufferSize,
+        RandomAccessTFRecordDatasetOp::kNumShards,
+        RandomAccessTFRecordDatasetOp::kShardIndex,
+    };
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {RandomAccessTFRecordDatasetOp::kShuffle, shuffle_},
+        {RandomAccessTFRecordDatasetOp::kShuffleSeed, shuffle_seed_},
+        {RandomAccessTFRecordDatasetOp::kShuffleBlockSize,
+         shuffle_block_size_},
+        {RandomAccessTFRecordDatasetOp::kShuffleWindowBlocks,
+         shuffle_window_blocks_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return RandomAccessTFRecordDatasetOp::kDatasetType;
+  }
+
+  const std::vector<tstring>& filenames() const { return filenames_; }
+
+ private:
+  std::vector<tstring> filenames_;
+  int64 buffer_size_;
+  int64 num_shards_;
+  int64 shard_index_;
+  bool shuffle_;
+  int64 shuffle_seed_;
+  int64 shuffle_block_size_;
+  int64 shuffle_window_blocks_;
+};
+
+class RandomAccessTFRecordDatasetOpTest : public DatasetOpsTestBase {};
+
+// Writes two uncompressed TFRecord files. Only the first one gets a record
+// index, so the second one is scanned when iteration starts.
+std::vector<tstring> CreateTestFiles() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/random_access_tf_record_1"),
+      absl::StrCat(testing::TmpDir(), "/random_access_tf_record_2")};
+  std::vector<std::vector<absl::string_view>> contents = {
+      {"1", "22", "333"}, {"a", "bb", "ccc"}};
+  CompressionParams params;
+  params.compression_type = CompressionType::UNCOMPRESSED;
+  Env* env = Env::Default();
+  for (int i = 0; i < filenames.size(); ++i) {
+    Status s = WriteDataToTFRecordFile(filenames[i], contents[i], params);
+    if (s.ok() && i == 0) {
+      std::vector<uint64> offsets;
+      s = io::BuildRecordIndex(env, filenames[i], &offsets);
+      if (s.ok()) s = io::WriteRecordIndex(env, filenames[i], offsets);
+    } else if (s.ok()) {
+      env->DeleteFile(io::RecordIndexFilename(filenames[i])).IgnoreError();
+    }
+    if (!s.ok()) {
+      VLOG(WARNING) << "Failed to create the test file " << filenames[i]
+                    << ": " << s;
+    }
+  }
+  return filenames;
+}
+
+// Test case 1: all records of both files.
+RandomAccessTFRecordDatasetParams RandomAccessTFRecordDatasetParams1() {
+  return RandomAccessTFRecordDatasetParams(CreateTestFiles(),
+                                           /*buffer_size=*/0,
+                                           /*num_shards=*/1,
+                                           /*shard_index=*/0,
+                                           /*shuffle=*/false,
+                                           /*shuffle_seed=*/0,
+                                           /*shuffle_block_size=*/256,
+                                           /*shuffle_window_blocks=*/64,
+                                           /*node_name=*/kNodeName);
+}
+
+// Test case 2: the second of two shards, which starts at a file boundary.
+RandomAccessTFRecordDatasetParams RandomAccessTFRecordDatasetParams2() {
+  return RandomAccessTFRecordDatasetParams(CreateTestFiles(),
+                                           /*buffer_size=*/16,
+                                           /*num_shards=*/2,
+                                           /*shard_index=*/1,
+                                           /*shuffle=*/false,
+                                           /*shuffle_seed=*/0,
+                                           /*shuffle_block_size=*/256,
+                                           /*shuffle_window_blocks=*/64,
+                                           /*node_name=*/kNodeName);
+}
+
+// Test case 3: the second of three shards, which spans both files.
+RandomAccessTFRecordDatasetParams RandomAccessTFRecordDatasetParams3() {
+  return RandomAccessTFRecordDatasetParams(CreateTestFiles(),
+                                           /*buffer_size=*/1024,
+                                           /*num_shards=*/3,
+                                           /*shard_index=*/1,
+                                           /*shuffle=*/false,
+                                           /*shuffle_seed=*/0,
+                                           /*shuffle_block_size=*/256,
+                                           /*shuffle_window_blocks=*/64,
+                                           /*node_name=*/kNodeName);
+}
+
+// Test case 4: all records, shuffled in two windows of two blocks each.
+RandomAccessTFRecordDatasetParams RandomAccessTFRecordDatasetParams4() {
+  return RandomAccessTFRecordDatasetParams(CreateTestFiles(),
+                                           /*buffer_size=*/16,
+                                           /*num_shards=*/1,
+                                           /*shard_index=*/0,
+                                           /*shuffle=*/true,
+                                           /*shuffle_seed=*/42,
+                                           /*shuffle_block_size=*/2,
+                                           /*shuffle_window_blocks=*/2,
+                                           /*node_name=*/kNodeName);
+}
+
+// Test case 5: an invalid shard index.
+RandomAccessTFRecordDatasetParams InvalidShardIndexParams() {
+  return RandomAccessTFRecordDatasetParams(CreateTestFiles(),
+                                           /*buffer_size=*/0,
+                                           /*num_shards=*/2,
+                                           /*shard_index=*/2,
+                                           /*shuffle=*/false,
+                                           /*shuffle_seed=*/0,
+                                           /*shuffle_block_size=*/256,
+                                           /*shuffle_window_blocks=*/64,
+                                           /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<RandomAccessTFRecordDatasetParams>>
+GetNextTestCases() {
+  return {
+      {/*dataset_params=*/RandomAccessTFRecordDatasetParams1(),
+       /*expected_outputs=*/
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/RandomAccessTFRecordDatasetParams2(),
+       /*expected_outputs=*/
+       CreateTensors<tstring>(TensorShape({}), {{"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/RandomAccessTFRecordDatasetParams3(),
+       /*expected_outputs=*/
+       CreateTensors<tstring>(TensorShape({}), {{"333"}, {"a"}})},
+      {/*dataset_params=*/RandomAccessTFRecordDatasetParams4(),
+       /*expected_outputs=*/
+       CreateTensors<tstring>(
+           TensorShape({}),
+           {{"bb"}, {"333"}, {"a"}, {"ccc"}, {"1"}, {"22"}})}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(RandomAccessTFRecordDatasetOpTest,
+                         RandomAccessTFRecordDatasetParams, GetNextTestCases())
+
+std::vector<SkipTestCase<RandomAccessTFRecordDatasetParams>> SkipTestCases() {
+  return {{/*dataset_params=*/RandomAccessTFRecordDatasetParams1(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
+          {/*dataset_params=*/RandomAccessTFRecordDatasetParams1(),
+           /*num_to_skip*/ 7, /*expected_num_skipped*/ 6},
+          {/*dataset_params=*/RandomAccessTFRecordDatasetParams2(),
+           /*num_to_skip*/ 1, /*expected_num_skipped*/ 1, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
+          {/*dataset_params=*/RandomAccessTFRecordDatasetParams4(),
+           /*num_to_skip*/ 3, /*expected_num_skipped*/ 3, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"ccc"}})}};
+}
+
+ITERATOR_SKIP_TEST_P(RandomAccessTFRecordDatasetOpTest,
+                     RandomAccessTFRecordDatasetParams, SkipTestCases())
+
+TEST_F(RandomAccessTFRecordDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = RandomAccessTFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(RandomAccessTFRecordDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = RandomAccessTFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(RandomAccessTFRecordDatasetOp::kDatasetType)));
+}
+
+TEST_F(RandomAccessTFRecordDatasetOpTest, DatasetOutputDtypes) {
+  auto dataset_params = RandomAccessTFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputDtypes({DT_STRING}));
+}
+
+TEST_F(RandomAccessTFRecordDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = RandomAccessTFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes({PartialTensorShape({})}));
+}
+
+TEST_F(RandomAccessTFRecordDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = RandomAccessTFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(name_utils::IteratorPrefix(
+      RandomAccessTFRecordDatasetOp::kDatasetType,
+      dataset_params.iterator_prefix())));
+}
+
+TEST_F(RandomAccessTFRecordDatasetOpTest, InvalidShardIndex) {
+  auto dataset_params = InvalidShardIndexParams();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+// Only the footer of the index of a file outside the shard is read, so a
+// corrupt offset in it goes unnoticed.
+TEST_F(RandomAccessTFRecordDatasetOpTest, ReadsOffsetsOnlyForFilesInShard) {
+  auto dataset_params = RandomAccessTFRecordDatasetParams2();
+  Env* env = Env::Default();
+  const string index_filename =
+      io::RecordIndexFilename(dataset_params.filenames()[0]);
+  string index;
+  TF_ASSERT_OK(ReadFileToString(env, index_filename, &index));
+  index[0] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(env, index_filename, index));
+
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(
+      out_tensors,
+      CreateTensors<tstring>(TensorShape({}), {{"a"}, {"bb"}, {"ccc"}}),
+      /*compare_order=*/true));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<RandomAccessTFRecordDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {
+      {/*dataset_params=*/RandomAccessTFRecordDatasetParams1(),
+       /*breakpoints=*/{0, 2, 4, 7},
+       /*expected_outputs=*/
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/RandomAccessTFRecordDatasetParams2(),
+       /*breakpoints=*/{0, 1, 4},
+       /*expected_outputs=*/
+       CreateTensors<tstring>(TensorShape({}), {{"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/RandomAccessTFRecordDatasetParams4(),
+       /*breakpoints=*/{0, 3, 5, 7},
+       /*expected_outputs=*/
+       CreateTensors<tstring>(
+           TensorShape({}),
+           {{"bb"}, {"333"}, {"a"}, {"ccc"}, {"1"}, {"22"}})}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(RandomAccessTFRecordDatasetOpTest,
+                                 RandomAccessTFRecordDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
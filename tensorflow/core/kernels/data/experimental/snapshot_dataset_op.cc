@@ -53,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/numbers.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/snapshot.pb.h"
@@ -82,6 +83,10 @@ namespace experimental {
     SnapshotDatasetV2Op::kReaderFuncTarguments;
 /* static */ constexpr const char* const
     SnapshotDatasetV2Op::kShardFuncTarguments;
+/* static */ constexpr const char* const
+    SnapshotDatasetV2Op::kWriterBufferSizeBytes;
+/* static */ constexpr const char* const
+    SnapshotDatasetV2Op::kNumWritersPerShard;
 /* static */ constexpr const int SnapshotDatasetV2Op::kFileFormatVersion;
 
 // ==== Snapshot Implementation ====
@@ -93,7 +98,9 @@ namespace experimental {
  *       - run1/
  *         - 00000000.shard/  // shard index
  *           // new checkpoint files are created on all threads at once, either
- *           // when a file gets too big, or when a TF checkpoint happens.
+ *           // when a file gets too big, or when a TF checkpoint happens. With
+ *           // `num_writers_per_shard` > 1, each of the shard's writers writes
+ *           // its own consecutively numbered checkpoint file.
  *           - 00000000.snapshot  // checkpoint file 0
  *           - 00000001.snapshot  // checkpoint file 1
  *           - ...
@@ -120,7 +127,8 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
           const std::string& path, const std::string& compression,
           const std::string& reader_prefix, const std::string& writer_prefix,
           std::unique_ptr<CapturedFunction> reader_func,
-          std::unique_ptr<CapturedFunction> shard_func)
+          std::unique_ptr<CapturedFunction> shard_func,
+          int64 writer_buffer_size_bytes, int64 num_writers_per_shard)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         hash_(hash),
@@ -129,7 +137,9 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         reader_prefix_(reader_prefix),
         writer_prefix_(writer_prefix),
         reader_func_(std::move(reader_func)),
-        shard_func_(std::move(shard_func)) {
+        shard_func_(std::move(shard_func)),
+        writer_buffer_size_bytes_(writer_buffer_size_bytes),
+        num_writers_per_shard_(num_writers_per_shard) {
     input_->Ref();
   }
 
@@ -213,6 +223,13 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
     b->BuildAttrValue(shard_func_other_args_types,
                       &shard_func_arguments_types_attr);
 
+    AttrValue writer_buffer_size_bytes_attr;
+    b->BuildAttrValue(writer_buffer_size_bytes_,
+                      &writer_buffer_size_bytes_attr);
+
+    AttrValue num_writers_per_shard_attr;
+    b->BuildAttrValue(num_writers_per_shard_, &num_writers_per_shard_attr);
+
     return b->AddDataset(
         this,
         /*inputs=*/
@@ -229,7 +246,9 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
          {kReaderFunc, reader_func_attr},
          {kShardFunc, shard_func_attr},
          {kReaderFuncTarguments, reader_func_arguments_types_attr},
-         {kShardFuncTarguments, shard_func_arguments_types_attr}},
+         {kShardFuncTarguments, shard_func_arguments_types_attr},
+         {kWriterBufferSizeBytes, writer_buffer_size_bytes_attr},
+         {kNumWritersPerShard, num_writers_per_shard_attr}},
         output);
   }
 
@@ -244,6 +263,12 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
   std::unique_ptr<CapturedFunction> reader_func_;
   std::unique_ptr<CapturedFunction> shard_func_;
 
+  // Upper bound on the bytes of elements buffered by the writer that have not
+  // been written out yet. A value of 0 means the buffer is unbounded.
+  const int64 writer_buffer_size_bytes_;
+  // Number of writer threads, each writing its own file, per shard.
+  const int64 num_writers_per_shard_;
+
   class Reader : public DatasetIterator<Dataset> {
    public:
     static constexpr const char* const kIteratorName = "Reader";
@@ -347,9 +372,17 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         : DatasetIterator<Dataset>(params),
           writers_closed_(false),
           run_id_(0),
-          current_checkpoint_id_(0) {}
+          current_checkpoint_id_(0) {
+      if (dataset()->writer_buffer_size_bytes_ > 0) {
+        budget_ = absl::make_unique<snapshot_util::WriterBufferBudget>(
+            dataset()->writer_buffer_size_bytes_);
+      }
+    }
 
     ~Writer() override {
+      if (budget_ != nullptr) {
+        budget_->Cancel();
+      }
       mutex_lock l(mu_);
       SignalEOF(true);
     }
@@ -418,25 +451,38 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         int64 shard_index = 0;
         TF_RETURN_IF_ERROR(GetShardIndex(ctx, *out_tensors, &shard_index));
 
-        // If the index does not exist, we will start a new thread.
-        if (writers_.count(shard_index) == 0) {
+        // If the index does not exist, we will start new threads. Each of
+        // the shard's writers compresses and writes its own checkpoint file,
+        // and elements are assigned to them round-robin.
+        ShardWriters& shard_writers = writers_[shard_index];
+        if (shard_writers.writers.empty()) {
           auto snapshot_shard_directory =
               snapshot_util::ShardDirectory(run_dir_, shard_index);
-          auto writer = std::make_unique<snapshot_util::AsyncWriter>(
-              ctx->env(), shard_index, snapshot_shard_directory,
-              current_checkpoint_id_, dataset()->compression_,
-              kFileFormatVersion, dataset()->output_dtypes(), [this](Status s) {
-                if (!s.ok()) {
-                  LOG(ERROR) << "AsyncWriter in snapshot writer failed: " << s;
-                  mutex_lock l(writer_status_mu_);
-                  writer_status_ = s;
-                }
-              });
-          writers_.insert({shard_index, std::move(writer)});
+          for (int64 i = 0; i < dataset()->num_writers_per_shard_; ++i) {
+            shard_writers.writers.push_back(
+                std::make_unique<snapshot_util::AsyncWriter>(
+                    ctx->env(), shard_index, snapshot_shard_directory,
+                    current_checkpoint_id_ + i, dataset()->compression_,
+                    kFileFormatVersion, dataset()->output_dtypes(),
+                    [this](Status s) {
+                      if (!s.ok()) {
+                        LOG(ERROR)
+                            << "AsyncWriter in snapshot writer failed: " << s;
+                        mutex_lock l(writer_status_mu_);
+                        writer_status_ = s;
+                      }
+                    },
+                    budget_.get()));
+          }
         }
-        current_writer = writers_[shard_index].get();
+        current_writer =
+            shard_writers.writers[shard_writers.next_writer].get();
+        shard_writers.next_writer =
+            (shard_writers.next_writer + 1) % shard_writers.writers.size();
       }
 
+      // Blocks while the writer buffer budget is exhausted, which throttles
+      // the input pipeline to the speed at which the snapshot is written.
       current_writer->Write(*out_tensors);
       return Status::OK();
     }
@@ -445,14 +491,21 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
     Status SaveInternal(SerializationContext* ctx,
                         IteratorStateWriter* writer) override {
       mutex_lock l(mu_);
+      // Closes the current checkpoint files so that everything read from the
+      // input so far is durable before the input position is saved. A
+      // restored writer then continues with fresh checkpoint files rather than
+      // overwriting the ones that hold the elements written so far.
+      SignalEOF(/*mark_closed=*/false);
+      current_checkpoint_id_ += dataset()->num_writers_per_shard_;
+      {
+        mutex_lock wsl(writer_status_mu_);
+        TF_RETURN_IF_ERROR(writer_status_);
+      }
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(full_name(kRunId), static_cast<int64>(run_id_)));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(full_name(kCurrentCheckpointId),
                               static_cast<int64>(current_checkpoint_id_)));
-      SignalEOF(/*mark_closed=*/false);
-      writers_.clear();
-      current_checkpoint_id_++;
       return SaveInput(ctx, writer, input_impl_);
     }
 
@@ -473,6 +526,7 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
               dataset()->hash_),
           run_id_);
       current_checkpoint_id_ = static_cast<uint64>(current_checkpoint_id);
+      TF_RETURN_IF_ERROR(DeleteCheckpointFilesFrom(ctx->env()));
 
       return RestoreInput(ctx, reader, input_impl_);
     }
@@ -499,6 +553,33 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
       return Status::OK();
     }
 
+    // Deletes the checkpoint files written after the restored checkpoint, e.g.
+    // by a preempted writer. Their elements are written again from the
+    // restored input position, so keeping them would duplicate elements.
+    Status DeleteCheckpointFilesFrom(Env* env)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<std::string> checkpoint_files;
+      TF_RETURN_IF_ERROR(env->GetMatchingPaths(
+          io::JoinPath(
+              run_dir_,
+              strings::StrCat("*", snapshot_util::kShardDirectorySuffix),
+              "*.snapshot"),
+          &checkpoint_files));
+      for (const auto& checkpoint_file : checkpoint_files) {
+        uint64 checkpoint_id;
+        if (!strings::safe_strtou64(
+                io::Basename(checkpoint_file).substr(0, 8), &checkpoint_id)) {
+          continue;
+        }
+        if (checkpoint_id >= current_checkpoint_id_) {
+          VLOG(2) << "Deleting snapshot checkpoint file " << checkpoint_file
+                  << " written after the restored iterator checkpoint.";
+          TF_RETURN_IF_ERROR(env->DeleteFile(checkpoint_file));
+        }
+      }
+      return Status::OK();
+    }
+
     Status WriteMetadataFile(Env* env, bool finalized)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       DCHECK(!run_dir_.empty());
@@ -523,8 +604,10 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
       if (!writers_closed_) {
         // Push the end of sequence signal to each of the threads to close
         // files.
-        for (auto& writer : writers_) {
-          writer.second->SignalEOF();
+        for (auto& shard_writers : writers_) {
+          for (auto& writer : shard_writers.second.writers) {
+            writer->SignalEOF();
+          }
         }
 
         writers_.clear();
@@ -532,12 +615,20 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
       }
     }
 
+    struct ShardWriters {
+      std::vector<std::unique_ptr<snapshot_util::AsyncWriter>> writers;
+      // Index of the writer that receives the shard's next element.
+      size_t next_writer = 0;
+    };
+
     mutex mu_;
     mutex writer_status_mu_;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
 
-    absl::flat_hash_map<int64, std::unique_ptr<snapshot_util::AsyncWriter>>
-        writers_ TF_GUARDED_BY(mu_);
+    // Shared by the writers of all shards; null if the buffer is unbounded.
+    // Declared before `writers_` so that it outlives the writer threads.
+    std::unique_ptr<snapshot_util::WriterBufferBudget> budget_;
+    absl::flat_hash_map<int64, ShardWriters> writers_ TF_GUARDED_BY(mu_);
     Status writer_status_ TF_GUARDED_BY(writer_status_mu_);
     bool writers_closed_ TF_GUARDED_BY(mu_);
 
@@ -736,6 +827,23 @@ SnapshotDatasetV2Op::SnapshotDatasetV2Op(OpKernelConstruction* ctx)
   if (ctx->HasAttr(kWriterPrefix)) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr(kWriterPrefix, &writer_prefix_));
   }
+  if (ctx->HasAttr(kWriterBufferSizeBytes)) {
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttr(kWriterBufferSizeBytes, &writer_buffer_size_bytes_));
+    OP_REQUIRES(ctx, writer_buffer_size_bytes_ >= 0,
+                errors::InvalidArgument(
+                    "`writer_buffer_size_bytes` must be non-negative, got ",
+                    writer_buffer_size_bytes_));
+  }
+
+  if (ctx->HasAttr(kNumWritersPerShard)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kNumWritersPerShard, &num_writers_per_shard_));
+    OP_REQUIRES(ctx, num_writers_per_shard_ > 0,
+                errors::InvalidArgument(
+                    "`num_writers_per_shard` must be positive, got ",
+                    num_writers_per_shard_));
+  }
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kHashValid, &hash_valid_));
   int64 hash;
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kHash, &hash));
@@ -784,7 +892,8 @@ void SnapshotDatasetV2Op::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
 
   *output = new SnapshotDatasetV2Op::Dataset(
       ctx, input, hash, path, compression, reader_prefix_, writer_prefix_,
-      std::move(reader_func), std::move(shard_func));
+      std::move(reader_func), std::move(shard_func), writer_buffer_size_bytes_,
+      num_writers_per_shard_);
 }
 
 namespace {
@@ -885,9 +994,11 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         ctx,
         compression_ == io::compression::kNone ||
             compression_ == io::compression::kGzip ||
-            compression_ == io::compression::kSnappy,
-        errors::InvalidArgument("compression must be either '', 'GZIP' or "
-                                "'SNAPPY'."));
+            compression_ == io::compression::kSnappy ||
+            compression_ == io::compression::kZstd ||
+            compression_ == io::compression::kLz4,
+        errors::InvalidArgument("compression must be either '', 'GZIP', "
+                                "'SNAPPY', 'ZSTD' or 'LZ4'."));
 
     OP_REQUIRES(
         ctx, pending_snapshot_expiry_seconds_ >= 1,
@@ -475,13 +475,24 @@ class PrivateThreadPoolDatasetOp::Dataset : public DatasetBase {
         : DatasetIterator<Dataset>(params) {}
 
     Status Initialize(IteratorContext* ctx) override {
+      if (ctx->numa_node() != port::kNUMANoAffinity) {
+        // The dataset's pool is shared by all of its iterators, so an
+        // iterator placed on a NUMA node gets a pool of its own.
+        ThreadOptions thread_options;
+        thread_options.numa_node = ctx->numa_node();
+        numa_thread_pool_ = absl::make_unique<thread::ThreadPool>(
+            ctx->env(), thread_options, "data_private_threadpool",
+            dataset()->num_threads_);
+      }
       return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
     }
 
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
-      thread::ThreadPool* pool = dataset()->thread_pool_.get();
+      thread::ThreadPool* pool = numa_thread_pool_
+                                     ? numa_thread_pool_.get()
+                                     : dataset()->thread_pool_.get();
       IteratorContext::Params params(ctx);
       params.runner = [pool](std::function<void()> c) {
         pool->Schedule(std::move(c));
@@ -515,6 +526,9 @@ class PrivateThreadPoolDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    std::unique_ptr<thread::ThreadPool> numa_thread_pool_;
+    // Must be ordered after `numa_thread_pool_` so that the input iterator,
+    // whose functions may run on that pool, is destroyed first.
     std::unique_ptr<IteratorBase> input_impl_;
   };
 
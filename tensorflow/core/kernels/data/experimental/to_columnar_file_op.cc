@@ -0,0 +1,142 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/columnar_file.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/root_dataset.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/function_handle_cache.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/resource.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Writes the elements of a dataset to a columnar file (see
+// core/data/columnar_file.h) that ColumnarDataset can read. Each component of
+// the dataset is one column. A component is either a scalar, holding the value
+// of one row, or a vector, holding the values of consecutive rows.
+class ToColumnarFileOp : public AsyncOpKernel {
+ public:
+  explicit ToColumnarFileOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        background_worker_(ctx->env(), "tf_data_to_columnar_file") {}
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    // The call to `iterator->GetNext()` may block and depend on an inter-op
+    // thread pool thread, so we issue the call using a background thread.
+    background_worker_.Schedule([this, ctx, done = std::move(done)]() {
+      OP_REQUIRES_OK_ASYNC(ctx, DoCompute(ctx), done);
+      done();
+    });
+  }
+
+ private:
+  Status DoCompute(OpKernelContext* ctx) {
+    tensorflow::ResourceTagger tag(kTFDataResourceTag,
+                                   ctx->op_kernel().type_string());
+    tstring filename;
+    TF_RETURN_IF_ERROR(
+        ParseScalarArgument<tstring>(ctx, "filename", &filename));
+    const Tensor* columns_tensor;
+    TF_RETURN_IF_ERROR(ctx->input("columns", &columns_tensor));
+    if (!TensorShapeUtils::IsVector(columns_tensor->shape())) {
+      return errors::InvalidArgument("`columns` must be a vector.");
+    }
+    tstring compression_type;
+    TF_RETURN_IF_ERROR(ParseScalarArgument<tstring>(ctx, "compression_type",
+                                                    &compression_type));
+    int64 rows_per_row_group;
+    TF_RETURN_IF_ERROR(ParseScalarArgument<int64>(ctx, "rows_per_row_group",
+                                                  &rows_per_row_group));
+
+    DatasetBase* dataset;
+    TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(ctx->input(0), &dataset));
+    const DataTypeVector& dtypes = dataset->output_dtypes();
+    if (columns_tensor->NumElements() != dtypes.size()) {
+      return errors::InvalidArgument(
+          "Expected one column name per dataset component, got ",
+          columns_tensor->NumElements(), " names and ", dtypes.size(),
+          " components.");
+    }
+    std::vector<ColumnSchema> columns;
+    for (int i = 0; i < dtypes.size(); ++i) {
+      columns.push_back({columns_tensor->flat<tstring>()(i), dtypes[i]});
+    }
+
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(ctx->env()->NewWritableFile(filename, &file));
+    ColumnarFileWriterOptions options;
+    options.compression_type = compression_type;
+    if (rows_per_row_group > 0) {
+      options.rows_per_row_group = rows_per_row_group;
+    }
+    ColumnarFileWriter writer(file.get(), std::move(columns), options);
+    TF_RETURN_IF_ERROR(writer.Initialize());
+
+    IteratorContext::Params params(ctx);
+    FunctionHandleCache function_handle_cache(params.flr);
+    params.function_handle_cache = &function_handle_cache;
+    ResourceMgr resource_mgr;
+    params.resource_mgr = &resource_mgr;
+    CancellationManager cancellation_manager(ctx->cancellation_manager());
+    params.cancellation_manager = &cancellation_manager;
+
+    IteratorContext iter_ctx(std::move(params));
+    DatasetBase* finalized_dataset;
+    TF_RETURN_IF_ERROR(FinalizeDataset(ctx, dataset, &finalized_dataset));
+    core::ScopedUnref unref(finalized_dataset);
+
+    std::unique_ptr<IteratorBase> iterator;
+    TF_RETURN_IF_ERROR(finalized_dataset->MakeIterator(
+        &iter_ctx, /*parent=*/nullptr, "ToColumnarFileOpIterator", &iterator));
+
+    std::vector<Tensor> components;
+    components.reserve(dtypes.size());
+    bool end_of_sequence;
+    do {
+      TF_RETURN_IF_ERROR(
+          iterator->GetNext(&iter_ctx, &components, &end_of_sequence));
+      if (!end_of_sequence) {
+        for (Tensor& component : components) {
+          if (TensorShapeUtils::IsScalar(component.shape())) {
+            Tensor row;
+            CHECK(row.CopyFrom(component, TensorShape({1})));
+            component = std::move(row);
+          }
+        }
+        TF_RETURN_IF_ERROR(writer.Write(components));
+      }
+      components.clear();
+    } while (!end_of_sequence);
+    TF_RETURN_IF_ERROR(writer.Finish());
+    return file->Close();
+  }
+
+  BackgroundWorker background_worker_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DatasetToColumnarFile").Device(DEVICE_CPU),
+                        ToColumnarFileOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -41,6 +41,8 @@ void GetModelDatasetParams(const Options& options,
   *algorithm = model::AutotuneAlgorithm::HILL_CLIMB;
   if (options.optimization_options().autotune_buffers()) {
     *algorithm = model::AutotuneAlgorithm::GRADIENT_DESCENT;
+  } else if (options.optimization_options().autotune_cpu_time()) {
+    *algorithm = model::AutotuneAlgorithm::CPU_TIME_HILL_CLIMB;
   }
   *cpu_budget = options.optimization_options().autotune_cpu_budget();
   *ram_budget = options.optimization_options().autotune_ram_budget();
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/fixed_length_record_dataset_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/metrics.h"
+#include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -23,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/lib/random/random.h"
 
 namespace tensorflow {
 namespace data {
@@ -40,10 +44,20 @@ namespace data {
     FixedLengthRecordDatasetOp::kBufferSize;
 /* static */ constexpr const char* const
     FixedLengthRecordDatasetOp::kCompressionType;
+/* static */ constexpr const char* const FixedLengthRecordDatasetOp::kShuffle;
+/* static */ constexpr const char* const
+    FixedLengthRecordDatasetOp::kShuffleSeed;
+/* static */ constexpr const char* const
+    FixedLengthRecordDatasetOp::kShuffleBlockSize;
+/* static */ constexpr const char* const
+    FixedLengthRecordDatasetOp::kShuffleWindowBlocks;
 
 constexpr char kFixedLengthRecordDataset[] = "FixedLengthRecordDataset";
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kCurrentPos[] = "current_pos";
+constexpr char kSeed[] = "seed";
+constexpr char kWindow[] = "window";
+constexpr char kOffset[] = "offset";
 constexpr char kZLIB[] = "ZLIB";
 constexpr char kGZIP[] = "GZIP";
 
@@ -52,7 +66,8 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    int64 header_bytes, int64 record_bytes, int64 footer_bytes,
                    int64 buffer_size, const string& compression_type,
-                   int op_version)
+                   int op_version, bool shuffle, int64 shuffle_seed,
+                   int64 shuffle_block_size, int64 shuffle_window_blocks)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         header_bytes_(header_bytes),
@@ -60,13 +75,20 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
         footer_bytes_(footer_bytes),
         buffer_size_(buffer_size),
         compression_type_(compression_type),
-        op_version_(op_version) {}
+        op_version_(op_version),
+        shuffle_(shuffle),
+        shuffle_seed_(shuffle_seed),
+        shuffle_block_size_(shuffle_block_size),
+        shuffle_window_blocks_(shuffle_window_blocks) {}
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
     name_utils::IteratorPrefixParams params;
     params.op_version = op_version_;
-    if (compression_type_.empty()) {
+    if (shuffle_) {
+      return absl::make_unique<ShuffledIterator>(ShuffledIterator::Params{
+          this, name_utils::IteratorPrefix(kDatasetType, prefix, params)});
+    } else if (compression_type_.empty()) {
       return absl::make_unique<UncompressedIterator>(
           UncompressedIterator::Params{
               this, name_utils::IteratorPrefix(kDatasetType, prefix, params)});
@@ -115,11 +137,31 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(footer_bytes_, &footer_bytes));
     TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
-    TF_RETURN_IF_ERROR(
-        b->AddDataset(this,
-                      {filenames, header_bytes, record_bytes, footer_bytes,
-                       buffer_size, compression_type},
-                      output));
+    if (op_version_ == 1) {
+      TF_RETURN_IF_ERROR(
+          b->AddDataset(this,
+                        {filenames, header_bytes, record_bytes, footer_bytes,
+                         buffer_size, compression_type},
+                        output));
+      return Status::OK();
+    }
+    AttrValue shuffle;
+    b->BuildAttrValue(shuffle_, &shuffle);
+    AttrValue shuffle_seed;
+    b->BuildAttrValue(shuffle_seed_, &shuffle_seed);
+    AttrValue shuffle_block_size;
+    b->BuildAttrValue(shuffle_block_size_, &shuffle_block_size);
+    AttrValue shuffle_window_blocks;
+    b->BuildAttrValue(shuffle_window_blocks_, &shuffle_window_blocks);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {filenames, header_bytes, record_bytes, footer_bytes, buffer_size,
+         compression_type},
+        {std::make_pair(kShuffle, shuffle),
+         std::make_pair(kShuffleSeed, shuffle_seed),
+         std::make_pair(kShuffleBlockSize, shuffle_block_size),
+         std::make_pair(kShuffleWindowBlocks, shuffle_window_blocks)},
+        output));
     return Status::OK();
   }
 
@@ -445,6 +487,165 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
     tstring lookahead_cache_ TF_GUARDED_BY(mu_);
   };
 
+  // Emits the records of all files in the order of a BlockShuffledReader.
+  // Each block of consecutive records is read with one read per file it
+  // overlaps.
+  class ShuffledIterator : public DatasetIterator<Dataset> {
+   public:
+    explicit ShuffledIterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      file_start_.assign(1, 0);
+      for (const string& filename : dataset()->filenames_) {
+        uint64 file_size;
+        TF_RETURN_IF_ERROR(ctx->env()->GetFileSize(filename, &file_size));
+        const uint64 header_and_footer =
+            dataset()->header_bytes_ + dataset()->footer_bytes_;
+        const uint64 body_size =
+            file_size >= header_and_footer ? file_size - header_and_footer : 0;
+        if (body_size % dataset()->record_bytes_ != 0) {
+          return errors::InvalidArgument(
+              "Excluding the header (", dataset()->header_bytes_,
+              " bytes) and footer (", dataset()->footer_bytes_,
+              " bytes), input file \"", filename, "\" has body length ",
+              body_size,
+              " bytes, which is not an exact multiple of the record length (",
+              dataset()->record_bytes_, " bytes).");
+        }
+        file_start_.push_back(file_start_.back() +
+                              body_size / dataset()->record_bytes_);
+      }
+      seed_ = dataset()->shuffle_seed_ != 0 ? dataset()->shuffle_seed_
+                                            : random::New64();
+      shuffled_reader_ = absl::make_unique<BlockShuffledReader>(
+          file_start_.back(), dataset()->shuffle_block_size_,
+          dataset()->shuffle_window_blocks_, seed_);
+      return Status::OK();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      Env* env = ctx->env();
+      auto read_range = [this, env](uint64 begin, uint64 end,
+                                    std::vector<tstring>* records)
+                            TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+                              return ReadRangeLocked(env, begin, end, records);
+                            };
+      tstring record;
+      TF_RETURN_IF_ERROR(
+          shuffled_reader_->GetNext(read_range, &record, end_of_sequence));
+      if (*end_of_sequence) return Status::OK();
+      Tensor record_tensor(ctx->allocator({}), DT_STRING, {});
+      record_tensor.scalar<tstring>()() = std::move(record);
+      out_tensors->emplace_back(std::move(record_tensor));
+      return Status::OK();
+    }
+
+    Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                        bool* end_of_sequence, int* num_skipped) override {
+      mutex_lock l(mu_);
+      int64 num_skipped_records;
+      shuffled_reader_->Skip(num_to_skip, &num_skipped_records);
+      *num_skipped = static_cast<int>(num_skipped_records);
+      *end_of_sequence = *num_skipped < num_to_skip;
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      const int64 window = shuffled_reader_->window();
+      const int64 offset = shuffled_reader_->offset();
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kSeed), static_cast<int64>(seed_)));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kWindow), window));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kOffset), offset));
+      return Status::OK();
+    }
+
+    // Only the seed and the position within the shuffle order are saved, so
+    // restoring re-reads just the records of the current window.
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64 seed;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed), &seed));
+      int64 window;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kWindow), &window));
+      int64 offset;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset));
+      seed_ = seed;
+      shuffled_reader_ = absl::make_unique<BlockShuffledReader>(
+          file_start_.back(), dataset()->shuffle_block_size_,
+          dataset()->shuffle_window_blocks_, seed_);
+      Status s = shuffled_reader_->Seek(window, offset);
+      if (!s.ok()) {
+        return errors::FailedPrecondition(
+            s.error_message(), ". The input files may have changed.");
+      }
+      return Status::OK();
+    }
+
+   private:
+    // Appends records [begin, end) to `*records`.
+    Status ReadRangeLocked(Env* env, uint64 begin, uint64 end,
+                           std::vector<tstring>* records)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      const uint64 record_bytes = dataset()->record_bytes_;
+      while (begin < end) {
+        const size_t file_index =
+            std::upper_bound(file_start_.begin(), file_start_.end(), begin) -
+            file_start_.begin() - 1;
+        if (file_ == nullptr || file_index != current_file_index_) {
+          file_.reset();
+          TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
+              dataset()->filenames_[file_index], &file_));
+          current_file_index_ = file_index;
+        }
+        const uint64 segment_end = std::min(end, file_start_[file_index + 1]);
+        const uint64 n = (segment_end - begin) * record_bytes;
+        scratch_.resize(n);
+        StringPiece data;
+        TF_RETURN_IF_ERROR(file_->Read(
+            dataset()->header_bytes_ +
+                (begin - file_start_[file_index]) * record_bytes,
+            n, &data, &scratch_[0]));
+        if (data.size() != n) {
+          return errors::DataLoss("Truncated read of ", n, " bytes from \"",
+                                  dataset()->filenames_[file_index], "\"");
+        }
+        bytes_counter->IncrementBy(n);
+        for (uint64 pos = 0; pos < n; pos += record_bytes) {
+          records->emplace_back(data.substr(pos, record_bytes));
+        }
+        begin = segment_end;
+      }
+      return Status::OK();
+    }
+
+    mutex mu_;
+    // `file_start_[i]` is the global ordinal of the first record of file `i`;
+    // the last element is the total number of records.
+    std::vector<uint64> file_start_ TF_GUARDED_BY(mu_);
+    uint64 seed_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<BlockShuffledReader> shuffled_reader_ TF_GUARDED_BY(mu_);
+    size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
+    string scratch_ TF_GUARDED_BY(mu_);
+  };
+
   const std::vector<string> filenames_;
   const int64 header_bytes_;
   const int64 record_bytes_;
@@ -452,12 +653,34 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
   const int64 buffer_size_;
   const tstring compression_type_;
   const int op_version_;
+  const bool shuffle_;
+  const int64 shuffle_seed_;
+  const int64 shuffle_block_size_;
+  const int64 shuffle_window_blocks_;
 };
 
 FixedLengthRecordDatasetOp::FixedLengthRecordDatasetOp(
     OpKernelConstruction* ctx)
     : DatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kFixedLengthRecordDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kFixedLengthRecordDataset ? 1 : 2) {
+  if (ctx->HasAttr(kShuffle)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kShuffle, &shuffle_));
+  }
+  if (ctx->HasAttr(kShuffleSeed)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kShuffleSeed, &shuffle_seed_));
+  }
+  if (ctx->HasAttr(kShuffleBlockSize)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kShuffleBlockSize, &shuffle_block_size_));
+    OP_REQUIRES(ctx, shuffle_block_size_ > 0,
+                errors::InvalidArgument("`shuffle_block_size` must be > 0"));
+  }
+  if (ctx->HasAttr(kShuffleWindowBlocks)) {
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttr(kShuffleWindowBlocks, &shuffle_window_blocks_));
+    OP_REQUIRES(ctx, shuffle_window_blocks_ > 0,
+                errors::InvalidArgument("`shuffle_window_blocks` must be > 0"));
+  }
+}
 
 void FixedLengthRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                              DatasetBase** output) {
@@ -508,10 +731,14 @@ void FixedLengthRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                 compression_type.empty() || compression_type == kZLIB ||
                     compression_type == kGZIP,
                 errors::InvalidArgument("Unsupported compression_type."));
+    OP_REQUIRES(ctx, !shuffle_ || compression_type.empty(),
+                errors::InvalidArgument(
+                    "`shuffle` requires uncompressed input files."));
   }
-  *output =
-      new Dataset(ctx, std::move(filenames), header_bytes, record_bytes,
-                  footer_bytes, buffer_size, compression_type, op_version_);
+  *output = new Dataset(ctx, std::move(filenames), header_bytes, record_bytes,
+                        footer_bytes, buffer_size, compression_type,
+                        op_version_, shuffle_, shuffle_seed_,
+                        shuffle_block_size_, shuffle_window_blocks_);
 }
 
 namespace {
@@ -29,6 +29,11 @@ class FixedLengthRecordDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kFooterBytes = "footer_bytes";
   static constexpr const char* const kBufferSize = "buffer_size";
   static constexpr const char* const kCompressionType = "compression_type";
+  static constexpr const char* const kShuffle = "shuffle";
+  static constexpr const char* const kShuffleSeed = "shuffle_seed";
+  static constexpr const char* const kShuffleBlockSize = "shuffle_block_size";
+  static constexpr const char* const kShuffleWindowBlocks =
+      "shuffle_window_blocks";
 
   explicit FixedLengthRecordDatasetOp(OpKernelConstruction* ctx);
 
@@ -38,6 +43,10 @@ class FixedLengthRecordDatasetOp : public DatasetOpKernel {
  private:
   class Dataset;
   const int op_version_;
+  bool shuffle_ = false;
+  int64 shuffle_seed_ = 0;
+  int64 shuffle_block_size_ = 256;
+  int64 shuffle_window_blocks_ = 64;
 };
 
 }  // namespace data
@@ -32,6 +32,9 @@ class FixedLengthRecordDatasetParams : public DatasetParams {
                                  int64 header_bytes, int64 record_bytes,
                                  int64 footer_bytes, int64 buffer_size,
                                  CompressionType compression_type,
+                                 bool shuffle, int64 shuffle_seed,
+                                 int64 shuffle_block_size,
+                                 int64 shuffle_window_blocks,
                                  string node_name)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
@@ -40,7 +43,11 @@ class FixedLengthRecordDatasetParams : public DatasetParams {
         record_bytes_(record_bytes),
         footer_bytes_(footer_bytes),
         buffer_size_(buffer_size),
-        compression_type_(compression_type) {
+        compression_type_(compression_type),
+        shuffle_(shuffle),
+        shuffle_seed_(shuffle_seed),
+        shuffle_block_size_(shuffle_block_size),
+        shuffle_window_blocks_(shuffle_window_blocks) {
     op_version_ = 2;
   }
 
@@ -67,7 +74,12 @@ class FixedLengthRecordDatasetParams : public DatasetParams {
   }
 
   Status GetAttributes(AttributeVector* attr_vector) const override {
-    *attr_vector = {};
+    *attr_vector = {
+        {FixedLengthRecordDatasetOp::kShuffle, shuffle_},
+        {FixedLengthRecordDatasetOp::kShuffleSeed, shuffle_seed_},
+        {FixedLengthRecordDatasetOp::kShuffleBlockSize, shuffle_block_size_},
+        {FixedLengthRecordDatasetOp::kShuffleWindowBlocks,
+         shuffle_window_blocks_}};
     return Status::OK();
   }
 
@@ -82,6 +94,10 @@ class FixedLengthRecordDatasetParams : public DatasetParams {
   int64 footer_bytes_;
   int64 buffer_size_;
   CompressionType compression_type_;
+  bool shuffle_;
+  int64 shuffle_seed_;
+  int64 shuffle_block_size_;
+  int64 shuffle_window_blocks_;
 };
 
 class FixedLengthRecordDatasetOpTest : public DatasetOpsTestBase {};
@@ -127,6 +143,10 @@ FixedLengthRecordDatasetParams FixedLengthRecordDatasetParams1() {
                                         /*footer_bytes=*/2,
                                         /*buffer_size=*/10,
                                         /*compression_type=*/compression_type,
+                                        /*shuffle=*/false,
+                                        /*shuffle_seed=*/0,
+                                        /*shuffle_block_size=*/256,
+                                        /*shuffle_window_blocks=*/64,
                                         /*node_name=*/kNodeName);
 }
 
@@ -147,6 +167,10 @@ FixedLengthRecordDatasetParams FixedLengthRecordDatasetParams2() {
                                         /*footer_bytes=*/2,
                                         /*buffer_size=*/10,
                                         /*compression_type=*/compression_type,
+                                        /*shuffle=*/false,
+                                        /*shuffle_seed=*/0,
+                                        /*shuffle_block_size=*/256,
+                                        /*shuffle_window_blocks=*/64,
                                         /*node_name=*/kNodeName);
 }
 
@@ -167,6 +191,57 @@ FixedLengthRecordDatasetParams FixedLengthRecordDatasetParams3() {
                                         /*footer_bytes=*/2,
                                         /*buffer_size=*/10,
                                         /*compression_type=*/compression_type,
+                                        /*shuffle=*/false,
+                                        /*shuffle_seed=*/0,
+                                        /*shuffle_block_size=*/256,
+                                        /*shuffle_window_blocks=*/64,
+                                        /*node_name=*/kNodeName);
+}
+
+// Test case 4: multiple fixed-length record files without compression, read
+// in shuffled blocks of two records.
+FixedLengthRecordDatasetParams FixedLengthRecordDatasetParams4() {
+  std::vector<tstring> filenames = {LocalTempFilename(), LocalTempFilename()};
+  std::vector<string> contents = {
+      absl::StrCat("HHHHH", "111", "222", "333", "FF"),
+      absl::StrCat("HHHHH", "aaa", "bbb", "FF")};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return FixedLengthRecordDatasetParams(filenames,
+                                        /*header_bytes=*/5,
+                                        /*record_bytes=*/3,
+                                        /*footer_bytes=*/2,
+                                        /*buffer_size=*/10,
+                                        /*compression_type=*/compression_type,
+                                        /*shuffle=*/true,
+                                        /*shuffle_seed=*/7,
+                                        /*shuffle_block_size=*/2,
+                                        /*shuffle_window_blocks=*/1,
+                                        /*node_name=*/kNodeName);
+}
+
+// Shuffling compressed files is not supported.
+FixedLengthRecordDatasetParams CompressedShuffleParams() {
+  std::vector<tstring> filenames = {LocalTempFilename()};
+  std::vector<string> contents = {absl::StrCat("HHHHH", "111", "222", "FF")};
+  CompressionType compression_type = CompressionType::ZLIB;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return FixedLengthRecordDatasetParams(filenames,
+                                        /*header_bytes=*/5,
+                                        /*record_bytes=*/3,
+                                        /*footer_bytes=*/2,
+                                        /*buffer_size=*/10,
+                                        /*compression_type=*/compression_type,
+                                        /*shuffle=*/true,
+                                        /*shuffle_seed=*/7,
+                                        /*shuffle_block_size=*/2,
+                                        /*shuffle_window_blocks=*/1,
                                         /*node_name=*/kNodeName);
 }
 
@@ -182,7 +257,10 @@ GetNextTestCases() {
                               {{"111"}, {"222"}, {"333"}, {"aaa"}, {"bbb"}})},
       {/*dataset_params=*/FixedLengthRecordDatasetParams3(),
        CreateTensors<tstring>(TensorShape({}),
-                              {{"111"}, {"222"}, {"333"}, {"aaa"}, {"bbb"}})}};
+                              {{"111"}, {"222"}, {"333"}, {"aaa"}, {"bbb"}})},
+      {/*dataset_params=*/FixedLengthRecordDatasetParams4(),
+       CreateTensors<tstring>(TensorShape({}),
+                              {{"bbb"}, {"333"}, {"aaa"}, {"111"}, {"222"}})}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(FixedLengthRecordDatasetOpTest,
@@ -243,6 +321,12 @@ TEST_F(FixedLengthRecordDatasetOpTest, IteratorPrefix) {
       dataset_params.iterator_prefix(), iterator_prefix_params)));
 }
 
+TEST_F(FixedLengthRecordDatasetOpTest, ShuffleRequiresUncompressedFiles) {
+  auto dataset_params = CompressedShuffleParams();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<FixedLengthRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
@@ -258,7 +342,11 @@ IteratorSaveAndRestoreTestCases() {
       {/*dataset_params=*/FixedLengthRecordDatasetParams3(),
        /*breakpoints=*/{0, 2, 6},
        CreateTensors<tstring>(TensorShape({}),
-                              {{"111"}, {"222"}, {"333"}, {"aaa"}, {"bbb"}})}};
+                              {{"111"}, {"222"}, {"333"}, {"aaa"}, {"bbb"}})},
+      {/*dataset_params=*/FixedLengthRecordDatasetParams4(),
+       /*breakpoints=*/{0, 2, 6},
+       CreateTensors<tstring>(TensorShape({}),
+                              {{"bbb"}, {"333"}, {"aaa"}, {"111"}, {"222"}})}};
 }
 
 ITERATOR_SAVE_AND_RESTORE_TEST_P(FixedLengthRecordDatasetOpTest,
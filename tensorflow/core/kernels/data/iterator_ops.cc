@@ -185,6 +185,48 @@ Status IteratorResource::Save(SerializationContext* ctx,
       "saving it.");
 }
 
+bool IteratorResource::SymbolicCheckpointEnabled(OpKernelContext* ctx) {
+  std::shared_ptr<State> captured_state;
+  {
+    tf_shared_lock l(mu_);
+    captured_state = iterator_state_;
+  }
+  auto iterator = captured_state->iterator();
+  if (!iterator) {
+    return false;
+  }
+  const DatasetBase* dataset = iterator->dataset();
+  const Options& options = dataset->options();
+  if (options.optional_symbolic_checkpoint_case() !=
+          Options::kSymbolicCheckpoint ||
+      !options.symbolic_checkpoint()) {
+    return false;
+  }
+  if (options.optional_deterministic_case() == Options::kDeterministic &&
+      !options.deterministic()) {
+    VLOG(2) << "Saving a full checkpoint because the dataset is not "
+               "deterministic.";
+    return false;
+  }
+  // Symbolic checkpoints are restored by skipping a fresh input iterator, so
+  // they are only correct if that iterator replays the same elements.
+  std::vector<std::pair<string, Tensor>> input_list;
+  GraphDef graph_def;
+  string output_node;
+  Status s = AsGraphDefMinimal(ctx, dataset, &input_list, &graph_def,
+                               &output_node);
+  if (s.ok()) {
+    s = CheckReplayable(graph_def);
+  }
+  if (!s.ok()) {
+    VLOG(2) << "Saving a full checkpoint because the dataset cannot be "
+               "replayed: "
+            << s;
+    return false;
+  }
+  return true;
+}
+
 Status IteratorResource::Restore(OpKernelContext* ctx,
                                  IteratorStateReader* reader) {
   const DatasetBase* dataset;
@@ -1079,6 +1121,8 @@ void SerializeIteratorOp::Compute(OpKernelContext* ctx) {
   IteratorVariantSerializer serializer;
   SerializationContext::Params params(ctx);
   params.external_state_policy = external_state_policy_;
+  params.symbolic_checkpoint =
+      iterator_resource->SymbolicCheckpointEnabled(ctx);
   SerializationContext serialization_ctx(params);
   OP_REQUIRES_OK(ctx, serializer.InitializeFromIterator(&serialization_ctx,
                                                         iterator_resource));
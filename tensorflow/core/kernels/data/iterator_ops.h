@@ -57,6 +57,12 @@ class IteratorResource : public ResourceBase {
   // Restores the state of the iterator from a checkpoint created by `Save`.
   Status Restore(OpKernelContext* ctx, IteratorStateReader* reader);
 
+  // Returns whether the options of the iterated dataset request symbolic
+  // checkpoints, which save input positions instead of buffered elements, and
+  // the dataset replays the same elements when restored. Datasets with random
+  // or non-deterministic transformations fall back to full checkpoints.
+  bool SymbolicCheckpointEnabled(OpKernelContext* ctx);
+
   // Creates an iterator for `dataset`, and associates the iterator with this
   // iterator resource.
   //
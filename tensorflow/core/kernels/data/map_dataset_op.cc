@@ -179,6 +179,19 @@ class MapDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                        bool* end_of_sequence, int* num_skipped) override {
+      if (ctx->is_restoring()) {
+        // A downstream symbolic checkpoint is being restored. The skipped
+        // elements were already produced before the checkpoint, so `f` does
+        // not need to be run on them again.
+        return input_impl_->Skip(ctx, num_to_skip, end_of_sequence,
+                                 num_skipped);
+      }
+      return DatasetIterator<Dataset>::SkipInternal(ctx, num_to_skip,
+                                                   end_of_sequence, num_skipped);
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
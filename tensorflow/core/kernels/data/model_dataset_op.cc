@@ -37,6 +37,17 @@ namespace {
 // Default share of available RAM that can be used by model's internal buffers.
 constexpr double kRamBudgetShare = 0.5;
 
+const char* AlgorithmName(model::AutotuneAlgorithm algorithm) {
+  switch (algorithm) {
+    case model::AutotuneAlgorithm::GRADIENT_DESCENT:
+      return "gradient descent";
+    case model::AutotuneAlgorithm::CPU_TIME_HILL_CLIMB:
+      return "cpu time hill climb";
+    default:
+      return "hill climb";
+  }
+}
+
 }  // namespace
 
 /* static */ constexpr const char* const ModelDatasetOp::kDatasetType;
@@ -62,9 +73,7 @@ class ModelDatasetOp::Dataset : public DatasetBase {
         cpu_budget_(cpu_budget),
         ram_budget_(ram_budget),
         traceme_metadata_(
-            {{"algorithm", algorithm == model::AutotuneAlgorithm::HILL_CLIMB
-                               ? "hill climb"
-                               : "gradient descent"},
+            {{"algorithm", AlgorithmName(algorithm)},
              {"cpu_budget",
               strings::Printf("%lld", static_cast<long long>(cpu_budget))},
              {"ram_budget",
@@ -135,6 +144,9 @@ class ModelDatasetOp::Dataset : public DatasetBase {
                           : dataset()->ram_budget_) {
       cancellation_manager_ = absl::make_unique<CancellationManager>();
       model_ = std::make_shared<model::Model>();
+      model_->set_record_cpu_time(
+          dataset()->algorithm_ ==
+          model::AutotuneAlgorithm::CPU_TIME_HILL_CLIMB);
     }
 
     ~Iterator() override { cancellation_manager_->StartCancel(); }
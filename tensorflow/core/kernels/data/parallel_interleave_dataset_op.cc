@@ -78,6 +78,8 @@ namespace data {
 /* static */ constexpr const char* const
     ParallelInterleaveDatasetOp::kDeterministic;
 /* static */ constexpr const char* const ParallelInterleaveDatasetOp::kSloppy;
+/* static */ constexpr const char* const
+    ParallelInterleaveDatasetOp::kReadAhead;
 
 namespace {
 
@@ -113,6 +115,12 @@ constexpr double kDefaultCyclePrefetchFactor = 2.0L;
 // match the behavior of the original implementation.
 constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 
+// Iterators at the cycle positions that read ahead in deterministic mode may
+// buffer `kReadAheadBufferFactor * buffer_output_elements` results. This is a
+// fixed factor rather than an attr; `read_ahead` controls how many positions
+// get the deeper buffers.
+constexpr int64 kReadAheadBufferFactor = 4;
+
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
@@ -160,7 +168,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           std::unique_ptr<CapturedFunction> captured_func, int64 cycle_length,
           int64 block_length, int64 buffer_output_elements,
           int64 prefetch_input_elements, int64 num_parallel_calls,
-          DeterminismPolicy deterministic, const DataTypeVector& output_types,
+          DeterminismPolicy deterministic, int64 read_ahead,
+          const DataTypeVector& output_types,
           const std::vector<PartialTensorShape>& output_shapes, int op_version)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
@@ -173,6 +182,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             prefetch_input_elements, cycle_length)),
         num_parallel_calls_(num_parallel_calls),
         deterministic_(deterministic),
+        read_ahead_(std::min(read_ahead, cycle_length - 1)),
         output_types_(output_types),
         output_shapes_(output_shapes),
         op_version_(op_version),
@@ -184,7 +194,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
              {"cycle_length",
               strings::Printf("%lld", static_cast<long long>(cycle_length))},
              {"deterministic",
-              deterministic.IsNondeterministic() ? "false" : "true"}}) {
+              deterministic.IsNondeterministic() ? "false" : "true"},
+             {"read_ahead",
+              strings::Printf("%lld", static_cast<long long>(read_ahead_))}}) {
     input_->Ref();
   }
 
@@ -297,6 +309,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       b->BuildAttrValue(deterministic_.String(), &deterministic_attr);
       attrs.emplace_back(kDeterministic, deterministic_attr);
     }
+    if (op_version_ >= 4) {
+      AttrValue read_ahead_attr;
+      b->BuildAttrValue(read_ahead_, &read_ahead_attr);
+      attrs.emplace_back(kReadAhead, read_ahead_attr);
+    }
 
     TF_RETURN_IF_ERROR(b->AddDataset(this, inputs, list_inputs, attrs, output));
     return Status::OK();
@@ -313,6 +330,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
           deterministic_(deterministic),
+          read_ahead_(deterministic ? params.dataset->read_ahead_ : 0),
           current_elements_(params.dataset->cycle_length_) {}
 
     ~ParallelInterleaveIterator() override {
@@ -637,6 +655,16 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       DCHECK_NE(last_valid_current_element_, -1);
       block_index_ = 0;
       cycle_index_ = (cycle_index_ + 1) % (last_valid_current_element_ + 1);
+      if (read_ahead_ > 0) {
+        // The element entering the read-ahead window may buffer more results.
+        int64 index =
+            (cycle_index_ + read_ahead_) % (last_valid_current_element_ + 1);
+        const auto& element = current_elements_[index];
+        if (NeedsProcessing(element) && !element->active) {
+          elements_to_process_.push_back(index);
+          current_workers_cond_var_.notify_one();
+        }
+      }
     }
 
     // Advances the position in the interleave cycle by one.
@@ -851,8 +879,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           element.reset();
           while (!cancelled_) {
             while (!elements_to_process_.empty() && !wait_for_checkpoint_) {
-              int index = elements_to_process_.front();
-              elements_to_process_.pop_front();
+              int index = PopElementToProcess();
               auto& e = current_elements_[index];
               if (NeedsProcessing(e) && !e->active) {
                 element_index = index;
@@ -985,7 +1012,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() >= BufferLimit(*element)) {
           break;
         }
       }
@@ -1084,7 +1111,52 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         return true;
       }
       return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+             element->results.size() < BufferLimit(*element);
+    }
+
+    // Returns the distance from the current cycle position to the given index
+    // of `current_elements_`, in cycle positions.
+    int64 CycleDistance(int64 index) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64 num_positions = last_valid_current_element_ + 1;
+      if (num_positions <= 0) {
+        return 0;
+      }
+      return (index - cycle_index_ + num_positions) % num_positions;
+    }
+
+    // Returns the number of results the given element may buffer. Elements at
+    // the current cycle position and the `read_ahead_` positions after it
+    // read ahead so that a slow element at the current position does not leave
+    // the worker threads idle.
+    int64 BufferLimit(const Element& element) const
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (read_ahead_ > 0 && element.cycle_index != -1 &&
+          CycleDistance(element.cycle_index) <= read_ahead_) {
+        return kReadAheadBufferFactor * dataset()->buffer_output_elements_;
+      }
+      return dataset()->buffer_output_elements_;
+    }
+
+    // Removes and returns the next index of `current_elements_` for a current
+    // worker to process. With read-ahead, this is the index closest to the
+    // current cycle position, so that workers do not fill the buffers of
+    // elements further along the cycle while an earlier element waits.
+    //
+    // This scans `elements_to_process_` linearly while holding `mu_`. The
+    // deque holds at most `cycle_length` indices, so the scan is short next to
+    // producing an element, but it does grow with the cycle length.
+    int PopElementToProcess() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      auto next = elements_to_process_.begin();
+      if (read_ahead_ > 0) {
+        for (auto it = next + 1; it != elements_to_process_.end(); ++it) {
+          if (CycleDistance(*it) < CycleDistance(*next)) {
+            next = it;
+          }
+        }
+      }
+      int index = *next;
+      elements_to_process_.erase(next);
+      return index;
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1525,6 +1597,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Determines whether outputs can be produced in deterministic order.
     const bool deterministic_;
 
+    // The number of cycle positions after the current one whose elements read
+    // ahead. Always 0 if `deterministic_` is false.
+    const int64 read_ahead_;
+
     // Controls cancellation of `input_impl_`. Must be ordered before
     // `input_impl_` so that `input_impl_` is destroyed first.
     std::unique_ptr<CancellationManager> cancellation_manager_;
@@ -1586,6 +1662,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const int64 prefetch_input_elements_;
   const int64 num_parallel_calls_;
   const DeterminismPolicy deterministic_;
+  // The number of cycle positions after the current one whose iterators read
+  // ahead in deterministic mode.
+  const int64 read_ahead_;
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
   const int op_version_;
@@ -1616,6 +1695,12 @@ ParallelInterleaveDatasetOp::ParallelInterleaveDatasetOp(
     OP_REQUIRES_OK(
         ctx, DeterminismPolicy::FromString(deterministic, &deterministic_));
   }
+  if (op_version_ >= 4) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kReadAhead, &read_ahead_));
+    OP_REQUIRES(ctx, read_ahead_ >= 0,
+                errors::InvalidArgument("`read_ahead` must be >= 0 but is ",
+                                        read_ahead_));
+  }
 }
 
 void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -1689,7 +1774,7 @@ void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
   *output = new Dataset(
       ctx, input, std::move(captured_func), cycle_length, block_length,
       buffer_output_elements, prefetch_input_elements, num_parallel_calls,
-      deterministic_, output_types_, output_shapes_, op_version_);
+      deterministic_, read_ahead_, output_types_, output_shapes_, op_version_);
 }
 
 namespace {
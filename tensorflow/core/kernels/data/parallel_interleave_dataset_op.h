@@ -40,6 +40,7 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kOutputShapes = "output_shapes";
   static constexpr const char* const kDeterministic = "deterministic";
   static constexpr const char* const kSloppy = "sloppy";
+  static constexpr const char* const kReadAhead = "read_ahead";
 
   explicit ParallelInterleaveDatasetOp(OpKernelConstruction* ctx);
 
@@ -54,6 +55,7 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   DeterminismPolicy deterministic_;
+  int64 read_ahead_ = 0;
 };
 
 }  // namespace data
@@ -31,7 +31,8 @@ class ParallelInterleaveDatasetParams : public DatasetParams {
       std::vector<FunctionDef> func_lib, DataTypeVector type_arguments,
       const DataTypeVector& output_dtypes,
       const std::vector<PartialTensorShape>& output_shapes,
-      const std::string& deterministic, const std::string& node_name)
+      const std::string& deterministic, const std::string& node_name,
+      int64 read_ahead = 0)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         other_arguments_(std::move(other_arguments)),
@@ -43,7 +44,8 @@ class ParallelInterleaveDatasetParams : public DatasetParams {
         func_(std::move(func)),
         func_lib_(std::move(func_lib)),
         type_arguments_(std::move(type_arguments)),
-        deterministic_(deterministic) {
+        deterministic_(deterministic),
+        read_ahead_(read_ahead) {
     input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
     op_version_ = kOpVersion;
     name_utils::IteratorPrefixParams params;
@@ -90,7 +92,8 @@ class ParallelInterleaveDatasetParams : public DatasetParams {
         {ParallelInterleaveDatasetOp::kDeterministic, deterministic_},
         {ParallelInterleaveDatasetOp::kTarguments, type_arguments_},
         {ParallelInterleaveDatasetOp::kOutputShapes, output_shapes_},
-        {ParallelInterleaveDatasetOp::kOutputTypes, output_dtypes_}};
+        {ParallelInterleaveDatasetOp::kOutputTypes, output_dtypes_},
+        {ParallelInterleaveDatasetOp::kReadAhead, read_ahead_}};
     return Status::OK();
   }
 
@@ -111,6 +114,7 @@ class ParallelInterleaveDatasetParams : public DatasetParams {
   std::vector<FunctionDef> func_lib_;
   DataTypeVector type_arguments_;
   std::string deterministic_;
+  int64 read_ahead_;
 };
 
 class ParallelInterleaveDatasetOpTest : public DatasetOpsTestBase {};
@@ -399,6 +403,32 @@ ParallelInterleaveDatasetParams LongCycleDeterministicParams() {
       /*node_name=*/kNodeName);
 }
 
+ParallelInterleaveDatasetParams ReadAheadDeterministicParams() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<tstring>(
+          TensorShape{3, 3, 1}, {"a", "b", "c", "d", "e", "f", "g", "h", "i"})},
+      /*node_name=*/"tensor_slice");
+  return ParallelInterleaveDatasetParams(
+      tensor_slice_dataset_params,
+      /*other_arguments=*/{},
+      /*cycle_length=*/3,
+      /*block_length=*/1,
+      /*buffer_output_elements=*/1,
+      /*prefetch_input_elements=*/model::kAutotune,
+      /*num_parallel_calls=*/2,
+      /*func=*/
+      MakeTensorSliceDatasetFunc(
+          DataTypeVector({DT_STRING}),
+          std::vector<PartialTensorShape>({PartialTensorShape({1})})),
+      /*func_lib=*/{test::function::MakeTensorSliceDataset()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_STRING},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*node_name=*/kNodeName,
+      /*read_ahead=*/2);
+}
+
 ParallelInterleaveDatasetParams
 ParallelInterleaveDatasetParamsWithInvalidCycleLength() {
   auto tensor_slice_dataset_params = TensorSliceDatasetParams(
@@ -595,6 +625,13 @@ GetNextTestCases() {
           {/*dataset_params=*/
            LongCycleDeterministicParams(),
            /*expected_outputs=*/
+           CreateTensors<tstring>(
+               TensorShape{1},
+               {{"a"}, {"d"}, {"g"}, {"b"}, {"e"}, {"h"}, {"c"}, {"f"}, {"i"}}),
+           /*compare_order=*/true},
+          {/*dataset_params=*/
+           ReadAheadDeterministicParams(),
+           /*expected_outputs=*/
            CreateTensors<tstring>(
                TensorShape{1},
                {{"a"}, {"d"}, {"g"}, {"b"}, {"e"}, {"h"}, {"c"}, {"f"}, {"i"}}),
@@ -753,7 +790,15 @@ IteratorSaveAndRestoreTestCases() {
            CreateTensors<tstring>(
                TensorShape{1},
                {{"a"}, {"b"}, {"c"}, {"d"}, {"e"}, {"f"}, {"g"}, {"h"}, {"i"}}),
-           /*compare_order=*/false}};
+           /*compare_order=*/false},
+          {/*dataset_params=*/
+           ReadAheadDeterministicParams(),
+           /*breakpoints=*/{0, 4, 11},
+           /*expected_outputs=*/
+           CreateTensors<tstring>(
+               TensorShape{1},
+               {{"a"}, {"d"}, {"g"}, {"b"}, {"e"}, {"h"}, {"c"}, {"f"}, {"i"}}),
+           /*compare_order=*/true}};
 }
 
 ITERATOR_SAVE_AND_RESTORE_TEST_P(ParallelInterleaveDatasetOpTest,
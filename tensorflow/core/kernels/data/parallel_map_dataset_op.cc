@@ -63,6 +63,8 @@ constexpr char kSize[] = "size";
 constexpr char kEndOfInput[] = "end_of_input";
 constexpr char kErrorCode[] = "code";
 constexpr char kErrorMessage[] = "error_message";
+constexpr char kInputPosition[] = "input_position";
+constexpr char kSymbolicCheckpoint[] = "symbolic_checkpoint";
 
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
@@ -253,6 +255,12 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       RecordStop(ctx);
       result->notification.WaitForNotification();
       RecordStart(ctx);
+      if (deterministic_ && !result->end_of_input) {
+        mutex_lock l(*mu_);
+        if (input_position_ >= 0) {
+          input_position_++;
+        }
+      }
       profiler::TraceMe traceme([&] {
         return profiler::TraceMeEncode("ParallelMapConsume",
                                        {{"element_id", result->uid}});
@@ -260,6 +268,27 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       return ProcessResult(ctx, result, out_tensors, end_of_sequence);
     }
 
+    Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                        bool* end_of_sequence, int* num_skipped) override {
+      {
+        mutex_lock l(*mu_);
+        if (ctx->is_restoring() && deterministic_ && !runner_thread_ &&
+            invocation_results_.empty()) {
+          // A downstream symbolic checkpoint is being restored. The skipped
+          // elements were already produced before the checkpoint, so `f` does
+          // not need to be run on them again.
+          TF_RETURN_IF_ERROR(input_impl_->Skip(ctx, num_to_skip,
+                                               end_of_sequence, num_skipped));
+          if (input_position_ >= 0) {
+            input_position_ += *num_skipped;
+          }
+          return Status::OK();
+        }
+      }
+      return DatasetIterator<Dataset>::SkipInternal(ctx, num_to_skip,
+                                                   end_of_sequence, num_skipped);
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
@@ -272,8 +301,22 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
 
     Status SaveInternal(SerializationContext* ctx,
                         IteratorStateWriter* writer) override {
-      TF_RETURN_IF_ERROR(ctx->HandleCheckExternalStateStatus(
-          dataset()->captured_func_->CheckExternalState()));
+      Status external_state = dataset()->captured_func_->CheckExternalState();
+      TF_RETURN_IF_ERROR(ctx->HandleCheckExternalStateStatus(external_state));
+      if (ctx->symbolic_checkpoint() && deterministic_ &&
+          external_state.ok() &&
+          dataset()->input_->CheckExternalState().ok()) {
+        // The function is recomputed for the in-flight and buffered elements
+        // after restoring, so only the number of consumed input elements is
+        // saved and in-flight calls need not be waited for.
+        mutex_lock l(*mu_);
+        if (input_position_ >= 0) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name(kSymbolicCheckpoint), ""));
+          return writer->WriteScalar(full_name(kInputPosition),
+                                     input_position_);
+        }
+      }
       mutex_lock l(*mu_);
       // Wait for all in-flight calls to complete.
       while (num_calls_ > 0) {
@@ -284,6 +327,8 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
             "Unexpected outstanding calls encountered.");
       }
       TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kInputPosition), input_position_));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(absl::StrCat(prefix(), "::", kInvocationResults),
                               kSize, invocation_results_.size()));
@@ -311,6 +356,17 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
       mutex_lock l(*mu_);
+      if (reader->Contains(full_name(kInputPosition))) {
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kInputPosition), &input_position_));
+      } else {
+        // The checkpoint predates position tracking, so later saves cannot be
+        // symbolic.
+        input_position_ = -1;
+      }
+      if (reader->Contains(full_name(kSymbolicCheckpoint))) {
+        return SkipInput(ctx, input_position_, input_impl_);
+      }
       TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
       int64 invocation_results_size;
       TF_RETURN_IF_ERROR(
@@ -654,6 +710,10 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     // Buffer for storing the invocation results.
     std::deque<std::shared_ptr<InvocationResult>> invocation_results_
         TF_GUARDED_BY(*mu_);
+    // Number of input elements whose results have been returned to the
+    // consumer, or -1 if unknown because the iterator was restored from an
+    // older checkpoint. Only maintained in deterministic mode.
+    int64 input_position_ TF_GUARDED_BY(*mu_) = 0;
     std::unique_ptr<Thread> runner_thread_ TF_GUARDED_BY(*mu_);
     std::unique_ptr<Thread> stats_thread_ TF_GUARDED_BY(*mu_);
     bool cancelled_ TF_GUARDED_BY(*mu_) = false;
@@ -15,17 +15,29 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 
+#include <algorithm>
+
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.h"
 
 namespace tensorflow {
 namespace data {
 
-PrefetchAutotuner::PrefetchAutotuner(int64 initial_buffer_size,
-                                     int64 buffer_size_min)
-    : buffer_limit_(initial_buffer_size) {
+PrefetchAutotuner::PrefetchAutotuner(
+    int64 initial_buffer_size, int64 buffer_size_min,
+    model::RamBudgetManager* ram_budget_manager)
+    : buffer_limit_(initial_buffer_size),
+      buffer_size_min_(std::max(int64{1}, buffer_size_min)),
+      ram_budget_manager_(ram_budget_manager) {
   if (initial_buffer_size == model::kAutotune) {
     mode_ = Mode::kUpswing;
-    buffer_limit_ = std::max(int64{1}, buffer_size_min);
+    buffer_limit_ = buffer_size_min_;
+  }
+}
+
+PrefetchAutotuner::~PrefetchAutotuner() {
+  if (ram_budget_manager_) {
+    ram_budget_manager_->RemoveAllocation(this);
   }
 }
 
@@ -34,6 +46,10 @@ namespace {
 // limits less than the threshold, an exponential increase is used, while for
 // limits greater than or equal to the threshold, a linear increase is used.
 size_t kBufferLimitThreshold = 2048;
+
+// Determines how often (in number of consumed elements) the buffer is checked
+// against the RAM budget.
+constexpr int64 kRamBudgetCheckPeriod = 64;
 }  // namespace
 
 void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size) {
@@ -45,19 +61,53 @@ void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size) {
           buffer_limit_) {
         mode_ = Mode::kDownswing;
       }
-      return;
+      break;
     case Mode::kDownswing:
       if (current_buffer_size == 0) {
+        int64 new_buffer_limit;
         if (buffer_limit_ >=
             static_cast<tensorflow::int64>(kBufferLimitThreshold)) {
-          buffer_limit_ += kBufferLimitThreshold;
+          new_buffer_limit = buffer_limit_ + kBufferLimitThreshold;
         } else {
-          buffer_limit_ *= 2;
+          new_buffer_limit = buffer_limit_ * 2;
+        }
+        if (AllocateRam(new_buffer_limit)) {
+          buffer_limit_ = new_buffer_limit;
+          mode_ = Mode::kUpswing;
         }
-        mode_ = Mode::kUpswing;
       }
-      return;
+      break;
+  }
+  if (ram_budget_manager_ && ++num_consumptions_ % kRamBudgetCheckPeriod == 0) {
+    ShrinkToRamBudget();
+  }
+}
+
+bool PrefetchAutotuner::AllocateRam(int64 buffer_limit) {
+  if (!ram_budget_manager_ || element_size_ == 0) {
+    return true;
+  }
+  if (buffer_limit * element_size_ >
+      ram_budget_manager_->AvailableFor(this)) {
+    return false;
+  }
+  ram_budget_manager_->SetAllocation(this, buffer_limit * element_size_);
+  return true;
+}
+
+void PrefetchAutotuner::ShrinkToRamBudget() {
+  if (element_size_ == 0) {
+    return;
+  }
+  const int64 available = ram_budget_manager_->AvailableFor(this);
+  if (buffer_limit_ * element_size_ > available &&
+      buffer_limit_ > buffer_size_min_) {
+    buffer_limit_ = std::max(buffer_size_min_, available / element_size_);
+    // Only grow the buffer again once it has been drained.
+    mode_ = Mode::kDownswing;
+    metrics::RecordTFDataAutotuneBufferShrink();
   }
+  ram_budget_manager_->SetAllocation(this, buffer_limit_ * element_size_);
 }
 
 }  // namespace data
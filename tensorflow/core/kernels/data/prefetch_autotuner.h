@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_PREFETCH_AUTOTUNER_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_PREFETCH_AUTOTUNER_H_
 
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -33,16 +35,26 @@ namespace data {
 // if the prefetching thread is able to successfully fill the buffer at its
 // current size.
 //
-// Note: in the current implementation, we never decrease the buffer_limit().
-// This should change in the future!
+// If a `RamBudgetManager` is provided, the buffer is accounted against the RAM
+// budget shared with other input pipelines: the buffer_limit is only increased
+// if the larger buffer fits into the budget, and it is decreased when the
+// buffer no longer fits, e.g. because another input pipeline has grown its
+// buffers. Otherwise, the buffer_limit never decreases.
 //
 // PrefetchAutotuner is NOT thread safe.
 class PrefetchAutotuner {
  public:
-  explicit PrefetchAutotuner(int64 initial_buffer_size, int64 buffer_size_min);
+  explicit PrefetchAutotuner(
+      int64 initial_buffer_size, int64 buffer_size_min,
+      model::RamBudgetManager* ram_budget_manager = nullptr);
+  ~PrefetchAutotuner();
 
   int64 buffer_limit() const { return buffer_limit_; }
 
+  // Sets the number of bytes of a buffered element, which is used to account
+  // the buffer against the RAM budget.
+  void SetElementSize(int64 element_size) { element_size_ = element_size; }
+
   void RecordConsumption(size_t current_buffer_size);
   void RecordEmpty() { RecordConsumption(0); }
 
@@ -61,8 +73,23 @@ class PrefetchAutotuner {
     kDownswing,
   };
 
+  // Returns whether a buffer of `buffer_limit` elements fits into the RAM
+  // budget and, if so, allocates it.
+  bool AllocateRam(int64 buffer_limit);
+
+  // Decreases the buffer_limit if the buffer no longer fits into the RAM
+  // budget.
+  void ShrinkToRamBudget();
+
   int64 buffer_limit_;
+  const int64 buffer_size_min_;
   Mode mode_ = Mode::kDisabled;
+  model::RamBudgetManager* const ram_budget_manager_;
+  // The number of bytes of a buffered element, or 0 if unknown.
+  int64 element_size_ = 0;
+  int64 num_consumptions_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PrefetchAutotuner);
 };
 
 }  // namespace data
@@ -103,6 +103,56 @@ TEST(PrefetchAutotuner, StartWithMin) {
   }
 }
 
+TEST(PrefetchAutotuner, GrowsWithinRamBudget) {
+  model::RamBudgetManager ram_budget_manager(/*budget=*/40);
+  PrefetchAutotuner t(model::kAutotune, 0, &ram_budget_manager);
+  t.SetElementSize(10);
+  EXPECT_EQ(1, t.buffer_limit());
+  t.RecordConsumption(1);
+  t.RecordConsumption(0);  // Expect buffer limit to increase.
+  EXPECT_EQ(2, t.buffer_limit());
+  t.RecordConsumption(2);
+  t.RecordConsumption(0);  // Expect buffer limit to increase.
+  EXPECT_EQ(4, t.buffer_limit());
+  t.RecordConsumption(4);
+  t.RecordConsumption(0);  // Expect buffer limit to stay within the budget.
+  EXPECT_EQ(4, t.buffer_limit());
+  EXPECT_EQ(40, ram_budget_manager.TotalAllocation());
+}
+
+TEST(PrefetchAutotuner, ShrinksUnderRamPressure) {
+  model::RamBudgetManager ram_budget_manager(/*budget=*/40);
+  PrefetchAutotuner t(model::kAutotune, 0, &ram_budget_manager);
+  t.SetElementSize(10);
+  t.RecordConsumption(1);
+  t.RecordConsumption(0);
+  t.RecordConsumption(2);
+  t.RecordConsumption(0);
+  EXPECT_EQ(4, t.buffer_limit());
+
+  // Another input pipeline takes most of the budget.
+  int other_pipeline;
+  ram_budget_manager.SetAllocation(&other_pipeline, 30);
+  // The buffer is checked against the budget periodically.
+  for (int i = 0; i < 100; ++i) {
+    t.RecordConsumption(2);
+  }
+  EXPECT_EQ(1, t.buffer_limit());
+  EXPECT_EQ(40, ram_budget_manager.TotalAllocation());
+}
+
+TEST(PrefetchAutotuner, ReleasesRamBudget) {
+  model::RamBudgetManager ram_budget_manager(/*budget=*/40);
+  {
+    PrefetchAutotuner t(model::kAutotune, 0, &ram_budget_manager);
+    t.SetElementSize(10);
+    t.RecordConsumption(1);
+    t.RecordConsumption(0);
+    EXPECT_EQ(20, ram_budget_manager.TotalAllocation());
+  }
+  EXPECT_EQ(0, ram_budget_manager.TotalAllocation());
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
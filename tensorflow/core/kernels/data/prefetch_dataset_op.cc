@@ -57,6 +57,8 @@ constexpr char kStatus[] = "status";
 constexpr char kSizeSuffix[] = ".size";
 constexpr char kCodeSuffix[] = ".code";
 constexpr char kErrorMessageSuffix[] = ".error_message";
+constexpr char kInputPosition[] = "input_position";
+constexpr char kSymbolicCheckpoint[] = "symbolic_checkpoint";
 
 }  // namespace
 
@@ -136,7 +138,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           mu_(std::make_shared<mutex>()),
           cond_var_(std::make_shared<condition_variable>()),
           buffer_size_min_(params.dataset->buffer_size_min_),
-          auto_tuner_(params.dataset->buffer_size_, buffer_size_min_),
+          auto_tuner_(params.dataset->buffer_size_, buffer_size_min_,
+                      model::RamBudgetManager::Global()),
           legacy_autotune_(params.dataset->legacy_autotune_),
           // If `legacy_autotune_`, initialize the `buffer_size_` value to be 0
           // to avoid the created node to be collected as tunable nodes in the
@@ -223,7 +226,35 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         }
         // Release mu_
       }
-      return input_impl_->GetNext(ctx, out_tensors, end_of_sequence);
+      TF_RETURN_IF_ERROR(
+          input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+      if (!*end_of_sequence) {
+        mutex_lock l(*mu_);
+        if (input_position_ >= 0) {
+          input_position_++;
+        }
+      }
+      return Status::OK();
+    }
+
+    Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                        bool* end_of_sequence, int* num_skipped) override {
+      {
+        mutex_lock input_l(input_mu_);
+        mutex_lock l(*mu_);
+        if (ctx->is_restoring() && !prefetch_thread_ && buffer_.empty()) {
+          // A downstream symbolic checkpoint is being restored, so nothing
+          // has been prefetched yet and the input can be skipped directly.
+          TF_RETURN_IF_ERROR(input_impl_->Skip(ctx, num_to_skip,
+                                               end_of_sequence, num_skipped));
+          if (input_position_ >= 0) {
+            input_position_ += *num_skipped;
+          }
+          return Status::OK();
+        }
+      }
+      return DatasetIterator<Dataset>::SkipInternal(ctx, num_to_skip,
+                                                   end_of_sequence, num_skipped);
     }
 
    protected:
@@ -239,11 +270,26 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
 
     Status SaveInternal(SerializationContext* ctx,
                         IteratorStateWriter* writer) override {
+      if (ctx->symbolic_checkpoint() &&
+          dataset()->input_->CheckExternalState().ok()) {
+        // Only the number of consumed input elements is saved. Neither the
+        // input iterator nor the buffer need to be serialized, so the prefetch
+        // thread keeps running.
+        mutex_lock l(*mu_);
+        if (input_position_ >= 0) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(prefix(), kSymbolicCheckpoint, ""));
+          return writer->WriteScalar(prefix(), kInputPosition,
+                                     input_position_);
+        }
+      }
       // Acquire both locks to ensure that the prefetch thread and
       // all GetNext threads are blocked.
       mutex_lock input_l(input_mu_);
       mutex_lock l(*mu_);
       TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kInputPosition, input_position_));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(prefix(), kBufferSize, buffer_.size()));
       for (size_t i = 0; i < buffer_.size(); i++) {
@@ -268,6 +314,18 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       mutex_lock input_l(input_mu_);
       mutex_lock l(*mu_);
       DCHECK(buffer_.empty());
+      if (reader->Contains(prefix(), kInputPosition)) {
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(prefix(), kInputPosition, &input_position_));
+      } else {
+        // The checkpoint predates position tracking, so later saves cannot be
+        // symbolic.
+        input_position_ = -1;
+      }
+      if (reader->Contains(prefix(), kSymbolicCheckpoint)) {
+        // The buffer is refilled by the prefetch thread once it starts.
+        return SkipInput(ctx, input_position_, input_impl_);
+      }
       TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
       size_t buffer_size;
       {
@@ -420,10 +478,16 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         RecordBufferDequeue(ctx, buffer_.front().value);
       }
       if (legacy_autotune_) {
+        if (s.ok()) {
+          auto_tuner_.SetElementSize(GetAllocatedBytes(*out_tensors));
+        }
         auto_tuner_.RecordConsumption(buffer_.size());
         buffer_size_->value = auto_tuner_.buffer_limit();
       }
       buffer_.pop_front();
+      if (input_position_ >= 0) {
+        input_position_++;
+      }
       *end_of_sequence = false;
 
       // Wake the prefetch thread, in case it has been waiting for space
@@ -574,6 +638,9 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     std::unique_ptr<Thread> prefetch_thread_ TF_GUARDED_BY(*mu_);
     bool cancelled_ TF_GUARDED_BY(*mu_) = false;
     bool prefetch_thread_finished_ TF_GUARDED_BY(*mu_) = false;
+    // Number of input elements that have been returned to the consumer, or -1
+    // if unknown because the iterator was restored from an older checkpoint.
+    int64 input_position_ TF_GUARDED_BY(*mu_) = 0;
     const bool legacy_autotune_;
 
     std::atomic<int64> slack_us_;
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/range_dataset_op.h"
 
+#include <algorithm>
 #include <functional>
 #include <string>
 #include <utility>
@@ -65,6 +66,21 @@ class RangeCounter {
     return result;
   }
 
+  // Advances the counter by up to `num_to_skip` values without producing
+  // them, and returns the number of values skipped.
+  int64 Skip(int64 num_to_skip) {
+    mutex_lock l(mu_);
+    int64 num_remaining = 0;
+    if (step_ > 0 && next_ < stop_) {
+      num_remaining = (stop_ - next_ - 1) / step_ + 1;
+    } else if (step_ < 0 && next_ > stop_) {
+      num_remaining = (next_ - stop_ - 1) / -step_ + 1;
+    }
+    const int64 num_skipped = std::min(num_to_skip, num_remaining);
+    next_ += num_skipped * step_;
+    return num_skipped;
+  }
+
   int64 Peek() const {
     mutex_lock l(mu_);
     return next_;
@@ -250,6 +266,17 @@ class RangeDatasetOp::Dataset : public DatasetBase {
       return Status::OK();
     }
 
+    Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                        bool* end_of_sequence, int* num_skipped) override {
+      if (split_provider_ != nullptr) {
+        return DatasetIterator<Dataset>::SkipInternal(
+            ctx, num_to_skip, end_of_sequence, num_skipped);
+      }
+      *num_skipped = static_cast<int>(counter_->Skip(num_to_skip));
+      *end_of_sequence = *num_skipped < num_to_skip;
+      return Status::OK();
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
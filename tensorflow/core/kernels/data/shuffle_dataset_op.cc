@@ -14,8 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <algorithm>
 #include <deque>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/data/dataset_utils.h"
@@ -67,6 +69,9 @@ constexpr char kSlicesStart[] = "slices_start";
 constexpr char kSlicesEnd[] = "slices_end";
 constexpr char kSeedGenerator[] = "SeedGenerator";
 constexpr char kEpochNumRandomSamples[] = "epoch_num_random_samples";
+constexpr char kInputPosition[] = "input_position";
+constexpr char kBufferPositions[] = "buffer_positions";
+constexpr char kSymbolicCheckpoint[] = "symbolic_checkpoint";
 constexpr char kShuffleDatasetV1[] = "ShuffleDataset";
 constexpr char kShuffleDatasetV2[] = "ShuffleDatasetV2";
 constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
@@ -148,6 +153,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           generator_(&parent_generator_) {
       buffer_ = absl::make_unique<std::vector<std::vector<Tensor>>>(
           params.dataset->buffer_size_);
+      buffer_positions_.resize(params.dataset->buffer_size_);
       slices_.push_back(absl::make_unique<Slice>(0, 0));
     }
 
@@ -167,6 +173,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       if (!input_impl_ && epoch_ == 0) {
         TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
             ctx, this, this->prefix(), &input_impl_));
+        input_position_ = 0;
       }
       while (input_impl_ && num_elements_ < this->dataset()->buffer_size_) {
         if (EnvTime::NowMicros() >
@@ -201,6 +208,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           }
           TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
               ctx, this, this->prefix(), &input_impl_));
+          input_position_ = 0;
         }
         if (!end_of_input_sequence) {
           if (num_elements_ == 0) {
@@ -208,8 +216,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
                     << this->dataset()->buffer_size_;
           }
           this->RecordBufferEnqueue(ctx, input_element);
-          buffer_->at(slices_.back()->end % this->dataset()->buffer_size_) =
-              std::move(input_element);
+          const int64 slot =
+              slices_.back()->end % this->dataset()->buffer_size_;
+          buffer_->at(slot) = std::move(input_element);
+          buffer_positions_[slot] = input_position_++;
           num_elements_++;
           slices_.back()->end++;
         } else {
@@ -248,9 +258,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             (slices_.front()->start + offset) % this->dataset()->buffer_size_;
         *out_tensors = std::move(buffer_->at(index));
         this->RecordBufferDequeue(ctx, *out_tensors);
-        std::swap(buffer_->at(index),
-                  buffer_->at(slices_.front()->start %
-                              this->dataset()->buffer_size_));
+        const int64 start_index =
+            slices_.front()->start % this->dataset()->buffer_size_;
+        std::swap(buffer_->at(index), buffer_->at(start_index));
+        std::swap(buffer_positions_[index], buffer_positions_[start_index]);
         slices_.front()->start++;
         num_elements_--;
       } else {
@@ -287,12 +298,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kSeed), seed_));
       TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kSeed2), seed2_));
 
+      // With symbolic checkpoints, only the input positions of the buffered
+      // elements are saved, and the elements are re-read on restore.
+      const bool symbolic = ctx->symbolic_checkpoint() && positions_valid_ &&
+                            this->dataset()->input_->CheckExternalState().ok();
+
       // Save input iterator if it hasn't been exhausted else write
       // "end_of_input_sequence".
       if (!input_impl_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(this->full_name(kEndOfInputSequence), ""));
-      } else {
+      } else if (!symbolic) {
         TF_RETURN_IF_ERROR(this->SaveInput(ctx, writer, input_impl_));
       }
 
@@ -300,7 +316,16 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kEpoch), epoch_));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(this->full_name(kNumElements), num_elements_));
-      TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(writer, prefix(), *buffer_));
+      if (positions_valid_) {
+        TF_RETURN_IF_ERROR(WritePositions(writer));
+      }
+      if (symbolic) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(this->full_name(kSymbolicCheckpoint), ""));
+      } else {
+        TF_RETURN_IF_ERROR(
+            WriteElementsToCheckpoint(writer, prefix(), *buffer_));
+      }
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(this->full_name(kSlicesSize), slices_.size()));
       for (size_t i = 0; i < slices_.size(); ++i) {
@@ -335,13 +360,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(reader->ReadScalar(this->full_name(kSeed2), &seed2_));
       ResetRngs();
 
-      // Restore the input iterator if it wasn't already exhausted.
-      if (!reader->Contains(this->full_name(kEndOfInputSequence))) {
+      const bool symbolic =
+          reader->Contains(this->full_name(kSymbolicCheckpoint));
+
+      // Restore the input iterator if it wasn't already exhausted. For
+      // symbolic checkpoints, it is restored below together with the buffer.
+      if (reader->Contains(this->full_name(kEndOfInputSequence))) {
+        input_impl_.reset();
+      } else if (!symbolic) {
         TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
             ctx, this, this->prefix(), &input_impl_));
         TF_RETURN_IF_ERROR(this->RestoreInput(ctx, reader, input_impl_));
-      } else {
-        input_impl_.reset();
       }
 
       // Restore the epoch counter, buffer, and buffer slices.
@@ -357,8 +386,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       }
       buffer_ = absl::make_unique<std::vector<std::vector<Tensor>>>(
           this->dataset()->buffer_size_);
-      TF_RETURN_IF_ERROR(
-          ReadElementsFromCheckpoint(ctx, reader, prefix(), buffer_.get()));
+      if (!symbolic) {
+        TF_RETURN_IF_ERROR(
+            ReadElementsFromCheckpoint(ctx, reader, prefix(), buffer_.get()));
+      }
       slices_.clear();
       for (size_t i = 0; i < slices_size; ++i) {
         int64 start;
@@ -374,6 +405,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       }
       data_produced_ = reader->Contains(this->full_name(kDataProduced));
 
+      positions_valid_ = reader->Contains(this->full_name(kBufferPositions));
+      if (positions_valid_) {
+        TF_RETURN_IF_ERROR(ReadPositions(reader));
+      } else if (symbolic) {
+        return errors::DataLoss("Symbolic checkpoint of ", prefix(),
+                                " does not contain buffer positions.");
+      }
+      if (symbolic) {
+        TF_RETURN_IF_ERROR(RecomputeBuffer(
+            ctx, reader->Contains(this->full_name(kEndOfInputSequence))));
+      }
       return Status::OK();
     }
 
@@ -394,6 +436,94 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       int64 end;
     };
 
+    // Writes the input positions of the buffered elements, ordered by slice,
+    // followed by the position of the input iterator.
+    Status WritePositions(IteratorStateWriter* writer)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Tensor positions(DT_INT64, TensorShape({num_elements_}));
+      auto positions_t = positions.vec<int64>();
+      int64 i = 0;
+      for (const auto& slice : slices_) {
+        for (int64 j = slice->start; j < slice->end; ++j) {
+          positions_t(i++) =
+              buffer_positions_[j % this->dataset()->buffer_size_];
+        }
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteTensor(this->full_name(kBufferPositions), positions));
+      return writer->WriteScalar(this->full_name(kInputPosition),
+                                 input_position_);
+    }
+
+    Status ReadPositions(IteratorStateReader* reader)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Tensor positions;
+      TF_RETURN_IF_ERROR(
+          reader->ReadTensor(this->full_name(kBufferPositions), &positions));
+      if (positions.dtype() != DT_INT64 ||
+          positions.NumElements() != num_elements_) {
+        return errors::DataLoss("Invalid buffer positions in checkpoint of ",
+                                prefix(), ": ", positions.DebugString());
+      }
+      auto positions_t = positions.vec<int64>();
+      int64 i = 0;
+      for (const auto& slice : slices_) {
+        for (int64 j = slice->start; j < slice->end; ++j) {
+          buffer_positions_[j % this->dataset()->buffer_size_] =
+              positions_t(i++);
+        }
+      }
+      return reader->ReadScalar(this->full_name(kInputPosition),
+                                &input_position_);
+    }
+
+    // Re-reads the buffered elements of a symbolic checkpoint from the input.
+    // Each slice holds elements of one epoch, and the last slice belongs to
+    // the current epoch. Unless `end_of_input` is set, the input iterator of
+    // the current epoch is then advanced to `input_position_`.
+    Status RecomputeBuffer(IteratorContext* ctx, bool end_of_input)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (size_t i = 0; i < slices_.size(); ++i) {
+        const bool resume_input = i + 1 == slices_.size() && !end_of_input;
+        if (slices_[i]->start == slices_[i]->end && !resume_input) {
+          continue;
+        }
+        std::unique_ptr<IteratorBase> input;
+        TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
+            ctx, this, this->prefix(), &input));
+        // Visit the slots of the slice in input order.
+        std::vector<std::pair<int64, int64>> position_and_slot;
+        for (int64 j = slices_[i]->start; j < slices_[i]->end; ++j) {
+          const int64 slot = j % this->dataset()->buffer_size_;
+          position_and_slot.emplace_back(buffer_positions_[slot], slot);
+        }
+        std::sort(position_and_slot.begin(), position_and_slot.end());
+        int64 position = 0;
+        for (const auto& entry : position_and_slot) {
+          TF_RETURN_IF_ERROR(
+              this->SkipInput(ctx, entry.first - position, input));
+          std::vector<Tensor>& element = buffer_->at(entry.second);
+          bool end_of_sequence = false;
+          TF_RETURN_IF_ERROR(input->GetNext(ctx, &element, &end_of_sequence));
+          if (end_of_sequence) {
+            return errors::FailedPrecondition(
+                "Failed to restore shuffle buffer of ", prefix(),
+                " because its input ended before position ", entry.first,
+                ". Symbolic checkpoints require the input to produce the same "
+                "elements each time it is iterated.");
+          }
+          this->RecordBufferEnqueue(ctx, element);
+          position = entry.first + 1;
+        }
+        if (resume_input) {
+          TF_RETURN_IF_ERROR(
+              this->SkipInput(ctx, input_position_ - position, input));
+          input_impl_ = std::move(input);
+        }
+      }
+      return Status::OK();
+    }
+
     random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random()
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       num_random_samples_++;
@@ -405,6 +535,13 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
     std::unique_ptr<std::vector<std::vector<Tensor>>> buffer_
         TF_GUARDED_BY(mu_);
+    // Positions of the elements in `buffer_` within the input of their epoch.
+    std::vector<int64> buffer_positions_ TF_GUARDED_BY(mu_);
+    // Number of elements read from the input iterator of the current epoch.
+    int64 input_position_ TF_GUARDED_BY(mu_) = 0;
+    // False if the iterator was restored from a checkpoint that predates
+    // position tracking, in which case saves cannot be symbolic.
+    bool positions_valid_ TF_GUARDED_BY(mu_) = true;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_) = nullptr;
     int64 epoch_ TF_GUARDED_BY(mu_) = 0;
     int64 num_elements_ TF_GUARDED_BY(mu_) = 0;
@@ -14,13 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/block_record_reader.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/record_block.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
@@ -35,6 +39,8 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const
+    TFRecordDatasetOp::kDecompressionParallelism;
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
@@ -42,6 +48,9 @@ constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64 kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64 kS3BlockSize = kCloudTpuBlockSize;
+// Number of blocks decompressed concurrently per block-compressed file when
+// `decompression_parallelism` is AUTOTUNE.
+constexpr int64 kDefaultDecompressionParallelism = 4;
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -54,12 +63,15 @@ bool is_cloud_tpu_gcs_fs() {
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64 buffer_size)
+                   const string& compression_type, int64 buffer_size,
+                   int64 decompression_parallelism)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
-        options_(io::RecordReaderOptions::CreateRecordReaderOptions(
-            compression_type)) {
+        decompression_parallelism_(decompression_parallelism) {
+    string codec = compression_type;
+    block_compressed_ = io::ConsumeRecordBlockCompressionSuffix(&codec);
+    options_ = io::RecordReaderOptions::CreateRecordReaderOptions(codec);
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
@@ -102,8 +114,12 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+    AttrValue decompression_parallelism;
+    b->BuildAttrValue(decompression_parallelism_, &decompression_parallelism);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+        this, {filenames, compression_type, buffer_size},
+        {std::make_pair(kDecompressionParallelism, decompression_parallelism)},
+        output));
     return Status::OK();
   }
 
@@ -120,11 +136,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next record.
-        if (reader_) {
+        if (HasReaderLocked()) {
           out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
                                     TensorShape({}));
           Status s =
-              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+              ReadRecordLocked(&out_tensors->back().scalar<tstring>()());
           if (s.ok()) {
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
@@ -155,7 +171,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           return Status::OK();
         }
 
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
       } while (true);
     }
 
@@ -166,10 +182,10 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       do {
         // We are currently processing a file, so try to skip reading
         // the next (num_to_skip - *num_skipped) record.
-        if (reader_) {
+        if (HasReaderLocked()) {
           int last_num_skipped;
-          Status s = reader_->SkipRecords(num_to_skip - *num_skipped,
-                                          &last_num_skipped);
+          Status s = SkipRecordsLocked(num_to_skip - *num_skipped,
+                                       &last_num_skipped);
           *num_skipped += last_num_skipped;
           if (s.ok()) {
             *end_of_sequence = false;
@@ -196,7 +212,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           return Status::OK();
         }
 
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
       } while (true);
     }
 
@@ -212,9 +228,9 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
                                              current_file_index_));
 
-      if (reader_) {
+      if (HasReaderLocked()) {
         TF_RETURN_IF_ERROR(
-            writer->WriteScalar(full_name(kOffset), reader_->TellOffset()));
+            writer->WriteScalar(full_name(kOffset), TellOffsetLocked()));
       }
       return Status::OK();
     }
@@ -230,15 +246,17 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       if (reader->Contains(full_name(kOffset))) {
         int64 offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset));
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
+        TF_RETURN_IF_ERROR(SeekOffsetLocked(offset));
       }
       return Status::OK();
     }
 
    private:
     // Sets up reader streams to read from the file at `current_file_index_`.
-    Status SetupStreamsLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status SetupStreamsLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Env* env = ctx->env();
       if (current_file_index_ >= dataset()->filenames_.size()) {
         return errors::InvalidArgument(
             "current_file_index_:", current_file_index_,
@@ -248,6 +266,27 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       // Actually move on to next file.
       const string& next_filename = dataset()->filenames_[current_file_index_];
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(next_filename, &file_));
+      if (dataset()->block_compressed_ &&
+          dataset()->options_.compression_type !=
+              io::RecordReaderOptions::NONE) {
+        // Block-compressed files carry a footer and are decompressed by
+        // BlockRecordReader, possibly several blocks at a time on the
+        // iterator's runner. Files without a footer are read as regular
+        // compressed files.
+        uint64 file_size;
+        TF_RETURN_IF_ERROR(env->GetFileSize(next_filename, &file_size));
+        if (io::IsRecordBlockFile(file_.get(), file_size)) {
+          int64 parallelism = dataset()->decompression_parallelism_;
+          if (parallelism == model::kAutotune) {
+            parallelism = std::min<int64>(kDefaultDecompressionParallelism,
+                                          ctx->runner_threadpool_size());
+          }
+          block_reader_ = absl::make_unique<io::BlockRecordReader>(
+              file_.get(), file_size, dataset()->options_, *ctx->runner(),
+              parallelism);
+          return block_reader_->Initialize();
+        }
+      }
       reader_ = absl::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
       return Status::OK();
@@ -256,25 +295,69 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // Resets all reader streams.
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
+      block_reader_.reset();
       file_.reset();
     }
 
+    bool HasReaderLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return reader_ != nullptr || block_reader_ != nullptr;
+    }
+
+    Status ReadRecordLocked(tstring* record) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return block_reader_ ? block_reader_->ReadRecord(record)
+                           : reader_->ReadRecord(record);
+    }
+
+    Status SkipRecordsLocked(int num_to_skip, int* num_skipped)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return block_reader_
+                 ? block_reader_->SkipRecords(num_to_skip, num_skipped)
+                 : reader_->SkipRecords(num_to_skip, num_skipped);
+    }
+
+    // For block-compressed files the offset is a record ordinal rather than
+    // a byte offset; the kind of file is rediscovered on restore.
+    uint64 TellOffsetLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return block_reader_ ? block_reader_->TellOffset()
+                           : reader_->TellOffset();
+    }
+
+    Status SeekOffsetLocked(uint64 offset) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return block_reader_ ? block_reader_->SeekOffset(offset)
+                           : reader_->SeekOffset(offset);
+    }
+
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
 
-    // `reader_` will borrow the object that `file_` points to, so
-    // we must destroy `reader_` before `file_`.
+    // `reader_` and `block_reader_` will borrow the object that `file_`
+    // points to, so we must destroy them before `file_`. At most one of them
+    // is set.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<io::BlockRecordReader> block_reader_ TF_GUARDED_BY(mu_);
   };
 
   const std::vector<string> filenames_;
   const tstring compression_type_;
+  // Whether `compression_type_` carries kRecordBlockCompressionSuffix.
+  bool block_compressed_;
   io::RecordReaderOptions options_;
+  const int64 decompression_parallelism_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  if (ctx->HasAttr(kDecompressionParallelism)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kDecompressionParallelism,
+                                     &decompression_parallelism_));
+  }
+  OP_REQUIRES(ctx,
+              decompression_parallelism_ == model::kAutotune ||
+                  decompression_parallelism_ >= 0,
+              errors::InvalidArgument(
+                  "`decompression_parallelism` must be >= 0 or AUTOTUNE"));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -322,8 +405,8 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, decompression_parallelism_);
 }
 
 namespace {
@@ -26,6 +26,8 @@ class TFRecordDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kFileNames = "filenames";
   static constexpr const char* const kCompressionType = "compression_type";
   static constexpr const char* const kBufferSize = "buffer_size";
+  static constexpr const char* const kDecompressionParallelism =
+      "decompression_parallelism";
 
   explicit TFRecordDatasetOp(OpKernelConstruction* ctx);
 
@@ -34,6 +36,7 @@ class TFRecordDatasetOp : public DatasetOpKernel {
 
  private:
   class Dataset;
+  int64 decompression_parallelism_ = model::kAutotune;
 };
 
 }  // namespace data
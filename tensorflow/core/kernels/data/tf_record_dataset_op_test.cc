@@ -12,6 +12,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/lib/io/record_block.h"
 
 namespace tensorflow {
 namespace data {
@@ -22,19 +23,27 @@ constexpr char kNodeName[] = "tf_record_dataset";
 class TFRecordDatasetParams : public DatasetParams {
  public:
   TFRecordDatasetParams(std::vector<tstring> filenames,
-                        CompressionType compression_type, int64 buffer_size,
-                        string node_name)
+                        CompressionType compression_type,
+                        bool block_compressed, int64 buffer_size,
+                        int64 decompression_parallelism, string node_name)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
-        buffer_size_(buffer_size) {}
+        block_compressed_(block_compressed),
+        buffer_size_(buffer_size),
+        decompression_parallelism_(decompression_parallelism) {}
 
   std::vector<Tensor> GetInputTensors() const override {
     int num_files = filenames_.size();
     return {
         CreateTensor<tstring>(TensorShape({num_files}), filenames_),
-        CreateTensor<tstring>(TensorShape({}), {ToString(compression_type_)}),
+        CreateTensor<tstring>(
+            TensorShape({}),
+            {block_compressed_
+                 ? absl::StrCat(ToString(compression_type_),
+                                io::kRecordBlockCompressionSuffix)
+                 : ToString(compression_type_)}),
         CreateTensor<int64>(TensorShape({}), {buffer_size_})};
   }
 
@@ -49,7 +58,8 @@ class TFRecordDatasetParams : public DatasetParams {
   }
 
   Status GetAttributes(AttributeVector* attr_vector) const override {
-    *attr_vector = {};
+    *attr_vector = {{TFRecordDatasetOp::kDecompressionParallelism,
+                     decompression_parallelism_}};
     return Status::OK();
   }
 
@@ -60,14 +70,17 @@ class TFRecordDatasetParams : public DatasetParams {
  private:
   std::vector<tstring> filenames_;
   CompressionType compression_type_;
+  bool block_compressed_;
   int64 buffer_size_;
+  int64 decompression_parallelism_;
 };
 
 class TFRecordDatasetOpTest : public DatasetOpsTestBase {};
 
 Status CreateTestFiles(const std::vector<tstring>& filenames,
                        const std::vector<std::vector<string>>& contents,
-                       CompressionType compression_type) {
+                       CompressionType compression_type,
+                       int64 block_size_bytes = 0) {
   if (filenames.size() != contents.size()) {
     return tensorflow::errors::InvalidArgument(
         "The number of files does not match with the contents");
@@ -76,6 +89,7 @@ Status CreateTestFiles(const std::vector<tstring>& filenames,
     CompressionParams params;
     params.output_buffer_size = 10;
     params.compression_type = compression_type;
+    params.block_size_bytes = block_size_bytes;
     std::vector<absl::string_view> records(contents[i].begin(),
                                            contents[i].end());
     TF_RETURN_IF_ERROR(WriteDataToTFRecordFile(filenames[i], records, params));
@@ -97,7 +111,9 @@ TFRecordDatasetParams TFRecordDatasetParams1() {
   }
   return TFRecordDatasetParams(filenames,
                                /*compression_type=*/compression_type,
+                               /*block_compressed=*/false,
                                /*buffer_size=*/10,
+                               /*decompression_parallelism=*/model::kAutotune,
                                /*node_name=*/kNodeName);
 }
 
@@ -115,7 +131,9 @@ TFRecordDatasetParams TFRecordDatasetParams2() {
   }
   return TFRecordDatasetParams(filenames,
                                /*compression_type=*/compression_type,
+                               /*block_compressed=*/false,
                                /*buffer_size=*/10,
+                               /*decompression_parallelism=*/model::kAutotune,
                                /*node_name=*/kNodeName);
 }
 
@@ -133,7 +151,32 @@ TFRecordDatasetParams TFRecordDatasetParams3() {
   }
   return TFRecordDatasetParams(filenames,
                                /*compression_type=*/compression_type,
+                               /*block_compressed=*/false,
                                /*buffer_size=*/10,
+                               /*decompression_parallelism=*/model::kAutotune,
+                               /*node_name=*/kNodeName);
+}
+
+// Test case 4: multiple block-compressed ZLIB files whose blocks hold about
+// two records each, decompressed in parallel.
+TFRecordDatasetParams TFRecordDatasetParams4() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_ZLIB_BLOCK_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_ZLIB_BLOCK_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::ZLIB;
+  if (!CreateTestFiles(filenames, contents, compression_type,
+                       /*block_size_bytes=*/30)
+           .ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*block_compressed=*/true,
+                               /*buffer_size=*/10,
+                               /*decompression_parallelism=*/2,
                                /*node_name=*/kNodeName);
 }
 
@@ -147,6 +190,9 @@ std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams4(),
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
 }
@@ -186,6 +232,17 @@ std::vector<SkipTestCase<TFRecordDatasetParams>> SkipTestCases() {
            /*expected_outputs=*/
            CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
           {/*dataset_params=*/TFRecordDatasetParams3(),
+           /*num_to_skip*/ 7, /*expected_num_skipped*/ 6},
+
+          {/*dataset_params=*/TFRecordDatasetParams4(),
+           /*num_to_skip*/ 2, /*expected_num_skipped*/ 2, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"333"}})},
+          {/*dataset_params=*/TFRecordDatasetParams4(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
+          {/*dataset_params=*/TFRecordDatasetParams4(),
            /*num_to_skip*/ 7, /*expected_num_skipped*/ 6}};
 }
 
@@ -255,6 +312,10 @@ IteratorSaveAndRestoreTestCases() {
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams4(),
        /*breakpoints=*/{0, 2, 7},
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
@@ -42,6 +42,16 @@ static void GetRendezvousKey(const string& key_prefix,
                      frame_iter.iter_id);
 }
 
+// Only the cached top-level key uses the rendezvous slot assigned at
+// partition time; keys inside loops are matched by their full key.
+static void GetRendezvousSlot(OpKernelConstruction* ctx,
+                              Rendezvous::ParsedKey* parsed_key) {
+  int64 slot;
+  if (ctx->GetAttr("_rendezvous_slot", &slot).ok()) {
+    parsed_key->slot = slot;
+  }
+}
+
 static FrameAndIter GetFrameAndIter(OpKernelContext* ctx,
                                     bool hostmem_sendrecv) {
   if (hostmem_sendrecv && ctx->call_frame() != nullptr) {
@@ -72,6 +82,7 @@ SendOp::SendOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
   // proactively cache the rendezvous key for the top-level.
   GetRendezvousKey(key_prefix_, {0, 0}, &parsed_key_.buf_);
   OP_REQUIRES_OK(ctx, Rendezvous::ParseKey(parsed_key_.buf_, &parsed_key_));
+  GetRendezvousSlot(ctx, &parsed_key_);
   if (!ctx->GetAttr("_hostmem_sendrecv", &hostmem_sendrecv_).ok()) {
     hostmem_sendrecv_ = false;
   }
@@ -151,6 +162,7 @@ RecvOp::RecvOp(OpKernelConstruction* ctx) : AsyncOpKernel(ctx) {
   // proactively cache the rendezvous key for the top-level.
   GetRendezvousKey(key_prefix_, {0, 0}, &parsed_key_.buf_);
   OP_REQUIRES_OK(ctx, Rendezvous::ParseKey(parsed_key_.buf_, &parsed_key_));
+  GetRendezvousSlot(ctx, &parsed_key_);
   if (!ctx->GetAttr("_hostmem_sendrecv", &hostmem_sendrecv_).ok()) {
     hostmem_sendrecv_ = false;
   }
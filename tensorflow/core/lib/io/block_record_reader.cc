@@ -0,0 +1,239 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/block_record_reader.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace io {
+
+struct BlockRecordReader::Block {
+  explicit Block(int64 index) : index(index) {}
+
+  const int64 index;
+  // Written by the decoding thread before `done` is set; read by the consumer
+  // only after it observes `done` under `mu_`.
+  Status status;
+  tstring data;
+  bool done = false;
+};
+
+BlockRecordReader::BlockRecordReader(
+    RandomAccessFile* file, uint64 file_size,
+    const RecordReaderOptions& options,
+    std::function<void(std::function<void()>)> runner, int parallelism)
+    : file_(file),
+      file_size_(file_size),
+      options_(options),
+      runner_(std::move(runner)),
+      parallelism_(runner_ ? std::max(parallelism, 1) : 1) {}
+
+BlockRecordReader::~BlockRecordReader() {
+  mutex_lock l(mu_);
+  while (num_outstanding_ > 0) {
+    cond_var_.wait(l);
+  }
+}
+
+Status BlockRecordReader::Initialize() {
+  int compression_type;
+  TF_RETURN_IF_ERROR(
+      ReadRecordBlockIndex(file_, file_size_, &compression_type, &blocks_));
+  if (compression_type != options_.compression_type) {
+    return errors::InvalidArgument(
+        "Block-compressed record file was written with compression type ",
+        compression_type, " but is being read with compression type ",
+        options_.compression_type);
+  }
+  first_record_.clear();
+  first_record_.reserve(blocks_.size() + 1);
+  first_record_.push_back(0);
+  for (const RecordBlockHandle& block : blocks_) {
+    first_record_.push_back(first_record_.back() + block.num_records);
+  }
+  return Status::OK();
+}
+
+Status BlockRecordReader::DecodeBlock(int64 index, tstring* data) const {
+  const RecordBlockHandle& block = blocks_[index];
+  std::unique_ptr<char[]> scratch(new char[block.compressed_size]);
+  StringPiece compressed;
+  TF_RETURN_IF_ERROR(file_->Read(block.offset, block.compressed_size,
+                                 &compressed, scratch.get()));
+  if (compressed.size() != block.compressed_size) {
+    return errors::DataLoss("Truncated record block ", index, ": expected ",
+                            block.compressed_size, " bytes but read ",
+                            compressed.size());
+  }
+  return UncompressRecordBlock(options_.compression_type, compressed,
+                               block.uncompressed_size, data);
+}
+
+void BlockRecordReader::ScheduleBlocks() {
+  while (pending_.size() < parallelism_ &&
+         next_block_ + pending_.size() < blocks_.size()) {
+    auto block = std::make_shared<Block>(next_block_ + pending_.size());
+    pending_.push_back(block);
+    if (parallelism_ <= 1) {
+      // Decompressed on demand in AdvanceBlock().
+      continue;
+    }
+    {
+      mutex_lock l(mu_);
+      ++num_outstanding_;
+    }
+    runner_([this, block]() {
+      tstring data;
+      Status s = DecodeBlock(block->index, &data);
+      mutex_lock l(mu_);
+      block->status = s;
+      block->data = std::move(data);
+      block->done = true;
+      --num_outstanding_;
+      cond_var_.notify_all();
+    });
+  }
+}
+
+Status BlockRecordReader::AdvanceBlock() {
+  current_.reset();
+  current_pos_ = 0;
+  if (next_block_ >= blocks_.size()) {
+    return errors::OutOfRange("EOF reached");
+  }
+  ScheduleBlocks();
+  std::shared_ptr<Block> block = std::move(pending_.front());
+  pending_.pop_front();
+  ++next_block_;
+  if (parallelism_ <= 1) {
+    block->status = DecodeBlock(block->index, &block->data);
+  } else {
+    mutex_lock l(mu_);
+    while (!block->done) {
+      cond_var_.wait(l);
+    }
+  }
+  // Keep the pipeline full while the consumer works through this block.
+  ScheduleBlocks();
+  if (!block->status.ok()) {
+    // Move past the failed block so that callers which ignore errors make
+    // progress.
+    next_record_ = first_record_[next_block_];
+    return block->status;
+  }
+  current_ = std::move(block);
+  return Status::OK();
+}
+
+Status BlockRecordReader::ParseRecord(StringPiece* record) {
+  const tstring& data = current_->data;
+  const size_t available = data.size() - current_pos_;
+  if (available < RecordReader::kHeaderSize) {
+    return errors::DataLoss("Truncated record header in record block ",
+                            current_->index);
+  }
+  const char* header = data.data() + current_pos_;
+  const uint64 length = core::DecodeFixed64(header);
+  if (crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64))) !=
+      crc32c::Value(header, sizeof(uint64))) {
+    return errors::DataLoss("Corrupted record header in record block ",
+                            current_->index);
+  }
+  if (available - RecordReader::kHeaderSize < RecordReader::kFooterSize ||
+      length >
+          available - RecordReader::kHeaderSize - RecordReader::kFooterSize) {
+    return errors::DataLoss("Truncated record in record block ",
+                            current_->index);
+  }
+  const char* payload = header + RecordReader::kHeaderSize;
+  if (crc32c::Unmask(core::DecodeFixed32(payload + length)) !=
+      crc32c::Value(payload, length)) {
+    return errors::DataLoss("Corrupted record in record block ",
+                            current_->index);
+  }
+  *record = StringPiece(payload, length);
+  current_pos_ +=
+      RecordReader::kHeaderSize + length + RecordReader::kFooterSize;
+  return Status::OK();
+}
+
+Status BlockRecordReader::ReadRecord(tstring* record) {
+  while (current_ == nullptr || current_pos_ >= current_->data.size()) {
+    TF_RETURN_IF_ERROR(AdvanceBlock());
+  }
+  StringPiece data;
+  TF_RETURN_IF_ERROR(ParseRecord(&data));
+  record->assign(data.data(), data.size());
+  ++next_record_;
+  return Status::OK();
+}
+
+Status BlockRecordReader::SkipRecords(int num_to_skip, int* num_skipped) {
+  const uint64 start = next_record_;
+  const uint64 target = std::min<uint64>(start + num_to_skip, num_records());
+  Status s = SeekOffset(target);
+  *num_skipped = next_record_ - start;
+  TF_RETURN_IF_ERROR(s);
+  if (*num_skipped < num_to_skip) {
+    return errors::OutOfRange("EOF reached");
+  }
+  return Status::OK();
+}
+
+Status BlockRecordReader::SeekOffset(uint64 offset) {
+  if (offset > num_records()) {
+    return errors::OutOfRange("Trying to seek to record ", offset,
+                              " of a file with ", num_records(), " records");
+  }
+  // The block holding record `offset`, or blocks_.size() at the end of file.
+  const int64 target_block =
+      std::upper_bound(first_record_.begin(), first_record_.end(), offset) -
+      first_record_.begin() - 1;
+  const bool in_current_block = current_ != nullptr &&
+                                current_->index == target_block &&
+                                offset >= next_record_;
+  if (!in_current_block) {
+    const int64 to_drop = target_block - next_block_;
+    if (to_drop >= 0 && to_drop < pending_.size()) {
+      pending_.erase(pending_.begin(), pending_.begin() + to_drop);
+    } else {
+      // Blocks still in flight are kept alive by their decoding closures.
+      pending_.clear();
+    }
+    next_block_ = target_block;
+    next_record_ = first_record_[target_block];
+    current_.reset();
+    current_pos_ = 0;
+    if (target_block < blocks_.size()) {
+      TF_RETURN_IF_ERROR(AdvanceBlock());
+    }
+  }
+  while (next_record_ < offset) {
+    StringPiece record;
+    TF_RETURN_IF_ERROR(ParseRecord(&record));
+    ++next_record_;
+  }
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
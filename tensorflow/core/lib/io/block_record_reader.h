@@ -0,0 +1,137 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_BLOCK_RECORD_READER_H_
+#define TENSORFLOW_CORE_LIB_IO_BLOCK_RECORD_READER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/record_block.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class RandomAccessFile;
+
+namespace io {
+
+// Reads records from a block-compressed TFRecord file (see record_block.h).
+//
+// Blocks are read and decompressed ahead of the consumer on `runner`,
+// with at most `parallelism` blocks in flight, and records are returned in
+// file order. This lets a single large file use more than one core for
+// decompression.
+//
+// Offsets used by TellOffset() and SeekOffset() are record ordinals rather
+// than byte offsets, so a saved offset can be restored without decompressing
+// the blocks before it.
+//
+// A BlockRecordReader is NOT safe for concurrent use by multiple threads.
+class BlockRecordReader {
+ public:
+  // Creates a reader for `file`, which is `file_size` bytes long. `*file` must
+  // remain live while this reader is in use, and functions passed to `runner`
+  // must be allowed to run until the destructor returns. If `runner` is empty
+  // or `parallelism` <= 1, blocks are decompressed on the calling thread as
+  // they are needed.
+  BlockRecordReader(RandomAccessFile* file, uint64 file_size,
+                    const RecordReaderOptions& options,
+                    std::function<void(std::function<void()>)> runner,
+                    int parallelism);
+
+  // Waits for any in-flight block decompression to finish.
+  ~BlockRecordReader();
+
+  // Reads the block index. Must be called before any other method. Fails if
+  // the file was not written with the compression type in `options`.
+  Status Initialize();
+
+  // Reads the next record into *record. Returns OK on success, OUT_OF_RANGE
+  // at the end of the file, or something else for an error.
+  Status ReadRecord(tstring* record);
+
+  // Skips the next `num_to_skip` records. Returns OK on success, OUT_OF_RANGE
+  // if the end of the file was reached first, or something else for an
+  // error. "*num_skipped" records the number of records actually skipped.
+  // Blocks that are skipped entirely are never decompressed.
+  Status SkipRecords(int num_to_skip, int* num_skipped);
+
+  // Returns the ordinal of the next record to be read.
+  uint64 TellOffset() const { return next_record_; }
+
+  // Positions the reader so that the next record read is record number
+  // `offset`. Seeking backwards is supported.
+  Status SeekOffset(uint64 offset);
+
+  // Returns the number of records in the file. Only valid after a successful
+  // call to Initialize().
+  uint64 num_records() const { return first_record_.back(); }
+
+ private:
+  struct Block;
+
+  // Schedules decompression of upcoming blocks until `parallelism_` blocks
+  // are pending or all blocks have been scheduled.
+  void ScheduleBlocks();
+
+  // Makes the next pending block the current block, waiting for it to be
+  // decompressed.
+  Status AdvanceBlock();
+
+  // Reads and decompresses block `index` into `*data`.
+  Status DecodeBlock(int64 index, tstring* data) const;
+
+  // Parses the record at `current_pos_` of the current block and advances
+  // past it.
+  Status ParseRecord(StringPiece* record);
+
+  RandomAccessFile* const file_;
+  const uint64 file_size_;
+  const RecordReaderOptions options_;
+  const std::function<void(std::function<void()>)> runner_;
+  const int parallelism_;
+
+  std::vector<RecordBlockHandle> blocks_;
+  // `first_record_[i]` is the ordinal of the first record of block `i`; the
+  // last element is the total number of records.
+  std::vector<uint64> first_record_ = {0};
+
+  mutex mu_;
+  condition_variable cond_var_;
+  int64 num_outstanding_ TF_GUARDED_BY(mu_) = 0;
+
+  // Blocks `next_block_` through `next_block_ + pending_.size() - 1`, in
+  // order, some of which may still be decompressing.
+  std::deque<std::shared_ptr<Block>> pending_;
+  int64 next_block_ = 0;
+  std::shared_ptr<Block> current_;
+  size_t current_pos_ = 0;
+  uint64 next_record_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockRecordReader);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_BLOCK_RECORD_READER_H_
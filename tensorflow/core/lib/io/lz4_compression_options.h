@@ -0,0 +1,51 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_LZ4_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_CORE_LIB_IO_LZ4_COMPRESSION_OPTIONS_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+struct Lz4CompressionOptions {
+  // Size of the buffer used for caching the data read from source file. When
+  // compressing, input is handed to LZ4 in chunks of at most this size.
+  int64 input_buffer_size = 256 << 10;
+
+  // Size of the sink buffer where the compressed/decompressed data produced by
+  // LZ4 is cached. When compressing, the buffer is grown if needed to fit the
+  // worst-case compressed size of an input chunk.
+  int64 output_buffer_size = 256 << 10;
+
+  // From the LZ4 manual: 0 selects the fast compressor, values from 3 to 12
+  // select the high compression (LZ4_HC) compressor with increasing ratio and
+  // decreasing speed. Decompression speed does not depend on the level.
+  //
+  // This option is ignored for `Lz4InputStream`.
+  int32 compression_level = 0;
+
+  // Whether to append a checksum of the uncompressed content to each frame.
+  // TFRecords already carry per-record checksums, so this is off by default.
+  //
+  // This option is ignored for `Lz4InputStream`.
+  bool content_checksum = false;
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_LZ4_COMPRESSION_OPTIONS_H_
@@ -0,0 +1,160 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/lz4_inputstream.h"
+
+#include <lz4frame.h>
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace io {
+
+struct Lz4DecompressorDef {
+  LZ4F_dctx* context = nullptr;
+
+  ~Lz4DecompressorDef() { LZ4F_freeDecompressionContext(context); }
+};
+
+Lz4InputStream::Lz4InputStream(InputStreamInterface* input_stream,
+                               size_t input_buffer_bytes,
+                               size_t output_buffer_bytes,
+                               bool owns_input_stream)
+    : owns_input_stream_(owns_input_stream),
+      input_stream_(input_stream),
+      input_buffer_capacity_(input_buffer_bytes),
+      output_buffer_capacity_(output_buffer_bytes),
+      output_buffer_(new char[output_buffer_bytes]),
+      decompressor_(new Lz4DecompressorDef) {
+  if (input_buffer_capacity_ == 0 || output_buffer_capacity_ == 0) {
+    init_status_ = errors::InvalidArgument(
+        "input_buffer_bytes and output_buffer_bytes should be greater than 0");
+    return;
+  }
+  LZ4F_errorCode_t error = LZ4F_createDecompressionContext(
+      &decompressor_->context, LZ4F_VERSION);
+  if (LZ4F_isError(error)) {
+    init_status_ = errors::ResourceExhausted(
+        "Failed to create an LZ4 context: ", LZ4F_getErrorName(error));
+  }
+}
+
+Lz4InputStream::Lz4InputStream(InputStreamInterface* input_stream,
+                               size_t input_buffer_bytes,
+                               size_t output_buffer_bytes)
+    : Lz4InputStream(input_stream, input_buffer_bytes, output_buffer_bytes,
+                     false) {}
+
+Lz4InputStream::~Lz4InputStream() {
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status Lz4InputStream::Reset() {
+  TF_RETURN_IF_ERROR(init_status_);
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  LZ4F_resetDecompressionContext(decompressor_->context);
+  input_buffer_.clear();
+  input_pos_ = 0;
+  output_pos_ = 0;
+  output_size_ = 0;
+  in_frame_ = false;
+  bytes_read_ = 0;
+  return Status::OK();
+}
+
+Status Lz4InputStream::Decompress() {
+  output_pos_ = 0;
+  output_size_ = 0;
+  // A call to LZ4F_decompress() may consume input without producing any
+  // output, e.g. when reading a frame or block header, so loop until output is
+  // available.
+  while (output_size_ == 0) {
+    if (input_pos_ == input_buffer_.size()) {
+      input_pos_ = 0;
+      Status s = input_stream_->ReadNBytes(input_buffer_capacity_,
+                                           &input_buffer_);
+      if (!s.ok() && !errors::IsOutOfRange(s)) {
+        return s;
+      }
+      if (input_buffer_.empty()) {
+        if (in_frame_) {
+          return errors::DataLoss("Truncated LZ4 stream");
+        }
+        return errors::OutOfRange("EOF reached");
+      }
+    }
+    size_t input_size = input_buffer_.size() - input_pos_;
+    size_t output_size = output_buffer_capacity_;
+    const size_t result = LZ4F_decompress(
+        decompressor_->context, output_buffer_.get(), &output_size,
+        input_buffer_.data() + input_pos_, &input_size, /*dOptPtr=*/nullptr);
+    if (LZ4F_isError(result)) {
+      return errors::DataLoss("LZ4F_decompress() failed: ",
+                              LZ4F_getErrorName(result));
+    }
+    input_pos_ += input_size;
+    output_size_ = output_size;
+    // A return value of 0 means that a frame has been completely decoded and
+    // flushed.
+    in_frame_ = result != 0;
+  }
+  return Status::OK();
+}
+
+size_t Lz4InputStream::ReadBytesFromCache(size_t bytes_to_read,
+                                          tstring* result) {
+  const size_t can_read_bytes = std::min(bytes_to_read, NumUnreadBytes());
+  if (can_read_bytes > 0) {
+    result->append(output_buffer_.get() + output_pos_, can_read_bytes);
+    output_pos_ += can_read_bytes;
+    bytes_read_ += can_read_bytes;
+  }
+  return can_read_bytes;
+}
+
+Status Lz4InputStream::ReadNBytes(int64 bytes_to_read, tstring* result) {
+  TF_RETURN_IF_ERROR(init_status_);
+  result->clear();
+  // Read as many bytes as possible from cache.
+  bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+
+  while (bytes_to_read > 0) {
+    // At this point we can be sure that cache has been emptied.
+    DCHECK_EQ(NumUnreadBytes(), 0);
+    TF_RETURN_IF_ERROR(Decompress());
+    bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+  }
+  return Status::OK();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status Lz4InputStream::ReadNBytes(int64 bytes_to_read, absl::Cord* result) {
+  tstring buf;
+  TF_RETURN_IF_ERROR(ReadNBytes(bytes_to_read, &buf));
+  result->Clear();
+  result->Append(buf.data());
+  return Status::OK();
+}
+#endif
+
+int64 Lz4InputStream::Tell() const { return bytes_read_; }
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,123 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_LZ4_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_LZ4_INPUTSTREAM_H_
+
+#include <memory>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/lz4_compression_options.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Forward declare some members of lz4frame.h, which is only included in the
+// .cc file.
+struct Lz4DecompressorDef;
+
+// An Lz4InputStream provides support for reading from a stream compressed
+// using the LZ4 frame format (https://lz4.github.io/lz4/). Buffers the
+// contents of the file. Streams consisting of several concatenated LZ4 frames
+// are supported.
+//
+// A given instance of an Lz4InputStream is NOT safe for concurrent use by
+// multiple threads.
+class Lz4InputStream : public InputStreamInterface {
+ public:
+  // Create an Lz4InputStream for `input_stream` with a buffer of size
+  // `input_buffer_bytes` bytes for reading contents from `input_stream` and
+  // another buffer with size `output_buffer_bytes` for caching decompressed
+  // contents.
+  //
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  Lz4InputStream(InputStreamInterface* input_stream, size_t input_buffer_bytes,
+                 size_t output_buffer_bytes, bool owns_input_stream);
+
+  // Equivalent to the previous constructor with owns_input_stream=false.
+  Lz4InputStream(InputStreamInterface* input_stream, size_t input_buffer_bytes,
+                 size_t output_buffer_bytes);
+
+  ~Lz4InputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If the stream is corrupted or truncated in the middle of an
+  //               LZ4 frame.
+  // others:       If reading from stream failed.
+  Status ReadNBytes(int64 bytes_to_read, tstring* result) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status ReadNBytes(int64 bytes_to_read, absl::Cord* result) override;
+#endif
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Decompresses the next chunk of data into `output_buffer_`, reading more
+  // compressed data from `input_stream_` as needed. Returns OutOfRange if the
+  // end of `input_stream_` has been reached at a frame boundary.
+  //
+  // REQUIRES: `NumUnreadBytes() == 0`.
+  Status Decompress();
+
+  // Appends up to `bytes_to_read` bytes from the decompressed data cache to
+  // `result`. Returns the number of bytes appended.
+  size_t ReadBytesFromCache(size_t bytes_to_read, tstring* result);
+
+  // The number of decompressed bytes that have not been read yet.
+  size_t NumUnreadBytes() const { return output_size_ - output_pos_; }
+
+  const bool owns_input_stream_;
+  InputStreamInterface* input_stream_;
+  const size_t input_buffer_capacity_;
+  const size_t output_buffer_capacity_;
+  Status init_status_;
+
+  // Compressed bytes read from `input_stream_`; the bytes before
+  // `input_pos_` have been consumed by LZ4.
+  tstring input_buffer_;
+  size_t input_pos_ = 0;
+
+  // Decompressed bytes; the bytes in [`output_pos_`, `output_size_`) have
+  // not been read yet.
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_pos_ = 0;
+  size_t output_size_ = 0;
+
+  // Whether LZ4 is in the middle of decoding a frame.
+  bool in_frame_ = false;
+
+  // Number of *uncompressed* bytes that have been read from this stream.
+  int64 bytes_read_ = 0;
+
+  std::unique_ptr<Lz4DecompressorDef> decompressor_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Lz4InputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_LZ4_INPUTSTREAM_H_
@@ -0,0 +1,185 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/lz4_outputbuffer.h"
+
+#include <lz4frame.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+struct Lz4CompressorDef {
+  LZ4F_cctx* context = nullptr;
+  LZ4F_preferences_t preferences;
+
+  ~Lz4CompressorDef() { LZ4F_freeCompressionContext(context); }
+};
+
+Lz4OutputBuffer::Lz4OutputBuffer(WritableFile* file, int32 input_buffer_bytes,
+                                 int32 output_buffer_bytes,
+                                 const Lz4CompressionOptions& lz4_options)
+    : file_(file),
+      lz4_options_(lz4_options),
+      input_chunk_bytes_(input_buffer_bytes),
+      output_buffer_capacity_(output_buffer_bytes) {}
+
+Lz4OutputBuffer::~Lz4OutputBuffer() {
+  if (compressor_ != nullptr) {
+    LOG(WARNING) << "Lz4OutputBuffer::Close() not called. Possible data loss";
+  }
+}
+
+Status Lz4OutputBuffer::Init() {
+  if (input_chunk_bytes_ == 0) {
+    return errors::InvalidArgument(
+        "input_buffer_bytes should be greater than 0");
+  }
+  auto compressor = absl::make_unique<Lz4CompressorDef>();
+  LZ4F_errorCode_t error =
+      LZ4F_createCompressionContext(&compressor->context, LZ4F_VERSION);
+  if (LZ4F_isError(error)) {
+    return errors::ResourceExhausted("Failed to create an LZ4 context: ",
+                                     LZ4F_getErrorName(error));
+  }
+  memset(&compressor->preferences, 0, sizeof(compressor->preferences));
+  compressor->preferences.compressionLevel = lz4_options_.compression_level;
+  compressor->preferences.frameInfo.blockMode = LZ4F_blockLinked;
+  compressor->preferences.frameInfo.contentChecksumFlag =
+      lz4_options_.content_checksum ? LZ4F_contentChecksumEnabled
+                                    : LZ4F_noContentChecksum;
+
+  // LZ4F_compressUpdate() requires room for the worst-case compressed size of
+  // its input, so grow the output buffer to fit at least one chunk.
+  output_buffer_capacity_ = std::max<size_t>(
+      output_buffer_capacity_,
+      LZ4F_compressBound(input_chunk_bytes_, &compressor->preferences));
+  output_buffer_.reset(new char[output_buffer_capacity_]);
+
+  const size_t header_size = LZ4F_compressBegin(
+      compressor->context, output_buffer_.get(), output_buffer_capacity_,
+      &compressor->preferences);
+  if (LZ4F_isError(header_size)) {
+    return errors::InvalidArgument("LZ4F_compressBegin() failed: ",
+                                   LZ4F_getErrorName(header_size));
+  }
+  output_buffer_size_ = header_size;
+  compressor_ = std::move(compressor);
+  return Status::OK();
+}
+
+Status Lz4OutputBuffer::EnsureOutputSpace(size_t bytes) {
+  if (output_buffer_capacity_ - output_buffer_size_ < bytes) {
+    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  }
+  return Status::OK();
+}
+
+Status Lz4OutputBuffer::FlushOutputBufferToFile() {
+  if (output_buffer_size_ > 0) {
+    TF_RETURN_IF_ERROR(file_->Append(
+        StringPiece(output_buffer_.get(), output_buffer_size_)));
+    output_buffer_size_ = 0;
+  }
+  return Status::OK();
+}
+
+Status Lz4OutputBuffer::Append(StringPiece data) {
+  if (compressor_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Lz4OutputBuffer is not initialized or has been closed");
+  }
+  while (!data.empty()) {
+    const size_t chunk_size = std::min(data.size(), input_chunk_bytes_);
+    TF_RETURN_IF_ERROR(EnsureOutputSpace(
+        LZ4F_compressBound(chunk_size, &compressor_->preferences)));
+    const size_t written = LZ4F_compressUpdate(
+        compressor_->context, output_buffer_.get() + output_buffer_size_,
+        output_buffer_capacity_ - output_buffer_size_, data.data(), chunk_size,
+        /*cOptPtr=*/nullptr);
+    if (LZ4F_isError(written)) {
+      return errors::DataLoss("LZ4F_compressUpdate() failed: ",
+                              LZ4F_getErrorName(written));
+    }
+    output_buffer_size_ += written;
+    data.remove_prefix(chunk_size);
+  }
+  return Status::OK();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status Lz4OutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return Status::OK();
+}
+#endif
+
+Status Lz4OutputBuffer::Flush() {
+  if (compressor_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Lz4OutputBuffer is not initialized or has been closed");
+  }
+  TF_RETURN_IF_ERROR(
+      EnsureOutputSpace(LZ4F_compressBound(0, &compressor_->preferences)));
+  const size_t written = LZ4F_flush(
+      compressor_->context, output_buffer_.get() + output_buffer_size_,
+      output_buffer_capacity_ - output_buffer_size_, /*cOptPtr=*/nullptr);
+  if (LZ4F_isError(written)) {
+    return errors::DataLoss("LZ4F_flush() failed: ",
+                            LZ4F_getErrorName(written));
+  }
+  output_buffer_size_ += written;
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  return file_->Flush();
+}
+
+Status Lz4OutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status Lz4OutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status Lz4OutputBuffer::Close() {
+  if (compressor_ != nullptr) {
+    TF_RETURN_IF_ERROR(
+        EnsureOutputSpace(LZ4F_compressBound(0, &compressor_->preferences)));
+    const size_t written = LZ4F_compressEnd(
+        compressor_->context, output_buffer_.get() + output_buffer_size_,
+        output_buffer_capacity_ - output_buffer_size_, /*cOptPtr=*/nullptr);
+    if (LZ4F_isError(written)) {
+      return errors::DataLoss("LZ4F_compressEnd() failed: ",
+                              LZ4F_getErrorName(written));
+    }
+    output_buffer_size_ += written;
+    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    compressor_.reset();
+  }
+  return Status::OK();
+}
+
+Status Lz4OutputBuffer::Tell(int64* position) { return file_->Tell(position); }
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,117 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_LZ4_OUTPUTBUFFER_H_
+#define TENSORFLOW_CORE_LIB_IO_LZ4_OUTPUTBUFFER_H_
+
+#include <memory>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/lz4_compression_options.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Forward declare some members of lz4frame.h, which is only included in the
+// .cc file.
+struct Lz4CompressorDef;
+
+// Compresses input data using the LZ4 frame format (https://lz4.github.io/lz4/)
+// and writes to `file`.
+//
+// Input data is handed to the LZ4 frame compressor in chunks of at most
+// `input_buffer_bytes` bytes; the compressor buffers partial blocks
+// internally. The compressed output is buffered in a buffer of at least
+// `output_buffer_bytes` bytes which gets flushed to file when it cannot fit
+// the compressed output of another chunk.
+//
+// The output is a standard LZ4 frame that can be decompressed with
+// `Lz4InputStream` or the `lz4` command line tool.
+class Lz4OutputBuffer : public WritableFile {
+ public:
+  // Create an Lz4OutputBuffer for `file`. Does not take ownership of `file`.
+  Lz4OutputBuffer(WritableFile* file, int32 input_buffer_bytes,
+                  int32 output_buffer_bytes,
+                  const Lz4CompressionOptions& lz4_options);
+
+  // Per convention, the dtor does not call Flush() or Close(). We expect the
+  // caller to call those manually when done.
+  ~Lz4OutputBuffer() override;
+
+  // Initializes the compression context and writes the frame header to the
+  // output buffer. Must be called before any other method.
+  Status Init();
+
+  // Adds `data` to the compression pipeline.
+  //
+  // The input data is buffered internally and will be written to disk at a
+  // later time. To immediately write contents to file call `Flush()`.
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any buffered input and writes all output to file. The LZ4
+  // frame is not ended, so further data can be appended.
+  Status Flush() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Compresses any buffered input, writes all output to file and syncs it.
+  Status Sync() override;
+
+  // Ends the LZ4 frame and writes all output to file. This must be called
+  // before the destructor to avoid any data loss. Does *not* close `file`.
+  //
+  // After calling this, any further calls to `Append()`, `Flush()` or `Close()`
+  // will fail.
+  Status Close() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64* position) override;
+
+ private:
+  // Writes the output buffer to file unless it can fit `bytes` more bytes.
+  Status EnsureOutputSpace(size_t bytes);
+
+  // Appends the contents of `output_buffer_` to `file_`.
+  Status FlushOutputBufferToFile();
+
+  WritableFile* file_;  // Not owned
+
+  const Lz4CompressionOptions lz4_options_;
+  const size_t input_chunk_bytes_;
+
+  // Buffer for storing compressed contents before they are written to file.
+  size_t output_buffer_capacity_;
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_buffer_size_ = 0;
+
+  std::unique_ptr<Lz4CompressorDef> compressor_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Lz4OutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_LZ4_OUTPUTBUFFER_H_
@@ -0,0 +1,265 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_block.h"
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#include <memory>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// Mirrors the values of RecordWriterOptions::CompressionType and
+// RecordReaderOptions::CompressionType.
+constexpr int kZlibCompression = 1;
+constexpr int kSnappyCompression = 2;
+constexpr int kZstdCompression = 3;
+constexpr int kLz4Compression = 4;
+
+Status UnsupportedCompression(int compression_type) {
+  return errors::InvalidArgument(
+      "Unsupported compression type for block-compressed records: ",
+      compression_type);
+}
+
+}  // namespace
+
+Status CompressRecordBlock(int compression_type, int compression_level,
+                           StringPiece input, string* output) {
+  switch (compression_type) {
+    case kZlibCompression: {
+      uLongf output_size = compressBound(input.size());
+      output->resize(output_size);
+      int result = compress2(reinterpret_cast<Bytef*>(&(*output)[0]),
+                             &output_size,
+                             reinterpret_cast<const Bytef*>(input.data()),
+                             input.size(), compression_level);
+      if (result != Z_OK) {
+        return errors::Internal("Failed to compress record block with zlib: ",
+                                result);
+      }
+      output->resize(output_size);
+      return Status::OK();
+    }
+    case kSnappyCompression:
+      if (!port::Snappy_Compress(input.data(), input.size(), output)) {
+        return errors::Internal(
+            "Failed to compress record block with snappy.");
+      }
+      return Status::OK();
+    case kZstdCompression: {
+      output->resize(ZSTD_compressBound(input.size()));
+      size_t result = ZSTD_compress(&(*output)[0], output->size(),
+                                    input.data(), input.size(),
+                                    compression_level);
+      if (ZSTD_isError(result)) {
+        return errors::Internal("Failed to compress record block with zstd: ",
+                                ZSTD_getErrorName(result));
+      }
+      output->resize(result);
+      return Status::OK();
+    }
+    case kLz4Compression: {
+      if (input.size() > LZ4_MAX_INPUT_SIZE) {
+        return errors::InvalidArgument("Record block of ", input.size(),
+                                       " bytes is too large for LZ4.");
+      }
+      output->resize(LZ4_compressBound(input.size()));
+      int result =
+          compression_level > 0
+              ? LZ4_compress_HC(input.data(), &(*output)[0], input.size(),
+                                output->size(), compression_level)
+              : LZ4_compress_default(input.data(), &(*output)[0],
+                                     input.size(), output->size());
+      if (result <= 0 && !input.empty()) {
+        return errors::Internal("Failed to compress record block with LZ4.");
+      }
+      output->resize(result);
+      return Status::OK();
+    }
+    default:
+      return UnsupportedCompression(compression_type);
+  }
+}
+
+Status UncompressRecordBlock(int compression_type, StringPiece input,
+                             uint64 uncompressed_size, tstring* output) {
+  output->resize_uninitialized(uncompressed_size);
+  bool ok = false;
+  switch (compression_type) {
+    case kZlibCompression: {
+      uLongf output_size = uncompressed_size;
+      ok = uncompress(reinterpret_cast<Bytef*>(output->mdata()), &output_size,
+                      reinterpret_cast<const Bytef*>(input.data()),
+                      input.size()) == Z_OK &&
+           output_size == uncompressed_size;
+      break;
+    }
+    case kSnappyCompression: {
+      size_t output_size;
+      ok = port::Snappy_GetUncompressedLength(input.data(), input.size(),
+                                              &output_size) &&
+           output_size == uncompressed_size &&
+           port::Snappy_Uncompress(input.data(), input.size(),
+                                   output->mdata());
+      break;
+    }
+    case kZstdCompression: {
+      size_t result = ZSTD_decompress(output->mdata(), uncompressed_size,
+                                      input.data(), input.size());
+      ok = !ZSTD_isError(result) && result == uncompressed_size;
+      break;
+    }
+    case kLz4Compression: {
+      if (uncompressed_size > LZ4_MAX_INPUT_SIZE ||
+          input.size() > LZ4_MAX_INPUT_SIZE) {
+        break;
+      }
+      int result = LZ4_decompress_safe(input.data(), output->mdata(),
+                                       input.size(), uncompressed_size);
+      ok = result >= 0 && static_cast<uint64>(result) == uncompressed_size;
+      break;
+    }
+    default:
+      return UnsupportedCompression(compression_type);
+  }
+  if (!ok) {
+    return errors::DataLoss("Corrupted record block: expected ",
+                            uncompressed_size, " bytes from ", input.size(),
+                            " compressed bytes.");
+  }
+  return Status::OK();
+}
+
+void EncodeRecordBlockIndex(const std::vector<RecordBlockHandle>& blocks,
+                            int compression_type, uint64 index_offset,
+                            string* output) {
+  const size_t index_start = output->size();
+  for (const RecordBlockHandle& block : blocks) {
+    core::PutFixed64(output, block.offset);
+    core::PutFixed64(output, block.compressed_size);
+    core::PutFixed64(output, block.uncompressed_size);
+    core::PutFixed64(output, block.num_records);
+  }
+  const uint32 index_crc = crc32c::Mask(crc32c::Value(
+      output->data() + index_start, output->size() - index_start));
+  core::PutFixed64(output, index_offset);
+  core::PutFixed64(output, blocks.size());
+  core::PutFixed32(output, compression_type);
+  core::PutFixed32(output, index_crc);
+  core::PutFixed64(output, kRecordBlockMagic);
+}
+
+namespace {
+
+Status ReadFooter(RandomAccessFile* file, uint64 file_size, char* scratch,
+                  StringPiece* footer) {
+  if (file_size < kRecordBlockFooterSize) {
+    return errors::DataLoss("File is too small to hold a record block footer");
+  }
+  TF_RETURN_IF_ERROR(file->Read(file_size - kRecordBlockFooterSize,
+                                kRecordBlockFooterSize, footer, scratch));
+  if (footer->size() != kRecordBlockFooterSize ||
+      core::DecodeFixed64(footer->data() + kRecordBlockFooterSize -
+                          sizeof(uint64)) != kRecordBlockMagic) {
+    return errors::DataLoss("Missing record block footer");
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+bool ConsumeRecordBlockCompressionSuffix(string* compression_type) {
+  const size_t suffix_size = sizeof(kRecordBlockCompressionSuffix) - 1;
+  if (compression_type->size() < suffix_size ||
+      compression_type->compare(compression_type->size() - suffix_size,
+                                suffix_size,
+                                kRecordBlockCompressionSuffix) != 0) {
+    return false;
+  }
+  compression_type->resize(compression_type->size() - suffix_size);
+  return true;
+}
+
+bool IsRecordBlockFile(RandomAccessFile* file, uint64 file_size) {
+  char scratch[kRecordBlockFooterSize];
+  StringPiece footer;
+  return ReadFooter(file, file_size, scratch, &footer).ok();
+}
+
+Status ReadRecordBlockIndex(RandomAccessFile* file, uint64 file_size,
+                            int* compression_type,
+                            std::vector<RecordBlockHandle>* blocks) {
+  char footer_scratch[kRecordBlockFooterSize];
+  StringPiece footer;
+  TF_RETURN_IF_ERROR(ReadFooter(file, file_size, footer_scratch, &footer));
+  const char* p = footer.data();
+  const uint64 index_offset = core::DecodeFixed64(p);
+  const uint64 num_blocks = core::DecodeFixed64(p + sizeof(uint64));
+  *compression_type = core::DecodeFixed32(p + 2 * sizeof(uint64));
+  const uint32 index_crc =
+      core::DecodeFixed32(p + 2 * sizeof(uint64) + sizeof(uint32));
+
+  const uint64 index_end = file_size - kRecordBlockFooterSize;
+  if (index_offset > index_end ||
+      (index_end - index_offset) / kRecordBlockIndexEntrySize != num_blocks ||
+      (index_end - index_offset) % kRecordBlockIndexEntrySize != 0) {
+    return errors::DataLoss("Corrupted record block footer: index at ",
+                            index_offset, " with ", num_blocks,
+                            " blocks does not fit a file of ", file_size,
+                            " bytes");
+  }
+  const size_t index_size = index_end - index_offset;
+  std::unique_ptr<char[]> index_scratch(new char[index_size]);
+  StringPiece index;
+  TF_RETURN_IF_ERROR(
+      file->Read(index_offset, index_size, &index, index_scratch.get()));
+  if (index.size() != index_size ||
+      crc32c::Unmask(index_crc) != crc32c::Value(index.data(), index_size)) {
+    return errors::DataLoss("Corrupted record block index");
+  }
+
+  blocks->clear();
+  blocks->reserve(num_blocks);
+  for (uint64 i = 0; i < num_blocks; ++i) {
+    const char* entry = index.data() + i * kRecordBlockIndexEntrySize;
+    RecordBlockHandle block;
+    block.offset = core::DecodeFixed64(entry);
+    block.compressed_size = core::DecodeFixed64(entry + sizeof(uint64));
+    block.uncompressed_size = core::DecodeFixed64(entry + 2 * sizeof(uint64));
+    block.num_records = core::DecodeFixed64(entry + 3 * sizeof(uint64));
+    if (block.offset > index_offset ||
+        block.compressed_size > index_offset - block.offset) {
+      return errors::DataLoss("Record block ", i, " at offset ", block.offset,
+                              " overlaps the block index");
+    }
+    blocks->push_back(block);
+  }
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
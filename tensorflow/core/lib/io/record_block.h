@@ -0,0 +1,108 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_RECORD_BLOCK_H_
+#define TENSORFLOW_CORE_LIB_IO_RECORD_BLOCK_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class RandomAccessFile;
+
+namespace io {
+
+// A block-compressed TFRecord file groups records into blocks that are
+// compressed independently of each other, so that a reader can decompress
+// several blocks of the same file concurrently. The uncompressed content of a
+// block is a sequence of records in the regular TFRecord framing (see
+// RecordWriter). The file layout is:
+//
+//   block[0] ... block[num_blocks - 1]
+//   index entry[0] ... index entry[num_blocks - 1]
+//   footer
+//
+// Index entry (kRecordBlockIndexEntrySize bytes):
+//   uint64    offset of the compressed block in the file
+//   uint64    compressed size of the block
+//   uint64    uncompressed size of the block
+//   uint64    number of records in the block
+//
+// Footer (kRecordBlockFooterSize bytes):
+//   uint64    offset of the index in the file
+//   uint64    number of blocks
+//   uint32    compression type (a RecordWriterOptions::CompressionType)
+//   uint32    masked crc of the index
+//   uint64    kRecordBlockMagic
+struct RecordBlockHandle {
+  uint64 offset = 0;
+  uint64 compressed_size = 0;
+  uint64 uncompressed_size = 0;
+  uint64 num_records = 0;
+};
+
+// "TFRECBLK" in little-endian byte order.
+constexpr uint64 kRecordBlockMagic = 0x4b4c424345524654ull;
+constexpr size_t kRecordBlockIndexEntrySize = 4 * sizeof(uint64);
+constexpr size_t kRecordBlockFooterSize =
+    3 * sizeof(uint64) + 2 * sizeof(uint32);
+
+// Compresses the framed records in `input` into `*output` as one
+// independently decodable block. `compression_type` is a
+// RecordWriterOptions::CompressionType other than NONE; `compression_level`
+// is interpreted by the codec and ignored for Snappy.
+Status CompressRecordBlock(int compression_type, int compression_level,
+                           StringPiece input, string* output);
+
+// Decompresses a block produced by CompressRecordBlock into `*output`, which
+// is resized to `uncompressed_size`. Returns DATA_LOSS if the block is corrupt
+// or does not decompress to exactly `uncompressed_size` bytes.
+Status UncompressRecordBlock(int compression_type, StringPiece input,
+                             uint64 uncompressed_size, tstring* output);
+
+// Appends the encoded index and footer for `blocks` to `*output`.
+// `index_offset` is the file offset at which the index will start.
+void EncodeRecordBlockIndex(const std::vector<RecordBlockHandle>& blocks,
+                            int compression_type, uint64 index_offset,
+                            string* output);
+
+// Suffix appended to a compression type (e.g. "ZLIB_BLOCK") to tell readers
+// that files may be block-compressed. Readers only look for the block footer
+// when it is present, so regular compressed files pay no extra I/O on open.
+constexpr char kRecordBlockCompressionSuffix[] = "_BLOCK";
+
+// If `*compression_type` ends in kRecordBlockCompressionSuffix, strips the
+// suffix and returns true. Otherwise leaves it unchanged and returns false.
+bool ConsumeRecordBlockCompressionSuffix(string* compression_type);
+
+// Returns true if the last bytes of `file` (of size `file_size`) are a
+// block-compressed TFRecord footer.
+bool IsRecordBlockFile(RandomAccessFile* file, uint64 file_size);
+
+// Reads and validates the block index of `file`, whose size is `file_size`.
+// Stores the codec recorded in the footer in `*compression_type`.
+Status ReadRecordBlockIndex(RandomAccessFile* file, uint64 file_size,
+                            int* compression_type,
+                            std::vector<RecordBlockHandle>* blocks);
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_RECORD_BLOCK_H_
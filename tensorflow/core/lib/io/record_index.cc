@@ -0,0 +1,250 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+constexpr char kRecordIndexSuffix[] = ".index";
+constexpr size_t kBuildBufferSize = 256 << 10;  // 256KB
+
+// The smallest number of bytes a record can occupy in a TFRecord file.
+constexpr uint64 kMinRecordSize =
+    RecordReader::kHeaderSize + RecordReader::kFooterSize;
+
+}  // namespace
+
+std::string RecordIndexFilename(StringPiece filename) {
+  return strings::StrCat(filename, kRecordIndexSuffix);
+}
+
+void EncodeRecordIndex(const std::vector<uint64>& offsets, string* output) {
+  DCHECK(!offsets.empty());
+  const size_t index_start = output->size();
+  for (uint64 offset : offsets) {
+    core::PutFixed64(output, offset);
+  }
+  const uint32 index_crc = crc32c::Mask(crc32c::Value(
+      output->data() + index_start, output->size() - index_start));
+  core::PutFixed64(output, offsets.size() - 1);
+  core::PutFixed32(output, index_crc);
+  core::PutFixed32(output, 0);
+  core::PutFixed64(output, kRecordIndexMagic);
+}
+
+Status DecodeRecordIndex(StringPiece input, std::vector<uint64>* offsets) {
+  if (input.size() < kRecordIndexFooterSize ||
+      core::DecodeFixed64(input.data() + input.size() - sizeof(uint64)) !=
+          kRecordIndexMagic) {
+    return errors::DataLoss("Missing record index footer");
+  }
+  const char* footer = input.data() + input.size() - kRecordIndexFooterSize;
+  const uint64 num_records = core::DecodeFixed64(footer);
+  const uint32 index_crc = core::DecodeFixed32(footer + sizeof(uint64));
+  const uint32 reserved =
+      core::DecodeFixed32(footer + sizeof(uint64) + sizeof(uint32));
+  const uint64 index_size = input.size() - kRecordIndexFooterSize;
+  if (reserved != 0 || index_size % sizeof(uint64) != 0 ||
+      index_size / sizeof(uint64) != num_records + 1) {
+    return errors::DataLoss("Corrupted record index footer");
+  }
+  if (crc32c::Unmask(index_crc) != crc32c::Value(input.data(), index_size)) {
+    return errors::DataLoss("Corrupted record index");
+  }
+  offsets->clear();
+  offsets->reserve(num_records + 1);
+  for (uint64 i = 0; i <= num_records; ++i) {
+    const uint64 offset =
+        core::DecodeFixed64(input.data() + i * sizeof(uint64));
+    if (!offsets->empty() && offset < offsets->back() + kMinRecordSize) {
+      return errors::DataLoss("Record index offsets are not increasing at ",
+                              "record ", i);
+    }
+    offsets->push_back(offset);
+  }
+  return Status::OK();
+}
+
+Status WriteRecordIndex(Env* env, const std::string& filename,
+                        const std::vector<uint64>& offsets) {
+  string contents;
+  EncodeRecordIndex(offsets, &contents);
+  // Write to a temporary file first so that readers never observe a
+  // partially written index.
+  const std::string index_filename = RecordIndexFilename(filename);
+  const std::string tmp_filename = strings::StrCat(index_filename, ".tmp");
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename, contents));
+  return env->RenameFile(tmp_filename, index_filename);
+}
+
+Status ReadRecordIndex(Env* env, const std::string& filename,
+                       std::vector<uint64>* offsets) {
+  const std::string index_filename = RecordIndexFilename(filename);
+  TF_RETURN_IF_ERROR(env->FileExists(index_filename));
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_filename, &contents));
+  Status s = DecodeRecordIndex(contents, offsets);
+  if (!s.ok()) {
+    errors::AppendToMessage(&s, "While reading ", index_filename);
+    return s;
+  }
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  if (offsets->back() != file_size) {
+    return errors::FailedPrecondition(
+        "Record index ", index_filename, " describes ", offsets->back(),
+        " bytes but ", filename, " has ", file_size,
+        " bytes. Rebuild the index.");
+  }
+  return Status::OK();
+}
+
+Status ReadRecordIndexSize(Env* env, const std::string& filename,
+                           uint64* num_records) {
+  const std::string index_filename = RecordIndexFilename(filename);
+  TF_RETURN_IF_ERROR(env->FileExists(index_filename));
+  uint64 index_file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(index_filename, &index_file_size));
+  // The last offset, which is the size of the data file, and the footer.
+  constexpr size_t kTailSize = sizeof(uint64) + kRecordIndexFooterSize;
+  if (index_file_size < kTailSize) {
+    return errors::DataLoss("Missing record index footer while reading ",
+                            index_filename);
+  }
+  std::unique_ptr<RandomAccessFile> index_file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(index_filename, &index_file));
+  char scratch[kTailSize];
+  StringPiece tail;
+  TF_RETURN_IF_ERROR(
+      index_file->Read(index_file_size - kTailSize, kTailSize, &tail, scratch));
+  if (tail.size() != kTailSize ||
+      core::DecodeFixed64(tail.data() + kTailSize - sizeof(uint64)) !=
+          kRecordIndexMagic) {
+    return errors::DataLoss("Missing record index footer while reading ",
+                            index_filename);
+  }
+  const uint64 data_size = core::DecodeFixed64(tail.data());
+  const char* footer = tail.data() + sizeof(uint64);
+  *num_records = core::DecodeFixed64(footer);
+  const uint64 index_size = index_file_size - kRecordIndexFooterSize;
+  if (index_size / sizeof(uint64) != *num_records + 1 ||
+      index_size % sizeof(uint64) != 0) {
+    return errors::DataLoss("Corrupted record index footer while reading ",
+                            index_filename);
+  }
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  if (data_size != file_size) {
+    return errors::FailedPrecondition(
+        "Record index ", index_filename, " describes ", data_size,
+        " bytes but ", filename, " has ", file_size,
+        " bytes. Rebuild the index.");
+  }
+  return Status::OK();
+}
+
+Status BuildRecordIndex(Env* env, const std::string& filename,
+                        std::vector<uint64>* offsets) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  RecordReaderOptions options;
+  options.buffer_size = kBuildBufferSize;
+  RecordReader reader(file.get(), options);
+
+  offsets->clear();
+  uint64 offset = 0;
+  while (offset < file_size) {
+    offsets->push_back(offset);
+    int num_skipped;
+    TF_RETURN_IF_ERROR(reader.SkipRecords(&offset, 1, &num_skipped));
+  }
+  if (offset != file_size) {
+    return errors::DataLoss("truncated record at ", offsets->back(), " in ",
+                            filename);
+  }
+  offsets->push_back(file_size);
+  return Status::OK();
+}
+
+IndexedRecordReader::IndexedRecordReader(RandomAccessFile* file,
+                                         const std::vector<uint64>* offsets,
+                                         size_t buffer_size)
+    : file_(file), offsets_(offsets), buffer_size_(buffer_size) {}
+
+Status IndexedRecordReader::ReadRecord(uint64 n, tstring* record) {
+  if (n >= num_records()) {
+    return errors::OutOfRange("Record ", n, " is out of range; the file has ",
+                              num_records(), " records");
+  }
+  const uint64 offset = (*offsets_)[n];
+  const uint64 end = (*offsets_)[n + 1];
+  const size_t size = end - offset;
+  if (offset < buffer_offset_ || end > buffer_offset_ + buffer_.size()) {
+    // Read the whole record, and as much of what follows it as fits in the
+    // buffer.
+    const size_t read_size = std::max<uint64>(
+        size, std::min<uint64>(buffer_size_, offsets_->back() - offset));
+    buffer_.resize(read_size);
+    StringPiece result;
+    Status s = file_->Read(offset, read_size, &result, &buffer_[0]);
+    if (!s.ok() && !errors::IsOutOfRange(s)) {
+      buffer_.clear();
+      return s;
+    }
+    if (result.size() < size) {
+      buffer_.clear();
+      return errors::DataLoss("truncated record at ", offset);
+    }
+    if (result.data() != buffer_.data()) {
+      buffer_.assign(result.data(), result.size());
+    } else {
+      buffer_.resize(result.size());
+    }
+    buffer_offset_ = offset;
+  }
+
+  const char* data = buffer_.data() + (offset - buffer_offset_);
+  const uint64 length = core::DecodeFixed64(data);
+  if (crc32c::Unmask(core::DecodeFixed32(data + sizeof(uint64))) !=
+          crc32c::Value(data, sizeof(uint64)) ||
+      length != size - kMinRecordSize) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  data += RecordReader::kHeaderSize;
+  if (crc32c::Unmask(core::DecodeFixed32(data + length)) !=
+      crc32c::Value(data, length)) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  record->assign(data, length);
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
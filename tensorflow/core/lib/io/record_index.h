@@ -0,0 +1,126 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Env;
+class RandomAccessFile;
+
+namespace io {
+
+// A record index maps the ordinals of the records in an uncompressed TFRecord
+// file to their byte offsets, so that record N can be read without scanning
+// the N records before it. The index of file `foo` is stored next to it in
+// `foo.index` (see RecordIndexFilename()), with the layout:
+//
+//   offset[0] ... offset[num_records]
+//   footer
+//
+// where each offset is a uint64 and offset[num_records] is the size of the
+// data file, which is used to detect an index that is out of date.
+//
+// Footer (kRecordIndexFooterSize bytes):
+//   uint64    number of records
+//   uint32    masked crc of the offsets
+//   uint32    reserved, must be 0
+//   uint64    kRecordIndexMagic
+
+// "TFRECIDX" in little-endian byte order.
+constexpr uint64 kRecordIndexMagic = 0x5844494345524654ull;
+constexpr size_t kRecordIndexFooterSize =
+    2 * sizeof(uint64) + 2 * sizeof(uint32);
+
+// Returns the name of the sidecar index file for `filename`.
+std::string RecordIndexFilename(StringPiece filename);
+
+// Appends the encoded index for `offsets` to `*output`. `offsets` holds the
+// offset of every record followed by the size of the data file.
+void EncodeRecordIndex(const std::vector<uint64>& offsets, string* output);
+
+// Decodes an index produced by EncodeRecordIndex. Returns DATA_LOSS if
+// `input` is not a valid index.
+Status DecodeRecordIndex(StringPiece input, std::vector<uint64>* offsets);
+
+// Writes `offsets` to the sidecar index file of `filename`, replacing any
+// existing index.
+Status WriteRecordIndex(Env* env, const std::string& filename,
+                        const std::vector<uint64>& offsets);
+
+// Reads the sidecar index of `filename`. Returns NOT_FOUND if there is no
+// index, and FAILED_PRECONDITION if the index does not describe the current
+// contents of `filename` (for example because records were appended after
+// the index was written).
+Status ReadRecordIndex(Env* env, const std::string& filename,
+                       std::vector<uint64>* offsets);
+
+// Reads only the number of records from the sidecar index of `filename`,
+// without loading its offsets. Fails like ReadRecordIndex if there is no index
+// or it is out of date; the offsets themselves are only validated by
+// ReadRecordIndex.
+Status ReadRecordIndexSize(Env* env, const std::string& filename,
+                           uint64* num_records);
+
+// Computes the index of the uncompressed TFRecord file `filename` by scanning
+// its record headers.
+Status BuildRecordIndex(Env* env, const std::string& filename,
+                        std::vector<uint64>* offsets);
+
+// Reads records from an uncompressed TFRecord file by ordinal, using the
+// offsets of its record index. A record is fetched with a single read of the
+// file; when `buffer_size` is positive, up to `buffer_size` bytes are read at
+// a time so that nearby records are served from memory.
+//
+// An IndexedRecordReader is NOT safe for concurrent use by multiple threads.
+class IndexedRecordReader {
+ public:
+  // `*file` and `*offsets` must remain live while this reader is in use.
+  IndexedRecordReader(RandomAccessFile* file,
+                      const std::vector<uint64>* offsets, size_t buffer_size);
+
+  // Returns the number of records in the file.
+  uint64 num_records() const { return offsets_->size() - 1; }
+
+  // Reads record number `n` into *record. Returns OUT_OF_RANGE if `n` is not
+  // less than num_records(), and DATA_LOSS if the record is corrupt.
+  Status ReadRecord(uint64 n, tstring* record);
+
+ private:
+  RandomAccessFile* const file_;
+  const std::vector<uint64>* const offsets_;
+  const size_t buffer_size_;
+
+  // Bytes of the file starting at `buffer_offset_`.
+  string buffer_;
+  uint64 buffer_offset_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IndexedRecordReader);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
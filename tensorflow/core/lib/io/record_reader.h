@@ -22,8 +22,12 @@ limitations under the License.
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_inputstream.h"
+#include "tensorflow/core/lib/io/lz4_compression_options.h"
+#include "tensorflow/core/lib/io/lz4_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/lib/io/zstd_compression_options.h"
+#include "tensorflow/core/lib/io/zstd_inputstream.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
@@ -38,7 +42,9 @@ struct RecordReaderOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    ZSTD_COMPRESSION = 3,
+    LZ4_COMPRESSION = 4
   };
   CompressionType compression_type = NONE;
 
@@ -54,6 +60,8 @@ struct RecordReaderOptions {
   // Options specific to compression.
   ZlibCompressionOptions zlib_options;
   SnappyCompressionOptions snappy_options;
+  ZstdCompressionOptions zstd_options;
+  Lz4CompressionOptions lz4_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -17,8 +17,13 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 
 #include <zlib.h>
+#include <functional>
 #include <vector>
+#include "tensorflow/core/lib/io/block_record_reader.h"
+#include "tensorflow/core/lib/io/record_block.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -26,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
@@ -41,6 +47,12 @@ io::RecordReaderOptions GetMatchingReaderOptions(
   if (options.compression_type == io::RecordWriterOptions::ZLIB_COMPRESSION) {
     return io::RecordReaderOptions::CreateRecordReaderOptions("ZLIB");
   }
+  if (options.compression_type == io::RecordWriterOptions::ZSTD_COMPRESSION) {
+    return io::RecordReaderOptions::CreateRecordReaderOptions("ZSTD");
+  }
+  if (options.compression_type == io::RecordWriterOptions::LZ4_COMPRESSION) {
+    return io::RecordReaderOptions::CreateRecordReaderOptions("LZ4");
+  }
   return io::RecordReaderOptions::CreateRecordReaderOptions("");
 }
 
@@ -305,6 +317,104 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestZstd) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zstd_test";
+
+  for (auto buf_size : BufferSizes()) {
+    // Keep the buffer sizes consistent with the other codecs.
+    if (buf_size == 1) continue;
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+      io::RecordWriterOptions options;
+      options.compression_type = io::RecordWriterOptions::ZSTD_COMPRESSION;
+      options.zstd_options.output_buffer_size = buf_size;
+      io::RecordWriter writer(file.get(), options);
+      TF_EXPECT_OK(writer.WriteRecord("abc"));
+      TF_EXPECT_OK(writer.WriteRecord("defg"));
+      TF_CHECK_OK(writer.Close());
+    }
+
+    {
+      std::unique_ptr<RandomAccessFile> read_file;
+      // Read it back with the RecordReader.
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options;
+      options.compression_type = io::RecordReaderOptions::ZSTD_COMPRESSION;
+      options.zstd_options.input_buffer_size = buf_size;
+      options.zstd_options.output_buffer_size = buf_size;
+      io::RecordReader reader(read_file.get(), options);
+      uint64 offset = 0;
+      tstring record;
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("abc", record);
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("defg", record);
+      EXPECT_EQ(reader.ReadRecord(&offset, &record).code(),
+                error::OUT_OF_RANGE);
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestLz4) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_lz4_test";
+
+  for (auto buf_size : BufferSizes()) {
+    // Keep the buffer sizes consistent with the other codecs.
+    if (buf_size == 1) continue;
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+      io::RecordWriterOptions options;
+      options.compression_type = io::RecordWriterOptions::LZ4_COMPRESSION;
+      options.lz4_options.input_buffer_size = buf_size;
+      options.lz4_options.output_buffer_size = buf_size;
+      io::RecordWriter writer(file.get(), options);
+      TF_EXPECT_OK(writer.WriteRecord("abc"));
+      TF_EXPECT_OK(writer.WriteRecord("defg"));
+      TF_CHECK_OK(writer.Close());
+    }
+
+    {
+      std::unique_ptr<RandomAccessFile> read_file;
+      // Read it back with the RecordReader.
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options;
+      options.compression_type = io::RecordReaderOptions::LZ4_COMPRESSION;
+      options.lz4_options.input_buffer_size = buf_size;
+      options.lz4_options.output_buffer_size = buf_size;
+      io::RecordReader reader(read_file.get(), options);
+      uint64 offset = 0;
+      tstring record;
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("abc", record);
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("defg", record);
+      EXPECT_EQ(reader.ReadRecord(&offset, &record).code(),
+                error::OUT_OF_RANGE);
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestCompressionTypeFromString) {
+  EXPECT_EQ(io::RecordReaderOptions::CreateRecordReaderOptions("ZSTD")
+                .compression_type,
+            io::RecordReaderOptions::ZSTD_COMPRESSION);
+  EXPECT_EQ(io::RecordReaderOptions::CreateRecordReaderOptions("LZ4")
+                .compression_type,
+            io::RecordReaderOptions::LZ4_COMPRESSION);
+  EXPECT_EQ(io::RecordWriterOptions::CreateRecordWriterOptions("ZSTD")
+                .compression_type,
+            io::RecordWriterOptions::ZSTD_COMPRESSION);
+  EXPECT_EQ(io::RecordWriterOptions::CreateRecordWriterOptions("LZ4")
+                .compression_type,
+            io::RecordWriterOptions::LZ4_COMPRESSION);
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
@@ -328,4 +438,296 @@ TEST(RecordReaderWriterTest, TestUseAfterClose) {
   }
 }
 
+// Writes `num_records` records to `fname` in block-compressed form and returns
+// the records written.
+std::vector<string> WriteBlockFile(const string& fname,
+                                   const string& compression_type,
+                                   int64 block_size_bytes, int num_records) {
+  Env* env = Env::Default();
+  std::vector<string> records;
+  for (int i = 0; i < num_records; ++i) {
+    records.push_back(strings::StrCat("record_", i, string(i % 37, 'x')));
+  }
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(env->NewWritableFile(fname, &file));
+  io::RecordWriterOptions options =
+      io::RecordWriterOptions::CreateRecordWriterOptions(compression_type);
+  options.block_size_bytes = block_size_bytes;
+  io::RecordWriter writer(file.get(), options);
+  for (const string& record : records) {
+    TF_CHECK_OK(writer.WriteRecord(record));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+  return records;
+}
+
+TEST(RecordReaderWriterTest, TestBlockCompressed) {
+  Env* env = Env::Default();
+  thread::ThreadPool pool(env, "test", 4);
+  auto runner = [&pool](std::function<void()> fn) {
+    pool.Schedule(std::move(fn));
+  };
+  for (const string compression_type : {"ZLIB", "SNAPPY", "ZSTD", "LZ4"}) {
+    for (int64 block_size : {1, 100, 1000, 1 << 20}) {
+      for (int parallelism : {1, 4}) {
+        string fname = testing::TmpDir() + "/record_reader_writer_block_test";
+        std::vector<string> records =
+            WriteBlockFile(fname, compression_type, block_size, 200);
+        const uint64 file_size = GetFileSize(fname);
+        std::unique_ptr<RandomAccessFile> read_file;
+        TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+        EXPECT_TRUE(io::IsRecordBlockFile(read_file.get(), file_size));
+
+        io::BlockRecordReader reader(
+            read_file.get(), file_size,
+            io::RecordReaderOptions::CreateRecordReaderOptions(
+                compression_type),
+            runner, parallelism);
+        TF_ASSERT_OK(reader.Initialize());
+        EXPECT_EQ(reader.num_records(), records.size());
+        tstring record;
+        for (const string& expected : records) {
+          TF_ASSERT_OK(reader.ReadRecord(&record));
+          EXPECT_EQ(record, expected);
+        }
+        EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+
+        // Seek backwards, then skip across block boundaries.
+        TF_ASSERT_OK(reader.SeekOffset(17));
+        TF_ASSERT_OK(reader.ReadRecord(&record));
+        EXPECT_EQ(record, records[17]);
+        int num_skipped;
+        TF_ASSERT_OK(reader.SkipRecords(100, &num_skipped));
+        EXPECT_EQ(num_skipped, 100);
+        EXPECT_EQ(reader.TellOffset(), uint64{118});
+        TF_ASSERT_OK(reader.ReadRecord(&record));
+        EXPECT_EQ(record, records[118]);
+        EXPECT_TRUE(
+            errors::IsOutOfRange(reader.SkipRecords(1000, &num_skipped)));
+        EXPECT_EQ(num_skipped, static_cast<int>(records.size()) - 119);
+      }
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestBlockCompressedMismatchedCodec) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_block_mismatch";
+  WriteBlockFile(fname, "ZLIB", 100, 10);
+  const uint64 file_size = GetFileSize(fname);
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::BlockRecordReader reader(
+      read_file.get(), file_size,
+      io::RecordReaderOptions::CreateRecordReaderOptions("ZSTD"),
+      /*runner=*/nullptr, /*parallelism=*/1);
+  EXPECT_FALSE(reader.Initialize().ok());
+}
+
+TEST(RecordReaderWriterTest, TestStreamCompressedIsNotBlockFile) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_stream_test";
+  WriteBlockFile(fname, "ZLIB", /*block_size_bytes=*/0, 10);
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  EXPECT_FALSE(io::IsRecordBlockFile(read_file.get(), GetFileSize(fname)));
+}
+
+TEST(RecordReaderWriterTest, TestRecordIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  std::vector<string> records;
+  for (int i = 0; i < 100; ++i) {
+    records.push_back(strings::StrCat("record_", i, string(i % 13, 'x')));
+  }
+  std::vector<uint64> writer_offsets;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options;
+    options.build_index = true;
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_ASSERT_OK(writer.WriteRecord(record));
+    }
+    TF_ASSERT_OK(writer.Close());
+    TF_ASSERT_OK(file->Close());
+    TF_ASSERT_OK(writer.GetRecordIndex(&writer_offsets));
+  }
+  TF_ASSERT_OK(io::WriteRecordIndex(env, fname, writer_offsets));
+
+  // The index written by RecordWriter matches the one found by scanning.
+  std::vector<uint64> offsets;
+  TF_ASSERT_OK(io::ReadRecordIndex(env, fname, &offsets));
+  EXPECT_EQ(offsets, writer_offsets);
+  uint64 num_records;
+  TF_ASSERT_OK(io::ReadRecordIndexSize(env, fname, &num_records));
+  EXPECT_EQ(num_records, records.size());
+  std::vector<uint64> scanned_offsets;
+  TF_ASSERT_OK(io::BuildRecordIndex(env, fname, &scanned_offsets));
+  EXPECT_EQ(offsets, scanned_offsets);
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  for (size_t buffer_size : {0, 1, 100, 65536}) {
+    io::IndexedRecordReader reader(read_file.get(), &offsets, buffer_size);
+    EXPECT_EQ(reader.num_records(), records.size());
+    tstring record;
+    for (uint64 i : {0, 99, 50, 51, 52, 7, 6, 5}) {
+      TF_ASSERT_OK(reader.ReadRecord(i, &record));
+      EXPECT_EQ(record, records[i]);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(100, &record)));
+  }
+
+  // Appending to the file makes the index stale.
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewAppendableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_ASSERT_OK(writer.WriteRecord("abc"));
+    TF_ASSERT_OK(writer.Close());
+    TF_ASSERT_OK(file->Close());
+  }
+  EXPECT_TRUE(
+      errors::IsFailedPrecondition(io::ReadRecordIndex(env, fname, &offsets)));
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      io::ReadRecordIndexSize(env, fname, &num_records)));
+}
+
+TEST(RecordReaderWriterTest, TestRecordIndexCorruption) {
+  std::vector<uint64> offsets = {0, 20, 45, 100};
+  string encoded;
+  io::EncodeRecordIndex(offsets, &encoded);
+  std::vector<uint64> decoded;
+  TF_ASSERT_OK(io::DecodeRecordIndex(encoded, &decoded));
+  EXPECT_EQ(decoded, offsets);
+
+  string corrupted = encoded;
+  corrupted[9] ^= 1;
+  EXPECT_TRUE(errors::IsDataLoss(io::DecodeRecordIndex(corrupted, &decoded)));
+  EXPECT_TRUE(errors::IsDataLoss(
+      io::DecodeRecordIndex(encoded.substr(8), &decoded)));
+  EXPECT_TRUE(errors::IsDataLoss(io::DecodeRecordIndex("", &decoded)));
+}
+
+TEST(RecordReaderWriterTest, TestRecordIndexRequiresUncompressed) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_zlib";
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(env->NewWritableFile(fname, &file));
+  io::RecordWriterOptions options =
+      io::RecordWriterOptions::CreateRecordWriterOptions("ZLIB");
+  options.build_index = true;
+  io::RecordWriter writer(file.get(), options);
+  TF_ASSERT_OK(writer.WriteRecord("abc"));
+  std::vector<uint64> offsets;
+  EXPECT_TRUE(errors::IsFailedPrecondition(writer.GetRecordIndex(&offsets)));
+}
+
+namespace {
+
+// Decode throughput of the RecordReader for each supported codec. The input
+// is a file of `kNumRecords` moderately compressible records; the reported
+// bytes are uncompressed record bytes.
+void BM_ReadRecords(::testing::benchmark::State& state) {
+  static const char* const kCompressionTypes[] = {"", "ZLIB", "SNAPPY",
+                                                  "ZSTD", "LZ4"};
+  const string compression_type = kCompressionTypes[state.range(0)];
+  constexpr int kNumRecords = 10000;
+  constexpr int kRecordSize = 1024;
+
+  Env* env = Env::Default();
+  string fname;
+  CHECK(env->LocalTempFilename(&fname));
+  string record(kRecordSize, 0);
+  for (int i = 0; i < kRecordSize; ++i) {
+    record[i] = 'a' + (i * 7 + i / 16) % 26;
+  }
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(
+        file.get(),
+        io::RecordWriterOptions::CreateRecordWriterOptions(compression_type));
+    for (int i = 0; i < kNumRecords; ++i) {
+      TF_CHECK_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  const io::RecordReaderOptions options =
+      io::RecordReaderOptions::CreateRecordReaderOptions(compression_type);
+  tstring result;
+  for (auto s : state) {
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    for (int i = 0; i < kNumRecords; ++i) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &result));
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64>(state.iterations()) *
+                          kNumRecords * kRecordSize);
+  state.SetLabel(compression_type.empty() ? "NONE" : compression_type);
+}
+BENCHMARK(BM_ReadRecords)->Arg(0)->Arg(1)->Arg(2)->Arg(3)->Arg(4);
+
+// Decode throughput of the BlockRecordReader on a ZSTD block-compressed file,
+// as a function of the number of blocks decompressed in parallel.
+void BM_ReadBlockRecords(::testing::benchmark::State& state) {
+  const int parallelism = state.range(0);
+  constexpr int kNumRecords = 10000;
+  constexpr int kRecordSize = 1024;
+
+  Env* env = Env::Default();
+  string fname;
+  CHECK(env->LocalTempFilename(&fname));
+  string record(kRecordSize, 0);
+  for (int i = 0; i < kRecordSize; ++i) {
+    record[i] = 'a' + (i * 7 + i / 16) % 26;
+  }
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options =
+        io::RecordWriterOptions::CreateRecordWriterOptions("ZSTD");
+    options.block_size_bytes = 256 << 10;
+    io::RecordWriter writer(file.get(), options);
+    for (int i = 0; i < kNumRecords; ++i) {
+      TF_CHECK_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  uint64 file_size;
+  TF_CHECK_OK(env->GetFileSize(fname, &file_size));
+  thread::ThreadPool pool(env, "bm", parallelism);
+  auto runner = [&pool](std::function<void()> fn) {
+    pool.Schedule(std::move(fn));
+  };
+  tstring result;
+  for (auto s : state) {
+    io::BlockRecordReader reader(
+        read_file.get(), file_size,
+        io::RecordReaderOptions::CreateRecordReaderOptions("ZSTD"), runner,
+        parallelism);
+    TF_CHECK_OK(reader.Initialize());
+    for (int i = 0; i < kNumRecords; ++i) {
+      TF_CHECK_OK(reader.ReadRecord(&result));
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64>(state.iterations()) *
+                          kNumRecords * kRecordSize);
+}
+BENCHMARK(BM_ReadBlockRecords)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+}  // namespace
+
 }  // namespace tensorflow
@@ -30,6 +30,27 @@ bool IsZlibCompressed(const RecordWriterOptions& options) {
 bool IsSnappyCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
 }
+
+bool IsZstdCompressed(const RecordWriterOptions& options) {
+  return options.compression_type == RecordWriterOptions::ZSTD_COMPRESSION;
+}
+
+bool IsLz4Compressed(const RecordWriterOptions& options) {
+  return options.compression_type == RecordWriterOptions::LZ4_COMPRESSION;
+}
+
+#if !defined(IS_SLIM_BUILD)
+int BlockCompressionLevel(const RecordWriterOptions& options) {
+  if (IsZlibCompressed(options)) {
+    return options.zlib_options.compression_level;
+  } else if (IsZstdCompressed(options)) {
+    return options.zstd_options.compression_level;
+  } else if (IsLz4Compressed(options)) {
+    return options.lz4_options.compression_level;
+  }
+  return 0;
+}
+#endif  // IS_SLIM_BUILD
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -49,6 +70,10 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordWriterOptions::ZSTD_COMPRESSION;
+  } else if (compression_type == compression::kLz4) {
+    options.compression_type = io::RecordWriterOptions::LZ4_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -65,7 +90,10 @@ RecordWriter::RecordWriter(WritableFile* dest,
     LOG(FATAL) << "Compression is unsupported on mobile platforms.";
   }
 #else
-  if (IsZlibCompressed(options)) {
+  if (IsBlockCompressed()) {
+    // Blocks are compressed as a whole in FinishBlock() and written straight
+    // to `dest`.
+  } else if (IsZlibCompressed(options)) {
     ZlibOutputBuffer* zlib_output_buffer = new ZlibOutputBuffer(
         dest, options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options);
@@ -79,6 +107,26 @@ RecordWriter::RecordWriter(WritableFile* dest,
     dest_ =
         new SnappyOutputBuffer(dest, options.snappy_options.input_buffer_size,
                                options.snappy_options.output_buffer_size);
+  } else if (IsZstdCompressed(options)) {
+    ZstdOutputBuffer* zstd_output_buffer =
+        new ZstdOutputBuffer(dest, options.zstd_options.output_buffer_size,
+                             options.zstd_options);
+    Status s = zstd_output_buffer->Init();
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize Zstd outputbuffer. Error: "
+                 << s.ToString();
+    }
+    dest_ = zstd_output_buffer;
+  } else if (IsLz4Compressed(options)) {
+    Lz4OutputBuffer* lz4_output_buffer = new Lz4OutputBuffer(
+        dest, options.lz4_options.input_buffer_size,
+        options.lz4_options.output_buffer_size, options.lz4_options);
+    Status s = lz4_output_buffer->Init();
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize Lz4 outputbuffer. Error: "
+                 << s.ToString();
+    }
+    dest_ = lz4_output_buffer;
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
@@ -110,6 +158,11 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   char footer[kFooterSize];
   PopulateHeader(header, data.data(), data.size());
   PopulateFooter(footer, data.data(), data.size());
+  if (IsBlockCompressed()) {
+    return AppendToBlock(StringPiece(header, sizeof(header)), data,
+                         StringPiece(footer, sizeof(footer)));
+  }
+  AddToIndex(data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
   return dest_->Append(StringPiece(footer, sizeof(footer)));
@@ -130,15 +183,98 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   char footer[kFooterSize];
   PopulateHeader(header, data);
   PopulateFooter(footer, data);
+  if (IsBlockCompressed()) {
+    return AppendToBlock(StringPiece(header, sizeof(header)),
+                         std::string(data),
+                         StringPiece(footer, sizeof(footer)));
+  }
+  AddToIndex(data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
   return dest_->Append(StringPiece(footer, sizeof(footer)));
 }
 #endif
 
+bool RecordWriter::IsBlockCompressed() const {
+#if defined(IS_SLIM_BUILD)
+  return false;
+#else
+  return options_.block_size_bytes > 0 &&
+         options_.compression_type != RecordWriterOptions::NONE;
+#endif  // IS_SLIM_BUILD
+}
+
+Status RecordWriter::AppendToBlock(StringPiece header, StringPiece data,
+                                   StringPiece footer) {
+  if (block_.empty()) {
+    block_.reserve(options_.block_size_bytes + header.size() + footer.size());
+  }
+  block_.append(header.data(), header.size());
+  block_.append(data.data(), data.size());
+  block_.append(footer.data(), footer.size());
+  ++block_num_records_;
+  if (block_.size() >= options_.block_size_bytes) {
+    return FinishBlock();
+  }
+  return Status::OK();
+}
+
+Status RecordWriter::FinishBlock() {
+#if !defined(IS_SLIM_BUILD)
+  if (block_num_records_ == 0) return Status::OK();
+  string compressed;
+  TF_RETURN_IF_ERROR(CompressRecordBlock(options_.compression_type,
+                                         BlockCompressionLevel(options_),
+                                         block_, &compressed));
+  TF_RETURN_IF_ERROR(dest_->Append(compressed));
+  RecordBlockHandle block;
+  block.offset = block_file_offset_;
+  block.compressed_size = compressed.size();
+  block.uncompressed_size = block_.size();
+  block.num_records = block_num_records_;
+  block_index_.push_back(block);
+  block_file_offset_ += compressed.size();
+  block_.clear();
+  block_num_records_ = 0;
+#endif  // IS_SLIM_BUILD
+  return Status::OK();
+}
+
+void RecordWriter::AddToIndex(size_t n) {
+  if (!options_.build_index) return;
+  record_offsets_.push_back(next_offset_);
+  next_offset_ += kHeaderSize + n + kFooterSize;
+}
+
+Status RecordWriter::GetRecordIndex(std::vector<uint64>* offsets) const {
+  if (!options_.build_index) {
+    return Status(::tensorflow::error::FAILED_PRECONDITION,
+                  "RecordWriter was not created with `build_index` set");
+  }
+  if (options_.compression_type != RecordWriterOptions::NONE) {
+    return Status(::tensorflow::error::FAILED_PRECONDITION,
+                  "Record indexes are only supported for uncompressed files");
+  }
+  *offsets = record_offsets_;
+  offsets->push_back(next_offset_);
+  return Status::OK();
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
-  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
+  if (IsBlockCompressed()) {
+    // `dest_` is the caller's file, so it is neither closed nor deleted.
+    Status s = FinishBlock();
+    if (s.ok()) {
+      string index;
+      EncodeRecordBlockIndex(block_index_, options_.compression_type,
+                             block_file_offset_, &index);
+      s = dest_->Append(index);
+    }
+    dest_ = nullptr;
+    return s;
+  }
+  if (options_.compression_type != RecordWriterOptions::NONE) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
@@ -152,6 +288,9 @@ Status RecordWriter::Flush() {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
                   "Writer not initialized or previously closed");
   }
+  if (IsBlockCompressed()) {
+    TF_RETURN_IF_ERROR(FinishBlock());
+  }
   return dest_->Flush();
 }
 
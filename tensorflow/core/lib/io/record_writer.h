@@ -20,11 +20,16 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_block.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/lz4_compression_options.h"
+#include "tensorflow/core/lib/io/lz4_outputbuffer.h"
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/core/lib/io/zstd_compression_options.h"
+#include "tensorflow/core/lib/io/zstd_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/macros.h"
@@ -41,17 +46,33 @@ struct RecordWriterOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    ZSTD_COMPRESSION = 3,
+    LZ4_COMPRESSION = 4
   };
   CompressionType compression_type = NONE;
 
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
+  // If positive and `compression_type` is not NONE, records are grouped into
+  // blocks of about this many uncompressed bytes that are compressed
+  // independently and followed by a block index (see record_block.h). Such
+  // files can be decompressed in parallel by BlockRecordReader, but cannot be
+  // read by RecordReader.
+  int64 block_size_bytes = 0;
+
+  // If true and `compression_type` is NONE, the writer remembers the offset of
+  // every record it writes so that a record index (see record_index.h) can be
+  // obtained from GetRecordIndex().
+  bool build_index = false;
+
 #if !defined(IS_SLIM_BUILD)
   // Options specific to compression.
   tensorflow::io::ZlibCompressionOptions zlib_options;
   tensorflow::io::SnappyCompressionOptions snappy_options;
+  tensorflow::io::ZstdCompressionOptions zstd_options;
+  tensorflow::io::Lz4CompressionOptions lz4_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -85,7 +106,7 @@ class RecordWriter {
 
   // Flushes any buffered data held by underlying containers of the
   // RecordWriter to the WritableFile. Does *not* flush the
-  // WritableFile.
+  // WritableFile. For block-compressed output this ends the current block.
   Status Flush();
 
   // Writes all output to the file. Does *not* close the WritableFile.
@@ -94,6 +115,11 @@ class RecordWriter {
   // are invalid.
   Status Close();
 
+  // Stores the offsets of the records written so far, followed by the offset
+  // of the next record, in `*offsets`. This is the input expected by
+  // WriteRecordIndex(). Requires `options.build_index` and no compression.
+  Status GetRecordIndex(std::vector<uint64>* offsets) const;
+
   // Utility method to populate TFRecord headers.  Populates record-header in
   // "header[0,kHeaderSize-1]".  The record-header is based on data[0, n-1].
   inline static void PopulateHeader(char* header, const char* data, size_t n);
@@ -109,9 +135,34 @@ class RecordWriter {
 #endif
 
  private:
+  bool IsBlockCompressed() const;
+
+  // Appends a framed record to the current block, compressing and writing
+  // the block once it reaches `options_.block_size_bytes`.
+  Status AppendToBlock(StringPiece header, StringPiece data,
+                       StringPiece footer);
+
+  // Compresses and writes the current block, if it is not empty.
+  Status FinishBlock();
+
+  // Accounts for an uncompressed record of `n` data bytes about to be
+  // written at `next_offset_`.
+  void AddToIndex(size_t n);
+
   WritableFile* dest_;
   RecordWriterOptions options_;
 
+  // State for block-compressed output. `dest_` is the underlying file in
+  // this mode.
+  string block_;
+  uint64 block_num_records_ = 0;
+  uint64 block_file_offset_ = 0;
+  std::vector<RecordBlockHandle> block_index_;
+
+  // State for `options_.build_index`.
+  uint64 next_offset_ = 0;
+  std::vector<uint64> record_offsets_;
+
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
   }
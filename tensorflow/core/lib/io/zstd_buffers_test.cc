@@ -0,0 +1,193 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/zstd_compression_options.h"
+#include "tensorflow/core/lib/io/zstd_inputstream.h"
+#include "tensorflow/core/lib/io/zstd_outputbuffer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+std::vector<int> InputBufferSizes() { return {10, 100, 200, 500, 1000, 10000}; }
+
+std::vector<int> OutputBufferSizes() { return {100, 200, 500, 1000}; }
+
+std::vector<int> NumCopies() { return {1, 50, 500}; }
+
+string GenTestString(int copies = 1) {
+  string result;
+  for (int i = 0; i < copies; i++) {
+    strings::StrAppend(&result, "Lorem ipsum dolor sit amet, record ", i,
+                       ", consectetur adipiscing elit. ");
+  }
+  return result;
+}
+
+// Writes `data` to `fname` as a zstd stream, calling Flush() after each of
+// `num_writes` appends of `data` if `with_flush` is set.
+void WriteCompressedFile(Env* env, const string& fname, int output_buf_size,
+                         const ZstdCompressionOptions& options,
+                         const string& data, int num_writes = 1,
+                         bool with_flush = false) {
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+  ZstdOutputBuffer out(file_writer.get(), output_buf_size, options);
+  TF_ASSERT_OK(out.Init());
+  for (int i = 0; i < num_writes; i++) {
+    TF_ASSERT_OK(out.Append(StringPiece(data)));
+    if (with_flush) {
+      TF_ASSERT_OK(out.Flush());
+    }
+  }
+  TF_ASSERT_OK(out.Close());
+  TF_ASSERT_OK(file_writer->Flush());
+  TF_ASSERT_OK(file_writer->Close());
+}
+
+void TestAllCombinations(const ZstdCompressionOptions& options) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  for (auto file_size : NumCopies()) {
+    string data = GenTestString(file_size);
+    for (auto input_buf_size : InputBufferSizes()) {
+      for (auto output_buf_size : OutputBufferSizes()) {
+        WriteCompressedFile(env, fname, output_buf_size, options, data);
+
+        std::unique_ptr<RandomAccessFile> file_reader;
+        TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+        RandomAccessInputStream input_stream(file_reader.get());
+        ZstdInputStream in(&input_stream, input_buf_size, output_buf_size,
+                           options);
+        tstring result;
+        TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+        EXPECT_EQ(result, data);
+        EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+      }
+    }
+  }
+}
+
+TEST(ZstdBuffers, DefaultOptions) {
+  TestAllCombinations(ZstdCompressionOptions());
+}
+
+TEST(ZstdBuffers, FastestLevel) {
+  ZstdCompressionOptions options;
+  options.compression_level = 1;
+  TestAllCombinations(options);
+}
+
+TEST(ZstdBuffers, Dictionary) {
+  ZstdCompressionOptions options;
+  options.dictionary = GenTestString(20);
+  TestAllCombinations(options);
+}
+
+TEST(ZstdBuffers, MultipleWriteCallsWithFlush) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  const string data = GenTestString();
+  WriteCompressedFile(env, fname, 200, ZstdCompressionOptions(), data,
+                      /*num_writes=*/10, /*with_flush=*/true);
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  ZstdInputStream in(&input_stream, 200, 200, ZstdCompressionOptions());
+  for (int i = 0; i < 10; i++) {
+    tstring result;
+    TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+    EXPECT_EQ(result, data);
+  }
+}
+
+TEST(ZstdInputStream, TellAndReset) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  const string data = GenTestString(50);
+  WriteCompressedFile(env, fname, 200, ZstdCompressionOptions(), data);
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  ZstdInputStream in(&input_stream, 100, 100, ZstdCompressionOptions());
+  tstring result;
+  TF_ASSERT_OK(in.ReadNBytes(1000, &result));
+  EXPECT_EQ(in.Tell(), 1000);
+  TF_ASSERT_OK(in.SkipNBytes(500));
+  EXPECT_EQ(in.Tell(), 1500);
+  TF_ASSERT_OK(in.ReadNBytes(10, &result));
+  EXPECT_EQ(result, data.substr(1500, 10));
+
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_EQ(in.Tell(), 0);
+  TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+  EXPECT_EQ(result, data);
+}
+
+TEST(ZstdInputStream, FailsOnTruncatedStream) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  const string data = GenTestString(50);
+  WriteCompressedFile(env, fname, 200, ZstdCompressionOptions(), data);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(env, fname, &contents));
+  TF_ASSERT_OK(WriteStringToFile(env, fname,
+                                 contents.substr(0, contents.size() / 2)));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  ZstdInputStream in(&input_stream, 100, 100, ZstdCompressionOptions());
+  tstring result;
+  Status s = in.ReadNBytes(data.size(), &result);
+  EXPECT_EQ(s.code(), error::DATA_LOSS);
+  EXPECT_LT(result.size(), data.size());
+}
+
+TEST(ZstdInputStream, FailsWithMismatchedDictionary) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  ZstdCompressionOptions output_options;
+  output_options.dictionary = GenTestString(20);
+  const string data = GenTestString(50);
+  WriteCompressedFile(env, fname, 200, output_options, data);
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  ZstdInputStream in(&input_stream, 200, 200, ZstdCompressionOptions());
+  tstring result;
+  Status s = in.ReadNBytes(data.size(), &result);
+  EXPECT_EQ(s.code(), error::DATA_LOSS);
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "ZSTD_decompressStream"));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,58 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_COMPRESSION_OPTIONS_H_
+
+#include <string>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+struct ZstdCompressionOptions {
+  // Size of the buffer used for caching the data read from source file.
+  int64 input_buffer_size = 256 << 10;
+
+  // Size of the sink buffer where the compressed/decompressed data produced by
+  // zstd is cached.
+  int64 output_buffer_size = 256 << 10;
+
+  // From the zstd manual (https://facebook.github.io/zstd/zstd_manual.html):
+  // Compression levels range from 1 (fastest) to 19 (best ratio); levels 20 to
+  // 22 require more memory. Negative levels trade ratio for even faster
+  // compression. 0 selects the library default (currently 3).
+  //
+  // This option is ignored for `ZstdInputStream`.
+  int32 compression_level = 3;
+
+  // Base two logarithm of the maximum back-reference distance. 0 selects a
+  // default based on `compression_level`. Decompressing a stream written with
+  // a window_log above 27 requires setting at least the same value on the
+  // `ZstdInputStream`.
+  int32 window_log = 0;
+
+  // An optional dictionary, e.g. trained with `zstd --train` on a sample of
+  // records. Dictionaries considerably improve the compression ratio of
+  // streams made of many small, similar records. The same dictionary must be
+  // used for compression and decompression.
+  std::string dictionary;
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_COMPRESSION_OPTIONS_H_
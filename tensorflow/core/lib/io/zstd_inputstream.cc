@@ -0,0 +1,170 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/zstd_inputstream.h"
+
+#include <zstd.h>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace io {
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 size_t input_buffer_bytes,
+                                 size_t output_buffer_bytes,
+                                 const ZstdCompressionOptions& zstd_options,
+                                 bool owns_input_stream)
+    : owns_input_stream_(owns_input_stream),
+      input_stream_(input_stream),
+      input_buffer_capacity_(input_buffer_bytes),
+      output_buffer_capacity_(output_buffer_bytes),
+      zstd_options_(zstd_options),
+      output_buffer_(new char[output_buffer_bytes]) {
+  init_status_ = Init();
+}
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 size_t input_buffer_bytes,
+                                 size_t output_buffer_bytes,
+                                 const ZstdCompressionOptions& zstd_options)
+    : ZstdInputStream(input_stream, input_buffer_bytes, output_buffer_bytes,
+                      zstd_options, false) {}
+
+ZstdInputStream::~ZstdInputStream() {
+  ZSTD_freeDCtx(dctx_);
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status ZstdInputStream::Init() {
+  if (input_buffer_capacity_ == 0 || output_buffer_capacity_ == 0) {
+    return errors::InvalidArgument(
+        "input_buffer_bytes and output_buffer_bytes should be greater than 0");
+  }
+  dctx_ = ZSTD_createDCtx();
+  if (dctx_ == nullptr) {
+    return errors::ResourceExhausted("Failed to create a zstd context");
+  }
+  size_t result = 0;
+  if (zstd_options_.window_log != 0) {
+    result = ZSTD_DCtx_setParameter(dctx_, ZSTD_d_windowLogMax,
+                                    zstd_options_.window_log);
+  }
+  if (!ZSTD_isError(result) && !zstd_options_.dictionary.empty()) {
+    result = ZSTD_DCtx_loadDictionary(dctx_, zstd_options_.dictionary.data(),
+                                      zstd_options_.dictionary.size());
+  }
+  if (ZSTD_isError(result)) {
+    return errors::InvalidArgument("Failed to initialize zstd decompression: ",
+                                   ZSTD_getErrorName(result));
+  }
+  return Status::OK();
+}
+
+Status ZstdInputStream::Reset() {
+  TF_RETURN_IF_ERROR(init_status_);
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_only);
+  input_buffer_.clear();
+  input_pos_ = 0;
+  output_pos_ = 0;
+  output_size_ = 0;
+  in_frame_ = false;
+  bytes_read_ = 0;
+  return Status::OK();
+}
+
+Status ZstdInputStream::Decompress() {
+  output_pos_ = 0;
+  output_size_ = 0;
+  // A call to ZSTD_decompressStream() may consume input without producing any
+  // output, e.g. when reading a frame header, so loop until output is
+  // available.
+  while (output_size_ == 0) {
+    if (input_pos_ == input_buffer_.size()) {
+      input_pos_ = 0;
+      Status s = input_stream_->ReadNBytes(input_buffer_capacity_,
+                                           &input_buffer_);
+      if (!s.ok() && !errors::IsOutOfRange(s)) {
+        return s;
+      }
+      if (input_buffer_.empty()) {
+        if (in_frame_) {
+          return errors::DataLoss("Truncated zstd stream");
+        }
+        return errors::OutOfRange("EOF reached");
+      }
+    }
+    ZSTD_inBuffer input = {input_buffer_.data(), input_buffer_.size(),
+                           input_pos_};
+    ZSTD_outBuffer output = {output_buffer_.get(), output_buffer_capacity_,
+                             0};
+    const size_t result = ZSTD_decompressStream(dctx_, &output, &input);
+    if (ZSTD_isError(result)) {
+      return errors::DataLoss("ZSTD_decompressStream() failed: ",
+                              ZSTD_getErrorName(result));
+    }
+    input_pos_ = input.pos;
+    output_size_ = output.pos;
+    // A return value of 0 means that a frame has been completely decoded and
+    // flushed.
+    in_frame_ = result != 0;
+  }
+  return Status::OK();
+}
+
+size_t ZstdInputStream::ReadBytesFromCache(size_t bytes_to_read,
+                                           tstring* result) {
+  const size_t can_read_bytes = std::min(bytes_to_read, NumUnreadBytes());
+  if (can_read_bytes > 0) {
+    result->append(output_buffer_.get() + output_pos_, can_read_bytes);
+    output_pos_ += can_read_bytes;
+    bytes_read_ += can_read_bytes;
+  }
+  return can_read_bytes;
+}
+
+Status ZstdInputStream::ReadNBytes(int64 bytes_to_read, tstring* result) {
+  TF_RETURN_IF_ERROR(init_status_);
+  result->clear();
+  // Read as many bytes as possible from cache.
+  bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+
+  while (bytes_to_read > 0) {
+    // At this point we can be sure that cache has been emptied.
+    DCHECK_EQ(NumUnreadBytes(), 0);
+    TF_RETURN_IF_ERROR(Decompress());
+    bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+  }
+  return Status::OK();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZstdInputStream::ReadNBytes(int64 bytes_to_read, absl::Cord* result) {
+  tstring buf;
+  TF_RETURN_IF_ERROR(ReadNBytes(bytes_to_read, &buf));
+  result->Clear();
+  result->Append(buf.data());
+  return Status::OK();
+}
+#endif
+
+int64 ZstdInputStream::Tell() const { return bytes_read_; }
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,146 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/zstd_outputbuffer.h"
+
+#include <zstd.h>
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+ZstdOutputBuffer::ZstdOutputBuffer(WritableFile* file,
+                                   int32 output_buffer_bytes,
+                                   const ZstdCompressionOptions& zstd_options)
+    : file_(file),
+      zstd_options_(zstd_options),
+      output_buffer_capacity_(output_buffer_bytes),
+      output_buffer_(new char[output_buffer_bytes]) {}
+
+ZstdOutputBuffer::~ZstdOutputBuffer() {
+  if (cctx_ != nullptr) {
+    LOG(WARNING) << "ZstdOutputBuffer::Close() not called. Possible data loss";
+    ZSTD_freeCCtx(cctx_);
+  }
+}
+
+Status ZstdOutputBuffer::Init() {
+  if (output_buffer_capacity_ == 0) {
+    return errors::InvalidArgument(
+        "output_buffer_bytes should be greater than 0");
+  }
+  cctx_ = ZSTD_createCCtx();
+  if (cctx_ == nullptr) {
+    return errors::ResourceExhausted("Failed to create a zstd context");
+  }
+  size_t result = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel,
+                                         zstd_options_.compression_level);
+  if (!ZSTD_isError(result) && zstd_options_.window_log != 0) {
+    result = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_windowLog,
+                                    zstd_options_.window_log);
+  }
+  if (!ZSTD_isError(result) && !zstd_options_.dictionary.empty()) {
+    result = ZSTD_CCtx_loadDictionary(cctx_, zstd_options_.dictionary.data(),
+                                      zstd_options_.dictionary.size());
+  }
+  if (ZSTD_isError(result)) {
+    ZSTD_freeCCtx(cctx_);
+    cctx_ = nullptr;
+    return errors::InvalidArgument("Failed to initialize zstd compression: ",
+                                   ZSTD_getErrorName(result));
+  }
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Compress(StringPiece data, int end_directive) {
+  if (cctx_ == nullptr) {
+    return errors::FailedPrecondition(
+        "ZstdOutputBuffer is not initialized or has been closed");
+  }
+  const auto mode = static_cast<ZSTD_EndDirective>(end_directive);
+  ZSTD_inBuffer input = {data.data(), data.size(), 0};
+  bool done;
+  do {
+    if (output_buffer_size_ == output_buffer_capacity_) {
+      TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    }
+    ZSTD_outBuffer output = {output_buffer_.get(), output_buffer_capacity_,
+                             output_buffer_size_};
+    const size_t remaining =
+        ZSTD_compressStream2(cctx_, &output, &input, mode);
+    if (ZSTD_isError(remaining)) {
+      return errors::DataLoss("ZSTD_compressStream2() failed: ",
+                              ZSTD_getErrorName(remaining));
+    }
+    output_buffer_size_ = output.pos;
+    // With `ZSTD_e_continue` zstd may keep consumed input buffered; flushes
+    // are only complete once zstd reports no remaining output.
+    done = mode == ZSTD_e_continue ? input.pos == input.size : remaining == 0;
+  } while (!done);
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::FlushOutputBufferToFile() {
+  if (output_buffer_size_ > 0) {
+    TF_RETURN_IF_ERROR(file_->Append(
+        StringPiece(output_buffer_.get(), output_buffer_size_)));
+    output_buffer_size_ = 0;
+  }
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Append(StringPiece data) {
+  return Compress(data, ZSTD_e_continue);
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZstdOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return Status::OK();
+}
+#endif
+
+Status ZstdOutputBuffer::Flush() {
+  TF_RETURN_IF_ERROR(Compress(StringPiece(), ZSTD_e_flush));
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  return file_->Flush();
+}
+
+Status ZstdOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ZstdOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ZstdOutputBuffer::Close() {
+  if (cctx_ != nullptr) {
+    TF_RETURN_IF_ERROR(Compress(StringPiece(), ZSTD_e_end));
+    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    ZSTD_freeCCtx(cctx_);
+    cctx_ = nullptr;
+  }
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Tell(int64* position) { return file_->Tell(position); }
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,119 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_OUTPUTBUFFER_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_OUTPUTBUFFER_H_
+
+#include <memory>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/zstd_compression_options.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+// Forward declare the compression context of zstd.h, which is only included in
+// the .cc file.
+struct ZSTD_CCtx_s;
+
+namespace tensorflow {
+namespace io {
+
+// Compresses input data using Zstandard (https://facebook.github.io/zstd/)
+// and writes to `file`.
+//
+// Input data is handed to the zstd streaming compressor, which buffers it
+// internally until a full block can be compressed. The compressed output is
+// buffered in a buffer of size `output_buffer_bytes` which gets flushed to
+// file when full.
+//
+// The output is a standard zstd frame that can be decompressed with
+// `ZstdInputStream` or the `zstd` command line tool.
+class ZstdOutputBuffer : public WritableFile {
+ public:
+  // Create a ZstdOutputBuffer for `file` with a buffer of size
+  // `output_buffer_bytes` for the compressed output.
+  // Does not take ownership of `file`.
+  ZstdOutputBuffer(WritableFile* file, int32 output_buffer_bytes,
+                   const ZstdCompressionOptions& zstd_options);
+
+  // Per convention, the dtor does not call Flush() or Close(). We expect the
+  // caller to call those manually when done.
+  ~ZstdOutputBuffer() override;
+
+  // Initializes the compression context and loads the dictionary, if any.
+  // Must be called before any other method.
+  Status Init();
+
+  // Adds `data` to the compression pipeline.
+  //
+  // The input data is buffered internally by zstd and will be written to disk
+  // at a later time. To immediately write contents to file call `Flush()`.
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any buffered input and writes all output to file. The zstd
+  // frame is not ended, so further data can be appended.
+  Status Flush() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Compresses any buffered input, writes all output to file and syncs it.
+  Status Sync() override;
+
+  // Ends the zstd frame and writes all output to file. This must be called
+  // before the destructor to avoid any data loss. Does *not* close `file`.
+  //
+  // After calling this, any further calls to `Append()`, `Flush()` or `Close()`
+  // will fail.
+  Status Close() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64* position) override;
+
+ private:
+  // Runs the compressor on `data` with the given `ZSTD_EndDirective`,
+  // writing the output buffer to file whenever it gets full. Returns once all
+  // of `data` has been consumed and, for flushes, all output has been
+  // produced.
+  Status Compress(StringPiece data, int end_directive);
+
+  // Appends the contents of `output_buffer_` to `file_`.
+  Status FlushOutputBufferToFile();
+
+  WritableFile* file_;  // Not owned
+
+  const ZstdCompressionOptions zstd_options_;
+
+  // Buffer for storing compressed contents before they are written to file.
+  const size_t output_buffer_capacity_;
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_buffer_size_ = 0;
+
+  ZSTD_CCtx_s* cctx_ = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_OUTPUTBUFFER_H_
@@ -133,10 +133,32 @@ REGISTER_OP("ExperimentalChooseFastestDataset")
     .Attr("output_shapes: list(shape) >= 1")
     .SetShapeFn(shape_inference::ScalarShape);
 
+REGISTER_OP("ColumnarDataset")
+    .Input("filenames: string")
+    .Input("columns: string")
+    .Input("batch_size: int64")
+    .Input("num_parallel_reads: int64")
+    .Output("handle: variant")
+    .Attr("output_types: list({float,double,int32,int64,string}) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetDoNotOptimize()  // TODO(b/123753214): See comment in dataset_ops.cc.
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // `filenames` must be a scalar or a vector.
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(0), 1, &unused));
+      // `columns` must be a vector.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      // `batch_size` and `num_parallel_reads` must be scalars.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("CompressElement")
     .Input("components: input_types")
     .Output("compressed: variant")
     .Attr("input_types: list(type) >= 1")
+    .Attr("compression: string = ''")
     .SetShapeFn(shape_inference::ScalarShape);
 
 REGISTER_OP("UncompressElement")
@@ -292,6 +314,15 @@ REGISTER_OP("DatasetFromGraph")
 // implement a mechanism to determine whether `dataset` has a side-effect
 // and use it to decide whether to use a stateless or stateful version of this
 // op.
+REGISTER_OP("DatasetToColumnarFile")
+    .Input("input_dataset: variant")
+    .Input("filename: string")
+    .Input("columns: string")
+    .Input("compression_type: string")
+    .Input("rows_per_row_group: int64")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::NoOutputs);
+
 REGISTER_OP("DatasetToTFRecord")
     .Input("input_dataset: variant")
     .Input("filename: string")
@@ -306,6 +337,24 @@ REGISTER_OP("ExperimentalDatasetToTFRecord")
     .SetIsStateful()
     .SetShapeFn(shape_inference::NoOutputs);
 
+REGISTER_OP("DenseToRaggedBatchDataset")
+    .Input("input_dataset: variant")
+    .Input("batch_size: int64")
+    .Input("drop_remainder: bool")
+    .Output("handle: variant")
+    .Attr("parallel_copy: bool = false")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // batch_size should be a scalar.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      // drop_remainder should be a scalar.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("DenseToSparseBatchDataset")
     .Input("input_dataset: variant")
     .Input("batch_size: int64")
@@ -754,6 +803,28 @@ REGISTER_OP("ExperimentalRandomDataset")
       return shape_inference::ScalarShape(c);
     });
 
+REGISTER_OP("RandomAccessTFRecordDataset")
+    .Input("filenames: string")
+    .Input("buffer_size: int64")
+    .Input("num_shards: int64")
+    .Input("shard_index: int64")
+    .Output("handle: variant")
+    .Attr("shuffle: bool = false")
+    .Attr("shuffle_seed: int = 0")
+    .Attr("shuffle_block_size: int = 256")
+    .Attr("shuffle_window_blocks: int = 64")
+    .SetDoNotOptimize()  // TODO(b/123753214): See comment in dataset_ops.cc.
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // `filenames` must be a scalar or a vector.
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(0), 1, &unused));
+      // buffer_size, num_shards, and shard_index should be scalars.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("RandomDataset")
     .Input("seed: int64")
     .Input("seed2: int64")
@@ -966,6 +1037,8 @@ REGISTER_OP("SnapshotDatasetV2")
     .Attr("shard_func: func")
     .Attr("Treader_func_args: list(type) >= 0")
     .Attr("Tshard_func_args: list(type) >= 0")
+    .Attr("writer_buffer_size_bytes: int = 0")
+    .Attr("num_writers_per_shard: int = 1")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       // `path` should be a scalar.
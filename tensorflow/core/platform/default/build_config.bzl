@@ -778,6 +778,8 @@ def tf_portable_deps_no_runtime():
         "@nsync//:nsync_cpp",
         "@com_googlesource_code_re2//:re2",
         "@farmhash_archive//:farmhash",
+        "@lz4",
+        "@zstd",
     ]
 
 def tf_google_mobile_srcs_no_runtime():
@@ -31,11 +31,18 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/presized_cuckoo_map.h"
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace tensorflow {
 namespace example {
 
@@ -113,6 +120,255 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Packed int64 lists are decoded by scanning whole blocks of the payload for
+// continuation bits: runs of single-byte varints (small ids, labels, counts)
+// are widened to int64 in bulk, and only the remaining multi-byte varints go
+// through the scalar decoder. The vector width is picked at runtime.
+#if defined(__GNUC__) && defined(__x86_64__)
+#define TF_EXAMPLE_PARSING_USE_SSE2
+#define TF_EXAMPLE_PARSING_USE_AVX2
+#elif defined(__GNUC__) && defined(__aarch64__) && defined(__ARM_NEON)
+#define TF_EXAMPLE_PARSING_USE_NEON
+#endif
+
+// Decodes one varint starting at `p`. Returns the position after it, or
+// nullptr if it is truncated or longer than 10 bytes.
+inline const uint8* DecodeVarint64(const uint8* p, const uint8* end,
+                                   uint64* value) {
+  uint64 result = 0;
+  for (int shift = 0; shift < 70 && p < end; shift += 7) {
+    const uint8 byte = *p++;
+    result |= static_cast<uint64>(byte & 0x7f) << shift;
+    if (byte < 0x80) {
+      *value = result;
+      return p;
+    }
+  }
+  return nullptr;
+}
+
+// Portable fallback, and the tail of every vectorized counter.
+size_t CountPackedVarintsScalar(const uint8* p, const uint8* end) {
+  size_t count = 0;
+  for (; p < end; ++p) count += *p < 0x80;
+  return count;
+}
+
+#if defined(TF_EXAMPLE_PARSING_USE_SSE2) || \
+    defined(TF_EXAMPLE_PARSING_USE_NEON)
+// Decodes the packed varints in [p, end) into `out`. Only the first
+// `capacity` values are stored, the remaining ones are validated and dropped.
+// `Block` provides `kWidth`, `ContinuationMask()` (bit i is set if byte i of
+// the block has its continuation bit set) and `Widen()`, which converts
+// `kWidth` single-byte varints to int64.
+template <typename Block>
+inline bool DecodePackedVarints(const uint8* p, const uint8* end, int64* out,
+                                size_t capacity) {
+  size_t index = 0;
+  while (p < end) {
+    if (end - p >= Block::kWidth) {
+      const uint32 mask = Block::ContinuationMask(p);
+      if (mask == 0 && index + Block::kWidth <= capacity) {
+        Block::Widen(p, out + index);
+        p += Block::kWidth;
+        index += Block::kWidth;
+        continue;
+      }
+      // Copy the single-byte varints in front of the first multi-byte one.
+      const int run = mask == 0 ? Block::kWidth : __builtin_ctz(mask);
+      for (int i = 0; i < run; ++i, ++index) {
+        if (index < capacity) out[index] = p[i];
+      }
+      p += run;
+      if (mask == 0) continue;
+    }
+    uint64 value;
+    p = DecodeVarint64(p, end, &value);
+    if (p == nullptr) return false;
+    if (index < capacity) out[index] = static_cast<int64>(value);
+    ++index;
+  }
+  return true;
+}
+#else
+bool DecodePackedVarintsScalar(const uint8* p, const uint8* end, int64* out,
+                               size_t capacity) {
+  size_t index = 0;
+  while (p < end) {
+    uint64 value;
+    p = DecodeVarint64(p, end, &value);
+    if (p == nullptr) return false;
+    if (index < capacity) out[index] = static_cast<int64>(value);
+    ++index;
+  }
+  return true;
+}
+#endif
+
+#ifdef TF_EXAMPLE_PARSING_USE_SSE2
+struct Sse2Block {
+  static constexpr int kWidth = 16;
+
+  static inline uint32 ContinuationMask(const uint8* p) {
+    return _mm_movemask_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+  }
+
+  static inline void Widen(const uint8* p, int64* out) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i* dst = reinterpret_cast<__m128i*>(out);
+    const __m128i words[2] = {_mm_unpacklo_epi8(bytes, zero),
+                              _mm_unpackhi_epi8(bytes, zero)};
+    for (int i = 0; i < 2; ++i) {
+      const __m128i dwords[2] = {_mm_unpacklo_epi16(words[i], zero),
+                                 _mm_unpackhi_epi16(words[i], zero)};
+      for (int j = 0; j < 2; ++j) {
+        _mm_storeu_si128(dst++, _mm_unpacklo_epi32(dwords[j], zero));
+        _mm_storeu_si128(dst++, _mm_unpackhi_epi32(dwords[j], zero));
+      }
+    }
+  }
+};
+
+size_t CountPackedVarintsSse2(const uint8* p, const uint8* end) {
+  size_t count = 0;
+  for (; end - p >= Sse2Block::kWidth; p += Sse2Block::kWidth) {
+    count += Sse2Block::kWidth -
+             __builtin_popcount(Sse2Block::ContinuationMask(p));
+  }
+  return count + CountPackedVarintsScalar(p, end);
+}
+
+bool DecodePackedVarintsSse2(const uint8* p, const uint8* end, int64* out,
+                             size_t capacity) {
+  return DecodePackedVarints<Sse2Block>(p, end, out, capacity);
+}
+#endif  // TF_EXAMPLE_PARSING_USE_SSE2
+
+#ifdef TF_EXAMPLE_PARSING_USE_AVX2
+// Built with the AVX2 target attribute so that the default build flags can
+// stay at the baseline ISA; only used when the CPU reports AVX2. The entry
+// points are flattened so the block helpers get inlined into AVX2 code.
+struct Avx2Block {
+  static constexpr int kWidth = 32;
+
+  __attribute__((target("avx2"))) static inline uint32 ContinuationMask(
+      const uint8* p) {
+    return _mm256_movemask_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+  }
+
+  __attribute__((target("avx2"))) static inline void Widen(const uint8* p,
+                                                           int64* out) {
+    __m256i* dst = reinterpret_cast<__m256i*>(out);
+    for (int half = 0; half < 2; ++half) {
+      const __m128i bytes =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * half));
+      _mm256_storeu_si256(dst++, _mm256_cvtepu8_epi64(bytes));
+      _mm256_storeu_si256(dst++,
+                          _mm256_cvtepu8_epi64(_mm_srli_si128(bytes, 4)));
+      _mm256_storeu_si256(dst++,
+                          _mm256_cvtepu8_epi64(_mm_srli_si128(bytes, 8)));
+      _mm256_storeu_si256(dst++,
+                          _mm256_cvtepu8_epi64(_mm_srli_si128(bytes, 12)));
+    }
+  }
+};
+
+__attribute__((target("avx2"), flatten)) size_t CountPackedVarintsAvx2(
+    const uint8* p, const uint8* end) {
+  size_t count = 0;
+  for (; end - p >= Avx2Block::kWidth; p += Avx2Block::kWidth) {
+    count += Avx2Block::kWidth -
+             __builtin_popcount(Avx2Block::ContinuationMask(p));
+  }
+  return count + CountPackedVarintsScalar(p, end);
+}
+
+__attribute__((target("avx2"), flatten)) bool DecodePackedVarintsAvx2(
+    const uint8* p, const uint8* end, int64* out, size_t capacity) {
+  return DecodePackedVarints<Avx2Block>(p, end, out, capacity);
+}
+#endif  // TF_EXAMPLE_PARSING_USE_AVX2
+
+#ifdef TF_EXAMPLE_PARSING_USE_NEON
+struct NeonBlock {
+  static constexpr int kWidth = 16;
+
+  static inline uint32 ContinuationMask(const uint8* p) {
+    const uint8x16_t bytes = vld1q_u8(p);
+    if (vmaxvq_u8(bytes) < 0x80) return 0;
+    // NEON has no movemask; weigh each lane's top bit by its position and
+    // add up each half.
+    static const uint8 kWeights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                       1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits =
+        vandq_u8(vcltq_s8(vreinterpretq_s8_u8(bytes), vdupq_n_s8(0)),
+                 vld1q_u8(kWeights));
+    return vaddv_u8(vget_low_u8(bits)) |
+           (static_cast<uint32>(vaddv_u8(vget_high_u8(bits))) << 8);
+  }
+
+  static inline void Widen(const uint8* p, int64* out) {
+    const uint8x16_t bytes = vld1q_u8(p);
+    const uint16x8_t words[2] = {vmovl_u8(vget_low_u8(bytes)),
+                                 vmovl_u8(vget_high_u8(bytes))};
+    for (int i = 0; i < 2; ++i) {
+      const uint32x4_t dwords[2] = {vmovl_u16(vget_low_u16(words[i])),
+                                    vmovl_u16(vget_high_u16(words[i]))};
+      for (int j = 0; j < 2; ++j) {
+        vst1q_s64(out, vreinterpretq_s64_u64(
+                           vmovl_u32(vget_low_u32(dwords[j]))));
+        vst1q_s64(out + 2, vreinterpretq_s64_u64(
+                               vmovl_u32(vget_high_u32(dwords[j]))));
+        out += 4;
+      }
+    }
+  }
+};
+
+size_t CountPackedVarintsNeon(const uint8* p, const uint8* end) {
+  size_t count = 0;
+  for (; end - p >= NeonBlock::kWidth; p += NeonBlock::kWidth) {
+    const uint8x16_t bytes = vld1q_u8(p);
+    count += vaddvq_u8(vshrq_n_u8(vmvnq_u8(bytes), 7));
+  }
+  return count + CountPackedVarintsScalar(p, end);
+}
+
+bool DecodePackedVarintsNeon(const uint8* p, const uint8* end, int64* out,
+                             size_t capacity) {
+  return DecodePackedVarints<NeonBlock>(p, end, out, capacity);
+}
+#endif  // TF_EXAMPLE_PARSING_USE_NEON
+
+struct PackedVarintDecoder {
+  size_t (*count)(const uint8* p, const uint8* end);
+  bool (*decode)(const uint8* p, const uint8* end, int64* out,
+                 size_t capacity);
+};
+
+PackedVarintDecoder SelectPackedVarintDecoder() {
+#ifdef TF_EXAMPLE_PARSING_USE_AVX2
+  if (port::TestCPUFeature(port::CPUFeature::AVX2)) {
+    return {CountPackedVarintsAvx2, DecodePackedVarintsAvx2};
+  }
+#endif
+#if defined(TF_EXAMPLE_PARSING_USE_SSE2)
+  return {CountPackedVarintsSse2, DecodePackedVarintsSse2};
+#elif defined(TF_EXAMPLE_PARSING_USE_NEON)
+  return {CountPackedVarintsNeon, DecodePackedVarintsNeon};
+#else
+  return {CountPackedVarintsScalar, DecodePackedVarintsScalar};
+#endif
+}
+
+const PackedVarintDecoder& GetPackedVarintDecoder() {
+  static const PackedVarintDecoder decoder = SelectPackedVarintDecoder();
+  return decoder;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -299,15 +555,29 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64>(n));
+        if (packed_length > 0) {
+          const void* packed_data;
+          int available;
+          if (!stream.GetDirectBufferPointer(&packed_data, &available) ||
+              available < static_cast<int>(packed_length)) {
+            return false;
+          }
+          const uint8* begin = static_cast<const uint8*>(packed_data);
+          const uint8* end = begin + packed_length;
+
+          // Size the output once from the number of varints, then decode the
+          // payload in bulk; a LimitedArraySlice may accept fewer values.
+          const PackedVarintDecoder& decoder = GetPackedVarintDecoder();
+          const size_t initial_size = int64_list->size();
+          const size_t num_values = decoder.count(begin, end);
+          int64_list->resize(initial_size + num_values);
+          const size_t capacity = int64_list->size() - initial_size;
+          if (!decoder.decode(begin, end, int64_list->data() + initial_size,
+                              capacity)) {
+            return false;
+          }
+          if (!stream.Skip(packed_length)) return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
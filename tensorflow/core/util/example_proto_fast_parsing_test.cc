@@ -13,12 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -249,6 +251,39 @@ static string ExampleWithSomeFeatures() {
 
 TEST(FastParse, SomeFeatures) { TestCorrectness(ExampleWithSomeFeatures()); }
 
+// A single int64 feature "a" holding the packed values 1 and 150.
+constexpr char kPackedInt64Example[] =
+    "\x0a\x0e\x0a\x0c\x0a\x01\x61\x12\x07\x1a\x05\x0a\x03\x01\x96\x01";
+
+TEST(FastParse, PackedInt64) { TestCorrectness(kPackedInt64Example); }
+
+TEST(FastParse, TruncatedPackedInt64) {
+  string serialized(kPackedInt64Example, sizeof(kPackedInt64Example) - 1);
+  // Set the continuation bit on the last byte of the packed payload.
+  serialized.back() |= 0x80;
+  Example example;
+  EXPECT_FALSE(TestFastParse(serialized, &example));
+}
+
+TEST(FastParse, PackedInt64VarintWidths) {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["int64_list"]
+          .mutable_int64_list();
+  // Long runs of single-byte varints interleaved with every other varint
+  // width, so that both the bulk and the scalar decoding paths are covered.
+  for (int i = 0; i < 100; ++i) int64_list->add_value(i);
+  for (int shift = 7; shift < 64; shift += 7) {
+    int64_list->add_value(static_cast<int64>(uint64{1} << shift));
+    for (int i = 0; i < shift; ++i) int64_list->add_value(127 - i);
+  }
+  int64_list->add_value(-1);
+  int64_list->add_value(std::numeric_limits<int64>::min());
+  int64_list->add_value(std::numeric_limits<int64>::max());
+  for (int i = 0; i < 40; ++i) int64_list->add_value(i % 3);
+  TestCorrectness(Serialize(example));
+}
+
 static void AddDenseFeature(const char* feature_name, DataType dtype,
                             PartialTensorShape shape, bool variable_length,
                             size_t elements_per_stride,
@@ -321,6 +356,40 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+TEST(FastParse, DensePackedInt64) {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["ids"]
+          .mutable_int64_list();
+  std::vector<int64> expected;
+  for (int i = 0; i < 70; ++i) {
+    expected.push_back(i % 5 == 0 ? int64{1000} * i : i);
+    int64_list->add_value(expected.back());
+  }
+  std::vector<tstring> serialized(2, Serialize(example));
+
+  FastParseExampleConfig config;
+  AddDenseFeature("ids", DT_INT64, {70}, false, 70, &config);
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  ASSERT_EQ(1, result.dense_values.size());
+  auto values = result.dense_values[0].matrix<int64>();
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 70; ++j) {
+      EXPECT_EQ(expected[j], values(i, j));
+    }
+  }
+
+  // Lists that do not match the dense shape are rejected.
+  for (int64 size : {69, 71}) {
+    FastParseExampleConfig config;
+    AddDenseFeature("ids", DT_INT64, {size}, false, size, &config);
+    Result result;
+    EXPECT_FALSE(
+        FastParseExample(config, serialized, {}, nullptr, &result).ok());
+  }
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
@@ -423,6 +492,90 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+
+// Benchmarks over Example shapes that are common in input pipelines. Items
+// are features, so the reported rate is the inverse of the cost per feature.
+struct BenchmarkShape {
+  int num_int64;       // Number of int64 features,
+  int int64_length;    // each with this many values,
+  uint64 int64_range;  // drawn from [0, int64_range), or any value if 0.
+  int num_float;
+  int float_length;
+  int num_bytes;
+};
+
+constexpr BenchmarkShape kBenchmarkShapes[] = {
+    // A list of small ids, e.g. categories or token ids below 128.
+    {1, 256, 128, 0, 0, 0},
+    // A list of hashed ids, which are mostly 9 or 10 byte varints.
+    {1, 256, 0, 0, 0, 0},
+    // A ranking example with many scalar features and a few short lists.
+    {16, 1, 10000, 16, 1, 4},
+    // Precomputed embeddings.
+    {0, 0, 0, 8, 128, 0},
+};
+
+void BM_FastParseExample(::testing::benchmark::State& state) {
+  const BenchmarkShape& shape = kBenchmarkShapes[state.range(0)];
+  const int batch_size = state.range(1);
+  random::PhiloxRandom philox(301);
+  random::SimplePhilox rng(&philox);
+
+  Example example;
+  FastParseExampleConfig config;
+  auto& features = *example.mutable_features()->mutable_feature();
+  std::vector<string> names;
+  auto add_feature = [&](const char* prefix, int i, DataType dtype,
+                         int length) {
+    names.push_back(strings::StrCat(prefix, i));
+    AddDenseFeature(names.back().c_str(), dtype, {length}, false, length,
+                    &config);
+    return &features[names.back()];
+  };
+  names.reserve(shape.num_int64 + shape.num_float + shape.num_bytes);
+  for (int i = 0; i < shape.num_int64; ++i) {
+    Int64List* list = add_feature("int64_", i, DT_INT64, shape.int64_length)
+                          ->mutable_int64_list();
+    for (int j = 0; j < shape.int64_length; ++j) {
+      const uint64 value = rng.Rand64();
+      list->add_value(shape.int64_range ? value % shape.int64_range : value);
+    }
+  }
+  for (int i = 0; i < shape.num_float; ++i) {
+    FloatList* list = add_feature("float_", i, DT_FLOAT, shape.float_length)
+                          ->mutable_float_list();
+    for (int j = 0; j < shape.float_length; ++j) {
+      list->add_value(rng.RandFloat());
+    }
+  }
+  for (int i = 0; i < shape.num_bytes; ++i) {
+    add_feature("bytes_", i, DT_STRING, 1)
+        ->mutable_bytes_list()
+        ->add_value(RandStr(&rng));
+  }
+  std::vector<tstring> serialized(batch_size, Serialize(example));
+
+  for (auto s : state) {
+    Result result;
+    TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  }
+  const int64 num_features =
+      shape.num_int64 + shape.num_float + shape.num_bytes;
+  state.SetItemsProcessed(state.iterations() * batch_size * num_features);
+  state.SetBytesProcessed(state.iterations() * batch_size *
+                          serialized[0].size());
+}
+
+BENCHMARK(BM_FastParseExample)
+    ->ArgPair(0, 1)
+    ->ArgPair(0, 128)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 128)
+    ->ArgPair(2, 1)
+    ->ArgPair(2, 128)
+    ->ArgPair(3, 1)
+    ->ArgPair(3, 128);
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
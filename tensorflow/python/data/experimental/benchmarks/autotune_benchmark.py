@@ -17,6 +17,7 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import time
 
 import numpy as np
 
@@ -261,6 +262,64 @@ class AutotuneBenchmark(benchmark_base.DatasetBenchmarkBase):
         benchmark_label="map_and_batch_and_interleave",
         benchmark_id=benchmark_id)
 
+  def benchmark_map_and_interleave_cpu_time(self):
+    a = self._benchmark_map_and_interleave_cpu_time(
+        autotune_cpu_time=False, benchmark_id=1)
+    b = self._benchmark_map_and_interleave_cpu_time(
+        autotune_cpu_time=True, benchmark_id=2)
+    print("autotune against cpu time vs hill climb throughput per cpu-second "
+          "ratio: {}".format(b / a))
+
+  def _benchmark_map_and_interleave_cpu_time(self, autotune_cpu_time,
+                                             benchmark_id):
+    # An oversubscribed pipeline: the autotunable stages together ask for far
+    # more parallelism than there are cores, so the elements produced per
+    # CPU-second measure how much parallelism is wasted on contention.
+    k = 1024 * 1024
+    num_elements = 1000
+    a = (np.random.rand(1, 8 * k), np.random.rand(8 * k, 1))
+    dataset = dataset_ops.Dataset.from_tensors(a).repeat()
+    dataset = dataset.interleave(
+        lambda x, y: dataset_ops.Dataset.from_tensors((x, y)).repeat(16),
+        cycle_length=10,
+        num_parallel_calls=dataset_ops.AUTOTUNE)
+    for _ in range(3):
+      dataset = dataset.map(
+          lambda x, y: (x, y, math_ops.matmul(x, y)),
+          num_parallel_calls=dataset_ops.AUTOTUNE)
+      dataset = dataset.map(lambda x, y, _: (x, y))
+    dataset = dataset.batch(
+        batch_size=4, num_parallel_calls=dataset_ops.AUTOTUNE)
+
+    options = dataset_ops.Options()
+    options.experimental_optimization.apply_default_optimizations = False
+    options.experimental_optimization.autotune = True
+    options.experimental_optimization.autotune_cpu_time = autotune_cpu_time
+    dataset = dataset.with_options(options)
+
+    start = time.process_time()
+    wall_time = self.run_benchmark(
+        dataset=dataset, num_elements=num_elements, iters=1, warmup=False)
+    cpu_time = time.process_time() - start
+    elements_per_cpu_second = num_elements / cpu_time
+
+    label = "map_and_interleave_cpu_time"
+    self.report_benchmark(
+        wall_time=wall_time,
+        iters=1,
+        name=label + ("_autotune_cpu_time" if autotune_cpu_time else ""),
+        extras={
+            "model_name":
+                "autotune.benchmark.%s.%d" % (label, benchmark_id),
+            "parameters":
+                "%s" % autotune_cpu_time,
+            "elements_per_cpu_second":
+                elements_per_cpu_second,
+            "num_elements":
+                num_elements,
+        })
+    return elements_per_cpu_second
+
 
 if __name__ == "__main__":
   benchmark_base.test.main()
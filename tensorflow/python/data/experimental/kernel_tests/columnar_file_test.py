@@ -0,0 +1,87 @@
+# Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for writing and reading columnar files."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+from absl.testing import parameterized
+
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import tensor_spec
+from tensorflow.python.ops import gen_experimental_dataset_ops
+from tensorflow.python.ops import string_ops
+from tensorflow.python.platform import test
+
+
+class ColumnarFileTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  def _write(self, dataset, columns, compression_type="",
+             rows_per_row_group=0):
+    filename = os.path.join(self.get_temp_dir(), "columnar")
+    self.evaluate(
+        gen_experimental_dataset_ops.dataset_to_columnar_file(
+            dataset._variant_tensor,
+            filename=filename,
+            columns=columns,
+            compression_type=compression_type,
+            rows_per_row_group=rows_per_row_group))
+    return filename
+
+  def _read(self, filename, columns, dtypes_, batch_size):
+    variant = gen_experimental_dataset_ops.columnar_dataset(
+        filenames=filename,
+        columns=columns,
+        batch_size=batch_size,
+        num_parallel_reads=dataset_ops.AUTOTUNE,
+        output_types=dtypes_,
+        output_shapes=[[None]] * len(dtypes_))
+    return dataset_ops._VariantDataset(
+        variant, tuple(tensor_spec.TensorSpec([None], d) for d in dtypes_))
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(compression_type=["", "ZLIB"])))
+  def testRoundTripRows(self, compression_type):
+    dataset = dataset_ops.Dataset.range(10).map(
+        lambda x: (x, string_ops.as_string(x)))
+    filename = self._write(
+        dataset, ["id", "name"],
+        compression_type=compression_type,
+        rows_per_row_group=4)
+    self.assertDatasetProduces(
+        self._read(filename, ["name", "id"], [dtypes.string, dtypes.int64],
+                   batch_size=6),
+        expected_output=[([b"0", b"1", b"2", b"3", b"4", b"5"],
+                          [0, 1, 2, 3, 4, 5]),
+                         ([b"6", b"7", b"8", b"9"], [6, 7, 8, 9])])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testRoundTripBatches(self):
+    dataset = dataset_ops.Dataset.range(7).batch(3)
+    filename = self._write(dataset, ["id"])
+    self.assertDatasetProduces(
+        self._read(filename, ["id"], [dtypes.int64], batch_size=4),
+        expected_output=[([0, 1, 2, 3],), ([4, 5, 6],)])
+
+
+if __name__ == "__main__":
+  test.main()
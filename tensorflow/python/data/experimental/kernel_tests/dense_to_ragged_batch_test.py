@@ -25,6 +25,7 @@ from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.util import nest
 from tensorflow.python.framework import combinations
+from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import sparse_tensor
@@ -140,6 +141,28 @@ class RaggedBatchTest(test_base.DatasetTestBase, parameterized.TestCase):
     with self.assertRaises(errors.OutOfRangeError):
       self.evaluate(get_next())
 
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(parallel_copy=[False, True])))
+  def testBatchesLeadingDimensionDirectly(self, parallel_copy):
+    # Elements whose only unknown dimension is the leading one are batched
+    # without being encoded as ragged tensors first.
+    supports = batching._DenseToRaggedBatchDataset.supports  # pylint: disable=protected-access
+    dataset = _make_tuple_ds(10)
+    self.assertTrue(supports(dataset.element_spec))
+    dataset = dataset.apply(
+        batching.dense_to_ragged_batch(
+            4, row_splits_dtype=dtypes.int32, parallel_copy=parallel_copy))
+    self.assertEqual(dataset.element_spec[1].row_splits_dtype, dtypes.int32)
+    get_next = self.getNext(dataset)
+    result = self.evaluate(get_next())
+    self.assertAllEqual(result[0], [0, 1, 2, 3])
+    self.assertAllEqual(result[1], [[], [0], [0, 1], [0, 1, 2]])
+    self.assertAllEqual(result[2], [[[x, x]] * x for x in range(4)])
+
+    dataset = _make_matrix_ds2(10)
+    self.assertFalse(supports(dataset.element_spec))
+
   @combinations.generate(test_base.default_test_combinations())
   def testWithStructuredElements(self):
     nrows = 20
@@ -0,0 +1,102 @@
+# Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the `ParseExampleVectorization` optimization."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from absl.testing import parameterized
+
+from tensorflow.core.example import example_pb2
+from tensorflow.core.example import feature_pb2
+from tensorflow.python.data.experimental.ops import testing
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import dtypes
+from tensorflow.python.ops import parsing_ops
+from tensorflow.python.platform import test
+
+
+def _make_example(i):
+  example = example_pb2.Example(
+      features=feature_pb2.Features(
+          feature={
+              "a":
+                  feature_pb2.Feature(
+                      int64_list=feature_pb2.Int64List(value=[i, 2 * i])),
+              "b":
+                  feature_pb2.Feature(
+                      bytes_list=feature_pb2.BytesList(
+                          value=[b"x%d" % i])),
+          }))
+  return example.SerializeToString()
+
+
+class ParseExampleVectorizationTest(test_base.DatasetTestBase,
+                                    parameterized.TestCase):
+
+  def _features(self):
+    return {
+        "a": parsing_ops.FixedLenFeature([2], dtypes.int64),
+        "b": parsing_ops.FixedLenFeature([], dtypes.string),
+        "c": parsing_ops.FixedLenFeature([], dtypes.float32, default_value=1.),
+    }
+
+  def _expected(self, start, end):
+    return {
+        "a": [[i, 2 * i] for i in range(start, end)],
+        "b": [b"x%d" % i for i in range(start, end)],
+        "c": [1.] * (end - start),
+    }
+
+  def _options(self):
+    options = dataset_ops.Options()
+    options.experimental_optimization.apply_default_optimizations = False
+    options.experimental_optimization.parse_example_vectorization = True
+    return options
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testParseExampleVectorization(self):
+    features = self._features()
+    dataset = dataset_ops.Dataset.from_tensor_slices(
+        [_make_example(i) for i in range(10)])
+    dataset = dataset.apply(
+        testing.assert_next(["BatchV2", "ParseExampleV2"])).map(
+            lambda x: parsing_ops.parse_single_example(x, features)).batch(
+                4, drop_remainder=False)
+    dataset = dataset.with_options(self._options())
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[
+            self._expected(0, 4),
+            self._expected(4, 8),
+            self._expected(8, 10)
+        ])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testNoVectorizationForVarLenFeatures(self):
+    features = {"a": parsing_ops.VarLenFeature(dtypes.int64)}
+    dataset = dataset_ops.Dataset.from_tensor_slices(
+        [_make_example(i) for i in range(4)])
+    dataset = dataset.apply(testing.assert_next(["Map", "BatchV2"])).map(
+        lambda x: parsing_ops.parse_single_example(x, features)["a"].values)
+    dataset = dataset.batch(2).with_options(self._options())
+    self.assertDatasetProduces(
+        dataset, expected_output=[[[0, 0], [1, 2]], [[2, 4], [3, 6]]])
+
+
+if __name__ == "__main__":
+  test.main()
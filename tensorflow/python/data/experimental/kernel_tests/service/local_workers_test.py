@@ -159,6 +159,24 @@ class LocalWorkersTest(data_service_test_base.TestBase, parameterized.TestCase):
     self.assertDatasetProduces(
         ds, num_workers * list(range(num_elements)), assert_items_equal=True)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(
+              num_local_workers=[1, 3], num_remote_workers=[0, 3])))
+  def testAutoRead(self, num_local_workers, num_remote_workers):
+    """Local workers are read in-process and remote workers over gRPC."""
+
+    cluster = multi_process_cluster.MultiProcessCluster(
+        num_local_workers=num_local_workers,
+        num_remote_workers=num_remote_workers)
+    num_elements = 10
+    ds = self.make_distributed_range_dataset(
+        num_elements, cluster, target_workers="auto")
+    num_workers = num_local_workers + num_remote_workers
+    self.assertDatasetProduces(
+        ds, num_workers * list(range(num_elements)), assert_items_equal=True)
+
   @combinations.generate(test_base.default_test_combinations())
   def testNoLocalWorker(self):
     cluster = multi_process_cluster.MultiProcessCluster(
@@ -35,7 +35,8 @@ from tensorflow.python.util.tf_export import tf_export
 @tf_export("data.experimental.dense_to_ragged_batch")
 def dense_to_ragged_batch(batch_size,
                           drop_remainder=False,
-                          row_splits_dtype=dtypes.int64):
+                          row_splits_dtype=dtypes.int64,
+                          parallel_copy=False):
   """A transformation that batches ragged elements into `tf.RaggedTensor`s.
 
   This transformation combines multiple consecutive elements of the input
@@ -85,12 +86,20 @@ def dense_to_ragged_batch(batch_size,
     row_splits_dtype: The dtype that should be used for the `row_splits` of any
       new ragged tensors.  Existing `tf.RaggedTensor` elements do not have their
       row_splits dtype changed.
+    parallel_copy: (Optional.) A `bool`. If `True`, the components of each
+      batch are copied in parallel. This only applies when every component is
+      a `tf.Tensor` whose shape is fully defined or only has an unknown leading
+      dimension; such elements are batched in one pass without encoding each
+      of them as a `tf.RaggedTensor` first.
 
   Returns:
     Dataset: A `Dataset`.
   """
 
   def _apply_fn(dataset):
+    if _DenseToRaggedBatchDataset.supports(dataset.element_spec):
+      return _DenseToRaggedBatchDataset(dataset, batch_size, drop_remainder,
+                                        row_splits_dtype, parallel_copy)
     ragged_dataset = _DenseToRaggedDataset(dataset, row_splits_dtype)
     return dataset_ops.BatchDataset(
         ragged_dataset, batch_size=batch_size, drop_remainder=drop_remainder)
@@ -377,6 +386,70 @@ class _MapAndBatchDataset(dataset_ops.UnaryDataset):
     return self._element_spec
 
 
+class _DenseToRaggedBatchDataset(dataset_ops.UnaryDataset):
+  """A `Dataset` that batches variable-length elements into ragged tensors.
+
+  Unlike `_DenseToRaggedDataset` followed by a `BatchDataset`, the row splits
+  and flat values of each batch are built directly from the element lengths,
+  without encoding every element as a ragged tensor first.
+  """
+
+  def __init__(self, input_dataset, batch_size, drop_remainder,
+               row_splits_dtype, parallel_copy=False):
+    """See `dense_to_ragged_batch()` for details."""
+    self._input_dataset = input_dataset
+    self._batch_size = ops.convert_to_tensor(
+        batch_size, dtype=dtypes.int64, name="batch_size")
+    self._drop_remainder = ops.convert_to_tensor(
+        drop_remainder, dtype=dtypes.bool, name="drop_remainder")
+
+    constant_batch_size = None
+    if tensor_util.constant_value(self._drop_remainder):
+      constant_batch_size = tensor_util.constant_value(self._batch_size)
+
+    def batched_spec(spec):
+      if _DenseToRaggedBatchDataset._is_ragged_component(spec):
+        spec = ragged_tensor.RaggedTensorSpec(
+            shape=spec.shape,
+            dtype=spec.dtype,
+            ragged_rank=0,
+            row_splits_dtype=row_splits_dtype)
+      return spec._batch(constant_batch_size)  # pylint: disable=protected-access
+
+    self._structure = nest.map_structure(batched_spec,
+                                         input_dataset.element_spec)
+    variant_tensor = ged_ops.dense_to_ragged_batch_dataset(
+        input_dataset._variant_tensor,  # pylint: disable=protected-access
+        batch_size=self._batch_size,
+        drop_remainder=self._drop_remainder,
+        parallel_copy=parallel_copy,
+        Tsplits=row_splits_dtype,
+        **self._flat_structure)
+    super(_DenseToRaggedBatchDataset, self).__init__(input_dataset,
+                                                     variant_tensor)
+
+  @staticmethod
+  def _is_ragged_component(spec):
+    """Whether `spec` has an unknown leading dimension and no other."""
+    shape = spec.shape
+    return (shape.rank is not None and shape.rank > 0 and
+            tensor_shape.dimension_value(shape[0]) is None and
+            shape[1:].is_fully_defined())
+
+  @staticmethod
+  def supports(element_spec):
+    """Whether elements of `element_spec` can be batched by this dataset."""
+    return all(
+        isinstance(spec, tensor_spec.TensorSpec) and
+        (spec.shape.is_fully_defined() or
+         _DenseToRaggedBatchDataset._is_ragged_component(spec))
+        for spec in nest.flatten(element_spec))
+
+  @property
+  def element_spec(self):
+    return self._structure
+
+
 class _DenseToRaggedDataset(dataset_ops.UnaryDataset):
   """A `Dataset` that encodes dense inputs as ragged (w/ ragged_rank=0).
 
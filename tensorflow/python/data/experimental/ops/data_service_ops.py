@@ -326,6 +326,11 @@ def _distribute(processing_mode,
             compression, valid_compressions))
   if compression == COMPRESSION_AUTO and data_transfer_protocol is not None:
     compression = COMPRESSION_NONE
+  # Local workers hand elements over in-process, so compressing them would only
+  # add CPU work.
+  if (compression == COMPRESSION_AUTO and
+      str(target_workers).upper() == "LOCAL"):
+    compression = COMPRESSION_NONE
   def _apply_fn(dataset):  # pylint: disable=missing-docstring
     dataset_id = _register_dataset(service, dataset, compression=compression)
     return _from_dataset_id(
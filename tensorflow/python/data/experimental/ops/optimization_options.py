@@ -28,6 +28,7 @@ class _AutotuneAlgorithm(enum.Enum):
   """Controls what algorithm is used in the autotune implementation."""
   HILL_CLIMB = 0
   GRADIENT_DESCENT = 1
+  CPU_TIME_HILL_CLIMB = 2
 
 
 @tf_export("data.experimental.OptimizationOptions")
@@ -84,6 +85,16 @@ class OptimizationOptions(options.OptionsBase):
       "budget to use. Values greater than the available RAM in bytes may "
       "result in OOM. If None, defaults to half of the available RAM in bytes.")
 
+  autotune_cpu_time = options.create_option(
+      name="autotune_cpu_time",
+      ty=bool,
+      docstring=
+      "When autotuning is enabled (through `autotune`), determines whether to "
+      "measure the thread CPU time spent in each transformation and tune "
+      "parallelism against it rather than against wall-clock time, keeping "
+      "the total parallelism within `autotune_cpu_budget`. Ignored when "
+      "`autotune_buffers` is enabled. If None, defaults to False.")
+
   filter_fusion = options.create_option(
       name="filter_fusion",
       ty=bool,
@@ -134,6 +145,16 @@ class OptimizationOptions(options.OptionsBase):
       "batching and b) you have validated that this optimization improves "
       "performance. If None, defaults to False.")
 
+  parse_example_vectorization = options.create_option(
+      name="parse_example_vectorization",
+      ty=bool,
+      docstring="Whether to replace a map transformation whose function only "
+      "parses its input with `tf.io.parse_single_example`, followed by a "
+      "batch transformation, with a transformation that parses each batch with "
+      "a single call. Only functions that return all parsed features, which "
+      "must be dense and of fixed shape, are rewritten. If None, defaults to "
+      "False.")
+
   shuffle_and_repeat_fusion = options.create_option(
       name="shuffle_and_repeat_fusion",
       ty=bool,
@@ -150,6 +171,8 @@ class OptimizationOptions(options.OptionsBase):
       pb.autotune_buffers = self.autotune_buffers
     if self.autotune_cpu_budget is not None:
       pb.autotune_cpu_budget = self.autotune_cpu_budget
+    if self.autotune_cpu_time is not None:
+      pb.autotune_cpu_time = self.autotune_cpu_time
     if self.autotune_ram_budget is not None:
       pb.autotune_ram_budget = self.autotune_ram_budget
     if self.filter_fusion is not None:
@@ -166,6 +189,8 @@ class OptimizationOptions(options.OptionsBase):
       pb.noop_elimination = self.noop_elimination
     if self.parallel_batch is not None:
       pb.parallel_batch = self.parallel_batch
+    if self.parse_example_vectorization is not None:
+      pb.parse_example_vectorization = self.parse_example_vectorization
     if self.shuffle_and_repeat_fusion is not None:
       pb.shuffle_and_repeat_fusion = self.shuffle_and_repeat_fusion
     return pb
@@ -179,6 +204,8 @@ class OptimizationOptions(options.OptionsBase):
       self.autotune_buffers = pb.autotune_buffers
     if pb.WhichOneof("optional_autotune_cpu_budget") is not None:
       self.autotune_cpu_budget = pb.autotune_cpu_budget
+    if pb.WhichOneof("optional_autotune_cpu_time") is not None:
+      self.autotune_cpu_time = pb.autotune_cpu_time
     if pb.WhichOneof("optional_autotune_ram_budget") is not None:
       self.autotune_ram_budget = pb.autotune_ram_budget
     if pb.WhichOneof("optional_filter_fusion") is not None:
@@ -195,6 +222,8 @@ class OptimizationOptions(options.OptionsBase):
       self.noop_elimination = pb.noop_elimination
     if pb.WhichOneof("optional_parallel_batch") is not None:
       self.parallel_batch = pb.parallel_batch
+    if pb.WhichOneof("optional_parse_example_vectorization") is not None:
+      self.parse_example_vectorization = pb.parse_example_vectorization
     if pb.WhichOneof("optional_shuffle_and_repeat_fusion") is not None:
       self.shuffle_and_repeat_fusion = pb.shuffle_and_repeat_fusion
 
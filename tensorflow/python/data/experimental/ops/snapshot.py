@@ -193,7 +193,12 @@ def legacy_snapshot(path,
 
 @deprecation.deprecated(None, "Use `tf.data.Dataset.snapshot(...)`.")
 @tf_export("data.experimental.snapshot")
-def snapshot(path, compression="AUTO", reader_func=None, shard_func=None):
+def snapshot(path,
+             compression="AUTO",
+             reader_func=None,
+             shard_func=None,
+             writer_buffer_size_bytes=None,
+             num_writers_per_shard=None):
   """API to persist the output of the input dataset.
 
   The snapshot API allows users to transparently persist the output of their
@@ -264,6 +269,12 @@ def snapshot(path, compression="AUTO", reader_func=None, shard_func=None):
       shards.
     shard_func: Optional. A function to control how to shard data when writing a
       snapshot.
+    writer_buffer_size_bytes: Optional. The maximum number of bytes of elements
+      that are buffered for writing the snapshot. When the buffer is full,
+      reading from the input blocks until buffered elements have been written.
+      Defaults to an unbounded buffer.
+    num_writers_per_shard: Optional. The number of threads that compress and
+      write the elements of each shard, each to its own file. Defaults to 1.
 
   Returns:
     A `Dataset` transformation function, which can be passed to
@@ -272,10 +283,16 @@ def snapshot(path, compression="AUTO", reader_func=None, shard_func=None):
 
   def _apply_fn(dataset):
     """Actual dataset transformation."""
+    writer_kwargs = {}
+    if writer_buffer_size_bytes is not None:
+      writer_kwargs["writer_buffer_size_bytes"] = writer_buffer_size_bytes
+    if num_writers_per_shard is not None:
+      writer_kwargs["num_writers_per_shard"] = num_writers_per_shard
     return dataset.snapshot(
         path=path,
         compression=compression,
         reader_func=reader_func,
-        shard_func=shard_func)
+        shard_func=shard_func,
+        **writer_kwargs)
 
   return _apply_fn
@@ -54,12 +54,24 @@ class ThreadingOptions(options.OptionsBase):
       "The value 0 can be used to indicate that the threadpool size should be "
       "determined at runtime based on the number of available CPU cores.")
 
+  numa_aware = options.create_option(
+      name="numa_aware",
+      ty=bool,
+      docstring=
+      "If set, the dataset will pin its threads to the NUMA node that the "
+      "thread consuming the dataset has been pinned to, or else to the NUMA "
+      "node of the consuming CPU device when the session config sets "
+      "`use_numa_affinity`. This has no effect if neither was set, or on "
+      "machines with a single NUMA node.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.ThreadingOptions()
     if self.max_intra_op_parallelism is not None:
       pb.max_intra_op_parallelism = self.max_intra_op_parallelism
     if self.private_threadpool_size is not None:
       pb.private_threadpool_size = self.private_threadpool_size
+    if self.numa_aware is not None:
+      pb.numa_aware = self.numa_aware
     return pb
 
   def _from_proto(self, pb):
@@ -67,3 +79,5 @@ class ThreadingOptions(options.OptionsBase):
       self.max_intra_op_parallelism = pb.max_intra_op_parallelism
     if pb.WhichOneof("optional_private_threadpool_size") is not None:
       self.private_threadpool_size = pb.private_threadpool_size
+    if pb.WhichOneof("optional_numa_aware") is not None:
+      self.numa_aware = pb.numa_aware
@@ -31,6 +31,7 @@ from tensorflow.python.framework import combinations
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import gen_dataset_ops
 from tensorflow.python.ops import io_ops
 from tensorflow.python.ops import math_ops
@@ -400,6 +401,93 @@ class CheckpointTest(test_base.DatasetTestBase, parameterized.TestCase):
     self.assertNotEqual(iter1, iter2)
     self.assertCountEqual(iter2, iter3)
 
+  @combinations.generate(test_base.eager_only_combinations())
+  def testSaveRestoreSymbolicCheckpoint(self):
+    checkpoint_directory = self.get_temp_dir()
+    checkpoint_prefix = os.path.join(checkpoint_directory, "ckpt")
+    dataset = dataset_ops.Dataset.range(100)
+    dataset = dataset.shuffle(20, seed=42, reshuffle_each_iteration=False)
+    dataset = dataset.map(
+        math_ops.square, num_parallel_calls=4, deterministic=True)
+    dataset = dataset.prefetch(5)
+    options = dataset_ops.Options()
+    options.experimental_symbolic_checkpoint = True
+    dataset = dataset.with_options(options)
+    iterator = iter(dataset)
+    checkpoint = trackable_utils.Checkpoint(iterator=iterator)
+    for _ in range(30):
+      next(iterator)
+    save_path = checkpoint.save(checkpoint_prefix)
+    expected = [next(iterator).numpy() for _ in range(70)]
+    checkpoint.restore(save_path).run_restore_ops()
+    actual = [next(iterator).numpy() for _ in range(70)]
+    self.assertAllEqual(expected, actual)
+    with self.assertRaises(StopIteration):
+      next(iterator)
+
+  def _saveAndRestoreSymbolic(self, dataset, num_before, num_after):
+    checkpoint_prefix = os.path.join(self.get_temp_dir(), "ckpt")
+    options = dataset_ops.Options()
+    options.experimental_symbolic_checkpoint = True
+    dataset = dataset.with_options(options)
+    iterator = iter(dataset)
+    checkpoint = trackable_utils.Checkpoint(iterator=iterator)
+    for _ in range(num_before):
+      next(iterator)
+    save_path = checkpoint.save(checkpoint_prefix)
+    expected = [next(iterator).numpy() for _ in range(num_after)]
+    checkpoint.restore(save_path).run_restore_ops()
+    actual = [next(iterator).numpy() for _ in range(num_after)]
+    self.assertAllEqual(expected, actual)
+    with self.assertRaises(StopIteration):
+      next(iterator)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testSaveRestoreSymbolicCheckpointRandomSeed(self):
+    # Without a seed, a fresh shuffle would produce a different order, so the
+    # iterator falls back to a full checkpoint.
+    dataset = dataset_ops.Dataset.range(100)
+    dataset = dataset.shuffle(20)
+    dataset = dataset.map(
+        math_ops.square, num_parallel_calls=4, deterministic=True)
+    dataset = dataset.prefetch(5)
+    self._saveAndRestoreSymbolic(dataset, num_before=30, num_after=70)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testSaveRestoreSymbolicCheckpointReshuffleRepeat(self):
+    dataset = dataset_ops.Dataset.range(20)
+    dataset = dataset.shuffle(10, seed=42, reshuffle_each_iteration=True)
+    dataset = dataset.repeat(3)
+    dataset = dataset.prefetch(5)
+    self._saveAndRestoreSymbolic(dataset, num_before=25, num_after=35)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testSymbolicCheckpointSize(self):
+
+    def checkpoint_size(symbolic):
+      dataset = dataset_ops.Dataset.range(100)
+      dataset = dataset.map(lambda x: array_ops.fill([64, 1024], x))
+      dataset = dataset.shuffle(10, seed=42, reshuffle_each_iteration=False)
+      options = dataset_ops.Options()
+      options.experimental_symbolic_checkpoint = symbolic
+      dataset = dataset.with_options(options)
+      iterator = iter(dataset)
+      next(iterator)
+      checkpoint_directory = os.path.join(self.get_temp_dir(), str(symbolic))
+      checkpoint = trackable_utils.Checkpoint(iterator=iterator)
+      checkpoint.save(os.path.join(checkpoint_directory, "ckpt"))
+      return sum(
+          os.path.getsize(os.path.join(checkpoint_directory, f))
+          for f in os.listdir(checkpoint_directory)
+          if ".data-" in f)
+
+    # The full checkpoint contains the shuffle buffer of 512KB elements, while
+    # the symbolic checkpoint only contains positions.
+    full_size = checkpoint_size(symbolic=False)
+    symbolic_size = checkpoint_size(symbolic=True)
+    self.assertGreater(full_size, 9 * 64 * 1024 * 8)
+    self.assertLess(symbolic_size, 64 * 1024)
+
   @combinations.generate(test_base.eager_only_combinations())
   def testSaveRestoreModifiedDataset(self):
     ckpt_dir = self.get_temp_dir()
@@ -161,7 +161,9 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_optimization.parallel_batch = True
     options.experimental_optimization.shuffle_and_repeat_fusion = True
     options.experimental_slack = True
+    options.experimental_symbolic_checkpoint = True
     options.threading.max_intra_op_parallelism = 30
+    options.threading.numa_aware = True
     options.threading.private_threadpool_size = 40
     pb = options._to_proto()
     result = dataset_ops.Options()
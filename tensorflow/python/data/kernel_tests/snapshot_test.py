@@ -338,6 +338,35 @@ class SnapshotTest(tf_record_test_base.TFRecordTestBase,
         num_runs_per_fingerprint=1,
         num_snapshot_shards_per_run=2)
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testWriteSnapshotBoundedBufferParallelWriters(self):
+    dataset = dataset_ops.Dataset.range(1000)
+    dataset = dataset.enumerate()
+    dataset = dataset.snapshot(
+        path=self._snapshot_dir,
+        shard_func=lambda i, _: i % 2,
+        writer_buffer_size_bytes=64,
+        num_writers_per_shard=3)
+    dataset = dataset.map(lambda _, elem: elem)
+    self.assertDatasetProduces(dataset, list(range(1000)))
+    self.assertSnapshotDirectoryContains(
+        self._snapshot_dir,
+        num_fingerprints=1,
+        num_runs_per_fingerprint=1,
+        num_snapshot_shards_per_run=2)
+
+    # The snapshot is read back from the files of all writers.
+    dataset = dataset_ops.Dataset.range(1000)
+    dataset = dataset.enumerate()
+    dataset = dataset.snapshot(
+        path=self._snapshot_dir,
+        shard_func=lambda i, _: i % 2,
+        writer_buffer_size_bytes=64,
+        num_writers_per_shard=3)
+    dataset = dataset.map(lambda _, elem: elem)
+    self.assertDatasetProduces(
+        dataset, list(range(1000)), assert_items_equal=True)
+
   @combinations.generate(test_base.default_test_combinations())
   def testWriteSnapshotDatasetWithTuples(self):
     dataset1 = dataset_ops.Dataset.range(0, 1000)
@@ -1016,7 +1045,7 @@ class LegacySnapshotTest(tf_record_test_base.TFRecordTestBase,
 class SnapshotCheckpointTest(checkpoint_test_base.CheckpointTestBase,
                              parameterized.TestCase):
 
-  def _build_snapshot_dataset(self, repeat=False):
+  def _build_snapshot_dataset(self, repeat=False, num_writers_per_shard=1):
 
     def ds_fn():
       self._snapshot_dir = os.path.join(self.get_temp_dir(), "snapshot")
@@ -1024,7 +1053,13 @@ class SnapshotCheckpointTest(checkpoint_test_base.CheckpointTestBase,
         os.mkdir(self._snapshot_dir)
 
       dataset = dataset_ops.Dataset.range(100)
-      dataset = dataset.snapshot(path=self._snapshot_dir)
+      if num_writers_per_shard > 1:
+        dataset = dataset.snapshot(
+            path=self._snapshot_dir,
+            shard_func=lambda x: x % 2,
+            num_writers_per_shard=num_writers_per_shard)
+      else:
+        dataset = dataset.snapshot(path=self._snapshot_dir)
       if repeat:
         dataset = dataset.repeat(2)
       return dataset
@@ -1040,6 +1075,29 @@ class SnapshotCheckpointTest(checkpoint_test_base.CheckpointTestBase,
         self.gen_outputs(ds_fn, [], 50, ckpt_saved=True, verify_exhausted=True))
     self.assertSequenceEqual(outputs, range(100))
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testCheckpointBeforeEpochEndParallelWriters(self):
+    ds_fn = self._build_snapshot_dataset(num_writers_per_shard=3)
+    outputs = self.gen_outputs(ds_fn, [], 50, verify_exhausted=False)
+    self.assertSequenceEqual(outputs, range(50))
+    outputs.extend(
+        self.gen_outputs(ds_fn, [], 50, ckpt_saved=True, verify_exhausted=True))
+    self.assertSequenceEqual(outputs, range(100))
+
+    # The restored run finished the snapshot, so a new iterator reads it back
+    # instead of writing another run. Files written by the first iterator
+    # after the checkpoint must not make elements appear twice.
+    outputs = self.gen_outputs(ds_fn, [], 100, verify_exhausted=True)
+    self.assertCountEqual(outputs, range(100))
+    fingerprints = listdir_and_filter(
+        self._snapshot_dir,
+        lambda p: not (is_graphdef_file(p) or is_temp_file(p)))
+    self.assertLen(fingerprints, 1)
+    runs = listdir_and_filter(
+        os.path.join(self._snapshot_dir, fingerprints[0]),
+        lambda p: not (is_temp_file(p) or p == "snapshot.metadata"))
+    self.assertLen(runs, 1)
+
   @combinations.generate(test_base.default_test_combinations())
   def testCheckpointBeforeOneEpochWithReading(self):
     ds_fn = self._build_snapshot_dataset(repeat=True)
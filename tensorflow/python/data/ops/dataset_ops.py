@@ -2768,7 +2768,9 @@ name=None))
                path,
                compression="AUTO",
                reader_func=None,
-               shard_func=None):
+               shard_func=None,
+               writer_buffer_size_bytes=None,
+               num_writers_per_shard=None):
     """API to persist the output of the input dataset.
 
     The snapshot API allows users to transparently persist the output of their
@@ -2839,6 +2841,12 @@ name=None))
         snapshot shards.
       shard_func: Optional. A function to control how to shard data when writing
         a snapshot.
+      writer_buffer_size_bytes: Optional. The maximum number of bytes of
+        elements that are buffered for writing the snapshot. When the buffer is
+        full, reading from the input blocks until buffered elements have been
+        written. Defaults to an unbounded buffer.
+      num_writers_per_shard: Optional. The number of threads that compress and
+        write the elements of each shard, each to its own file. Defaults to 1.
 
     Returns:
       A `Dataset`.
@@ -2863,7 +2871,9 @@ name=None))
         reader_func=reader_func,
         # This will not do the right thing where the graph is built on a
         # different machine than the executor (e.g. Cloud TPUs).
-        shard_func=local_shard_func)
+        shard_func=local_shard_func,
+        writer_buffer_size_bytes=writer_buffer_size_bytes,
+        num_writers_per_shard=num_writers_per_shard)
     if project_func is not None:
       dataset = dataset.map(project_func)
     return dataset
@@ -3692,6 +3702,20 @@ class Options(options_lib.OptionsBase):
       "`tf.data.experimental.OptimizationOptions` for more details.",
       default_factory=optimization_options.OptimizationOptions)
 
+  experimental_symbolic_checkpoint = options_lib.create_option(
+      name="experimental_symbolic_checkpoint",
+      ty=bool,
+      docstring="Whether iterator checkpoints should record the input "
+      "positions of buffering transformations (such as `shuffle`, `prefetch` "
+      "and deterministic parallel `map`) instead of the buffered elements. "
+      "This makes checkpoints much smaller, but restoring re-reads the input "
+      "to recompute the buffers, so it requires the input to produce the same "
+      "elements in the same order on every iteration. Pipelines with random "
+      "or non-deterministic transformations (such as `shuffle` without a "
+      "fixed seed or with `reshuffle_each_iteration=True`) fall back to full "
+      "checkpoints, and transformations whose input depends on external "
+      "state always save their buffers. If None, defaults to False.")
+
   experimental_slack = options_lib.create_option(
       name="experimental_slack",
       ty=bool,
@@ -3746,6 +3770,8 @@ class Options(options_lib.OptionsBase):
     pb.optimization_options.CopyFrom(self.experimental_optimization._to_proto())  # pylint: disable=protected-access
     if self.experimental_slack is not None:
       pb.slack = self.experimental_slack
+    if self.experimental_symbolic_checkpoint is not None:
+      pb.symbolic_checkpoint = self.experimental_symbolic_checkpoint
     pb.threading_options.CopyFrom(self.threading._to_proto())  # pylint: disable=protected-access
     return pb
 
@@ -3760,6 +3786,8 @@ class Options(options_lib.OptionsBase):
     self.experimental_optimization._from_proto(pb.optimization_options)  # pylint: disable=protected-access
     if pb.WhichOneof("optional_slack") is not None:
       self.experimental_slack = pb.slack
+    if pb.WhichOneof("optional_symbolic_checkpoint") is not None:
+      self.experimental_symbolic_checkpoint = pb.symbolic_checkpoint
     self.threading._from_proto(pb.threading_options)  # pylint: disable=protected-access
 
   def _set_mutable(self, mutable):
@@ -5578,7 +5606,9 @@ class _SnapshotDataset(UnaryUnchangedStructureDataset):
                compression=None,
                reader_func=None,
                pending_snapshot_expiry_seconds=None,
-               use_legacy_function=False):
+               use_legacy_function=False,
+               writer_buffer_size_bytes=None,
+               num_writers_per_shard=None):
 
     if reader_func is None:
       reader_func = lambda datasets: datasets.interleave(  # pylint:disable=g-long-lambda
@@ -5609,6 +5639,14 @@ class _SnapshotDataset(UnaryUnchangedStructureDataset):
       raise TypeError(
           "shard_func must return a 0-dimension tensor containing an int.")
 
+    # The writer attrs are only set when they differ from their defaults, so
+    # that the graph stays loadable by binaries that predate them.
+    compat_kwargs = {}
+    if writer_buffer_size_bytes:
+      compat_kwargs["writer_buffer_size_bytes"] = writer_buffer_size_bytes
+    if num_writers_per_shard is not None and num_writers_per_shard != 1:
+      compat_kwargs["num_writers_per_shard"] = num_writers_per_shard
+
     variant_tensor = ged_ops.snapshot_dataset_v2(
         input_dataset._variant_tensor,  # pylint: disable=protected-access
         path,
@@ -5617,6 +5655,7 @@ class _SnapshotDataset(UnaryUnchangedStructureDataset):
         compression=compression,
         reader_func=self._reader_func.function,
         shard_func=self._shard_func.function,
+        **compat_kwargs,
         **self._flat_structure)
     super(_SnapshotDataset, self).__init__(input_dataset, variant_tensor)
 